@@ -53,6 +53,61 @@ bool emp_diags_push(EmpDiags *d, EmpDiag diag) {
     return true;
 }
 
+static EmpLenAbi g_len_abi = EMP_LEN_ABI_32;
+
+void emp_set_len_abi(EmpLenAbi abi) {
+    g_len_abi = abi;
+}
+
+EmpLenAbi emp_len_abi(void) {
+    return g_len_abi;
+}
+
+size_t emp_string_inline_max(void) {
+    // Header size minus the tag byte and the NUL.
+    return g_len_abi == EMP_LEN_ABI_64 ? 22 : 14;
+}
+
+bool emp_simd_type_parse(EmpSlice name, EmpSlice *out_elem, uint32_t *out_lanes) {
+    static const struct {
+        const char *name;
+        uint32_t bits;
+    } elems[] = {
+        {"f32", 32}, {"f64", 64}, {"i8", 8}, {"i16", 16}, {"i32", 32}, {"i64", 64},
+        {"u8", 8}, {"u16", 16}, {"u32", 32}, {"u64", 64},
+    };
+    for (size_t i = 0; i < sizeof(elems) / sizeof(elems[0]); i++) {
+        size_t n = strlen(elems[i].name);
+        if (name.len < n + 2 || memcmp(name.ptr, elems[i].name, n) != 0 || name.ptr[n] != 'x') continue;
+        uint32_t lanes = 0;
+        for (size_t j = n + 1; j < name.len; j++) {
+            char c = name.ptr[j];
+            if (c < '0' || c > '9' || lanes > 64) return false;
+            lanes = lanes * 10 + (uint32_t)(c - '0');
+        }
+        if (name.ptr[n + 1] == '0' || lanes < 2 || lanes > 64 || (lanes & (lanes - 1)) != 0) return false;
+        if (lanes * elems[i].bits > 512) return false;
+        if (out_elem) *out_elem = (EmpSlice){ .ptr = name.ptr, .len = n };
+        if (out_lanes) *out_lanes = lanes;
+        return true;
+    }
+    return false;
+}
+
+bool emp_atomic_type_parse(EmpSlice name, EmpSlice *out_value) {
+    static const char *const values[] = {"i32", "i64", "u32", "u64", "ptr"};
+    static const char prefix[] = "atomic_";
+    size_t pn = sizeof(prefix) - 1;
+    if (!name.ptr || name.len <= pn || memcmp(name.ptr, prefix, pn) != 0) return false;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        size_t n = strlen(values[i]);
+        if (name.len != pn + n || memcmp(name.ptr + pn, values[i], n) != 0) continue;
+        if (out_value) *out_value = (EmpSlice){ .ptr = name.ptr + pn, .len = n };
+        return true;
+    }
+    return false;
+}
+
 const char *emp_binop_name(EmpBinOp op) {
     switch (op) {
         case EMP_BIN_ADD: return "+";
@@ -95,6 +150,7 @@ const char *emp_unop_name(EmpUnOp op) {
         case EMP_UN_BITNOT: return "~";
         case EMP_UN_BORROW: return "&";
         case EMP_UN_BORROW_MUT: return "&mut";
+        case EMP_UN_AWAIT: return "await";
         default: return "?";
     }
 }
@@ -108,6 +164,7 @@ const char *emp_type_kind_name(EmpTypeKind kind) {
         case EMP_TYPE_LIST: return "List";
         case EMP_TYPE_TUPLE: return "Tuple";
         case EMP_TYPE_DYN: return "Dyn";
+        case EMP_TYPE_GENERIC: return "Generic";
         default: return "Unknown";
     }
 }
@@ -132,6 +189,12 @@ static void emp_type_free_vectors(EmpType *t) {
             }
             emp_vec_free(&t->as.tuple.fields);
             break;
+        case EMP_TYPE_GENERIC:
+            for (size_t i = 0; i < t->as.generic.args.len; i++) {
+                emp_type_free_vectors((EmpType *)t->as.generic.args.items[i]);
+            }
+            emp_vec_free(&t->as.generic.args);
+            break;
         default:
             break;
     }
@@ -162,6 +225,10 @@ static void emp_expr_free_vectors(EmpExpr *e) {
                 emp_expr_free_vectors((EmpExpr *)e->as.call.args.items[i]);
             }
             emp_vec_free(&e->as.call.args);
+            for (size_t i = 0; i < e->as.call.type_args.len; i++) {
+                emp_type_free_vectors((EmpType *)e->as.call.type_args.items[i]);
+            }
+            emp_vec_free(&e->as.call.type_args);
             break;
         case EMP_EXPR_GROUP:
             emp_expr_free_vectors(e->as.group.inner);
@@ -224,6 +291,10 @@ static void emp_stmt_free_vectors(EmpStmt *s) {
         case EMP_STMT_RETURN:
             emp_expr_free_vectors(s->as.ret.value);
             break;
+        case EMP_STMT_YIELD:
+            emp_expr_free_vectors(s->as.yield_stmt.value);
+            emp_vec_free(&s->as.yield_stmt.drops);
+            break;
         case EMP_STMT_EXPR:
             emp_expr_free_vectors(s->as.expr.expr);
             break;
@@ -275,104 +346,116 @@ static void emp_stmt_free_vectors(EmpStmt *s) {
     }
 }
 
-void emp_program_free_vectors(EmpProgram *p) {
-    if (!p) return;
-
-    for (size_t i = 0; i < p->items.len; i++) {
-        EmpItem *it = (EmpItem *)p->items.items[i];
-        if (!it) continue;
+static void emp_item_free_vectors(EmpItem *it) {
+    if (!it) return;
 
-        switch (it->kind) {
-            case EMP_ITEM_TAG:
-                break;
-            case EMP_ITEM_EMP_MM_OFF:
-                break;
-            case EMP_ITEM_FN:
-                for (size_t j = 0; j < it->as.fn.params.len; j++) {
-                    EmpParam *param = (EmpParam *)it->as.fn.params.items[j];
+    switch (it->kind) {
+        case EMP_ITEM_TAG:
+            break;
+        case EMP_ITEM_EMP_MM_OFF:
+            break;
+        case EMP_ITEM_FN:
+            for (size_t j = 0; j < it->as.fn.params.len; j++) {
+                EmpParam *param = (EmpParam *)it->as.fn.params.items[j];
+                if (param) emp_type_free_vectors(param->ty);
+            }
+            emp_vec_free(&it->as.fn.params);
+            emp_vec_free(&it->as.fn.type_params);
+            emp_type_free_vectors(it->as.fn.ret_ty);
+            emp_stmt_free_vectors(it->as.fn.body);
+            emp_vec_free(&it->as.fn.coro_entry_drops);
+            break;
+        case EMP_ITEM_USE:
+            emp_vec_free(&it->as.use.names);
+            break;
+        case EMP_ITEM_CLASS:
+            for (size_t j = 0; j < it->as.class_decl.fields.len; j++) {
+                EmpClassField *f = (EmpClassField *)it->as.class_decl.fields.items[j];
+                if (f) emp_type_free_vectors(f->ty);
+            }
+            for (size_t j = 0; j < it->as.class_decl.methods.len; j++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[j];
+                if (!m) continue;
+                for (size_t k = 0; k < m->params.len; k++) {
+                    EmpParam *param = (EmpParam *)m->params.items[k];
                     if (param) emp_type_free_vectors(param->ty);
                 }
-                emp_vec_free(&it->as.fn.params);
-                emp_type_free_vectors(it->as.fn.ret_ty);
-                emp_stmt_free_vectors(it->as.fn.body);
-                break;
-            case EMP_ITEM_USE:
-                emp_vec_free(&it->as.use.names);
-                break;
-            case EMP_ITEM_CLASS:
-                for (size_t j = 0; j < it->as.class_decl.fields.len; j++) {
-                    EmpClassField *f = (EmpClassField *)it->as.class_decl.fields.items[j];
-                    if (f) emp_type_free_vectors(f->ty);
-                }
-                for (size_t j = 0; j < it->as.class_decl.methods.len; j++) {
-                    EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[j];
-                    if (!m) continue;
-                    for (size_t k = 0; k < m->params.len; k++) {
-                        EmpParam *param = (EmpParam *)m->params.items[k];
-                        if (param) emp_type_free_vectors(param->ty);
-                    }
-                    emp_vec_free(&m->params);
-                    emp_type_free_vectors(m->ret_ty);
-                    emp_stmt_free_vectors(m->body);
-                }
-                emp_vec_free(&it->as.class_decl.fields);
-                emp_vec_free(&it->as.class_decl.methods);
-                break;
-            case EMP_ITEM_TRAIT:
-                for (size_t j = 0; j < it->as.trait_decl.methods.len; j++) {
-                    EmpTraitMethod *m = (EmpTraitMethod *)it->as.trait_decl.methods.items[j];
-                    if (!m) continue;
-                    for (size_t k = 0; k < m->params.len; k++) {
-                        EmpParam *param = (EmpParam *)m->params.items[k];
-                        if (param) emp_type_free_vectors(param->ty);
-                    }
-                    emp_vec_free(&m->params);
-                    emp_type_free_vectors(m->ret_ty);
-                    emp_stmt_free_vectors(m->body);
-                }
-                emp_vec_free(&it->as.trait_decl.methods);
-                break;
-            case EMP_ITEM_CONST:
-                emp_type_free_vectors(it->as.const_decl.ty);
-                emp_expr_free_vectors(it->as.const_decl.init);
-                break;
-            case EMP_ITEM_STRUCT:
-                for (size_t j = 0; j < it->as.struct_decl.fields.len; j++) {
-                    EmpStructField *f = (EmpStructField *)it->as.struct_decl.fields.items[j];
-                    if (f) emp_type_free_vectors(f->ty);
+                emp_vec_free(&m->params);
+                emp_type_free_vectors(m->ret_ty);
+                emp_stmt_free_vectors(m->body);
+            }
+            emp_vec_free(&it->as.class_decl.fields);
+            emp_vec_free(&it->as.class_decl.methods);
+            break;
+        case EMP_ITEM_TRAIT:
+            for (size_t j = 0; j < it->as.trait_decl.methods.len; j++) {
+                EmpTraitMethod *m = (EmpTraitMethod *)it->as.trait_decl.methods.items[j];
+                if (!m) continue;
+                for (size_t k = 0; k < m->params.len; k++) {
+                    EmpParam *param = (EmpParam *)m->params.items[k];
+                    if (param) emp_type_free_vectors(param->ty);
                 }
-                emp_vec_free(&it->as.struct_decl.fields);
-                break;
-            case EMP_ITEM_ENUM:
-                for (size_t j = 0; j < it->as.enum_decl.variants.len; j++) {
-                    EmpEnumVariant *v = (EmpEnumVariant *)it->as.enum_decl.variants.items[j];
-                    if (!v) continue;
-                    for (size_t k = 0; k < v->fields.len; k++) {
-                        EmpType *ty = (EmpType *)v->fields.items[k];
-                        emp_type_free_vectors(ty);
-                    }
-                    emp_vec_free(&v->fields);
+                emp_vec_free(&m->params);
+                emp_type_free_vectors(m->ret_ty);
+                emp_stmt_free_vectors(m->body);
+            }
+            emp_vec_free(&it->as.trait_decl.methods);
+            break;
+        case EMP_ITEM_CONST:
+            emp_type_free_vectors(it->as.const_decl.ty);
+            emp_expr_free_vectors(it->as.const_decl.init);
+            break;
+        case EMP_ITEM_STRUCT:
+            for (size_t j = 0; j < it->as.struct_decl.fields.len; j++) {
+                EmpStructField *f = (EmpStructField *)it->as.struct_decl.fields.items[j];
+                if (f) emp_type_free_vectors(f->ty);
+            }
+            emp_vec_free(&it->as.struct_decl.fields);
+            emp_vec_free(&it->as.struct_decl.type_params);
+            break;
+        case EMP_ITEM_ENUM:
+            for (size_t j = 0; j < it->as.enum_decl.variants.len; j++) {
+                EmpEnumVariant *v = (EmpEnumVariant *)it->as.enum_decl.variants.items[j];
+                if (!v) continue;
+                for (size_t k = 0; k < v->fields.len; k++) {
+                    EmpType *ty = (EmpType *)v->fields.items[k];
+                    emp_type_free_vectors(ty);
                 }
-                emp_vec_free(&it->as.enum_decl.variants);
-                break;
-            case EMP_ITEM_IMPL:
-                for (size_t j = 0; j < it->as.impl_decl.methods.len; j++) {
-                    EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[j];
-                    if (!m) continue;
-                    for (size_t k = 0; k < m->params.len; k++) {
-                        EmpParam *param = (EmpParam *)m->params.items[k];
-                        if (param) emp_type_free_vectors(param->ty);
-                    }
-                    emp_vec_free(&m->params);
-                    emp_type_free_vectors(m->ret_ty);
-                    emp_stmt_free_vectors(m->body);
+                emp_vec_free(&v->fields);
+            }
+            emp_vec_free(&it->as.enum_decl.variants);
+            break;
+        case EMP_ITEM_IMPL:
+            for (size_t j = 0; j < it->as.impl_decl.methods.len; j++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[j];
+                if (!m) continue;
+                for (size_t k = 0; k < m->params.len; k++) {
+                    EmpParam *param = (EmpParam *)m->params.items[k];
+                    if (param) emp_type_free_vectors(param->ty);
                 }
-                emp_vec_free(&it->as.impl_decl.methods);
-                break;
-            default:
-                break;
-        }
+                emp_vec_free(&m->params);
+                emp_type_free_vectors(m->ret_ty);
+                emp_stmt_free_vectors(m->body);
+            }
+            emp_vec_free(&it->as.impl_decl.methods);
+            emp_vec_free(&it->as.impl_decl.type_params);
+            break;
+        default:
+            break;
+    }
+}
+
+void emp_program_free_vectors(EmpProgram *p) {
+    if (!p) return;
+
+    for (size_t i = 0; i < p->items.len; i++) {
+        emp_item_free_vectors((EmpItem *)p->items.items[i]);
+    }
+    for (size_t i = 0; i < p->generics.len; i++) {
+        emp_item_free_vectors((EmpItem *)p->generics.items[i]);
     }
 
     emp_vec_free(&p->items);
+    emp_vec_free(&p->fmt_consts);
+    emp_vec_free(&p->generics);
 }
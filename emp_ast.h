@@ -40,6 +40,7 @@ bool emp_diags_push(EmpDiags *d, EmpDiag diag);
 
 typedef struct EmpType EmpType;
 typedef struct EmpClassMethod EmpClassMethod;
+typedef struct EmpProgram EmpProgram;
 
 typedef enum EmpTypeKind {
     EMP_TYPE_AUTO,
@@ -49,6 +50,8 @@ typedef enum EmpTypeKind {
     EMP_TYPE_LIST,  // T[]
     EMP_TYPE_TUPLE, // (T a, U b)
     EMP_TYPE_DYN,   // dyn Base (fat pointer: {data, vtbl})
+    EMP_TYPE_GENERIC, // Name[T, ...]: generic struct applied to type arguments (rewritten to NAME by typecheck,
+                      // except the coroutine handles `Gen[T]` and `Task[T]`, see EmpCoroKind)
 } EmpTypeKind;
 
 typedef struct EmpTupleField {
@@ -65,12 +68,18 @@ struct EmpType {
         struct {
             EmpSlice base_name;
         } dyn;
+        struct {
+            EmpSlice name; // generic struct
+            EmpVec args;   // EmpType*
+        } generic;
         struct {
             EmpType *pointee;
         } ptr;
         struct {
             EmpType *elem;
-            EmpSlice size_text; // for arrays; e.g. "10" (from INT token). len==0 for list.
+            // For arrays; e.g. "10" (from INT token). len==0 for list. A size naming a `const`
+            // (`T[N]`) is rewritten to the digits of its value before typecheck (emp_consteval.h).
+            EmpSlice size_text;
         } array;
         struct {
             EmpVec fields; // EmpTupleField*
@@ -116,18 +125,73 @@ typedef enum EmpUnOp {
     EMP_UN_BITNOT,
     EMP_UN_BORROW,
     EMP_UN_BORROW_MUT,
+    EMP_UN_AWAIT, // `await t`, t: Task[T] (async fns only)
 } EmpUnOp;
 
 typedef struct EmpExpr EmpExpr;
 typedef struct EmpStmt EmpStmt;
 
+// Compile-time values (emp_consteval.h): the result of a `const` initializer or of a folded
+// `const fn` call. Nodes, strings and element arrays live in the program arena.
+typedef enum EmpConstKind {
+    EMP_CONST_INT = 1,
+    EMP_CONST_FLOAT,
+    EMP_CONST_BOOL,
+    EMP_CONST_CHAR,
+    EMP_CONST_STRING, // `*u8` literal text: codegen emits a NUL-terminated constant array
+    EMP_CONST_TUPLE,
+    EMP_CONST_ARRAY,  // `T[N]`
+} EmpConstKind;
+
+typedef struct EmpConstValue EmpConstValue;
+struct EmpConstValue {
+    EmpConstKind kind;
+    uint8_t bits;     // INT/FLOAT: width of the value's type (0 for an untyped literal)
+    bool is_unsigned; // INT
+    bool is_usize;    // INT: of type `usize` (arithmetic with it stays usize under --len64)
+    union {
+        uint64_t i; // INT: the value truncated to `bits`, sign-extended when signed
+        double f;
+        bool b;
+        uint32_t ch;
+        struct {
+            const char *ptr; // decoded bytes, without the NUL
+            size_t len;
+        } str;
+        struct {
+            EmpConstValue **items;
+            size_t len;
+            const EmpType *ty; // TUPLE: the declared tuple type once known (field names)
+        } agg;
+    } as;
+};
+
+// How an f-string part is formatted (set by typecheck).
+typedef enum EmpFmtKind {
+    EMP_FMT_TEXT = 0, // literal text
+    EMP_FMT_INT,      // signed integer of `bits` (emp.fmt.i64 after sign extension)
+    EMP_FMT_UINT,     // unsigned integer of `bits` (emp.fmt.u64 after zero extension)
+    EMP_FMT_BOOL,     // "true" / "false"
+    EMP_FMT_CHAR,     // UTF-8 encoding of a char
+    EMP_FMT_CSTR,     // NUL-terminated `*u8`; "<null>" for null
+    EMP_FMT_STRING,   // owned `string` (length read from the header)
+} EmpFmtKind;
+
 typedef struct EmpFStringPart {
     bool is_expr;
     EmpSlice text; // valid when !is_expr
     EmpExpr *expr; // valid when is_expr
     EmpSpan span;
+
+    EmpFmtKind fmt;
+    uint8_t bits;      // EMP_FMT_INT / EMP_FMT_UINT
+    uint32_t max_len;  // upper bound in bytes; 0 when only known at runtime (CSTR/STRING)
+    uint32_t const_id; // TEXT: index into EmpProgram.fmt_consts (see emp_fstring.h)
 } EmpFStringPart;
 
+// Most concrete classes a dyn call is speculated on (EmpExpr.call.devirt_class).
+#define EMP_DEVIRT_MAX_CLASSES 3u
+
 typedef enum EmpExprKind {
     EMP_EXPR_INT,
     EMP_EXPR_FLOAT,
@@ -156,10 +220,18 @@ struct EmpExpr {
         EmpSlice lit; // for literals + ident: slice into source
         struct {
             EmpVec parts; // EmpFStringPart*
+            // Set by typecheck: passed straight to a `*u8` parameter, so the text only has to
+            // live until the call returns.
+            bool is_temp;
+            // Set by emp_sem_plan_fstrings.
+            uint32_t static_len;    // sum of part bounds (bytes, without the NUL)
+            uint32_t dynamic_parts; // parts whose length is only known at runtime
         } fstring;
         struct {
             EmpUnOp op;
             EmpExpr *rhs;
+            // EMP_UN_AWAIT: 1-based suspend point of the enclosing coroutine (emp_sem_plan_coroutines).
+            uint32_t suspend_index;
         } unary;
         struct {
             EmpBinOp op;
@@ -169,6 +241,7 @@ struct EmpExpr {
         struct {
             EmpExpr *callee;
             EmpVec args; // EmpExpr*
+            EmpVec type_args; // EmpType*; explicit `f[T, ...](...)` arguments of a generic fn (usually empty)
             // Optional: set by semantic/typecheck when overload resolution picks a specific
             // symbol name (e.g. `foo__i32_u32`). When empty, codegen falls back to legacy
             // name-based lookup.
@@ -179,6 +252,26 @@ struct EmpExpr {
             const EmpClassMethod *dyn_method; // selected virtual method signature (decl in Base)
             EmpSlice dyn_base_name;           // Base name from `dyn Base`
             uint32_t dyn_slot;                // vtable slot index for dyn_method
+
+            // Set by emp_sem_devirtualize on dyn calls (see emp_devirt.h): concrete classes whose
+            // override of dyn_method codegen may call directly. Without devirt_guarded,
+            // devirt_class[0] is the only possible target; with it, each class is tried behind a
+            // vtable-pointer compare and the indirect call stays as the fallback.
+            EmpSlice devirt_class[EMP_DEVIRT_MAX_CLASSES];
+            uint8_t devirt_count;
+            bool devirt_guarded;
+
+            // Set by emp_sem_infer_alias_facts when no two arguments can share storage.
+            bool args_disjoint;
+
+            // Set by emp_sem_eval_consts: a call of a `const fn` whose arguments are all constant,
+            // evaluated at compile time. Codegen uses the value and emits no call.
+            const EmpConstValue *folded;
+
+            // Set by emp_sem_plan_coroutines on a call of a generator or async fn whose handle
+            // never leaves the caller: codegen inlines the ramp so CoroElide can put the frame
+            // in the caller's stack frame instead of the heap.
+            bool coro_elide;
         } call;
         struct {
             EmpExpr *inner;
@@ -199,14 +292,29 @@ struct EmpExpr {
         struct {
             EmpExpr *base;
             EmpExpr *index;
+
+            // Set by typecheck: `base` is a list of a `@soa` struct, so the element is gathered from
+            // (or scattered to) one slot per column; see also member.soa_column.
+            bool soa;
+
+            // Set by emp_sem_eliminate_bounds_checks (see emp_bounds.h).
+            bool in_bounds;             // proven in range: no check needed
+            const EmpStmt *hoist_loop;  // else: loop whose preheader can check `hoist_limit <= len(base)` once
+            const EmpExpr *hoist_limit;
         } index;
         struct {
             EmpExpr *base;
             EmpSlice member;
+            // Set by emp_sem_plan_soa: `xs[i].f` (or the value `v.f` of a @soa for loop) reads or
+            // writes column f of a @soa list directly; the element is never gathered.
+            bool soa_column;
         } member;
         struct {
             EmpSlice class_name;
             EmpVec args; // EmpExpr*
+            // Set by emp_sem_promote_new_to_stack: the object never outlives the function, so it
+            // lives in a stack slot instead of the heap.
+            bool on_stack;
         } new_expr;
         struct {
             EmpExpr *cond;
@@ -221,6 +329,48 @@ struct EmpExpr {
     } as;
 };
 
+// How codegen lowers a `for` loop. None of the forms allocates.
+typedef enum EmpForLowering {
+    EMP_FOR_UNCHECKED = 0, // not typechecked (yet)
+    // `for i in a..b` / `a..=b`: counted loop over an `idx_ty` induction variable; the range is never
+    // materialized. Inclusive ranges test `a <= b` once, then exit after the `i == b` iteration, so
+    // `b` may be the type's maximum.
+    EMP_FOR_COUNTED,
+    // `for i, v in arr` over `T[N]`: counted loop to the constant N.
+    EMP_FOR_ARRAY,
+    // `for i, v in xs` over `T[]`: when `len_invariant`, data/len are loaded once and the element
+    // pointer is bumped from `data` to `data + len`; otherwise both are reloaded each iteration.
+    EMP_FOR_LIST,
+    // `for i, v in xs` over a list of a `@soa` struct: counted loop over i with one pointer per
+    // column (hoisted when `len_invariant`). `v` is only assembled from the columns when
+    // `soa_gather`; otherwise every `v.f` is a member.soa_column load (emp_sem_plan_soa).
+    EMP_FOR_SOA,
+    // `for v in g` / `for i, v in g` over a generator `Gen[T]`: resume the frame, leave once
+    // `llvm.coro.done`, else load the yielded value from the promise. With one name, that name
+    // (idx_name, idx_ty = T) is the value; with two, i counts iterations in idx_ty = u64.
+    EMP_FOR_GEN,
+} EmpForLowering;
+
+// How codegen lowers an `EMP_STMT_DROP` (chosen by emp_sem_insert_drops).
+typedef enum EmpDropMode {
+    // The binding is definitely live here: drop it.
+    EMP_DROP_MODE_ALWAYS = 0,
+    // The binding may have been moved on some path: drop it only if its drop flag is set.
+    EMP_DROP_MODE_IF_FLAG,
+    // The binding was just moved out on a branch: clear its drop flag; nothing is dropped.
+    EMP_DROP_MODE_FORGET,
+} EmpDropMode;
+
+// How codegen lowers an `EMP_STMT_MATCH` (chosen by emp_sem_plan_matches, see emp_match.h).
+typedef enum EmpMatchLowering {
+    // Compare the scrutinee with each pattern in arm order (patterns that are not constants).
+    EMP_MATCH_CHAIN = 0,
+    // One LLVM `switch` on the value or enum tag; sparse cases become a balanced compare tree.
+    EMP_MATCH_SWITCH,
+    // A `switch` whose cases are dense enough for a jump table (O(1) dispatch).
+    EMP_MATCH_TABLE,
+} EmpMatchLowering;
+
 typedef enum EmpStmtKind {
     EMP_STMT_VAR,
     EMP_STMT_DROP,
@@ -237,6 +387,7 @@ typedef enum EmpStmtKind {
     EMP_STMT_MATCH,
     EMP_STMT_EMP_OFF,
     EMP_STMT_EMP_MM_OFF,
+    EMP_STMT_YIELD,
 } EmpStmtKind;
 
 typedef struct EmpMatchArm {
@@ -244,6 +395,15 @@ typedef struct EmpMatchArm {
     EmpExpr *pat; // NULL when is_default
     EmpStmt *body; // block
     EmpSpan span;
+
+    uint32_t variant;            // enum patterns: index of the variant (set by typecheck)
+    const EmpConstValue *value;  // other patterns: the value when constant (set by emp_sem_eval_consts)
+    // Set by emp_sem_plan_matches: the `switch` case of this arm (the value, or the stored enum
+    // tag / niche value), when it has one; and arms that can never run (an earlier arm takes the
+    // same value, or an `else` after every value is covered). Codegen emits nothing for those.
+    uint64_t case_value;
+    bool is_case;
+    bool is_dead;
 } EmpMatchArm;
 
 struct EmpStmt {
@@ -256,9 +416,23 @@ struct EmpStmt {
             bool is_destructure;
             EmpVec destruct_names; // EmpSlice*; only used when is_destructure
             EmpExpr *init; // optional
+
+            // Set by emp_sem_insert_drops when some drop of this binding is EMP_DROP_MODE_IF_FLAG:
+            // codegen keeps one i1 slot, set on initialization/assignment and cleared by every
+            // drop or FORGET of the binding.
+            bool drop_flag;
         } let_stmt;
         struct {
             EmpSlice name;
+            bool elided; // binding is statically an inline string: nothing to free (emp_sem_plan_strings)
+            EmpDropMode mode;
+            // On the first drop before a `return`/`break`/`continue`: 1-based id of the exit's
+            // cleanup sequence within the function; exits with the same id drop the same bindings
+            // the same way and jump to the same place, so codegen emits that cleanup once.
+            uint32_t cleanup;
+            // The binding is an on-stack `new` (emp_sem_promote_new_to_stack): destroy the fields,
+            // free nothing.
+            bool in_place;
         } drop_stmt;
         struct {
             EmpStmt *body; // block
@@ -269,6 +443,14 @@ struct EmpStmt {
         struct {
             EmpExpr *value; // optional
         } ret;
+        struct {
+            EmpExpr *value;
+            uint32_t index; // 1-based suspend point of the generator (emp_sem_plan_coroutines)
+            // Set by emp_sem_insert_drops: EMP_STMT_DROPs of the bindings live at this point,
+            // which codegen runs on the destroy edge of its `llvm.coro.suspend` (the consumer
+            // dropped the generator here).
+            EmpVec drops;
+        } yield_stmt;
         struct {
             EmpExpr *expr;
         } expr;
@@ -289,10 +471,21 @@ struct EmpStmt {
             EmpSlice val_name;   // optional; val_name.len==0 means none
             EmpExpr *iterable;
             EmpStmt *body; // block
+
+            // Lowering chosen by typecheck (see EmpForLowering).
+            EmpForLowering lowering;
+            EmpType *idx_ty;    // induction variable type (ranges: from the bounds; arrays/lists: i32)
+            bool len_invariant; // lists: the body never changes the length (set by emp_sem_eliminate_bounds_checks)
+            bool is_parallel;   // `parallel for i in a..b`: iterations run concurrently (runtime @emp.par.for)
+            bool soa_gather;    // EMP_FOR_SOA: the body needs `v` as a whole value (emp_sem_plan_soa)
         } for_stmt;
         struct {
             EmpExpr *scrutinee;
             EmpVec arms; // EmpMatchArm*
+
+            EmpType *scrutinee_ty;      // set by typecheck
+            EmpMatchLowering lowering;  // set by emp_sem_plan_matches
+            bool default_unreachable;   // every value has a live arm: the `switch` default is `unreachable`
         } match_stmt;
         struct {
             EmpStmt *body; // block
@@ -307,8 +500,29 @@ typedef struct EmpParam {
     EmpType *ty;
     EmpSlice name;
     EmpSpan span;
+
+    // Aliasing facts set by emp_sem_infer_alias_facts (see emp_borrow.h). Only meaningful for
+    // parameters passed by reference; false means "unknown".
+    bool is_readonly;
+    bool is_nocapture;
+    bool is_noalias;
+
+    // Owned parameter that may be moved on some path (see EmpStmt.let_stmt.drop_flag).
+    bool drop_flag;
 } EmpParam;
 
+// A function whose body is a coroutine (set by typecheck), lowered to a `switch`-ABI LLVM
+// coroutine: `llvm.coro.id` / `llvm.coro.begin`, one `llvm.coro.suspend` per suspend point, and
+// CoroSplit turns it into a ramp plus resume/destroy functions sharing one frame.
+typedef enum EmpCoroKind {
+    EMP_CORO_NONE = 0,
+    // Returns `Gen[T]`: the body runs lazily, each `yield v` hands one T to the consumer.
+    EMP_CORO_GEN,
+    // `async fn`: a call returns `Task[T]` (T = ret_ty) without running the body; `await` or
+    // `block_on` drive it to its `return`.
+    EMP_CORO_TASK,
+} EmpCoroKind;
+
 typedef struct EmpItemFn {
     EmpSlice name;
     EmpSpan span;
@@ -316,10 +530,25 @@ typedef struct EmpItemFn {
     bool is_extern;
     bool is_unsafe;
     bool is_mm_only; // only callable inside `@emp mm off` regions/files
+    bool is_const; // `const fn`: may run at compile time (emp_consteval.h)
+    bool is_async; // `async fn`
+    bool is_internal; // set by dead-item elimination: not exported/extern/entry => internal linkage
     EmpSlice abi; // optional; empty means target default C ABI
+    EmpVec type_params; // EmpSlice*; non-empty for a generic template `fn f[T](...)`
+    bool is_instance;   // monomorphized from a generic template by typecheck
     EmpVec params; // EmpParam*
     EmpType *ret_ty; // optional
     EmpStmt *body; // block; NULL for extern declarations
+    // Import decls of a `const fn`: the definition and the program its body resolves names in,
+    // so importers can evaluate calls at compile time.
+    const struct EmpItemFn *const_origin;
+    const EmpProgram *const_origin_program;
+
+    EmpCoroKind coro;  // set by typecheck
+    uint32_t suspends; // yield/await points in the body (emp_sem_plan_coroutines)
+    // Set by emp_sem_insert_drops: drops of the owned parameters, run when the coroutine is
+    // destroyed before its first resume.
+    EmpVec coro_entry_drops;
 } EmpItemFn;
 
 typedef struct EmpClassField {
@@ -334,6 +563,8 @@ typedef struct EmpClassMethod {
     bool is_exported;
     bool is_unsafe;
     bool is_virtual;
+    bool is_internal; // set by dead-item elimination (see EmpItemFn.is_internal)
+    bool self_nocapture; // `self` never outlives the call (emp_sem_promote_new_to_stack)
     EmpVec params; // EmpParam* (types may be auto)
     EmpType *ret_ty; // optional
     EmpStmt *body;   // block
@@ -368,20 +599,41 @@ typedef struct EmpItemConst {
     EmpSlice name;
     bool is_exported;
     EmpType *ty;     // optional (auto if omitted)
-    EmpExpr *init;   // required
+    EmpExpr *init;   // required (NULL for import decls)
     EmpSpan span;
+
+    // Set by emp_sem_eval_consts; codegen emits the value as a constant global.
+    const EmpConstValue *value;
+    // Import decls: the definition and the program its initializer resolves names in.
+    const struct EmpItemConst *origin;
+    const EmpProgram *origin_program;
 } EmpItemConst;
 
 typedef struct EmpStructField {
     EmpSlice name;
     EmpType *ty;
     EmpSpan span;
+    uint64_t offset; // byte offset in the struct (emp_sem_plan_layouts)
+    // `@soa` lists: bytes per element of the columns stored before this one, so the column
+    // starts at `data + cap * soa_column` (emp_sem_plan_layouts).
+    uint64_t soa_column;
 } EmpStructField;
 
 typedef struct EmpItemStruct {
     EmpSlice name;
     bool is_exported;
+    EmpVec type_params; // EmpSlice*; non-empty for a generic template `struct S[T]`
+    bool is_instance;   // monomorphized from a generic template by typecheck
     EmpVec fields; // EmpStructField*
+    // Layout attributes (Mds/ABI.md, "Structs").
+    uint32_t attr_align; // `@align(N)`: at least N-byte aligned (power of two); 0 = natural
+    bool is_packed;      // `@packed`: no padding between fields, alignment 1 unless `@align`
+    bool is_cacheline;   // `@cacheline`: aligned to and padded out to 64 bytes
+    bool is_soa;         // `@soa`: `S[]` stores one array per field (struct-of-arrays)
+    // Set by emp_sem_plan_layouts.
+    bool fields_reordered; // `fields` is no longer in source order (--reorder-fields)
+    uint64_t size;
+    uint32_t align;
     EmpSpan span;
 } EmpItemStruct;
 
@@ -396,12 +648,27 @@ typedef struct EmpItemEnum {
     bool is_exported;
     EmpVec variants; // EmpEnumVariant*
     EmpSpan span;
+
+    // Set by emp_sem_plan_layouts (Mds/ABI.md, "Enums"). The tag is at offset 0 and holds the
+    // variant index; the payload of every variant starts at payload_offset.
+    uint64_t size;
+    uint32_t align;
+    uint8_t tag_size;        // 4 (canonical), 1 or 2 (compact); 0 for a niche layout
+    uint32_t payload_offset;
+    // Niche layout (tag_size == 0): only `niche_variant` has a payload, stored at offset 0. The
+    // other variants, in declaration order, are the values niche_start, niche_start + 1, ... of
+    // the `niche_size`-byte integer at niche_offset, which the payload never holds.
+    uint32_t niche_variant;
+    uint8_t niche_size;
+    uint64_t niche_offset;
+    uint64_t niche_start;
 } EmpItemEnum;
 
 typedef struct EmpImplMethod {
     EmpSlice name;
     bool is_exported;
     bool is_unsafe;
+    bool is_internal; // set by dead-item elimination (see EmpItemFn.is_internal)
     EmpVec params; // EmpParam* (types may be auto)
     EmpType *ret_ty; // optional
     EmpStmt *body;   // block
@@ -413,6 +680,10 @@ typedef struct EmpItemImpl {
     // When empty, this is an inherent impl: `impl Type { ... }`.
     EmpSlice trait_name;
     EmpSlice target_name;
+    // Generic impl `impl[T, ...] S[T, ...]`: the parameters bind positionally to the type
+    // arguments of generic struct `target_name`.
+    EmpVec type_params; // EmpSlice*
+    bool is_instance;   // monomorphized from a generic template by typecheck
     EmpVec methods; // EmpImplMethod*
     EmpSpan span;
 } EmpItemImpl;
@@ -473,12 +744,41 @@ typedef struct EmpItem {
 
 typedef struct EmpProgram {
     EmpVec items; // EmpItem*
+    EmpVec fmt_consts; // const EmpSlice*: deduplicated f-string pieces (emp_sem_plan_fstrings)
+    EmpVec generics;   // EmpItem*: generic templates, moved out of `items` by typecheck
 } EmpProgram;
 
 // Frees heap-backed vectors within the AST (does NOT free nodes themselves).
 // Call this before freeing the arena that owns the AST nodes.
 void emp_program_free_vectors(EmpProgram *p);
 
+// Length/capacity layout of `T[]` and `string` (Mds/ABI.md, "Lists and strings").
+// - EMP_LEN_ABI_32 (ABI v1, default): `{ ptr, i32 len, i32 cap }`; `len()`/`cap()` are `i32`.
+// - EMP_LEN_ABI_64 (ABI v2, `--len64`): `{ ptr, i64 len, i64 cap }`; `len()`/`cap()` are `usize`.
+// Process-wide: set once by the driver before any semantic pass runs.
+typedef enum EmpLenAbi {
+    EMP_LEN_ABI_32 = 0,
+    EMP_LEN_ABI_64,
+} EmpLenAbi;
+
+void emp_set_len_abi(EmpLenAbi abi);
+EmpLenAbi emp_len_abi(void);
+
+// Longest `string` (bytes, without the NUL) stored inline in its header under the current
+// EmpLenAbi: 14 for ABI v1, 22 for ABI v2 (Mds/ABI.md, "Small strings").
+size_t emp_string_inline_max(void);
+
+// Portable SIMD vector types are builtin names `<elem>x<lanes>` (`f32x4`, `f64x4`, `i32x8`,
+// `u8x16`): elem is `f32`/`f64` or a fixed-width integer, lanes a power of two from 2 to 64, and
+// the vector at most 512 bits. LLVM IR: `<lanes x elem>`. Out params may be NULL.
+bool emp_simd_type_parse(EmpSlice name, EmpSlice *out_elem, uint32_t *out_lanes);
+
+// Atomic types are builtin names `atomic_<v>` for v in `i32`, `i64`, `u32`, `u64`, `ptr`;
+// source spells them `Atomic[i32]`, ..., `Atomic[*T]` (typecheck rewrites those). Same size and
+// alignment as the value; only the atomic_* builtins touch them. `out_value` (may be NULL) gets
+// the value type name (`ptr` for pointers).
+bool emp_atomic_type_parse(EmpSlice name, EmpSlice *out_value);
+
 // Helpers
 const char *emp_binop_name(EmpBinOp op);
 const char *emp_unop_name(EmpUnOp op);
@@ -1,4 +1,5 @@
 #include "emp_borrow.h"
+#include "emp_coro.h"
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -38,6 +39,9 @@ typedef struct EmpBorrowCtx {
     EmpBorrowScope *scopes;
     size_t scopes_len;
     size_t scopes_cap;
+
+    const EmpProgram *program;
+    size_t locals_mark; // binds below this are the current fn's parameters
 } EmpBorrowCtx;
 
 static bool slice_eq(EmpSlice a, EmpSlice b) {
@@ -168,6 +172,25 @@ static bool declare_bind(EmpBorrowCtx *c, EmpSlice name) {
     return true;
 }
 
+static bool bind_is_local(const EmpBorrowCtx *c, const EmpBorrowBind *b) {
+    for (size_t i = c->locals_mark; i < c->binds_len; i++) {
+        if (c->binds[i] == b) return true;
+    }
+    return false;
+}
+
+// A call of a generator or async fn: the frame it returns keeps the arguments.
+static bool call_is_coro(const EmpBorrowCtx *c, const EmpExpr *e) {
+    const EmpExpr *callee = e->as.call.callee;
+    if (!c->program || !callee || callee->kind != EMP_EXPR_IDENT) return false;
+    for (size_t i = 0; i < c->program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)c->program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_FN || !emp_fn_is_coroutine(&it->as.fn)) continue;
+        if (slice_eq(it->as.fn.name, callee->as.lit) || slice_eq(it->as.fn.name, e->as.call.resolved_name)) return true;
+    }
+    return false;
+}
+
 static bool record_delta(EmpBorrowCtx *c, EmpBorrowBind *b, int shared_delta, bool mut_delta) {
     if (!ensure_delta_cap(c, c->deltas_len + 1)) return false;
     EmpBorrowDelta d;
@@ -395,7 +418,7 @@ static void visit_expr(EmpArena *arena, EmpDiags *diags, EmpBorrowCtx *c, const
                 visit_expr(arena, diags, c, rhs, EMP_BOR_USE_READ, unsafe_depth);
                 return;
             }
-            visit_expr(arena, diags, c, e->as.unary.rhs, use, unsafe_depth);
+            visit_expr(arena, diags, c, e->as.unary.rhs, e->as.unary.op == EMP_UN_AWAIT ? EMP_BOR_USE_MOVE : use, unsafe_depth);
             return;
 
         case EMP_EXPR_BINARY: {
@@ -421,12 +444,15 @@ static void visit_expr(EmpArena *arena, EmpDiags *diags, EmpBorrowCtx *c, const
             return;
         }
 
-        case EMP_EXPR_CALL:
+        case EMP_EXPR_CALL: {
             visit_expr(arena, diags, c, e->as.call.callee, EMP_BOR_USE_READ, unsafe_depth);
             // Treat borrows created for call arguments as temporaries that end after the call.
             // This keeps patterns like `f(&mut x); f(&mut x);` usable without requiring an
-            // entire block scope to end.
-            (void)push_scope(c);
+            // entire block scope to end. The frame of a generator or async fn holds its
+            // arguments across suspensions, so borrows passed to one last until the end of the
+            // enclosing scope (which the handle cannot outlive without a move).
+            bool temp_args = !call_is_coro(c, e);
+            if (temp_args) (void)push_scope(c);
 
             // Conservative method receiver rule: treat `obj.method(...)` as taking a temporary
             // mutable borrow of the root receiver binding.
@@ -440,8 +466,9 @@ static void visit_expr(EmpArena *arena, EmpDiags *diags, EmpBorrowCtx *c, const
             for (size_t i = 0; i < e->as.call.args.len; i++) {
                 visit_expr(arena, diags, c, (const EmpExpr *)e->as.call.args.items[i], EMP_BOR_USE_MOVE, unsafe_depth);
             }
-            pop_scope(c);
+            if (temp_args) pop_scope(c);
             return;
+        }
 
         case EMP_EXPR_GROUP:
             visit_expr(arena, diags, c, e->as.group.inner, use, unsafe_depth);
@@ -482,6 +509,395 @@ static void visit_expr(EmpArena *arena, EmpDiags *diags, EmpBorrowCtx *c, const
     }
 }
 
+// `parallel for i in a..b`: iterations run concurrently, so the body may only write state shared
+// across iterations (bindings declared outside the body) at `x[i]...`, whose first index is the
+// unmodified loop index; distinct iterations then touch disjoint elements. Everything else that
+// writes shared state (`x = ...`, `x[j] = ...`, `&mut x`, `x.method()`) would race, and so does
+// reading `x[j]` when the body writes `x[i]`: element j belongs to another iteration.
+//
+// A local initialized from shared state (`let c = obj;`, `let row = xs[i];`) may be a pointer,
+// dyn or class handle to it, so writes through the local count as writes to the shared binding.
+typedef struct EmpParLocal {
+    EmpSlice name;
+    EmpSlice shared; // shared binding it was initialized from; empty for a private local
+    bool at_idx;     // initialized from `shared[i]...` (its iteration's element)
+} EmpParLocal;
+
+typedef struct EmpParCtx {
+    EmpSlice idx;
+    EmpParLocal *locals; // names declared inside the body (stack; shadows outer bindings)
+    size_t locals_len;
+    size_t locals_cap;
+    EmpSlice *written;   // shared bindings the body writes at the loop index
+    size_t written_len;
+    size_t written_cap;
+    bool collect;        // first pass: fill `written`, report nothing
+} EmpParCtx;
+
+static void par_declare_from(EmpParCtx *p, EmpSlice name, EmpSlice shared, bool at_idx) {
+    if (!name.len) return;
+    if (p->locals_len == p->locals_cap) {
+        size_t cap = p->locals_cap ? p->locals_cap * 2 : 16;
+        EmpParLocal *n = (EmpParLocal *)realloc(p->locals, cap * sizeof(EmpParLocal));
+        if (!n) return;
+        p->locals = n;
+        p->locals_cap = cap;
+    }
+    p->locals[p->locals_len++] = (EmpParLocal){name, shared, at_idx};
+}
+
+static void par_declare(EmpParCtx *p, EmpSlice name) {
+    par_declare_from(p, name, (EmpSlice){0}, false);
+}
+
+static const EmpParLocal *par_local(const EmpParCtx *p, EmpSlice name) {
+    for (size_t i = p->locals_len; i > 0; i--) {
+        if (slice_eq(p->locals[i - 1].name, name)) return &p->locals[i - 1];
+    }
+    return NULL;
+}
+
+static bool par_is_local(const EmpParCtx *p, EmpSlice name) {
+    return par_local(p, name) != NULL;
+}
+
+static bool par_is_idx(const EmpParCtx *p, const EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e && e->kind == EMP_EXPR_IDENT && slice_eq(e->as.lit, p->idx) && !par_is_local(p, e->as.lit);
+}
+
+static void par_mark_written(EmpParCtx *p, EmpSlice name) {
+    for (size_t i = 0; i < p->written_len; i++) {
+        if (slice_eq(p->written[i], name)) return;
+    }
+    if (p->written_len == p->written_cap) {
+        size_t cap = p->written_cap ? p->written_cap * 2 : 8;
+        EmpSlice *n = (EmpSlice *)realloc(p->written, cap * sizeof(EmpSlice));
+        if (!n) return;
+        p->written = n;
+        p->written_cap = cap;
+    }
+    p->written[p->written_len++] = name;
+}
+
+static bool par_is_written(const EmpParCtx *p, EmpSlice name) {
+    for (size_t i = 0; i < p->written_len; i++) {
+        if (slice_eq(p->written[i], name)) return true;
+    }
+    return false;
+}
+
+// The binding an access path starts at, and the access applied directly to it (NULL for a bare
+// name). Casts are looked through: `obj as dyn B` is still `obj`.
+static const EmpExpr *par_access_root(const EmpExpr *e, const EmpExpr **first) {
+    *first = NULL;
+    while (e) {
+        if (e->kind == EMP_EXPR_GROUP) {
+            e = e->as.group.inner;
+        } else if (e->kind == EMP_EXPR_CAST) {
+            e = e->as.cast.expr;
+        } else if (e->kind == EMP_EXPR_INDEX) {
+            *first = e;
+            e = e->as.index.base;
+        } else if (e->kind == EMP_EXPR_MEMBER) {
+            *first = e;
+            e = e->as.member.base;
+        } else {
+            break;
+        }
+    }
+    return e && e->kind == EMP_EXPR_IDENT ? e : NULL;
+}
+
+// Which shared binding (if any) a value computed by `init` may point into.
+static void par_origin(const EmpParCtx *p, const EmpExpr *init, EmpSlice *shared, bool *at_idx) {
+    *shared = (EmpSlice){0};
+    *at_idx = false;
+    const EmpExpr *first = NULL;
+    const EmpExpr *root = par_access_root(init, &first);
+    if (!root || slice_eq(root->as.lit, p->idx)) return;
+
+    const EmpParLocal *l = par_local(p, root->as.lit);
+    if (l) {
+        *shared = l->shared;
+        *at_idx = l->at_idx;
+        return;
+    }
+    *shared = root->as.lit;
+    *at_idx = first && first->kind == EMP_EXPR_INDEX && par_is_idx(p, first->as.index.index);
+}
+
+// Check a write to (or `&mut` of) lvalue `lv`. `through`: the write reaches what `lv` points at
+// (a method receiver), not `lv` itself.
+static void par_check_write(EmpArena *arena, EmpDiags *diags, EmpParCtx *p, EmpSpan span, const EmpExpr *lv, bool through) {
+    const EmpExpr *first = NULL;
+    const EmpExpr *root_e = par_access_root(lv, &first);
+    if (!root_e) return;
+    EmpSlice root = root_e->as.lit;
+
+    const EmpParLocal *l = par_local(p, root);
+    if (l) {
+        // Rebinding the local itself is private; writing through it reaches what it points at.
+        if (!l->shared.len || (!first && !through)) return;
+        if (l->at_idx) {
+            if (p->collect) par_mark_written(p, l->shared);
+            return;
+        }
+        if (!p->collect) {
+            diagf(arena, diags, span, "borrow: data race: parallel for iterations all write '%s' through a local that points into it (only elements indexed by the loop index are disjoint)", l->shared);
+        }
+        return;
+    }
+    if (slice_eq(root, p->idx)) {
+        if (!p->collect) diagf(arena, diags, span, "borrow: cannot modify loop index '%s' of a parallel for", root);
+        return;
+    }
+
+    if (first && first->kind == EMP_EXPR_INDEX && par_is_idx(p, first->as.index.index)) {
+        if (p->collect) par_mark_written(p, root);
+        return;
+    }
+    if (!p->collect) {
+        diagf(arena, diags, span, "borrow: data race: parallel for iterations all write '%s' (only elements indexed by the loop index are disjoint)", root);
+    }
+}
+
+// Check a read `x[j]...` of a shared binding the body also writes at `x[i]`.
+static void par_check_read(EmpArena *arena, EmpDiags *diags, const EmpParCtx *p, const EmpExpr *e) {
+    if (p->collect) return;
+    const EmpExpr *base = e->as.index.base;
+    while (base && (base->kind == EMP_EXPR_GROUP || base->kind == EMP_EXPR_CAST)) {
+        base = base->kind == EMP_EXPR_GROUP ? base->as.group.inner : base->as.cast.expr;
+    }
+    if (!base || base->kind != EMP_EXPR_IDENT || par_is_idx(p, e->as.index.index)) return;
+
+    EmpSlice shared = base->as.lit;
+    const EmpParLocal *l = par_local(p, shared);
+    if (l) {
+        // An element of this iteration's own element is still its own.
+        if (!l->shared.len || l->at_idx) return;
+        shared = l->shared;
+    } else if (slice_eq(shared, p->idx)) {
+        return;
+    }
+    if (!par_is_written(p, shared)) return;
+    diagf(arena, diags, e->span, "borrow: data race: parallel for iterations write '%s' at the loop index, so reading it at any other index races", shared);
+}
+
+static void par_check_expr(EmpArena *arena, EmpDiags *diags, EmpParCtx *p, const EmpExpr *e);
+
+// Visit the operands of an lvalue (its index expressions) without treating the lvalue as a read.
+static void par_check_lvalue(EmpArena *arena, EmpDiags *diags, EmpParCtx *p, const EmpExpr *lv) {
+    while (lv) {
+        if (lv->kind == EMP_EXPR_GROUP) {
+            lv = lv->as.group.inner;
+        } else if (lv->kind == EMP_EXPR_INDEX) {
+            par_check_expr(arena, diags, p, lv->as.index.index);
+            lv = lv->as.index.base;
+        } else if (lv->kind == EMP_EXPR_MEMBER) {
+            lv = lv->as.member.base;
+        } else {
+            par_check_expr(arena, diags, p, lv);
+            return;
+        }
+    }
+}
+
+static void par_check_expr(EmpArena *arena, EmpDiags *diags, EmpParCtx *p, const EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) par_check_expr(arena, diags, p, pt->expr);
+            }
+            return;
+
+        case EMP_EXPR_UNARY:
+            if (e->as.unary.op == EMP_UN_BORROW_MUT) {
+                par_check_write(arena, diags, p, e->span, e->as.unary.rhs, false);
+                par_check_lvalue(arena, diags, p, e->as.unary.rhs);
+                return;
+            }
+            par_check_expr(arena, diags, p, e->as.unary.rhs);
+            return;
+
+        case EMP_EXPR_BINARY:
+            if (is_assign_like(e->as.binary.op)) {
+                par_check_write(arena, diags, p, e->span, e->as.binary.lhs, false);
+                par_check_lvalue(arena, diags, p, e->as.binary.lhs);
+            } else {
+                par_check_expr(arena, diags, p, e->as.binary.lhs);
+            }
+            par_check_expr(arena, diags, p, e->as.binary.rhs);
+            return;
+
+        case EMP_EXPR_CALL:
+            // Same receiver rule as the borrow walk: `obj.method(...)` may mutate `obj`.
+            if (e->as.call.callee && e->as.call.callee->kind == EMP_EXPR_MEMBER) {
+                par_check_write(arena, diags, p, e->span, e->as.call.callee->as.member.base, true);
+                par_check_lvalue(arena, diags, p, e->as.call.callee->as.member.base);
+            } else {
+                par_check_expr(arena, diags, p, e->as.call.callee);
+            }
+            for (size_t i = 0; i < e->as.call.args.len; i++) {
+                par_check_expr(arena, diags, p, (const EmpExpr *)e->as.call.args.items[i]);
+            }
+            return;
+
+        case EMP_EXPR_GROUP:
+            par_check_expr(arena, diags, p, e->as.group.inner);
+            return;
+
+        case EMP_EXPR_CAST:
+            par_check_expr(arena, diags, p, e->as.cast.expr);
+            return;
+
+        case EMP_EXPR_TUPLE:
+            for (size_t i = 0; i < e->as.tuple.items.len; i++) par_check_expr(arena, diags, p, (const EmpExpr *)e->as.tuple.items.items[i]);
+            return;
+
+        case EMP_EXPR_LIST:
+            for (size_t i = 0; i < e->as.list.items.len; i++) par_check_expr(arena, diags, p, (const EmpExpr *)e->as.list.items.items[i]);
+            return;
+
+        case EMP_EXPR_INDEX:
+            par_check_read(arena, diags, p, e);
+            par_check_expr(arena, diags, p, e->as.index.base);
+            par_check_expr(arena, diags, p, e->as.index.index);
+            return;
+
+        case EMP_EXPR_MEMBER:
+            par_check_expr(arena, diags, p, e->as.member.base);
+            return;
+
+        case EMP_EXPR_NEW:
+            for (size_t i = 0; i < e->as.new_expr.args.len; i++) par_check_expr(arena, diags, p, (const EmpExpr *)e->as.new_expr.args.items[i]);
+            return;
+
+        case EMP_EXPR_TERNARY:
+            par_check_expr(arena, diags, p, e->as.ternary.cond);
+            par_check_expr(arena, diags, p, e->as.ternary.then_expr);
+            par_check_expr(arena, diags, p, e->as.ternary.else_expr);
+            return;
+
+        case EMP_EXPR_RANGE:
+            par_check_expr(arena, diags, p, e->as.range.start);
+            par_check_expr(arena, diags, p, e->as.range.end);
+            return;
+
+        default:
+            return;
+    }
+}
+
+static void par_check_stmt(EmpArena *arena, EmpDiags *diags, EmpParCtx *p, const EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_BLOCK: {
+            size_t mark = p->locals_len;
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) par_check_stmt(arena, diags, p, (const EmpStmt *)s->as.block.stmts.items[i]);
+            p->locals_len = mark;
+            return;
+        }
+
+        case EMP_STMT_VAR: {
+            par_check_expr(arena, diags, p, s->as.let_stmt.init);
+            EmpSlice shared;
+            bool at_idx;
+            par_origin(p, s->as.let_stmt.init, &shared, &at_idx);
+            if (s->as.let_stmt.is_destructure) {
+                for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                    const EmpSlice *nm = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                    if (nm) par_declare_from(p, *nm, shared, at_idx);
+                }
+            } else {
+                par_declare_from(p, s->as.let_stmt.name, shared, at_idx);
+            }
+            return;
+        }
+
+        case EMP_STMT_EXPR:
+            par_check_expr(arena, diags, p, s->as.expr.expr);
+            return;
+
+        case EMP_STMT_RETURN:
+            par_check_expr(arena, diags, p, s->as.ret.value);
+            return;
+
+        case EMP_STMT_DEFER:
+            par_check_stmt(arena, diags, p, s->as.defer_stmt.body);
+            return;
+
+        case EMP_STMT_IF:
+            par_check_expr(arena, diags, p, s->as.if_stmt.cond);
+            par_check_stmt(arena, diags, p, s->as.if_stmt.then_branch);
+            par_check_stmt(arena, diags, p, s->as.if_stmt.else_branch);
+            return;
+
+        case EMP_STMT_WHILE:
+            par_check_expr(arena, diags, p, s->as.while_stmt.cond);
+            par_check_stmt(arena, diags, p, s->as.while_stmt.body);
+            return;
+
+        case EMP_STMT_FOR: {
+            par_check_expr(arena, diags, p, s->as.for_stmt.iterable);
+            EmpSlice shared;
+            bool at_idx;
+            par_origin(p, s->as.for_stmt.iterable, &shared, &at_idx);
+            size_t mark = p->locals_len;
+            par_declare(p, s->as.for_stmt.idx_name);
+            par_declare_from(p, s->as.for_stmt.val_name, shared, at_idx);
+            par_check_stmt(arena, diags, p, s->as.for_stmt.body);
+            p->locals_len = mark;
+            return;
+        }
+
+        case EMP_STMT_MATCH: {
+            par_check_expr(arena, diags, p, s->as.match_stmt.scrutinee);
+            EmpSlice shared;
+            bool at_idx;
+            par_origin(p, s->as.match_stmt.scrutinee, &shared, &at_idx);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *a = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!a) continue;
+                size_t mark = p->locals_len;
+                // `Enum::Variant(x, y)` binds its identifier arguments.
+                if (!a->is_default && a->pat && a->pat->kind == EMP_EXPR_CALL) {
+                    for (size_t j = 0; j < a->pat->as.call.args.len; j++) {
+                        const EmpExpr *arg = (const EmpExpr *)a->pat->as.call.args.items[j];
+                        if (arg && arg->kind == EMP_EXPR_IDENT) par_declare_from(p, arg->as.lit, shared, at_idx);
+                    }
+                }
+                par_check_stmt(arena, diags, p, a->body);
+                p->locals_len = mark;
+            }
+            return;
+        }
+
+        default:
+            // `@emp off` / `@emp mm off` regions are unchecked, as for borrows.
+            return;
+    }
+}
+
+static void check_parallel_for(EmpArena *arena, EmpDiags *diags, const EmpStmt *s) {
+    EmpParCtx p;
+    memset(&p, 0, sizeof(p));
+    p.idx = s->as.for_stmt.idx_name;
+    if (p.idx.len == 1 && p.idx.ptr[0] == '_') p.idx = (EmpSlice){0};
+    // Reads are checked against every write in the body, including later ones.
+    p.collect = true;
+    par_check_stmt(arena, diags, &p, s->as.for_stmt.body);
+    p.collect = false;
+    p.locals_len = 0;
+    par_check_stmt(arena, diags, &p, s->as.for_stmt.body);
+    free(p.locals);
+    free(p.written);
+}
+
 static void visit_block(EmpArena *arena, EmpDiags *diags, EmpBorrowCtx *c, const EmpStmt *block) {
     if (!block || block->kind != EMP_STMT_BLOCK) return;
 
@@ -556,6 +972,19 @@ static void visit_stmt(EmpArena *arena, EmpDiags *diags, EmpBorrowCtx *c, const
             visit_expr(arena, diags, c, s->as.ret.value, EMP_BOR_USE_MOVE, unsafe_depth);
             return;
 
+        case EMP_STMT_YIELD:
+            // The consumer holds a yielded borrow while the generator runs again (and after it
+            // is dropped), so it may only point outside the frame.
+            if (unsafe_depth == 0 && expr_is_borrow_value(s->as.yield_stmt.value)) {
+                EmpSlice root = root_binding_name(s->as.yield_stmt.value->as.unary.rhs);
+                EmpBorrowBind *b = root.ptr ? lookup_bind(c, root) : NULL;
+                if (b && bind_is_local(c, b)) {
+                    diagf(arena, diags, s->span, "borrow: cannot yield a borrow of local '%s'; it lives in the generator frame", root);
+                }
+            }
+            visit_expr(arena, diags, c, s->as.yield_stmt.value, EMP_BOR_USE_MOVE, unsafe_depth);
+            return;
+
         case EMP_STMT_IF:
             visit_expr(arena, diags, c, s->as.if_stmt.cond, EMP_BOR_USE_READ, unsafe_depth);
             visit_stmt(arena, diags, c, s->as.if_stmt.then_branch, unsafe_depth);
@@ -569,9 +998,15 @@ static void visit_stmt(EmpArena *arena, EmpDiags *diags, EmpBorrowCtx *c, const
 
         case EMP_STMT_FOR: {
             visit_expr(arena, diags, c, s->as.for_stmt.iterable, EMP_BOR_USE_READ, unsafe_depth);
+            if (s->as.for_stmt.is_parallel && unsafe_depth == 0) check_parallel_for(arena, diags, s);
             // loop introduces bindings for its names inside the body scope
             if (s->as.for_stmt.body && s->as.for_stmt.body->kind == EMP_STMT_BLOCK) {
                 (void)push_scope(c);
+                // Each iteration resumes the generator: it is borrowed mutably for the whole loop.
+                if (s->as.for_stmt.lowering == EMP_FOR_GEN && unsafe_depth == 0) {
+                    EmpSlice gen = root_binding_name(s->as.for_stmt.iterable);
+                    if (gen.ptr && gen.len) try_add_mut_borrow(arena, diags, c, s->span, gen);
+                }
                 if (s->as.for_stmt.idx_name.ptr && s->as.for_stmt.idx_name.len && !(s->as.for_stmt.idx_name.len == 1 && s->as.for_stmt.idx_name.ptr[0] == '_')) {
                     (void)declare_bind(c, s->as.for_stmt.idx_name);
                 }
@@ -660,6 +1095,7 @@ void emp_sem_check_borrows_lexical(EmpArena *arena, const EmpProgram *program, E
 
     EmpBorrowCtx c;
     ctx_init(&c);
+    c.program = program;
     (void)push_scope(&c);
 
     const bool file_mm_off = program_has_emp_mm_off(program);
@@ -678,6 +1114,7 @@ void emp_sem_check_borrows_lexical(EmpArena *arena, const EmpProgram *program, E
                 if (!p) continue;
                 (void)declare_bind(&c, p->name);
             }
+            c.locals_mark = c.binds_len;
             visit_stmt(arena, diags, &c, it->as.fn.body, file_mm_off ? 1 : 0);
             continue;
         }
@@ -725,3 +1162,848 @@ void emp_sem_check_borrows_lexical(EmpArena *arena, const EmpProgram *program, E
 
     ctx_free(&c);
 }
+
+// ===== Aliasing facts =====
+
+typedef struct EmpAliasFn {
+    EmpVec *params;   // EmpParam*
+    EmpStmt *body;
+    EmpSlice name;    // free functions only; empty for methods
+    bool safe;        // not unsafe/extern and no `@emp off` / `@emp mm off` inside
+    bool noalias_ok;  // internal free function whose every call site is visible
+    bool *atomic;     // per param, sticky: reached by `atomic_*` here or in a callee (or NULL)
+} EmpAliasFn;
+
+typedef struct EmpAliasFns {
+    EmpAliasFn *items;
+    size_t len;
+    size_t cap;
+} EmpAliasFns;
+
+typedef enum EmpAliasUse {
+    EMP_ALIAS_READ,   // value is only inspected (scalar read, condition, operand)
+    EMP_ALIAS_ESCAPE, // value is stored, returned or moved somewhere
+} EmpAliasUse;
+
+typedef struct EmpAliasScan {
+    const EmpProgram *program;
+    const EmpAliasFns *fns;
+    const EmpVec *params; // params of the function being scanned
+    bool *written;
+    bool *captured;
+    bool *shadowed;
+    bool *atomic;   // reached by an `atomic_*` builtin: other threads may access it meanwhile
+    bool saw_unsafe;
+} EmpAliasScan;
+
+static bool slice_is(EmpSlice s, const char *lit) {
+    size_t n = strlen(lit);
+    return s.len == n && s.ptr && memcmp(s.ptr, lit, n) == 0;
+}
+
+static bool type_is_scalar(const EmpType *t) {
+    static const char *const k_scalars[] = {
+        "bool", "char", "i8", "i16", "i32", "i64", "isize", "u8", "u16", "u32", "u64", "usize", "f32", "f64",
+    };
+    if (!t || t->kind != EMP_TYPE_NAME) return false;
+    for (size_t i = 0; i < sizeof(k_scalars) / sizeof(k_scalars[0]); i++) {
+        if (slice_is(t->as.name, k_scalars[i])) return true;
+    }
+    return emp_simd_type_parse(t->as.name, NULL, NULL);
+}
+
+// Parameters lowered to a pointer to caller-owned storage. Raw pointers are excluded: they can
+// alias anything.
+static bool param_by_ref(const EmpParam *p) {
+    if (!p || !p->ty) return false;
+    switch (p->ty->kind) {
+        case EMP_TYPE_LIST:
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_TUPLE:
+        case EMP_TYPE_DYN:
+            return true;
+        case EMP_TYPE_NAME:
+            return !type_is_scalar(p->ty);
+        default:
+            return false;
+    }
+}
+
+static EmpSlice alias_root(const EmpExpr *e) {
+    while (e) {
+        switch (e->kind) {
+            case EMP_EXPR_IDENT:
+                return e->as.lit;
+            case EMP_EXPR_GROUP:
+                e = e->as.group.inner;
+                continue;
+            case EMP_EXPR_CAST:
+                e = e->as.cast.expr;
+                continue;
+            case EMP_EXPR_UNARY:
+                if (e->as.unary.op != EMP_UN_BORROW && e->as.unary.op != EMP_UN_BORROW_MUT) return (EmpSlice){0};
+                e = e->as.unary.rhs;
+                continue;
+            case EMP_EXPR_INDEX:
+                e = e->as.index.base;
+                continue;
+            case EMP_EXPR_MEMBER:
+                e = e->as.member.base;
+                continue;
+            default:
+                return (EmpSlice){0};
+        }
+    }
+    return (EmpSlice){0};
+}
+
+// Expressions that evaluate to new storage (or a plain scalar), so they share nothing with
+// another argument. Calls and ternaries are not: they may hand back one of their operands.
+static bool alias_expr_fresh(const EmpExpr *e) {
+    if (!e) return false;
+    switch (e->kind) {
+        case EMP_EXPR_INT:
+        case EMP_EXPR_FLOAT:
+        case EMP_EXPR_STRING:
+        case EMP_EXPR_FSTRING:
+        case EMP_EXPR_CHAR:
+        case EMP_EXPR_BINARY:
+        case EMP_EXPR_TUPLE:
+        case EMP_EXPR_LIST:
+        case EMP_EXPR_NEW:
+        case EMP_EXPR_RANGE:
+            return true;
+        case EMP_EXPR_UNARY:
+            return e->as.unary.op == EMP_UN_NEG || e->as.unary.op == EMP_UN_NOT || e->as.unary.op == EMP_UN_BITNOT;
+        case EMP_EXPR_GROUP:
+            return alias_expr_fresh(e->as.group.inner);
+        default:
+            return false;
+    }
+}
+
+static const EmpExpr *strip_group(const EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+static int alias_param_index(const EmpVec *params, EmpSlice name) {
+    if (!params || !name.len) return -1;
+    for (size_t i = 0; i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (p && slice_eq(p->name, name)) return (int)i;
+    }
+    return -1;
+}
+
+// The unique free function called `name`. Overloads are not resolved here.
+static const EmpAliasFn *alias_find_fn(const EmpAliasFns *fns, EmpSlice name) {
+    const EmpAliasFn *hit = NULL;
+    for (size_t i = 0; i < fns->len; i++) {
+        if (!fns->items[i].name.len || !slice_eq(fns->items[i].name, name)) continue;
+        if (hit) return NULL;
+        hit = &fns->items[i];
+    }
+    return hit;
+}
+
+static void alias_mark(EmpAliasScan *s, EmpSlice root, bool write, bool capture) {
+    int idx = alias_param_index(s->params, root);
+    if (idx < 0) return;
+    if (write) s->written[idx] = true;
+    if (capture) s->captured[idx] = true;
+}
+
+// `atomic_*` builtins (typecheck's tc_atomic_builtin) take `&a`, a shared borrow, and all but
+// `atomic_load` write through it.
+static bool alias_atomic_call(const EmpExpr *callee, bool *out_writes) {
+    if (!callee || callee->kind != EMP_EXPR_IDENT) return false;
+    EmpSlice n = callee->as.lit;
+    if (n.len <= 7 || memcmp(n.ptr, "atomic_", 7) != 0 || slice_is(n, "atomic_fence")) return false;
+    *out_writes = !slice_is(n, "atomic_load");
+    return true;
+}
+
+static void alias_mark_atomic(EmpAliasScan *s, EmpSlice root) {
+    int idx = alias_param_index(s->params, root);
+    if (idx >= 0) s->atomic[idx] = true;
+}
+
+static void alias_shadow(EmpAliasScan *s, EmpSlice name) {
+    int idx = alias_param_index(s->params, name);
+    if (idx >= 0) s->shadowed[idx] = true;
+}
+
+static void alias_shadow_pattern(EmpAliasScan *s, const EmpExpr *e) {
+    if (!e) return;
+    if (e->kind == EMP_EXPR_IDENT) {
+        alias_shadow(s, e->as.lit);
+    } else if (e->kind == EMP_EXPR_CALL) {
+        for (size_t i = 0; i < e->as.call.args.len; i++) alias_shadow_pattern(s, (const EmpExpr *)e->as.call.args.items[i]);
+    } else if (e->kind == EMP_EXPR_TUPLE) {
+        for (size_t i = 0; i < e->as.tuple.items.len; i++) alias_shadow_pattern(s, (const EmpExpr *)e->as.tuple.items.items[i]);
+    } else if (e->kind == EMP_EXPR_GROUP) {
+        alias_shadow_pattern(s, e->as.group.inner);
+    }
+}
+
+// Does reading `base.member` / `base[i]` copy out a scalar (as opposed to an alias of part of
+// the parameter's storage)?
+static bool alias_member_is_scalar(const EmpAliasScan *s, const EmpParam *p, EmpSlice member) {
+    if (!p || !p->ty) return false;
+    if (p->ty->kind == EMP_TYPE_LIST) return slice_is(member, "len") || slice_is(member, "cap");
+    if (p->ty->kind != EMP_TYPE_NAME) return false;
+    for (size_t i = 0; i < s->program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)s->program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_STRUCT && slice_eq(it->as.struct_decl.name, p->ty->as.name)) {
+            for (size_t f = 0; f < it->as.struct_decl.fields.len; f++) {
+                const EmpStructField *fd = (const EmpStructField *)it->as.struct_decl.fields.items[f];
+                if (fd && slice_eq(fd->name, member)) return type_is_scalar(fd->ty);
+            }
+            return false;
+        }
+        if (it->kind == EMP_ITEM_CLASS && slice_eq(it->as.class_decl.name, p->ty->as.name)) {
+            for (size_t f = 0; f < it->as.class_decl.fields.len; f++) {
+                const EmpClassField *fd = (const EmpClassField *)it->as.class_decl.fields.items[f];
+                if (fd && slice_eq(fd->name, member)) return type_is_scalar(fd->ty);
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+static void alias_expr(EmpAliasScan *s, const EmpExpr *e, EmpAliasUse use);
+
+static void alias_call(EmpAliasScan *s, const EmpExpr *e) {
+    const EmpExpr *callee = strip_group(e->as.call.callee);
+    const EmpAliasFn *target = NULL;
+
+    if (callee && callee->kind == EMP_EXPR_IDENT) {
+        target = alias_find_fn(s->fns, callee->as.lit);
+    } else if (callee && callee->kind == EMP_EXPR_MEMBER) {
+        // Method call: the receiver may be mutated or retained by the method.
+        alias_expr(s, callee->as.member.base, EMP_ALIAS_READ);
+        alias_mark(s, alias_root(callee->as.member.base), true, true);
+    } else {
+        alias_expr(s, callee, EMP_ALIAS_READ);
+    }
+
+    bool atomic_writes = false;
+    bool atomic = !target && alias_atomic_call(callee, &atomic_writes);
+    for (size_t i = 0; i < e->as.call.args.len; i++) {
+        const EmpExpr *a = strip_group((const EmpExpr *)e->as.call.args.items[i]);
+        if (!a) continue;
+        if (atomic && i == 0) {
+            alias_expr(s, a, EMP_ALIAS_READ);
+            alias_mark(s, alias_root(a), atomic_writes, false);
+            alias_mark_atomic(s, alias_root(a));
+            continue;
+        }
+        const EmpParam *cp = (target && i < target->params->len) ? (const EmpParam *)target->params->items[i] : NULL;
+        // A callee that reaches the argument with atomics may write it through a shared borrow.
+        bool callee_atomic = cp && target->atomic && target->atomic[i];
+        if (callee_atomic) alias_mark_atomic(s, alias_root(a));
+        // A raw-pointer parameter of a known callee may keep the address.
+        bool callee_keeps = cp && cp->ty && cp->ty->kind == EMP_TYPE_PTR && !cp->is_nocapture;
+
+        if (a->kind == EMP_EXPR_UNARY && (a->as.unary.op == EMP_UN_BORROW || a->as.unary.op == EMP_UN_BORROW_MUT)) {
+            // Borrows are lexical: they end with the call unless the callee stores a raw pointer.
+            alias_expr(s, a->as.unary.rhs, EMP_ALIAS_READ);
+            alias_mark(s, alias_root(a), a->as.unary.op == EMP_UN_BORROW_MUT || callee_keeps || callee_atomic, callee_keeps);
+            continue;
+        }
+        if (a->kind == EMP_EXPR_IDENT && alias_param_index(s->params, a->as.lit) >= 0) {
+            if (cp && target->safe) alias_mark(s, a->as.lit, !cp->is_readonly, !cp->is_nocapture);
+            else alias_mark(s, a->as.lit, true, true);
+            continue;
+        }
+        alias_expr(s, a, EMP_ALIAS_ESCAPE);
+    }
+}
+
+static void alias_expr(EmpAliasScan *s, const EmpExpr *e, EmpAliasUse use) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_IDENT:
+            if (use == EMP_ALIAS_ESCAPE) alias_mark(s, e->as.lit, true, true);
+            return;
+
+        case EMP_EXPR_GROUP:
+            alias_expr(s, e->as.group.inner, use);
+            return;
+
+        case EMP_EXPR_CAST:
+            alias_expr(s, e->as.cast.expr, use);
+            return;
+
+        case EMP_EXPR_UNARY:
+            if (e->as.unary.op == EMP_UN_BORROW || e->as.unary.op == EMP_UN_BORROW_MUT) {
+                alias_expr(s, e->as.unary.rhs, EMP_ALIAS_READ);
+                if (use == EMP_ALIAS_ESCAPE) alias_mark(s, alias_root(e), e->as.unary.op == EMP_UN_BORROW_MUT, true);
+                return;
+            }
+            alias_expr(s, e->as.unary.rhs, EMP_ALIAS_READ);
+            return;
+
+        case EMP_EXPR_BINARY:
+            if (is_assign_like(e->as.binary.op)) {
+                const EmpExpr *lhs = strip_group(e->as.binary.lhs);
+                // Rebinding the parameter itself loses track of what it points to.
+                bool rebinds = lhs && lhs->kind == EMP_EXPR_IDENT;
+                if (lhs && lhs->kind == EMP_EXPR_INDEX) alias_expr(s, lhs->as.index.index, EMP_ALIAS_READ);
+                alias_mark(s, alias_root(lhs), true, rebinds);
+                alias_expr(s, e->as.binary.rhs, EMP_ALIAS_ESCAPE);
+                return;
+            }
+            alias_expr(s, e->as.binary.lhs, EMP_ALIAS_READ);
+            alias_expr(s, e->as.binary.rhs, EMP_ALIAS_READ);
+            return;
+
+        case EMP_EXPR_INDEX: {
+            alias_expr(s, e->as.index.base, EMP_ALIAS_READ);
+            alias_expr(s, e->as.index.index, EMP_ALIAS_READ);
+            if (use != EMP_ALIAS_ESCAPE) return;
+            EmpSlice root = alias_root(e);
+            int idx = alias_param_index(s->params, root);
+            if (idx < 0) return;
+            const EmpParam *p = (const EmpParam *)s->params->items[idx];
+            const EmpExpr *base = strip_group(e->as.index.base);
+            bool direct = base && base->kind == EMP_EXPR_IDENT;
+            bool scalar_elem = direct && p && p->ty && (p->ty->kind == EMP_TYPE_LIST || p->ty->kind == EMP_TYPE_ARRAY) && type_is_scalar(p->ty->as.array.elem);
+            if (!scalar_elem) alias_mark(s, root, true, true);
+            return;
+        }
+
+        case EMP_EXPR_MEMBER: {
+            alias_expr(s, e->as.member.base, EMP_ALIAS_READ);
+            if (use != EMP_ALIAS_ESCAPE) return;
+            EmpSlice root = alias_root(e);
+            int idx = alias_param_index(s->params, root);
+            if (idx < 0) return;
+            const EmpExpr *base = strip_group(e->as.member.base);
+            bool direct = base && base->kind == EMP_EXPR_IDENT;
+            if (!direct || !alias_member_is_scalar(s, (const EmpParam *)s->params->items[idx], e->as.member.member)) {
+                alias_mark(s, root, true, true);
+            }
+            return;
+        }
+
+        case EMP_EXPR_CALL:
+            alias_call(s, e);
+            return;
+
+        case EMP_EXPR_NEW:
+            for (size_t i = 0; i < e->as.new_expr.args.len; i++) alias_expr(s, (const EmpExpr *)e->as.new_expr.args.items[i], EMP_ALIAS_ESCAPE);
+            return;
+
+        case EMP_EXPR_LIST:
+            for (size_t i = 0; i < e->as.list.items.len; i++) alias_expr(s, (const EmpExpr *)e->as.list.items.items[i], EMP_ALIAS_ESCAPE);
+            return;
+
+        case EMP_EXPR_TUPLE:
+            for (size_t i = 0; i < e->as.tuple.items.len; i++) alias_expr(s, (const EmpExpr *)e->as.tuple.items.items[i], EMP_ALIAS_ESCAPE);
+            return;
+
+        case EMP_EXPR_TERNARY:
+            alias_expr(s, e->as.ternary.cond, EMP_ALIAS_READ);
+            alias_expr(s, e->as.ternary.then_expr, use);
+            alias_expr(s, e->as.ternary.else_expr, use);
+            return;
+
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) alias_expr(s, pt->expr, EMP_ALIAS_READ);
+            }
+            return;
+
+        case EMP_EXPR_RANGE:
+            alias_expr(s, e->as.range.start, EMP_ALIAS_READ);
+            alias_expr(s, e->as.range.end, EMP_ALIAS_READ);
+            return;
+
+        default:
+            return;
+    }
+}
+
+static void alias_stmt(EmpAliasScan *s, const EmpStmt *st) {
+    if (!st) return;
+
+    switch (st->kind) {
+        case EMP_STMT_VAR:
+            alias_expr(s, st->as.let_stmt.init, EMP_ALIAS_ESCAPE);
+            alias_shadow(s, st->as.let_stmt.name);
+            if (st->as.let_stmt.is_destructure) {
+                for (size_t i = 0; i < st->as.let_stmt.destruct_names.len; i++) {
+                    const EmpSlice *n = (const EmpSlice *)st->as.let_stmt.destruct_names.items[i];
+                    if (n) alias_shadow(s, *n);
+                }
+            }
+            return;
+
+        case EMP_STMT_DROP:
+            alias_mark(s, st->as.drop_stmt.name, true, true);
+            return;
+
+        case EMP_STMT_DEFER:
+            alias_stmt(s, st->as.defer_stmt.body);
+            return;
+
+        case EMP_STMT_RETURN:
+            alias_expr(s, st->as.ret.value, EMP_ALIAS_ESCAPE);
+            return;
+
+        case EMP_STMT_YIELD:
+            alias_expr(s, st->as.yield_stmt.value, EMP_ALIAS_ESCAPE);
+            return;
+
+        case EMP_STMT_EXPR:
+            alias_expr(s, st->as.expr.expr, EMP_ALIAS_READ);
+            return;
+
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < st->as.block.stmts.len; i++) alias_stmt(s, (const EmpStmt *)st->as.block.stmts.items[i]);
+            return;
+
+        case EMP_STMT_IF:
+            alias_expr(s, st->as.if_stmt.cond, EMP_ALIAS_READ);
+            alias_stmt(s, st->as.if_stmt.then_branch);
+            alias_stmt(s, st->as.if_stmt.else_branch);
+            return;
+
+        case EMP_STMT_WHILE:
+            alias_expr(s, st->as.while_stmt.cond, EMP_ALIAS_READ);
+            alias_stmt(s, st->as.while_stmt.body);
+            return;
+
+        case EMP_STMT_FOR: {
+            alias_expr(s, st->as.for_stmt.iterable, EMP_ALIAS_READ);
+            // The value binding aliases elements of the iterable unless they are scalars.
+            int idx = alias_param_index(s->params, alias_root(st->as.for_stmt.iterable));
+            if (idx >= 0 && st->as.for_stmt.val_name.len) {
+                const EmpParam *p = (const EmpParam *)s->params->items[idx];
+                bool scalar_elem = p && p->ty && (p->ty->kind == EMP_TYPE_LIST || p->ty->kind == EMP_TYPE_ARRAY) && type_is_scalar(p->ty->as.array.elem);
+                if (!scalar_elem) alias_mark(s, p->name, true, true);
+            }
+            alias_shadow(s, st->as.for_stmt.idx_name);
+            alias_shadow(s, st->as.for_stmt.val_name);
+            alias_stmt(s, st->as.for_stmt.body);
+            return;
+        }
+
+        case EMP_STMT_MATCH:
+            alias_expr(s, st->as.match_stmt.scrutinee, EMP_ALIAS_READ);
+            for (size_t i = 0; i < st->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)st->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                alias_shadow_pattern(s, arm->pat);
+                alias_stmt(s, arm->body);
+            }
+            return;
+
+        case EMP_STMT_EMP_OFF:
+        case EMP_STMT_EMP_MM_OFF:
+            s->saw_unsafe = true;
+            return;
+
+        default:
+            return;
+    }
+}
+
+static bool alias_fns_push(EmpAliasFns *fns, EmpAliasFn f) {
+    if (fns->len + 1 > fns->cap) {
+        size_t nc = fns->cap ? fns->cap * 2 : 32;
+        EmpAliasFn *p = (EmpAliasFn *)realloc(fns->items, nc * sizeof(EmpAliasFn));
+        if (!p) return false;
+        fns->items = p;
+        fns->cap = nc;
+    }
+    fns->items[fns->len++] = f;
+    return true;
+}
+
+static void alias_collect_fns(EmpProgram *program, EmpAliasFns *out) {
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+
+        if (it->kind == EMP_ITEM_FN) {
+            EmpItemFn *fn = &it->as.fn;
+            EmpAliasFn f = {&fn->params, fn->body, fn->name, false, false, NULL};
+            // A coroutine's frame keeps its parameters past the call: no facts.
+            f.safe = fn->body && !fn->is_unsafe && !fn->is_extern && !fn->is_mm_only && !fn->coro;
+            f.noalias_ok = fn->is_internal;
+            (void)alias_fns_push(out, f);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (!m) continue;
+                EmpAliasFn f = {&m->params, m->body, (EmpSlice){0}, m->body && !m->is_unsafe, false, NULL};
+                (void)alias_fns_push(out, f);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (!m) continue;
+                EmpAliasFn f = {&m->params, m->body, (EmpSlice){0}, m->body && !m->is_unsafe, false, NULL};
+                (void)alias_fns_push(out, f);
+            }
+        }
+    }
+
+    // Overloaded names cannot be matched to call sites here; neither can functions whose
+    // address is taken (checked during the call-site walk).
+    for (size_t i = 0; i < out->len; i++) {
+        if (out->items[i].name.len && !alias_find_fn(out, out->items[i].name)) out->items[i].noalias_ok = false;
+    }
+}
+
+static void alias_set_params(EmpAliasFn *f, bool value) {
+    for (size_t i = 0; i < f->params->len; i++) {
+        EmpParam *p = (EmpParam *)f->params->items[i];
+        if (!p) continue;
+        bool v = value && f->safe && param_by_ref(p);
+        p->is_readonly = v;
+        p->is_nocapture = v;
+        // A dyn is a pointer to an object that other dyns or `*C`s can point at too; which object
+        // each argument names is not visible from its root, so it never gets noalias.
+        p->is_noalias = v && f->noalias_ok && p->ty->kind != EMP_TYPE_DYN;
+    }
+}
+
+// Re-scan one body with the current (optimistic) callee facts; returns true if a fact dropped.
+static bool alias_refine_fn(const EmpProgram *program, const EmpAliasFns *fns, EmpAliasFn *f) {
+    if (!f->body || !f->params->len) return false;
+
+    size_t n = f->params->len;
+    bool *flags = (bool *)calloc(n * 4, sizeof(bool));
+    if (!flags) return false;
+
+    EmpAliasScan s;
+    memset(&s, 0, sizeof(s));
+    s.program = program;
+    s.fns = fns;
+    s.params = f->params;
+    s.written = flags;
+    s.captured = flags + n;
+    s.shadowed = flags + 2 * n;
+    s.atomic = flags + 3 * n;
+    alias_stmt(&s, f->body);
+
+    bool changed = false;
+    if (s.saw_unsafe && f->safe) {
+        f->safe = false;
+        changed = true;
+    }
+    for (size_t i = 0; i < n; i++) {
+        EmpParam *p = (EmpParam *)f->params->items[i];
+        if (!p) continue;
+        bool ro = p->is_readonly && f->safe && !s.shadowed[i] && !s.written[i];
+        bool nc = p->is_nocapture && f->safe && !s.shadowed[i] && !s.captured[i];
+        if (s.atomic[i] && !f->atomic) f->atomic = (bool *)calloc(n, sizeof(bool));
+        if (s.atomic[i] && f->atomic && !f->atomic[i]) {
+            f->atomic[i] = true;
+            changed = true;
+        }
+        bool na = p->is_noalias && f->safe && !s.shadowed[i] && !s.atomic[i];
+        if (ro != p->is_readonly || nc != p->is_nocapture || na != p->is_noalias) changed = true;
+        p->is_readonly = ro;
+        p->is_nocapture = nc;
+        p->is_noalias = na;
+    }
+    free(flags);
+    return changed;
+}
+
+typedef struct EmpAliasSites {
+    EmpAliasFns *fns;
+    const EmpAliasFn *caller;
+    int unsafe_depth;
+    bool changed;
+    bool final_pass; // record EmpExpr.call.args_disjoint
+    size_t disjoint_calls;
+} EmpAliasSites;
+
+static void alias_drop_noalias(EmpAliasSites *w, EmpAliasFn *f) {
+    f->noalias_ok = false;
+    for (size_t i = 0; i < f->params->len; i++) {
+        EmpParam *p = (EmpParam *)f->params->items[i];
+        if (p && p->is_noalias) {
+            p->is_noalias = false;
+            w->changed = true;
+        }
+    }
+}
+
+typedef struct EmpAliasRoot {
+    EmpSlice name; // empty: unknown, may be anything
+    bool fresh;    // alias_expr_fresh
+} EmpAliasRoot;
+
+// Can arguments rooted at `a` and `b` share storage? An unknown root can; so can two
+// by-reference parameters of the caller, unless both are noalias themselves.
+static bool alias_roots_overlap(const EmpAliasSites *w, EmpAliasRoot ra, EmpAliasRoot rb) {
+    if (ra.fresh || rb.fresh) return false;
+    EmpSlice a = ra.name;
+    EmpSlice b = rb.name;
+    if (!a.len || !b.len) return true;
+    if (slice_eq(a, b)) return true;
+    int ia = alias_param_index(w->caller->params, a);
+    int ib = alias_param_index(w->caller->params, b);
+    if (ia < 0 || ib < 0) return false;
+    const EmpParam *pa = (const EmpParam *)w->caller->params->items[ia];
+    const EmpParam *pb = (const EmpParam *)w->caller->params->items[ib];
+    if (!param_by_ref(pa) || !param_by_ref(pb)) return false;
+    return !(pa->is_noalias && pb->is_noalias);
+}
+
+static void alias_sites_expr(EmpAliasSites *w, EmpExpr *e);
+
+static void alias_sites_call(EmpAliasSites *w, EmpExpr *e) {
+    const EmpExpr *callee = strip_group(e->as.call.callee);
+    EmpAliasFn *target = NULL;
+    if (callee && callee->kind == EMP_EXPR_IDENT) {
+        target = (EmpAliasFn *)alias_find_fn(w->fns, callee->as.lit);
+    } else {
+        alias_sites_expr(w, e->as.call.callee);
+    }
+
+    size_t argc = e->as.call.args.len;
+    EmpAliasRoot *roots = argc ? (EmpAliasRoot *)calloc(argc, sizeof(EmpAliasRoot)) : NULL;
+    for (size_t i = 0; i < argc; i++) {
+        EmpExpr *a = (EmpExpr *)e->as.call.args.items[i];
+        if (roots) {
+            // A dyn or raw pointer names an object its root does not identify: leave it unknown.
+            const EmpParam *pi = target && i < target->params->len ? (const EmpParam *)target->params->items[i] : NULL;
+            bool opaque = !pi || !pi->ty || pi->ty->kind == EMP_TYPE_DYN || pi->ty->kind == EMP_TYPE_PTR;
+            roots[i].fresh = alias_expr_fresh(a);
+            if (!roots[i].fresh && !opaque) roots[i].name = alias_root(a);
+        }
+        alias_sites_expr(w, a);
+    }
+
+    bool in_unsafe = w->unsafe_depth > 0 || !w->caller->safe;
+    if (target && target->noalias_ok) {
+        if (in_unsafe || (argc && !roots)) {
+            alias_drop_noalias(w, target);
+        } else {
+            for (size_t i = 0; i < argc && i < target->params->len; i++) {
+                EmpParam *pi = (EmpParam *)target->params->items[i];
+                if (!pi || !pi->is_noalias) continue;
+                for (size_t j = 0; j < argc; j++) {
+                    if (j == i || !alias_roots_overlap(w, roots[i], roots[j])) continue;
+                    const EmpParam *pj = j < target->params->len ? (const EmpParam *)target->params->items[j] : NULL;
+                    // Overlapping reads are harmless.
+                    if (pi->is_readonly && pj && pj->is_readonly) continue;
+                    pi->is_noalias = false;
+                    w->changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (w->final_pass) {
+        bool disjoint = !in_unsafe && (roots || !argc);
+        for (size_t i = 0; disjoint && i < argc; i++) {
+            for (size_t j = i + 1; j < argc; j++) {
+                if (alias_roots_overlap(w, roots[i], roots[j])) {
+                    disjoint = false;
+                    break;
+                }
+            }
+        }
+        e->as.call.args_disjoint = disjoint;
+        if (disjoint && argc >= 2) w->disjoint_calls++;
+    }
+    free(roots);
+}
+
+static void alias_sites_stmt(EmpAliasSites *w, EmpStmt *st);
+
+static void alias_sites_expr(EmpAliasSites *w, EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_IDENT: {
+            // A function used as a value can be called from anywhere.
+            EmpAliasFn *f = (EmpAliasFn *)alias_find_fn(w->fns, e->as.lit);
+            if (f && f->noalias_ok) alias_drop_noalias(w, f);
+            return;
+        }
+        case EMP_EXPR_CALL:
+            alias_sites_call(w, e);
+            return;
+        case EMP_EXPR_GROUP:
+            alias_sites_expr(w, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            alias_sites_expr(w, e->as.cast.expr);
+            return;
+        case EMP_EXPR_UNARY:
+            alias_sites_expr(w, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            alias_sites_expr(w, e->as.binary.lhs);
+            alias_sites_expr(w, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_INDEX:
+            alias_sites_expr(w, e->as.index.base);
+            alias_sites_expr(w, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER:
+            alias_sites_expr(w, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            for (size_t i = 0; i < e->as.new_expr.args.len; i++) alias_sites_expr(w, (EmpExpr *)e->as.new_expr.args.items[i]);
+            return;
+        case EMP_EXPR_LIST:
+            for (size_t i = 0; i < e->as.list.items.len; i++) alias_sites_expr(w, (EmpExpr *)e->as.list.items.items[i]);
+            return;
+        case EMP_EXPR_TUPLE:
+            for (size_t i = 0; i < e->as.tuple.items.len; i++) alias_sites_expr(w, (EmpExpr *)e->as.tuple.items.items[i]);
+            return;
+        case EMP_EXPR_TERNARY:
+            alias_sites_expr(w, e->as.ternary.cond);
+            alias_sites_expr(w, e->as.ternary.then_expr);
+            alias_sites_expr(w, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) alias_sites_expr(w, pt->expr);
+            }
+            return;
+        case EMP_EXPR_RANGE:
+            alias_sites_expr(w, e->as.range.start);
+            alias_sites_expr(w, e->as.range.end);
+            return;
+        default:
+            return;
+    }
+}
+
+static void alias_sites_stmt(EmpAliasSites *w, EmpStmt *st) {
+    if (!st) return;
+
+    switch (st->kind) {
+        case EMP_STMT_VAR:
+            alias_sites_expr(w, st->as.let_stmt.init);
+            return;
+        case EMP_STMT_DEFER:
+            alias_sites_stmt(w, st->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            alias_sites_expr(w, st->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            alias_sites_expr(w, st->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            alias_sites_expr(w, st->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < st->as.block.stmts.len; i++) alias_sites_stmt(w, (EmpStmt *)st->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            alias_sites_expr(w, st->as.if_stmt.cond);
+            alias_sites_stmt(w, st->as.if_stmt.then_branch);
+            alias_sites_stmt(w, st->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            alias_sites_expr(w, st->as.while_stmt.cond);
+            alias_sites_stmt(w, st->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            alias_sites_expr(w, st->as.for_stmt.iterable);
+            alias_sites_stmt(w, st->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            alias_sites_expr(w, st->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < st->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)st->as.match_stmt.arms.items[i];
+                if (arm) alias_sites_stmt(w, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            w->unsafe_depth++;
+            alias_sites_stmt(w, st->as.emp_off.body);
+            w->unsafe_depth--;
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            w->unsafe_depth++;
+            alias_sites_stmt(w, st->as.emp_mm_off.body);
+            w->unsafe_depth--;
+            return;
+        default:
+            return;
+    }
+}
+
+static void alias_sites_walk(EmpAliasSites *w) {
+    for (size_t i = 0; i < w->fns->len; i++) {
+        w->caller = &w->fns->items[i];
+        w->unsafe_depth = 0;
+        alias_sites_stmt(w, w->caller->body);
+    }
+    w->caller = NULL;
+}
+
+void emp_sem_infer_alias_facts(EmpProgram *program, EmpAliasStats *out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+
+    EmpAliasFns fns;
+    memset(&fns, 0, sizeof(fns));
+    alias_collect_fns(program, &fns);
+
+    const bool file_mm_off = program_has_emp_mm_off(program);
+    for (size_t i = 0; i < fns.len; i++) {
+        if (file_mm_off) fns.items[i].safe = false;
+        alias_set_params(&fns.items[i], true);
+    }
+
+    // readonly/nocapture: start optimistic and shrink to a fixpoint, since a parameter passed on
+    // to another function is only as readonly/nocapture as the callee's parameter.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 0; i < fns.len; i++) {
+            if (alias_refine_fn(program, &fns, &fns.items[i])) changed = true;
+        }
+    }
+
+    // noalias: drop it wherever a call site may pass overlapping storage. Callers' own noalias
+    // facts feed into that, so this is a fixpoint too.
+    EmpAliasSites w;
+    memset(&w, 0, sizeof(w));
+    w.fns = &fns;
+    do {
+        w.changed = false;
+        alias_sites_walk(&w);
+    } while (w.changed);
+
+    w.final_pass = true;
+    alias_sites_walk(&w);
+
+    if (out_stats) {
+        out_stats->disjoint_calls = w.disjoint_calls;
+        for (size_t i = 0; i < fns.len; i++) {
+            const EmpVec *params = fns.items[i].params;
+            for (size_t j = 0; j < params->len; j++) {
+                const EmpParam *p = (const EmpParam *)params->items[j];
+                if (!p) continue;
+                if (p->is_readonly) out_stats->readonly++;
+                if (p->is_nocapture) out_stats->nocapture++;
+                if (p->is_noalias) out_stats->noalias++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < fns.len; i++) free(fns.items[i].atomic);
+    free(fns.items);
+}
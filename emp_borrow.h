@@ -18,6 +18,34 @@ extern "C" {
 // Diagnostics are appended to `diags` and message strings are allocated in `arena`.
 void emp_sem_check_borrows_lexical(EmpArena *arena, const EmpProgram *program, EmpDiags *diags);
 
+typedef struct EmpAliasStats {
+    size_t readonly;  // by-reference params marked is_readonly
+    size_t nocapture; // ... is_nocapture
+    size_t noalias;   // ... is_noalias
+    size_t disjoint_calls;
+} EmpAliasStats;
+
+// Aliasing facts for codegen, derived from the ownership and borrow rules: a safe program never
+// has two live names for the same owned value unless both are shared borrows. Run it on the
+// final (merged, post-elimination) program, and only when the checks above produced no
+// diagnostics.
+//
+// For by-reference parameters (lists, arrays, tuples, structs/classes, dyn) it sets:
+// - EmpParam.is_readonly:  the body never writes through it        -> LLVM `readonly`
+//                          (`atomic_*` other than load write through `&a`)
+// - EmpParam.is_nocapture: it does not outlive the call            -> LLVM `nocapture`
+// - EmpParam.is_noalias:   internal free functions only, never a dyn or a param reached by
+//                          `atomic_*` (here or in a callee); no call site passes
+//                          another argument that may share its storage -> LLVM `noalias`,
+//                          and a distinct alias scope for loads/stores through it
+// and EmpExpr.call.args_disjoint on calls whose arguments have pairwise distinct roots.
+// An argument whose root is unknown (a call, a ternary, a dyn or raw pointer) may overlap
+// anything.
+//
+// Functions that are unsafe, extern or contain `@emp off` / `@emp mm off` regions get no facts,
+// and neither does a program with a file-wide `@emp mm off`. `out_stats` may be NULL.
+void emp_sem_infer_alias_facts(EmpProgram *program, EmpAliasStats *out_stats);
+
 #ifdef __cplusplus
 }
 #endif
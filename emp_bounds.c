@@ -0,0 +1,1070 @@
+#include "emp_bounds.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Function-wide summary of a name (all bindings of that name together).
+typedef struct BcVar {
+    EmpSlice name;
+    const EmpType *ty;   // declared type shared by every typed binding; NULL if unknown/mixed
+    bool ty_mixed;
+    const EmpExpr *init; // initializer of the only `let` binding
+    int bindings;
+    bool nonneg;         // every binding and every write keeps the value >= 0
+    bool written;        // assigned, `&mut`-borrowed or dropped somewhere
+} BcVar;
+
+typedef struct BcVars {
+    BcVar *items;
+    size_t len;
+    size_t cap;
+} BcVars;
+
+typedef struct BcFact {
+    EmpSlice idx;
+    EmpSlice base;        // 0 <= idx < len(base); empty for limit facts
+    const EmpExpr *limit; // 0 <= idx < limit (IDENT or INT)
+    const EmpStmt *loop;  // loop whose condition established `limit`; NULL otherwise
+} BcFact;
+
+typedef struct BcFacts {
+    BcFact *items;
+    size_t len;
+    size_t cap;
+} BcFacts;
+
+typedef struct BcCtx {
+    BcVars vars;
+    EmpBoundsStats stats;
+} BcCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static bool slice_is(EmpSlice s, const char *lit) {
+    size_t n = strlen(lit);
+    return s.len == n && s.ptr && memcmp(s.ptr, lit, n) == 0;
+}
+
+static const EmpExpr *strip_group(const EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+static const EmpExpr *as_ident(const EmpExpr *e) {
+    e = strip_group(e);
+    return e && e->kind == EMP_EXPR_IDENT ? e : NULL;
+}
+
+// Value of a plain integer literal (decimal/hex/binary/octal, optional type suffix).
+static bool int_lit_value(const EmpExpr *e, long long *out) {
+    e = strip_group(e);
+    if (!e || e->kind != EMP_EXPR_INT || !e->as.lit.ptr || !e->as.lit.len) return false;
+    const char *p = e->as.lit.ptr;
+    size_t n = e->as.lit.len;
+    size_t i = 0;
+    int base = 10;
+    if (n >= 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        base = 16;
+        i = 2;
+    } else if (n >= 2 && p[0] == '0' && (p[1] == 'b' || p[1] == 'B')) {
+        base = 2;
+        i = 2;
+    } else if (n >= 2 && p[0] == '0' && (p[1] == 'o' || p[1] == 'O')) {
+        base = 8;
+        i = 2;
+    }
+
+    unsigned long long v = 0;
+    bool saw_digit = false;
+    for (; i < n; i++) {
+        char ch = p[i];
+        int d;
+        if (ch == '_') continue;
+        if (ch >= '0' && ch <= '9') d = ch - '0';
+        else if (ch >= 'a' && ch <= 'f') d = ch - 'a' + 10;
+        else if (ch >= 'A' && ch <= 'F') d = ch - 'A' + 10;
+        else break;
+        if (d >= base) break;
+        if (v > (unsigned long long)(0x7fffffffffffffffLL - d) / (unsigned)base) return false;
+        v = v * (unsigned)base + (unsigned)d;
+        saw_digit = true;
+    }
+    if (!saw_digit) return false;
+    if (i < n && p[i] != 'i' && p[i] != 'u') return false;
+    *out = (long long)v;
+    return true;
+}
+
+static bool type_is_unsigned(const EmpType *t) {
+    if (!t || t->kind != EMP_TYPE_NAME) return false;
+    return slice_is(t->as.name, "u8") || slice_is(t->as.name, "u16") || slice_is(t->as.name, "u32") ||
+           slice_is(t->as.name, "u64") || slice_is(t->as.name, "usize");
+}
+
+static bool array_len(const EmpType *t, long long *out) {
+    if (!t || t->kind != EMP_TYPE_ARRAY || !t->as.array.size_text.len) return false;
+    EmpExpr tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.kind = EMP_EXPR_INT;
+    tmp.as.lit = t->as.array.size_text;
+    return int_lit_value(&tmp, out);
+}
+
+static bool is_borrow(const EmpExpr *e, bool *out_mut) {
+    if (!e || e->kind != EMP_EXPR_UNARY) return false;
+    if (e->as.unary.op != EMP_UN_BORROW && e->as.unary.op != EMP_UN_BORROW_MUT) return false;
+    if (out_mut) *out_mut = e->as.unary.op == EMP_UN_BORROW_MUT;
+    return true;
+}
+
+static EmpSlice root_name(const EmpExpr *e) {
+    while (e) {
+        switch (e->kind) {
+            case EMP_EXPR_IDENT:
+                return e->as.lit;
+            case EMP_EXPR_GROUP:
+                e = e->as.group.inner;
+                continue;
+            case EMP_EXPR_UNARY:
+                if (!is_borrow(e, NULL)) return (EmpSlice){0};
+                e = e->as.unary.rhs;
+                continue;
+            case EMP_EXPR_INDEX:
+                e = e->as.index.base;
+                continue;
+            case EMP_EXPR_MEMBER:
+                e = e->as.member.base;
+                continue;
+            default:
+                return (EmpSlice){0};
+        }
+    }
+    return (EmpSlice){0};
+}
+
+// Does match pattern `pat` bind `name`? Payload bindings (`Option::Some(i)`, `(a, b)`) are new
+// variables in the arm, whatever held that name outside.
+static bool pattern_binds(const EmpExpr *pat, EmpSlice name) {
+    if (!pat) return false;
+    if (pat->kind == EMP_EXPR_IDENT) return slice_eq(pat->as.lit, name);
+    if (pat->kind == EMP_EXPR_CALL) {
+        for (size_t i = 0; i < pat->as.call.args.len; i++) {
+            if (pattern_binds((const EmpExpr *)pat->as.call.args.items[i], name)) return true;
+        }
+    } else if (pat->kind == EMP_EXPR_TUPLE) {
+        for (size_t i = 0; i < pat->as.tuple.items.len; i++) {
+            if (pattern_binds((const EmpExpr *)pat->as.tuple.items.items[i], name)) return true;
+        }
+    } else if (pat->kind == EMP_EXPR_GROUP) {
+        return pattern_binds(pat->as.group.inner, name);
+    }
+    return false;
+}
+
+static bool is_assign_like(EmpBinOp op) {
+    switch (op) {
+        case EMP_BIN_ASSIGN:
+        case EMP_BIN_ADD_ASSIGN:
+        case EMP_BIN_SUB_ASSIGN:
+        case EMP_BIN_MUL_ASSIGN:
+        case EMP_BIN_DIV_ASSIGN:
+        case EMP_BIN_REM_ASSIGN:
+        case EMP_BIN_SHL_ASSIGN:
+        case EMP_BIN_SHR_ASSIGN:
+        case EMP_BIN_BITAND_ASSIGN:
+        case EMP_BIN_BITOR_ASSIGN:
+        case EMP_BIN_BITXOR_ASSIGN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// `list_len(&xs)`, `xs.len` or (before lowering) `xs.len()`: returns `xs`.
+static EmpSlice len_expr_base(const EmpExpr *e) {
+    e = strip_group(e);
+    if (!e) return (EmpSlice){0};
+    if (e->kind == EMP_EXPR_MEMBER && slice_is(e->as.member.member, "len")) {
+        const EmpExpr *b = as_ident(e->as.member.base);
+        return b ? b->as.lit : (EmpSlice){0};
+    }
+    if (e->kind != EMP_EXPR_CALL) return (EmpSlice){0};
+    const EmpExpr *callee = strip_group(e->as.call.callee);
+    if (!callee) return (EmpSlice){0};
+    if (callee->kind == EMP_EXPR_IDENT && slice_is(callee->as.lit, "list_len") && e->as.call.args.len == 1) {
+        const EmpExpr *a = strip_group((const EmpExpr *)e->as.call.args.items[0]);
+        if (a && is_borrow(a, NULL)) a = a->as.unary.rhs;
+        const EmpExpr *b = as_ident(a);
+        return b ? b->as.lit : (EmpSlice){0};
+    }
+    if (callee->kind == EMP_EXPR_MEMBER && slice_is(callee->as.member.member, "len") && e->as.call.args.len == 0) {
+        const EmpExpr *b = as_ident(callee->as.member.base);
+        return b ? b->as.lit : (EmpSlice){0};
+    }
+    return (EmpSlice){0};
+}
+
+// ===== Effects =====
+
+// May evaluating `e` write `name` or change the length of the list it names?
+static bool expr_mutates(const EmpExpr *e, EmpSlice name);
+
+static bool exprs_mutate(const EmpVec *v, EmpSlice name) {
+    for (size_t i = 0; i < v->len; i++) {
+        if (expr_mutates((const EmpExpr *)v->items[i], name)) return true;
+    }
+    return false;
+}
+
+static bool expr_mutates(const EmpExpr *e, EmpSlice name) {
+    if (!e) return false;
+
+    switch (e->kind) {
+        case EMP_EXPR_UNARY: {
+            bool is_mut = false;
+            if (is_borrow(e, &is_mut) && is_mut && slice_eq(root_name(e), name)) return true;
+            return expr_mutates(e->as.unary.rhs, name);
+        }
+        case EMP_EXPR_BINARY:
+            if (is_assign_like(e->as.binary.op)) {
+                const EmpExpr *lhs = as_ident(e->as.binary.lhs);
+                if (lhs && slice_eq(lhs->as.lit, name)) return true;
+            }
+            return expr_mutates(e->as.binary.lhs, name) || expr_mutates(e->as.binary.rhs, name);
+        case EMP_EXPR_CALL: {
+            const EmpExpr *callee = strip_group(e->as.call.callee);
+            // Method calls that were not lowered to builtins may mutate the receiver.
+            if (callee && callee->kind == EMP_EXPR_MEMBER && slice_eq(root_name(callee->as.member.base), name)) return true;
+            return expr_mutates(e->as.call.callee, name) || exprs_mutate(&e->as.call.args, name);
+        }
+        case EMP_EXPR_GROUP:
+            return expr_mutates(e->as.group.inner, name);
+        case EMP_EXPR_CAST:
+            return expr_mutates(e->as.cast.expr, name);
+        case EMP_EXPR_TUPLE:
+            return exprs_mutate(&e->as.tuple.items, name);
+        case EMP_EXPR_LIST:
+            return exprs_mutate(&e->as.list.items, name);
+        case EMP_EXPR_INDEX:
+            return expr_mutates(e->as.index.base, name) || expr_mutates(e->as.index.index, name);
+        case EMP_EXPR_MEMBER:
+            return expr_mutates(e->as.member.base, name);
+        case EMP_EXPR_NEW:
+            return exprs_mutate(&e->as.new_expr.args, name);
+        case EMP_EXPR_TERNARY:
+            return expr_mutates(e->as.ternary.cond, name) || expr_mutates(e->as.ternary.then_expr, name) || expr_mutates(e->as.ternary.else_expr, name);
+        case EMP_EXPR_RANGE:
+            return expr_mutates(e->as.range.start, name) || expr_mutates(e->as.range.end, name);
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr && expr_mutates(pt->expr, name)) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+static bool stmt_mutates(const EmpStmt *s, EmpSlice name) {
+    if (!s) return false;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            if (slice_eq(s->as.let_stmt.name, name)) return true;
+            for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                const EmpSlice *n = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                if (n && slice_eq(*n, name)) return true;
+            }
+            return expr_mutates(s->as.let_stmt.init, name);
+        case EMP_STMT_DROP:
+            return slice_eq(s->as.drop_stmt.name, name);
+        case EMP_STMT_DEFER:
+            return stmt_mutates(s->as.defer_stmt.body, name);
+        case EMP_STMT_RETURN:
+            return expr_mutates(s->as.ret.value, name);
+        case EMP_STMT_YIELD:
+            return expr_mutates(s->as.yield_stmt.value, name);
+        case EMP_STMT_EXPR:
+            return expr_mutates(s->as.expr.expr, name);
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) {
+                if (stmt_mutates((const EmpStmt *)s->as.block.stmts.items[i], name)) return true;
+            }
+            return false;
+        case EMP_STMT_IF:
+            return expr_mutates(s->as.if_stmt.cond, name) || stmt_mutates(s->as.if_stmt.then_branch, name) || stmt_mutates(s->as.if_stmt.else_branch, name);
+        case EMP_STMT_WHILE:
+            return expr_mutates(s->as.while_stmt.cond, name) || stmt_mutates(s->as.while_stmt.body, name);
+        case EMP_STMT_FOR:
+            return slice_eq(s->as.for_stmt.idx_name, name) || slice_eq(s->as.for_stmt.val_name, name) ||
+                   expr_mutates(s->as.for_stmt.iterable, name) || stmt_mutates(s->as.for_stmt.body, name);
+        case EMP_STMT_MATCH:
+            if (expr_mutates(s->as.match_stmt.scrutinee, name)) return true;
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                // Pattern bindings may shadow `name`.
+                if (arm && (expr_mutates(arm->pat, name) || stmt_mutates(arm->body, name))) return true;
+                if (arm && (pattern_binds(arm->pat, name) || slice_eq(root_name(arm->pat), name))) return true;
+            }
+            return false;
+        case EMP_STMT_EMP_OFF:
+            return stmt_mutates(s->as.emp_off.body, name);
+        case EMP_STMT_EMP_MM_OFF:
+            return stmt_mutates(s->as.emp_mm_off.body, name);
+        default:
+            return false;
+    }
+}
+
+// ===== Function-wide variable summary =====
+
+static BcVar *var_get(BcCtx *c, EmpSlice name, bool create) {
+    for (size_t i = 0; i < c->vars.len; i++) {
+        if (slice_eq(c->vars.items[i].name, name)) return &c->vars.items[i];
+    }
+    if (!create || !name.len) return NULL;
+    if (c->vars.len + 1 > c->vars.cap) {
+        size_t nc = c->vars.cap ? c->vars.cap * 2 : 32;
+        BcVar *p = (BcVar *)realloc(c->vars.items, nc * sizeof(BcVar));
+        if (!p) return NULL;
+        c->vars.items = p;
+        c->vars.cap = nc;
+    }
+    BcVar *v = &c->vars.items[c->vars.len++];
+    memset(v, 0, sizeof(*v));
+    v->name = name;
+    v->nonneg = true;
+    return v;
+}
+
+static void var_bind(BcCtx *c, EmpSlice name, const EmpType *ty, const EmpExpr *init, bool nonneg) {
+    BcVar *v = var_get(c, name, true);
+    if (!v) return;
+    v->bindings++;
+    v->init = v->bindings == 1 ? init : NULL;
+    if (ty && ty->kind != EMP_TYPE_AUTO) {
+        if (!v->ty && !v->ty_mixed) v->ty = ty;
+        else if (v->ty != ty) {
+            v->ty = NULL;
+            v->ty_mixed = true;
+        }
+    } else {
+        v->ty = NULL;
+        v->ty_mixed = true;
+    }
+    if (!nonneg && !type_is_unsigned(ty)) v->nonneg = false;
+}
+
+static bool value_nonneg(const EmpExpr *e) {
+    long long k = 0;
+    if (int_lit_value(e, &k)) return k >= 0;
+    return len_expr_base(e).len != 0;
+}
+
+// Does `name = rhs` keep a non-negative `name` non-negative?
+static bool write_keeps_nonneg(EmpBinOp op, EmpSlice name, const EmpExpr *rhs) {
+    long long k = 0;
+    if (op == EMP_BIN_ASSIGN) {
+        if (value_nonneg(rhs)) return true;
+        const EmpExpr *r = strip_group(rhs);
+        if (r && r->kind == EMP_EXPR_BINARY && r->as.binary.op == EMP_BIN_ADD) {
+            const EmpExpr *l = as_ident(r->as.binary.lhs);
+            const EmpExpr *rr = as_ident(r->as.binary.rhs);
+            if (l && slice_eq(l->as.lit, name) && int_lit_value(r->as.binary.rhs, &k) && k >= 0) return true;
+            if (rr && slice_eq(rr->as.lit, name) && int_lit_value(r->as.binary.lhs, &k) && k >= 0) return true;
+        }
+        return false;
+    }
+    if (op == EMP_BIN_ADD_ASSIGN || op == EMP_BIN_MUL_ASSIGN) return int_lit_value(rhs, &k) && k >= 0;
+    return false;
+}
+
+static void summarize_expr(BcCtx *c, const EmpExpr *e);
+
+static void summarize_exprs(BcCtx *c, const EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) summarize_expr(c, (const EmpExpr *)v->items[i]);
+}
+
+static void summarize_expr(BcCtx *c, const EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_UNARY: {
+            bool is_mut = false;
+            if (is_borrow(e, &is_mut) && is_mut) {
+                const EmpExpr *id = as_ident(e->as.unary.rhs);
+                BcVar *v = id ? var_get(c, id->as.lit, true) : NULL;
+                if (v) {
+                    v->written = true;
+                    v->nonneg = v->nonneg && type_is_unsigned(v->ty);
+                }
+            }
+            summarize_expr(c, e->as.unary.rhs);
+            return;
+        }
+        case EMP_EXPR_BINARY:
+            if (is_assign_like(e->as.binary.op)) {
+                const EmpExpr *id = as_ident(e->as.binary.lhs);
+                BcVar *v = id ? var_get(c, id->as.lit, true) : NULL;
+                if (v) {
+                    v->written = true;
+                    if (!type_is_unsigned(v->ty) && !write_keeps_nonneg(e->as.binary.op, id->as.lit, e->as.binary.rhs)) v->nonneg = false;
+                }
+            }
+            summarize_expr(c, e->as.binary.lhs);
+            summarize_expr(c, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            summarize_expr(c, e->as.call.callee);
+            summarize_exprs(c, &e->as.call.args);
+            return;
+        case EMP_EXPR_GROUP:
+            summarize_expr(c, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            summarize_expr(c, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE:
+            summarize_exprs(c, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            summarize_exprs(c, &e->as.list.items);
+            return;
+        case EMP_EXPR_INDEX:
+            summarize_expr(c, e->as.index.base);
+            summarize_expr(c, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER:
+            summarize_expr(c, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            summarize_exprs(c, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TERNARY:
+            summarize_expr(c, e->as.ternary.cond);
+            summarize_expr(c, e->as.ternary.then_expr);
+            summarize_expr(c, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            summarize_expr(c, e->as.range.start);
+            summarize_expr(c, e->as.range.end);
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) summarize_expr(c, pt->expr);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static void summarize_pattern(BcCtx *c, const EmpExpr *pat) {
+    if (!pat) return;
+    if (pat->kind == EMP_EXPR_IDENT) {
+        var_bind(c, pat->as.lit, NULL, NULL, false);
+    } else if (pat->kind == EMP_EXPR_CALL) {
+        for (size_t i = 0; i < pat->as.call.args.len; i++) summarize_pattern(c, (const EmpExpr *)pat->as.call.args.items[i]);
+    } else if (pat->kind == EMP_EXPR_TUPLE) {
+        for (size_t i = 0; i < pat->as.tuple.items.len; i++) summarize_pattern(c, (const EmpExpr *)pat->as.tuple.items.items[i]);
+    } else if (pat->kind == EMP_EXPR_GROUP) {
+        summarize_pattern(c, pat->as.group.inner);
+    }
+}
+
+static void summarize_stmt(BcCtx *c, const EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            summarize_expr(c, s->as.let_stmt.init);
+            if (s->as.let_stmt.is_destructure) {
+                for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                    const EmpSlice *n = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                    if (n) var_bind(c, *n, NULL, NULL, false);
+                }
+            } else {
+                var_bind(c, s->as.let_stmt.name, s->as.let_stmt.ty, s->as.let_stmt.init, value_nonneg(s->as.let_stmt.init));
+            }
+            return;
+        case EMP_STMT_DROP: {
+            BcVar *v = var_get(c, s->as.drop_stmt.name, true);
+            if (v) v->written = true;
+            return;
+        }
+        case EMP_STMT_DEFER:
+            summarize_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            summarize_expr(c, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            summarize_expr(c, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            summarize_expr(c, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) summarize_stmt(c, (const EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            summarize_expr(c, s->as.if_stmt.cond);
+            summarize_stmt(c, s->as.if_stmt.then_branch);
+            summarize_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            summarize_expr(c, s->as.while_stmt.cond);
+            summarize_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR: {
+            const EmpExpr *it = strip_group(s->as.for_stmt.iterable);
+            bool idx_nonneg = true;
+            if (it && it->kind == EMP_EXPR_RANGE) idx_nonneg = value_nonneg(it->as.range.start);
+            summarize_expr(c, s->as.for_stmt.iterable);
+            var_bind(c, s->as.for_stmt.idx_name, s->as.for_stmt.idx_ty, NULL, idx_nonneg);
+            if (s->as.for_stmt.val_name.len) var_bind(c, s->as.for_stmt.val_name, NULL, NULL, false);
+            summarize_stmt(c, s->as.for_stmt.body);
+            return;
+        }
+        case EMP_STMT_MATCH:
+            summarize_expr(c, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                summarize_pattern(c, arm->pat);
+                summarize_stmt(c, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            summarize_stmt(c, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            summarize_stmt(c, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+// ===== Facts =====
+
+static void facts_push(BcFacts *f, BcFact fact) {
+    if (f->len + 1 > f->cap) {
+        size_t nc = f->cap ? f->cap * 2 : 16;
+        BcFact *p = (BcFact *)realloc(f->items, nc * sizeof(BcFact));
+        if (!p) return;
+        f->items = p;
+        f->cap = nc;
+    }
+    f->items[f->len++] = fact;
+}
+
+static void facts_copy(BcFacts *dst, const BcFacts *src) {
+    dst->len = 0;
+    for (size_t i = 0; i < src->len; i++) facts_push(dst, src->items[i]);
+}
+
+static bool fact_mentions_mutated(const BcFact *f, bool (*mutates)(const void *, EmpSlice), const void *node) {
+    if (mutates(node, f->idx)) return true;
+    if (f->base.len && mutates(node, f->base)) return true;
+    const EmpExpr *lim = as_ident(f->limit);
+    return lim && mutates(node, lim->as.lit);
+}
+
+static bool expr_mutates_v(const void *e, EmpSlice name) { return expr_mutates((const EmpExpr *)e, name); }
+static bool stmt_mutates_v(const void *s, EmpSlice name) { return stmt_mutates((const EmpStmt *)s, name); }
+
+// Drop facts that `e` / `s` may invalidate.
+static void facts_kill_expr(BcFacts *f, const EmpExpr *e) {
+    size_t w = 0;
+    for (size_t i = 0; i < f->len; i++) {
+        if (!fact_mentions_mutated(&f->items[i], expr_mutates_v, e)) f->items[w++] = f->items[i];
+    }
+    f->len = w;
+}
+
+static bool pattern_binds_v(const void *pat, EmpSlice name) { return pattern_binds((const EmpExpr *)pat, name); }
+
+// Drop facts about names a match pattern rebinds for its arm.
+static void facts_kill_pattern(BcFacts *f, const EmpExpr *pat) {
+    size_t w = 0;
+    for (size_t i = 0; i < f->len; i++) {
+        if (!fact_mentions_mutated(&f->items[i], pattern_binds_v, pat)) f->items[w++] = f->items[i];
+    }
+    f->len = w;
+}
+
+static void facts_kill_stmt(BcFacts *f, const EmpStmt *s) {
+    size_t w = 0;
+    for (size_t i = 0; i < f->len; i++) {
+        if (!fact_mentions_mutated(&f->items[i], stmt_mutates_v, s)) f->items[w++] = f->items[i];
+    }
+    f->len = w;
+}
+
+// `idx < bound` holds: record it if `idx` is known to be non-negative.
+static void facts_add_lt(BcCtx *c, BcFacts *f, const EmpExpr *idx_e, const EmpExpr *bound, const EmpStmt *loop) {
+    const EmpExpr *idx = as_ident(idx_e);
+    if (!idx) return;
+    BcVar *iv = var_get(c, idx->as.lit, false);
+    if (!iv || !iv->nonneg) return;
+
+    EmpSlice base = len_expr_base(bound);
+    if (!base.len) {
+        // A local bound once to `list_len(&xs)` while `xs` keeps its length.
+        const EmpExpr *b = as_ident(bound);
+        BcVar *bv = b ? var_get(c, b->as.lit, false) : NULL;
+        if (bv && bv->bindings == 1 && !bv->written && bv->init) {
+            EmpSlice lb = len_expr_base(bv->init);
+            BcVar *lv = lb.len ? var_get(c, lb, false) : NULL;
+            if (lv && !lv->written) base = lb;
+        }
+    }
+    if (base.len) {
+        facts_push(f, (BcFact){idx->as.lit, base, NULL, NULL});
+        return;
+    }
+
+    long long k = 0;
+    if (as_ident(bound) || (int_lit_value(bound, &k) && k >= 0)) {
+        facts_push(f, (BcFact){idx->as.lit, (EmpSlice){0}, strip_group(bound), loop});
+    }
+}
+
+static void facts_from_cond(BcCtx *c, BcFacts *f, const EmpExpr *cond, bool positive, const EmpStmt *loop) {
+    cond = strip_group(cond);
+    if (!cond) return;
+
+    if (cond->kind == EMP_EXPR_UNARY && cond->as.unary.op == EMP_UN_NOT) {
+        facts_from_cond(c, f, cond->as.unary.rhs, !positive, loop);
+        return;
+    }
+    if (cond->kind != EMP_EXPR_BINARY) return;
+
+    const EmpExpr *l = cond->as.binary.lhs;
+    const EmpExpr *r = cond->as.binary.rhs;
+    switch (cond->as.binary.op) {
+        case EMP_BIN_AND:
+            if (positive) {
+                facts_from_cond(c, f, l, true, loop);
+                facts_from_cond(c, f, r, true, loop);
+            }
+            return;
+        case EMP_BIN_OR:
+            if (!positive) {
+                facts_from_cond(c, f, l, false, loop);
+                facts_from_cond(c, f, r, false, loop);
+            }
+            return;
+        case EMP_BIN_LT: // l < r
+            if (positive) facts_add_lt(c, f, l, r, loop);
+            return;
+        case EMP_BIN_GT: // r < l
+            if (positive) facts_add_lt(c, f, r, l, loop);
+            return;
+        case EMP_BIN_GE: // !(l >= r) => l < r
+            if (!positive) facts_add_lt(c, f, l, r, loop);
+            return;
+        case EMP_BIN_LE: // !(l <= r) => r < l
+            if (!positive) facts_add_lt(c, f, r, l, loop);
+            return;
+        default:
+            return;
+    }
+}
+
+static const BcFact *facts_find(const BcFacts *f, EmpSlice idx, EmpSlice base) {
+    for (size_t i = f->len; i > 0; i--) {
+        const BcFact *x = &f->items[i - 1];
+        if (slice_eq(x->idx, idx) && x->base.len && slice_eq(x->base, base)) return x;
+    }
+    return NULL;
+}
+
+// ===== Proving accesses =====
+
+static bool index_in_range(const BcFacts *f, EmpSlice base, const BcVar *bv, const EmpExpr *idx) {
+    long long n = -1;
+    bool is_array = bv && array_len(bv->ty, &n);
+
+    long long k = 0;
+    if (int_lit_value(idx, &k)) return is_array && k >= 0 && k < n;
+
+    const EmpExpr *id = as_ident(idx);
+    if (id) {
+        if (facts_find(f, id->as.lit, base)) return true;
+        if (!is_array) return false;
+        for (size_t i = 0; i < f->len; i++) {
+            const BcFact *x = &f->items[i];
+            if (!x->limit || !slice_eq(x->idx, id->as.lit)) continue;
+            if (int_lit_value(x->limit, &k) && k <= n) return true;
+        }
+        return false;
+    }
+
+    // `e & K` is in [0, K]; `e & m` is in [0, m] for a non-negative `m`.
+    idx = strip_group(idx);
+    if (idx && idx->kind == EMP_EXPR_BINARY && idx->as.binary.op == EMP_BIN_BITAND) {
+        const EmpExpr *sides[2] = {idx->as.binary.lhs, idx->as.binary.rhs};
+        for (int s = 0; s < 2; s++) {
+            if (int_lit_value(sides[s], &k) && k >= 0 && is_array && k < n) return true;
+            const EmpExpr *m = as_ident(sides[s]);
+            if (m && facts_find(f, m->as.lit, base)) return true;
+        }
+    }
+    return false;
+}
+
+// A loop-invariant limit that codegen can compare against `len(base)` once before the loop.
+static const BcFact *index_hoistable(const BcFacts *f, EmpSlice base, const EmpExpr *idx) {
+    const EmpExpr *id = as_ident(idx);
+    if (!id) return NULL;
+    for (size_t i = f->len; i > 0; i--) {
+        const BcFact *x = &f->items[i - 1];
+        if (!x->limit || !x->loop || !slice_eq(x->idx, id->as.lit)) continue;
+        const EmpStmt *loop = x->loop;
+        const EmpStmt *body = loop->kind == EMP_STMT_WHILE ? loop->as.while_stmt.body : loop->as.for_stmt.body;
+        if (stmt_mutates(body, base)) continue;
+        const EmpExpr *lim = as_ident(x->limit);
+        if (lim && stmt_mutates(body, lim->as.lit)) continue;
+        return x;
+    }
+    return NULL;
+}
+
+static void visit_expr(BcCtx *c, BcFacts *f, EmpExpr *e);
+
+static void visit_exprs(BcCtx *c, BcFacts *f, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) visit_expr(c, f, (EmpExpr *)v->items[i]);
+}
+
+static void visit_index(BcCtx *c, BcFacts *f, EmpExpr *e) {
+    visit_expr(c, f, e->as.index.base);
+    visit_expr(c, f, e->as.index.index);
+
+    e->as.index.in_bounds = false;
+    e->as.index.hoist_loop = NULL;
+    e->as.index.hoist_limit = NULL;
+
+    const EmpExpr *b = as_ident(e->as.index.base);
+    BcVar *bv = b ? var_get(c, b->as.lit, false) : NULL;
+    // Raw pointers and tuples are not bounds checked.
+    if (bv && bv->ty && (bv->ty->kind == EMP_TYPE_PTR || bv->ty->kind == EMP_TYPE_TUPLE)) return;
+
+    c->stats.checks++;
+    if (!b) return;
+
+    if (index_in_range(f, b->as.lit, bv, e->as.index.index)) {
+        e->as.index.in_bounds = true;
+        c->stats.removed++;
+        return;
+    }
+
+    const BcFact *h = index_hoistable(f, b->as.lit, e->as.index.index);
+    if (h) {
+        e->as.index.hoist_loop = h->loop;
+        e->as.index.hoist_limit = h->limit;
+        c->stats.hoisted++;
+    }
+}
+
+static void visit_expr(BcCtx *c, BcFacts *f, EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_INDEX:
+            visit_index(c, f, e);
+            return;
+        case EMP_EXPR_BINARY:
+            // Short-circuit operands see the facts of the left-hand side.
+            if (e->as.binary.op == EMP_BIN_AND || e->as.binary.op == EMP_BIN_OR) {
+                visit_expr(c, f, e->as.binary.lhs);
+                BcFacts rf;
+                memset(&rf, 0, sizeof(rf));
+                facts_copy(&rf, f);
+                facts_kill_expr(&rf, e->as.binary.lhs);
+                facts_from_cond(c, &rf, e->as.binary.lhs, e->as.binary.op == EMP_BIN_AND, NULL);
+                visit_expr(c, &rf, e->as.binary.rhs);
+                free(rf.items);
+                return;
+            }
+            visit_expr(c, f, e->as.binary.lhs);
+            visit_expr(c, f, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_TERNARY: {
+            visit_expr(c, f, e->as.ternary.cond);
+            BcFacts bf;
+            memset(&bf, 0, sizeof(bf));
+            facts_copy(&bf, f);
+            facts_from_cond(c, &bf, e->as.ternary.cond, true, NULL);
+            visit_expr(c, &bf, e->as.ternary.then_expr);
+            facts_copy(&bf, f);
+            facts_from_cond(c, &bf, e->as.ternary.cond, false, NULL);
+            visit_expr(c, &bf, e->as.ternary.else_expr);
+            free(bf.items);
+            return;
+        }
+        case EMP_EXPR_UNARY:
+            visit_expr(c, f, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            visit_expr(c, f, e->as.call.callee);
+            visit_exprs(c, f, &e->as.call.args);
+            return;
+        case EMP_EXPR_GROUP:
+            visit_expr(c, f, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            visit_expr(c, f, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE:
+            visit_exprs(c, f, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            visit_exprs(c, f, &e->as.list.items);
+            return;
+        case EMP_EXPR_MEMBER:
+            visit_expr(c, f, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            visit_exprs(c, f, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_RANGE:
+            visit_expr(c, f, e->as.range.start);
+            visit_expr(c, f, e->as.range.end);
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) visit_expr(c, f, pt->expr);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+// Visit an expression evaluated as a unit: facts it may invalidate part-way through are not
+// used for any of it. A top-level `x = rhs` writes `x` only after `rhs` is evaluated.
+static void visit_full_expr(BcCtx *c, BcFacts *f, EmpExpr *e) {
+    if (!e) return;
+    BcFacts use;
+    memset(&use, 0, sizeof(use));
+    facts_copy(&use, f);
+    const EmpExpr *se = strip_group(e);
+    if (se && se->kind == EMP_EXPR_BINARY && is_assign_like(se->as.binary.op) && as_ident(se->as.binary.lhs)) {
+        facts_kill_expr(&use, se->as.binary.rhs);
+    } else {
+        facts_kill_expr(&use, e);
+    }
+    visit_expr(c, &use, e);
+    free(use.items);
+    facts_kill_expr(f, e);
+}
+
+static bool stmt_always_exits(const EmpStmt *s) {
+    if (!s) return false;
+    switch (s->kind) {
+        case EMP_STMT_RETURN:
+        case EMP_STMT_BREAK:
+        case EMP_STMT_CONTINUE:
+            return true;
+        case EMP_STMT_BLOCK:
+            return s->as.block.stmts.len && stmt_always_exits((const EmpStmt *)s->as.block.stmts.items[s->as.block.stmts.len - 1]);
+        case EMP_STMT_IF:
+            return stmt_always_exits(s->as.if_stmt.then_branch) && stmt_always_exits(s->as.if_stmt.else_branch);
+        default:
+            return false;
+    }
+}
+
+static void visit_stmt(BcCtx *c, BcFacts *f, EmpStmt *s);
+
+static void visit_branch(BcCtx *c, const BcFacts *f, EmpStmt *s, const EmpExpr *cond, bool positive, const EmpStmt *loop) {
+    BcFacts bf;
+    memset(&bf, 0, sizeof(bf));
+    facts_copy(&bf, f);
+    if (cond) facts_from_cond(c, &bf, cond, positive, loop);
+    visit_stmt(c, &bf, s);
+    free(bf.items);
+}
+
+static void visit_stmt(BcCtx *c, BcFacts *f, EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            visit_full_expr(c, f, s->as.let_stmt.init);
+            facts_kill_stmt(f, s);
+            return;
+
+        case EMP_STMT_DROP:
+            facts_kill_stmt(f, s);
+            return;
+
+        case EMP_STMT_DEFER:
+            visit_branch(c, f, s->as.defer_stmt.body, NULL, true, NULL);
+            return;
+
+        case EMP_STMT_RETURN:
+            visit_full_expr(c, f, s->as.ret.value);
+            return;
+
+        case EMP_STMT_YIELD:
+            visit_full_expr(c, f, s->as.yield_stmt.value);
+            return;
+
+        case EMP_STMT_EXPR:
+            visit_full_expr(c, f, s->as.expr.expr);
+            return;
+
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) visit_stmt(c, f, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+
+        case EMP_STMT_IF: {
+            const EmpExpr *cond = s->as.if_stmt.cond;
+            visit_full_expr(c, f, s->as.if_stmt.cond);
+            visit_branch(c, f, s->as.if_stmt.then_branch, cond, true, NULL);
+            visit_branch(c, f, s->as.if_stmt.else_branch, cond, false, NULL);
+
+            bool then_exits = stmt_always_exits(s->as.if_stmt.then_branch);
+            bool else_exits = s->as.if_stmt.else_branch && stmt_always_exits(s->as.if_stmt.else_branch);
+            facts_kill_stmt(f, s->as.if_stmt.then_branch);
+            facts_kill_stmt(f, s->as.if_stmt.else_branch);
+            // `if i >= xs.len() { break; }` guards the rest of the block.
+            if (then_exits && !else_exits) facts_from_cond(c, f, cond, false, NULL);
+            else if (else_exits && !then_exits) facts_from_cond(c, f, cond, true, NULL);
+            return;
+        }
+
+        case EMP_STMT_WHILE: {
+            // Facts from before the loop only survive if no iteration can break them.
+            facts_kill_stmt(f, s);
+            BcFacts bf;
+            memset(&bf, 0, sizeof(bf));
+            facts_copy(&bf, f);
+            visit_full_expr(c, &bf, s->as.while_stmt.cond);
+            facts_from_cond(c, &bf, s->as.while_stmt.cond, true, s);
+            visit_stmt(c, &bf, s->as.while_stmt.body);
+            free(bf.items);
+            return;
+        }
+
+        case EMP_STMT_FOR: {
+            facts_kill_stmt(f, s);
+            visit_full_expr(c, f, s->as.for_stmt.iterable);
+
+            EmpSlice idx = s->as.for_stmt.idx_name;
+            const EmpExpr *it = strip_group(s->as.for_stmt.iterable);
+            if (s->as.for_stmt.lowering == EMP_FOR_LIST || s->as.for_stmt.lowering == EMP_FOR_SOA) {
+                // A temporary list cannot be resized by the body; a named one must not be.
+                EmpSlice root = root_name(it);
+                s->as.for_stmt.len_invariant = !root.len || !stmt_mutates(s->as.for_stmt.body, root);
+            }
+
+            BcFacts bf;
+            memset(&bf, 0, sizeof(bf));
+            facts_copy(&bf, f);
+            bool idx_stable = idx.len && !slice_is(idx, "_") && !stmt_mutates(s->as.for_stmt.body, idx);
+            if (idx_stable && it && it->kind == EMP_EXPR_RANGE && !it->as.range.inclusive) {
+                // `for i in a..b` with a >= 0: i < b.
+                if (value_nonneg(it->as.range.start)) {
+                    EmpExpr idx_e;
+                    memset(&idx_e, 0, sizeof(idx_e));
+                    idx_e.kind = EMP_EXPR_IDENT;
+                    idx_e.as.lit = idx;
+                    size_t before = bf.len;
+                    facts_add_lt(c, &bf, &idx_e, it->as.range.end, s);
+                    if (bf.len > before && bf.items[before].base.len && stmt_mutates(s->as.for_stmt.body, bf.items[before].base)) bf.len = before;
+                }
+            } else if (idx_stable && as_ident(it)) {
+                // `for i, v in xs`: i < len(xs) as long as the body keeps the length.
+                EmpSlice base = as_ident(it)->as.lit;
+                if (!stmt_mutates(s->as.for_stmt.body, base)) facts_push(&bf, (BcFact){idx, base, NULL, NULL});
+            }
+            visit_stmt(c, &bf, s->as.for_stmt.body);
+            free(bf.items);
+            return;
+        }
+
+        case EMP_STMT_MATCH:
+            visit_full_expr(c, f, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                BcFacts af;
+                memset(&af, 0, sizeof(af));
+                facts_copy(&af, f);
+                facts_kill_pattern(&af, arm->pat);
+                visit_branch(c, &af, arm->body, NULL, true, NULL);
+                free(af.items);
+            }
+            facts_kill_stmt(f, s);
+            return;
+
+        case EMP_STMT_EMP_OFF:
+            visit_stmt(c, f, s->as.emp_off.body);
+            return;
+
+        case EMP_STMT_EMP_MM_OFF:
+            visit_stmt(c, f, s->as.emp_mm_off.body);
+            return;
+
+        default:
+            return;
+    }
+}
+
+static void run_fn(BcCtx *c, const EmpVec *params, EmpStmt *body) {
+    if (!body) return;
+    c->vars.len = 0;
+    for (size_t i = 0; i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (p) var_bind(c, p->name, p->ty, NULL, false);
+    }
+    summarize_stmt(c, body);
+
+    BcFacts f;
+    memset(&f, 0, sizeof(f));
+    visit_stmt(c, &f, body);
+    free(f.items);
+}
+
+void emp_sem_eliminate_bounds_checks(EmpProgram *program, EmpBoundsStats *out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+
+    BcCtx c;
+    memset(&c, 0, sizeof(c));
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+
+        if (it->kind == EMP_ITEM_FN) {
+            run_fn(&c, &it->as.fn.params, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) run_fn(&c, &m->params, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) run_fn(&c, &m->params, m->body);
+            }
+        }
+    }
+
+    free(c.vars.items);
+    if (out_stats) *out_stats = c.stats;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EmpBoundsStats {
+    size_t checks;  // indexing expressions that would need a bounds check
+    size_t removed; // proven in range (EmpExpr.index.in_bounds)
+    size_t hoisted; // left to a single check in the loop preheader (EmpExpr.index.hoist_loop)
+} EmpBoundsStats;
+
+// Bounds-check elimination over the checked AST (run after type checking, which lowers
+// `xs.len()` to `list_len(&xs)`).
+//
+// Facts of the form `0 <= i < len(xs)` come from:
+// - loop/if conditions (`while i < xs.len()`, `if i >= n { break; }`, `i < xs.len() && xs[i]`)
+//   when `i` is provably non-negative (unsigned, or only ever set to non-negative literals and
+//   incremented by them)
+// - `for i, v in xs` and `for i in 0..xs.len()`
+// - locals bound once to `list_len(&xs)` while `xs` never changes length
+// Constant indices into `T[N]` arrays and masked indices (`e & K`, `e & m` with `m` in range)
+// are proven directly. A fact dies at the first statement that may write `i` or change the
+// length of `xs`.
+//
+// When a loop is bounded by a limit unrelated to the list (`while i < n { xs[i] }`) and neither
+// `n` nor the length of `xs` change inside it, the access records that loop and limit so codegen
+// can check `n <= len(xs)` once in the preheader and run a check-free loop body.
+//
+// The same walk sets `len_invariant` on list `for` loops whose body cannot change the list's
+// length, which lets codegen load data/len once and bump an element pointer.
+//
+// `out_stats` may be NULL.
+void emp_sem_eliminate_bounds_checks(EmpProgram *program, EmpBoundsStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,739 @@
+#include "emp_cache.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FNV-1a (64-bit). Stable across runs and platforms, which is all the cache needs.
+#define EMP_FNV_OFFSET 1469598103934665603ull
+#define EMP_FNV_PRIME 1099511628211ull
+
+typedef struct EmpHasher {
+    uint64_t h;
+    const EmpProgram *program; // for callee signature lookup
+} EmpHasher;
+
+static void h_bytes(EmpHasher *hs, const void *data, size_t n) {
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < n; i++) {
+        hs->h ^= (uint64_t)p[i];
+        hs->h *= EMP_FNV_PRIME;
+    }
+}
+
+static void h_u32(EmpHasher *hs, uint32_t v) {
+    unsigned char b[4];
+    b[0] = (unsigned char)(v & 0xff);
+    b[1] = (unsigned char)((v >> 8) & 0xff);
+    b[2] = (unsigned char)((v >> 16) & 0xff);
+    b[3] = (unsigned char)((v >> 24) & 0xff);
+    h_bytes(hs, b, sizeof(b));
+}
+
+static void h_u64(EmpHasher *hs, uint64_t v) {
+    h_u32(hs, (uint32_t)v);
+    h_u32(hs, (uint32_t)(v >> 32));
+}
+
+static void h_slice(EmpHasher *hs, EmpSlice s) {
+    // Length-prefixed so adjacent slices can't alias (`ab`+`c` vs `a`+`bc`).
+    h_u32(hs, (uint32_t)s.len);
+    if (s.ptr && s.len) h_bytes(hs, s.ptr, s.len);
+}
+
+static void h_cstr(EmpHasher *hs, const char *s) {
+    EmpSlice sl;
+    sl.ptr = s;
+    sl.len = s ? strlen(s) : 0;
+    h_slice(hs, sl);
+}
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static void h_type(EmpHasher *hs, const EmpType *t) {
+    if (!t) {
+        h_u32(hs, 0xffffffffu);
+        return;
+    }
+    h_u32(hs, (uint32_t)t->kind);
+    switch (t->kind) {
+        case EMP_TYPE_NAME:
+            h_slice(hs, t->as.name);
+            return;
+        case EMP_TYPE_DYN:
+            h_slice(hs, t->as.dyn.base_name);
+            return;
+        case EMP_TYPE_PTR:
+            h_type(hs, t->as.ptr.pointee);
+            return;
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            h_type(hs, t->as.array.elem);
+            h_slice(hs, t->as.array.size_text);
+            return;
+        case EMP_TYPE_TUPLE:
+            h_u32(hs, (uint32_t)t->as.tuple.fields.len);
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                h_type(hs, f ? f->ty : NULL);
+                if (f) h_slice(hs, f->name);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+// Folded calls and imported consts depend on code in other modules; hash the value itself.
+static void h_const_value(EmpHasher *hs, const EmpConstValue *v) {
+    if (!v) {
+        h_u32(hs, 0xffffffffu);
+        return;
+    }
+    h_u32(hs, (uint32_t)v->kind | (uint32_t)v->bits << 8 | (uint32_t)v->is_unsigned << 16 | (uint32_t)v->is_usize << 17);
+    switch (v->kind) {
+        case EMP_CONST_INT:
+            h_bytes(hs, &v->as.i, sizeof(v->as.i));
+            return;
+        case EMP_CONST_FLOAT:
+            h_bytes(hs, &v->as.f, sizeof(v->as.f));
+            return;
+        case EMP_CONST_BOOL:
+            h_u32(hs, (uint32_t)v->as.b);
+            return;
+        case EMP_CONST_CHAR:
+            h_u32(hs, v->as.ch);
+            return;
+        case EMP_CONST_STRING:
+            h_u32(hs, (uint32_t)v->as.str.len);
+            h_bytes(hs, v->as.str.ptr, v->as.str.len);
+            return;
+        case EMP_CONST_TUPLE:
+        case EMP_CONST_ARRAY:
+            h_type(hs, v->as.agg.ty);
+            h_u32(hs, (uint32_t)v->as.agg.len);
+            for (size_t i = 0; i < v->as.agg.len; i++) h_const_value(hs, v->as.agg.items[i]);
+            return;
+        default:
+            return;
+    }
+}
+
+static void h_params(EmpHasher *hs, const EmpVec *params) {
+    h_u32(hs, (uint32_t)params->len);
+    for (size_t i = 0; i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (!p) continue;
+        h_slice(hs, p->name);
+        h_type(hs, p->ty);
+        h_u32(hs, (uint32_t)p->is_readonly | (uint32_t)p->is_nocapture << 1 | (uint32_t)p->is_noalias << 2 | (uint32_t)p->drop_flag << 3);
+    }
+}
+
+// Mix in the signature(s) of the function(s) a call can resolve to. Overloads share a base name,
+// so all of them are included; that is conservative but stays correct when one is added/removed.
+static void h_callee_sigs(EmpHasher *hs, EmpSlice name) {
+    if (!hs->program || !name.ptr || !name.len) return;
+    for (size_t i = 0; i < hs->program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)hs->program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_FN) continue;
+        if (!slice_eq(it->as.fn.name, name)) continue;
+        h_params(hs, &it->as.fn.params);
+        h_type(hs, it->as.fn.ret_ty);
+        h_u32(hs, (uint32_t)it->as.fn.is_extern);
+        h_u32(hs, (uint32_t)it->as.fn.is_async);
+        h_slice(hs, it->as.fn.abi);
+    }
+}
+
+static void h_expr(EmpHasher *hs, const EmpExpr *e);
+static void h_stmt(EmpHasher *hs, const EmpStmt *s);
+
+static void h_exprs(EmpHasher *hs, const EmpVec *v) {
+    h_u32(hs, (uint32_t)v->len);
+    for (size_t i = 0; i < v->len; i++) {
+        h_expr(hs, (const EmpExpr *)v->items[i]);
+    }
+}
+
+static void h_expr(EmpHasher *hs, const EmpExpr *e) {
+    if (!e) {
+        h_u32(hs, 0xffffffffu);
+        return;
+    }
+    h_u32(hs, (uint32_t)e->kind);
+
+    switch (e->kind) {
+        case EMP_EXPR_INT:
+        case EMP_EXPR_FLOAT:
+        case EMP_EXPR_STRING:
+        case EMP_EXPR_CHAR:
+        case EMP_EXPR_IDENT:
+            h_slice(hs, e->as.lit);
+            return;
+
+        case EMP_EXPR_FSTRING:
+            h_u32(hs, (uint32_t)e->as.fstring.parts.len);
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (!pt) continue;
+                h_u32(hs, (uint32_t)pt->is_expr | (uint32_t)pt->fmt << 1 | (uint32_t)pt->bits << 8);
+                if (pt->is_expr) h_expr(hs, pt->expr);
+                else h_slice(hs, pt->text);
+            }
+            // const_id is program-wide and changes only together with some f-string's text.
+            h_u32(hs, (uint32_t)e->as.fstring.is_temp);
+            return;
+
+        case EMP_EXPR_UNARY:
+            h_u32(hs, (uint32_t)e->as.unary.op);
+            h_expr(hs, e->as.unary.rhs);
+            return;
+
+        case EMP_EXPR_BINARY:
+            h_u32(hs, (uint32_t)e->as.binary.op);
+            h_expr(hs, e->as.binary.lhs);
+            h_expr(hs, e->as.binary.rhs);
+            return;
+
+        case EMP_EXPR_CALL:
+            h_expr(hs, e->as.call.callee);
+            h_exprs(hs, &e->as.call.args);
+            h_slice(hs, e->as.call.resolved_name);
+            h_slice(hs, e->as.call.dyn_base_name);
+            h_u32(hs, e->as.call.dyn_slot);
+            h_u32(hs, (uint32_t)e->as.call.args_disjoint);
+            if (e->as.call.folded) h_const_value(hs, e->as.call.folded);
+            h_u32(hs, (uint32_t)e->as.call.devirt_count | (uint32_t)e->as.call.devirt_guarded << 8);
+            for (uint8_t i = 0; i < e->as.call.devirt_count; i++) h_slice(hs, e->as.call.devirt_class[i]);
+            if (e->as.call.callee && e->as.call.callee->kind == EMP_EXPR_IDENT) {
+                h_callee_sigs(hs, e->as.call.callee->as.lit);
+            }
+            return;
+
+        case EMP_EXPR_GROUP:
+            h_expr(hs, e->as.group.inner);
+            return;
+
+        case EMP_EXPR_CAST:
+            h_type(hs, e->as.cast.ty);
+            h_expr(hs, e->as.cast.expr);
+            h_slice(hs, e->as.cast.dyn_concrete_name);
+            return;
+
+        case EMP_EXPR_TUPLE:
+            h_exprs(hs, &e->as.tuple.items);
+            return;
+
+        case EMP_EXPR_LIST:
+            h_exprs(hs, &e->as.list.items);
+            return;
+
+        case EMP_EXPR_INDEX:
+            h_expr(hs, e->as.index.base);
+            h_expr(hs, e->as.index.index);
+            h_u32(hs, (uint32_t)e->as.index.in_bounds | (uint32_t)(e->as.index.hoist_loop != NULL) << 1);
+            return;
+
+        case EMP_EXPR_MEMBER:
+            h_expr(hs, e->as.member.base);
+            h_slice(hs, e->as.member.member);
+            return;
+
+        case EMP_EXPR_NEW:
+            h_slice(hs, e->as.new_expr.class_name);
+            h_exprs(hs, &e->as.new_expr.args);
+            h_u32(hs, (uint32_t)e->as.new_expr.on_stack);
+            return;
+
+        case EMP_EXPR_TERNARY:
+            h_expr(hs, e->as.ternary.cond);
+            h_expr(hs, e->as.ternary.then_expr);
+            h_expr(hs, e->as.ternary.else_expr);
+            return;
+
+        case EMP_EXPR_RANGE:
+            h_expr(hs, e->as.range.start);
+            h_expr(hs, e->as.range.end);
+            h_u32(hs, (uint32_t)e->as.range.inclusive);
+            return;
+
+        default:
+            return;
+    }
+}
+
+static void h_stmt(EmpHasher *hs, const EmpStmt *s) {
+    if (!s) {
+        h_u32(hs, 0xffffffffu);
+        return;
+    }
+    h_u32(hs, (uint32_t)s->kind);
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            h_type(hs, s->as.let_stmt.ty);
+            h_slice(hs, s->as.let_stmt.name);
+            h_u32(hs, (uint32_t)s->as.let_stmt.is_destructure);
+            for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                const EmpSlice *nm = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                if (nm) h_slice(hs, *nm);
+            }
+            h_expr(hs, s->as.let_stmt.init);
+            h_u32(hs, (uint32_t)s->as.let_stmt.drop_flag);
+            return;
+
+        case EMP_STMT_DROP:
+            h_slice(hs, s->as.drop_stmt.name);
+            h_u32(hs, (uint32_t)s->as.drop_stmt.elided | (uint32_t)s->as.drop_stmt.in_place << 1 | (uint32_t)s->as.drop_stmt.mode << 2);
+            h_u32(hs, s->as.drop_stmt.cleanup);
+            return;
+
+        case EMP_STMT_DEFER:
+            h_stmt(hs, s->as.defer_stmt.body);
+            return;
+
+        case EMP_STMT_TAG:
+            h_slice(hs, s->as.tag_stmt.name);
+            return;
+
+        case EMP_STMT_RETURN:
+            h_expr(hs, s->as.ret.value);
+            return;
+
+        case EMP_STMT_YIELD:
+            h_expr(hs, s->as.yield_stmt.value);
+            return;
+
+        case EMP_STMT_EXPR:
+            h_expr(hs, s->as.expr.expr);
+            return;
+
+        case EMP_STMT_BLOCK:
+            h_u32(hs, (uint32_t)s->as.block.stmts.len);
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) {
+                h_stmt(hs, (const EmpStmt *)s->as.block.stmts.items[i]);
+            }
+            return;
+
+        case EMP_STMT_IF:
+            h_expr(hs, s->as.if_stmt.cond);
+            h_stmt(hs, s->as.if_stmt.then_branch);
+            h_stmt(hs, s->as.if_stmt.else_branch);
+            return;
+
+        case EMP_STMT_WHILE:
+            h_expr(hs, s->as.while_stmt.cond);
+            h_stmt(hs, s->as.while_stmt.body);
+            return;
+
+        case EMP_STMT_FOR:
+            h_slice(hs, s->as.for_stmt.idx_name);
+            h_slice(hs, s->as.for_stmt.val_name);
+            h_expr(hs, s->as.for_stmt.iterable);
+            h_u32(hs, (uint32_t)s->as.for_stmt.lowering | (uint32_t)s->as.for_stmt.len_invariant << 8 | (uint32_t)s->as.for_stmt.is_parallel << 9 |
+                      (uint32_t)s->as.for_stmt.soa_gather << 10);
+            h_type(hs, s->as.for_stmt.idx_ty);
+            h_stmt(hs, s->as.for_stmt.body);
+            return;
+
+        case EMP_STMT_MATCH:
+            h_expr(hs, s->as.match_stmt.scrutinee);
+            h_u32(hs, (uint32_t)s->as.match_stmt.arms.len);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *a = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!a) continue;
+                h_u32(hs, (uint32_t)a->is_default);
+                h_expr(hs, a->pat);
+                h_stmt(hs, a->body);
+            }
+            return;
+
+        case EMP_STMT_EMP_OFF:
+            h_stmt(hs, s->as.emp_off.body);
+            return;
+
+        case EMP_STMT_EMP_MM_OFF:
+            h_stmt(hs, s->as.emp_mm_off.body);
+            return;
+
+        default:
+            return;
+    }
+}
+
+void emp_fingerprints_init(EmpFingerprints *fps) {
+    memset(fps, 0, sizeof(*fps));
+}
+
+void emp_fingerprints_free(EmpFingerprints *fps) {
+    if (!fps) return;
+    for (size_t i = 0; i < fps->len; i++) free(fps->items[i].symbol);
+    free(fps->items);
+    memset(fps, 0, sizeof(*fps));
+}
+
+static bool fps_push(EmpFingerprints *fps, const char *symbol, uint64_t hash) {
+    if (fps->len + 1 > fps->cap) {
+        size_t new_cap = fps->cap ? fps->cap * 2 : 32;
+        EmpFingerprint *p = (EmpFingerprint *)realloc(fps->items, new_cap * sizeof(EmpFingerprint));
+        if (!p) return false;
+        fps->items = p;
+        fps->cap = new_cap;
+    }
+    size_t n = strlen(symbol);
+    char *owned = (char *)malloc(n + 1);
+    if (!owned) return false;
+    memcpy(owned, symbol, n + 1);
+    fps->items[fps->len].symbol = owned;
+    fps->items[fps->len].hash = hash;
+    fps->len++;
+    return true;
+}
+
+static const EmpFingerprint *fps_find(const EmpFingerprints *fps, const char *symbol) {
+    for (size_t i = 0; i < fps->len; i++) {
+        if (strcmp(fps->items[i].symbol, symbol) == 0) return &fps->items[i];
+    }
+    return NULL;
+}
+
+// Symbols are built at full length: a truncated key could give two methods one manifest entry.
+typedef struct EmpSymBuf {
+    char *p;
+    size_t len;
+    size_t cap;
+    bool oom;
+} EmpSymBuf;
+
+static void sb_put(EmpSymBuf *b, const char *s, size_t n) {
+    if (b->len + n + 1 > b->cap) {
+        size_t nc = b->cap ? b->cap * 2 : 128;
+        while (nc < b->len + n + 1) nc *= 2;
+        char *p = (char *)realloc(b->p, nc);
+        if (!p) {
+            b->oom = true;
+            return;
+        }
+        b->p = p;
+        b->cap = nc;
+    }
+    if (n) memcpy(b->p + b->len, s, n);
+    b->len += n;
+    b->p[b->len] = '\0';
+}
+
+static void sb_cstr(EmpSymBuf *b, const char *s) { sb_put(b, s, strlen(s)); }
+static void sb_slice(EmpSymBuf *b, EmpSlice s) { sb_put(b, s.ptr, s.ptr ? s.len : 0); }
+
+static void sb_reset(EmpSymBuf *b) {
+    b->len = 0;
+    sb_put(b, "", 0);
+}
+
+// Push `symbol`, disambiguating repeats (overloads) as `symbol#1`, `symbol#2`, ... in program order.
+static bool fps_push_unique(EmpFingerprints *fps, const char *symbol, uint64_t hash) {
+    if (!fps_find(fps, symbol)) return fps_push(fps, symbol, hash);
+    size_t n = strlen(symbol) + 16;
+    char *buf = (char *)malloc(n);
+    if (!buf) return false;
+    bool ok = false;
+    for (unsigned k = 1;; k++) {
+        snprintf(buf, n, "%s#%u", symbol, k);
+        if (!fps_find(fps, buf)) {
+            ok = fps_push(fps, buf, hash);
+            break;
+        }
+    }
+    free(buf);
+    return ok;
+}
+
+// Pushes the symbol built in `sym`.
+static bool fps_push_sym(EmpFingerprints *fps, const EmpSymBuf *sym, uint64_t hash) {
+    return !sym->oom && fps_push_unique(fps, sym->p, hash);
+}
+
+static void hasher_begin(EmpHasher *hs, const EmpProgram *program, const char *target_key) {
+    hs->h = EMP_FNV_OFFSET;
+    hs->program = program;
+    h_cstr(hs, target_key ? target_key : "");
+}
+
+static bool fingerprint_items(const EmpProgram *program, const char *target_key, EmpFingerprints *out, EmpSymBuf *sb);
+
+bool emp_fingerprint_program(const EmpProgram *program, const char *target_key, EmpFingerprints *out) {
+    if (!program || !out) return false;
+    EmpSymBuf sb;
+    memset(&sb, 0, sizeof(sb));
+    bool ok = fingerprint_items(program, target_key, out, &sb);
+    free(sb.p);
+    return ok;
+}
+
+static bool fingerprint_items(const EmpProgram *program, const char *target_key, EmpFingerprints *out, EmpSymBuf *sb) {
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (!it) continue;
+        sb_reset(sb);
+
+        EmpHasher hs;
+        hasher_begin(&hs, program, target_key);
+        h_u32(&hs, (uint32_t)it->kind);
+
+        switch (it->kind) {
+            case EMP_ITEM_FN: {
+                const EmpItemFn *fn = &it->as.fn;
+                h_u32(&hs, (uint32_t)fn->is_exported);
+                h_u32(&hs, (uint32_t)fn->is_extern);
+                h_u32(&hs, (uint32_t)fn->is_internal);
+                h_u32(&hs, (uint32_t)fn->is_const);
+                h_u32(&hs, (uint32_t)fn->is_async);
+                h_slice(&hs, fn->abi);
+                h_params(&hs, &fn->params);
+                h_type(&hs, fn->ret_ty);
+                h_stmt(&hs, fn->body);
+                sb_slice(sb, fn->name);
+                if (!fps_push_sym(out, sb, hs.h)) return false;
+                break;
+            }
+
+            case EMP_ITEM_CLASS: {
+                // Layout / vtable fingerprint for the class itself, then one per method.
+                const EmpItemClass *cls = &it->as.class_decl;
+                h_slice(&hs, cls->base_name);
+                for (size_t fi = 0; fi < cls->fields.len; fi++) {
+                    const EmpClassField *f = (const EmpClassField *)cls->fields.items[fi];
+                    if (!f) continue;
+                    h_slice(&hs, f->name);
+                    h_type(&hs, f->ty);
+                }
+                for (size_t mi = 0; mi < cls->methods.len; mi++) {
+                    const EmpClassMethod *m = (const EmpClassMethod *)cls->methods.items[mi];
+                    if (!m) continue;
+                    h_slice(&hs, m->name);
+                    h_u32(&hs, (uint32_t)m->is_virtual | (uint32_t)m->self_nocapture << 1);
+                    h_params(&hs, &m->params);
+                    h_type(&hs, m->ret_ty);
+                }
+                sb_slice(sb, cls->name);
+                if (!fps_push_sym(out, sb, hs.h)) return false;
+
+                for (size_t mi = 0; mi < cls->methods.len; mi++) {
+                    const EmpClassMethod *m = (const EmpClassMethod *)cls->methods.items[mi];
+                    if (!m) continue;
+                    EmpHasher mh;
+                    hasher_begin(&mh, program, target_key);
+                    h_slice(&mh, cls->name);
+                    h_u32(&mh, (uint32_t)m->is_internal);
+                    h_params(&mh, &m->params);
+                    h_type(&mh, m->ret_ty);
+                    h_stmt(&mh, m->body);
+                    sb_reset(sb);
+                    sb_slice(sb, cls->name);
+                    sb_cstr(sb, ".");
+                    sb_slice(sb, m->name);
+                    if (!fps_push_sym(out, sb, mh.h)) return false;
+                }
+                break;
+            }
+
+            case EMP_ITEM_IMPL: {
+                const EmpItemImpl *im = &it->as.impl_decl;
+                for (size_t mi = 0; mi < im->methods.len; mi++) {
+                    const EmpImplMethod *m = (const EmpImplMethod *)im->methods.items[mi];
+                    if (!m) continue;
+                    EmpHasher mh;
+                    hasher_begin(&mh, program, target_key);
+                    h_slice(&mh, im->trait_name);
+                    h_slice(&mh, im->target_name);
+                    h_u32(&mh, (uint32_t)m->is_internal);
+                    h_params(&mh, &m->params);
+                    h_type(&mh, m->ret_ty);
+                    h_stmt(&mh, m->body);
+                    sb_reset(sb);
+                    sb_cstr(sb, "impl ");
+                    if (im->trait_name.len) {
+                        sb_slice(sb, im->trait_name);
+                        sb_cstr(sb, " for ");
+                    }
+                    sb_slice(sb, im->target_name);
+                    sb_cstr(sb, ".");
+                    sb_slice(sb, m->name);
+                    if (!fps_push_sym(out, sb, mh.h)) return false;
+                }
+                break;
+            }
+
+            case EMP_ITEM_TRAIT: {
+                const EmpItemTrait *tr = &it->as.trait_decl;
+                for (size_t mi = 0; mi < tr->methods.len; mi++) {
+                    const EmpTraitMethod *m = (const EmpTraitMethod *)tr->methods.items[mi];
+                    if (!m) continue;
+                    h_slice(&hs, m->name);
+                    h_params(&hs, &m->params);
+                    h_type(&hs, m->ret_ty);
+                    h_stmt(&hs, m->body);
+                }
+                sb_cstr(sb, "trait ");
+                sb_slice(sb, tr->name);
+                if (!fps_push_sym(out, sb, hs.h)) return false;
+                break;
+            }
+
+            case EMP_ITEM_CONST:
+                h_type(&hs, it->as.const_decl.ty);
+                h_expr(&hs, it->as.const_decl.init);
+                h_const_value(&hs, it->as.const_decl.value);
+                sb_cstr(sb, "const ");
+                sb_slice(sb, it->as.const_decl.name);
+                if (!fps_push_sym(out, sb, hs.h)) return false;
+                break;
+
+            case EMP_ITEM_STRUCT:
+                // Export status decides whether fields may be reordered; hash the planned layout too.
+                h_u32(&hs, (uint32_t)it->as.struct_decl.is_exported);
+                h_u64(&hs, it->as.struct_decl.size);
+                h_u32(&hs, it->as.struct_decl.align);
+                h_u32(&hs, it->as.struct_decl.attr_align);
+                h_u32(&hs, (uint32_t)it->as.struct_decl.is_packed | (uint32_t)it->as.struct_decl.is_cacheline << 1 | (uint32_t)it->as.struct_decl.is_soa << 2);
+                for (size_t fi = 0; fi < it->as.struct_decl.fields.len; fi++) {
+                    const EmpStructField *f = (const EmpStructField *)it->as.struct_decl.fields.items[fi];
+                    if (!f) continue;
+                    h_slice(&hs, f->name);
+                    h_type(&hs, f->ty);
+                    h_u64(&hs, f->offset);
+                }
+                sb_cstr(sb, "struct ");
+                sb_slice(sb, it->as.struct_decl.name);
+                if (!fps_push_sym(out, sb, hs.h)) return false;
+                break;
+
+            case EMP_ITEM_ENUM: {
+                // Export status picks the canonical or the compact layout (emp_sem_plan_layouts).
+                const EmpItemEnum *en = &it->as.enum_decl;
+                h_u32(&hs, (uint32_t)en->is_exported);
+                h_u64(&hs, en->size);
+                h_u32(&hs, en->align);
+                h_u32(&hs, en->tag_size);
+                h_u32(&hs, en->payload_offset);
+                h_u32(&hs, en->niche_variant);
+                h_u32(&hs, en->niche_size);
+                h_u64(&hs, en->niche_offset);
+                h_u64(&hs, en->niche_start);
+                for (size_t vi = 0; vi < it->as.enum_decl.variants.len; vi++) {
+                    const EmpEnumVariant *v = (const EmpEnumVariant *)it->as.enum_decl.variants.items[vi];
+                    if (!v) continue;
+                    h_slice(&hs, v->name);
+                    h_u32(&hs, (uint32_t)v->fields.len);
+                    for (size_t fi = 0; fi < v->fields.len; fi++) {
+                        h_type(&hs, (const EmpType *)v->fields.items[fi]);
+                    }
+                }
+                sb_cstr(sb, "enum ");
+                sb_slice(sb, en->name);
+                if (!fps_push_sym(out, sb, hs.h)) return false;
+                break;
+            }
+
+            case EMP_ITEM_EMP_MM_OFF:
+                // Changes drop/borrow behavior of the module; record as a pseudo symbol.
+                if (!fps_push_unique(out, "@emp mm off", hs.h)) return false;
+                break;
+
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+bool emp_fingerprints_load(const char *path, EmpFingerprints *out) {
+    if (!path || !out) return false;
+    FILE *f = NULL;
+#ifdef _WIN32
+    if (fopen_s(&f, path, "rb") != 0) f = NULL;
+#else
+    f = fopen(path, "rb");
+#endif
+    if (!f) return false;
+
+    // Lines are read whole: symbols have no length limit.
+    EmpSymBuf lb;
+    memset(&lb, 0, sizeof(lb));
+    char chunk[256];
+    bool ok = true;
+    while (ok) {
+        sb_reset(&lb);
+        bool got = false;
+        while (fgets(chunk, sizeof(chunk), f)) {
+            got = true;
+            sb_cstr(&lb, chunk);
+            if (lb.len && lb.p[lb.len - 1] == '\n') break;
+        }
+        if (!got) break;
+        if (lb.oom) {
+            ok = false;
+            break;
+        }
+        char *line = lb.p;
+        size_t n = lb.len;
+        while (n && (line[n - 1] == '\n' || line[n - 1] == '\r')) line[--n] = '\0';
+        if (!n) continue;
+
+        char *sp = strchr(line, ' ');
+        if (!sp) {
+            ok = false;
+            break;
+        }
+        *sp = '\0';
+        char *end = NULL;
+        unsigned long long h = strtoull(line, &end, 16);
+        if (!end || *end != '\0') {
+            ok = false;
+            break;
+        }
+        if (!fps_push(out, sp + 1, (uint64_t)h)) {
+            ok = false;
+            break;
+        }
+    }
+    free(lb.p);
+    fclose(f);
+    return ok;
+}
+
+bool emp_fingerprints_save(const char *path, const EmpFingerprints *fps) {
+    if (!path || !fps) return false;
+    FILE *f = NULL;
+#ifdef _WIN32
+    if (fopen_s(&f, path, "wb") != 0) f = NULL;
+#else
+    f = fopen(path, "wb");
+#endif
+    if (!f) return false;
+    for (size_t i = 0; i < fps->len; i++) {
+        fprintf(f, "%016llx %s\n", (unsigned long long)fps->items[i].hash, fps->items[i].symbol);
+    }
+    return fclose(f) == 0;
+}
+
+size_t emp_fingerprints_diff(const EmpFingerprints *prev, const EmpFingerprints *cur) {
+    size_t changed = 0;
+    for (size_t i = 0; i < cur->len; i++) {
+        const EmpFingerprint *p = prev ? fps_find(prev, cur->items[i].symbol) : NULL;
+        if (!p || p->hash != cur->items[i].hash) changed++;
+    }
+    if (prev) {
+        for (size_t i = 0; i < prev->len; i++) {
+            if (!fps_find(cur, prev->items[i].symbol)) changed++;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Incremental codegen cache: stable content fingerprints per function/method.
+//
+// Each fingerprint covers:
+// - the checked AST of the body (kinds, literal text, resolved overload/dyn info; no spans)
+// - the signatures of the callees it resolves to
+// - a caller-provided `target_key` (target triple + opt level)
+//
+// Non-function items (struct/enum/class layouts, consts, traits) get fingerprints too,
+// since they change the code generated for their users.
+//
+// Manifests are small text files (`<hex hash> <symbol>` per line) stored next to the
+// object file of the previous build.
+typedef struct EmpFingerprint {
+    char *symbol; // heap-owned; e.g. `foo`, `foo#1` (overload), `Point.len`, `impl Show for Point.show`
+    uint64_t hash;
+} EmpFingerprint;
+
+typedef struct EmpFingerprints {
+    EmpFingerprint *items;
+    size_t len;
+    size_t cap;
+} EmpFingerprints;
+
+void emp_fingerprints_init(EmpFingerprints *fps);
+void emp_fingerprints_free(EmpFingerprints *fps);
+
+// Fingerprint every item of `program` (typically the merged, post-elimination program).
+bool emp_fingerprint_program(const EmpProgram *program, const char *target_key, EmpFingerprints *out);
+
+// Manifest I/O. `load` returns false when the file is missing or malformed.
+bool emp_fingerprints_load(const char *path, EmpFingerprints *out);
+bool emp_fingerprints_save(const char *path, const EmpFingerprints *fps);
+
+// Number of symbols whose fingerprint differs between `prev` and `cur` (changed, added or removed).
+size_t emp_fingerprints_diff(const EmpFingerprints *prev, const EmpFingerprints *cur);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,2093 @@
+#include "emp_consteval.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Calls deeper than this stop evaluation (runaway recursion).
+#define CE_MAX_DEPTH 256
+// Longest array a const may build.
+#define CE_MAX_ELEMS (1u << 20)
+
+typedef enum CeFlow {
+    CE_NEXT = 0,
+    CE_RETURN,
+    CE_BREAK,
+    CE_CONTINUE,
+    CE_FAIL,
+} CeFlow;
+
+typedef struct CeVar {
+    EmpSlice name;
+    EmpConstValue val;
+    const EmpType *ty; // declared type (NULL: take the value's)
+} CeVar;
+
+// Where names resolve: the items of `program`, then the import decls in `scope` (may be NULL).
+typedef struct CeScope {
+    const EmpProgram *program;
+    const EmpVec *scope;
+} CeScope;
+
+typedef struct CeCtx {
+    EmpArena *arena;
+    EmpDiags *diags;
+    CeScope names;
+
+    CeVar *vars;
+    size_t vars_len;
+    size_t vars_cap;
+    size_t frame; // first var of the running call
+
+    size_t steps;
+    int depth;
+    bool failed; // a diagnostic was reported; everything unwinds
+    EmpConstValue ret;
+
+    EmpVec busy; // EmpItemConst* being evaluated (cycle detection)
+    EmpVec bad;  // EmpItemConst* whose evaluation already failed (reported once)
+} CeCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static bool slice_is(EmpSlice s, const char *lit) {
+    size_t n = strlen(lit);
+    return s.len == n && s.ptr && memcmp(s.ptr, lit, n) == 0;
+}
+
+static char *arena_strdup(EmpArena *a, const char *s) {
+    size_t n = strlen(s);
+    char *p = (char *)emp_arena_alloc(a, n + 1, 1);
+    if (!p) return NULL;
+    memcpy(p, s, n + 1);
+    return p;
+}
+
+static void diagf(EmpArena *arena, EmpDiags *diags, EmpSpan span, const char *fmt, EmpSlice name) {
+    if (!diags) return;
+    char name_buf[128];
+    size_t n = 0;
+    if (name.ptr && name.len) {
+        n = name.len < sizeof(name_buf) - 1 ? name.len : sizeof(name_buf) - 1;
+        memcpy(name_buf, name.ptr, n);
+    }
+    name_buf[n] = '\0';
+
+    char msg[256];
+    snprintf(msg, sizeof(msg), fmt, name_buf);
+
+    EmpDiag d;
+    d.span = span;
+    d.message = arena_strdup(arena, msg);
+    (void)emp_diags_push(diags, d);
+}
+
+// Reports the first failure of an evaluation; later ones are consequences of it.
+static void ce_fail(CeCtx *c, EmpSpan span, const char *fmt, EmpSlice name) {
+    if (c->failed) return;
+    c->failed = true;
+    diagf(c->arena, c->diags, span, fmt, name);
+}
+
+static const EmpExpr *strip_group(const EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+// ===== Types =====
+
+static bool type_is_name(const EmpType *t, const char *name) {
+    return t && t->kind == EMP_TYPE_NAME && slice_is(t->as.name, name);
+}
+
+// Integer type names: width in bits (0 when `name` is not an integer type).
+static int int_name_bits(EmpSlice n, bool *out_unsigned) {
+    static const struct {
+        const char *name;
+        int bits;
+        bool is_unsigned;
+    } ints[] = {
+        {"i8", 8, false},     {"i16", 16, false},   {"i32", 32, false},   {"i64", 64, false},
+        {"int8", 8, false},   {"int16", 16, false}, {"int32", 32, false}, {"int64", 64, false},
+        {"int", 32, false},   {"isize", 64, false}, {"u8", 8, true},      {"u16", 16, true},
+        {"u32", 32, true},    {"u64", 64, true},    {"uint8", 8, true},   {"uint16", 16, true},
+        {"uint32", 32, true}, {"uint64", 64, true}, {"usize", 64, true},
+    };
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        if (slice_is(n, ints[i].name)) {
+            if (out_unsigned) *out_unsigned = ints[i].is_unsigned;
+            return ints[i].bits;
+        }
+    }
+    return 0;
+}
+
+static int float_name_bits(EmpSlice n) {
+    if (slice_is(n, "f32") || slice_is(n, "float")) return 32;
+    if (slice_is(n, "f64") || slice_is(n, "double")) return 64;
+    return 0;
+}
+
+static bool type_is_cstr(const EmpType *t) {
+    return t && t->kind == EMP_TYPE_PTR && type_is_name(t->as.ptr.pointee, "u8");
+}
+
+// Element count of `T[N]` once N is digits.
+static bool array_size(const EmpType *t, uint64_t *out) {
+    if (!t || t->kind != EMP_TYPE_ARRAY || !t->as.array.size_text.len) return false;
+    uint64_t v = 0;
+    for (size_t i = 0; i < t->as.array.size_text.len; i++) {
+        char ch = t->as.array.size_text.ptr[i];
+        if (ch == '_') continue;
+        if (ch < '0' || ch > '9') return false;
+        v = v * 10u + (uint64_t)(ch - '0');
+    }
+    *out = v;
+    return true;
+}
+
+// ===== Values =====
+
+static uint64_t wrap_int(uint64_t v, int bits, bool is_unsigned) {
+    if (bits <= 0 || bits >= 64) return v;
+    uint64_t mask = (1ull << bits) - 1u;
+    v &= mask;
+    if (!is_unsigned && (v >> (bits - 1)) & 1u) v |= ~mask;
+    return v;
+}
+
+static EmpConstValue v_int(uint64_t i, int bits, bool is_unsigned) {
+    EmpConstValue v;
+    memset(&v, 0, sizeof(v));
+    v.kind = EMP_CONST_INT;
+    v.bits = (uint8_t)bits;
+    v.is_unsigned = is_unsigned;
+    v.as.i = wrap_int(i, bits, is_unsigned);
+    return v;
+}
+
+// `i` as a value of integer type `name` (int_name_bits(name) != 0).
+static EmpConstValue v_int_named(uint64_t i, EmpSlice name) {
+    bool is_unsigned = false;
+    int bits = int_name_bits(name, &is_unsigned);
+    EmpConstValue v = v_int(i, bits, is_unsigned);
+    v.is_usize = slice_is(name, "usize");
+    return v;
+}
+
+// `i` as a value of the same integer type as `t`.
+static EmpConstValue v_int_like(uint64_t i, const EmpConstValue *t) {
+    EmpConstValue v = v_int(i, t->bits, t->is_unsigned);
+    v.is_usize = t->is_usize;
+    return v;
+}
+
+static EmpConstValue v_float(double f, int bits) {
+    EmpConstValue v;
+    memset(&v, 0, sizeof(v));
+    v.kind = EMP_CONST_FLOAT;
+    v.bits = (uint8_t)bits;
+    v.as.f = bits == 32 ? (double)(float)f : f;
+    return v;
+}
+
+static EmpConstValue v_bool(bool b) {
+    EmpConstValue v;
+    memset(&v, 0, sizeof(v));
+    v.kind = EMP_CONST_BOOL;
+    v.as.b = b;
+    return v;
+}
+
+static EmpConstValue v_none(void) {
+    EmpConstValue v;
+    memset(&v, 0, sizeof(v));
+    return v;
+}
+
+static bool v_agg(CeCtx *c, EmpConstValue *v, EmpConstKind kind, size_t len) {
+    memset(v, 0, sizeof(*v));
+    v->kind = kind;
+    v->as.agg.len = len;
+    if (!len) return true;
+    v->as.agg.items = (EmpConstValue **)emp_arena_alloc(c->arena, len * sizeof(EmpConstValue *), sizeof(void *));
+    if (!v->as.agg.items) return false;
+    for (size_t i = 0; i < len; i++) {
+        v->as.agg.items[i] = (EmpConstValue *)emp_arena_alloc(c->arena, sizeof(EmpConstValue), sizeof(void *));
+        if (!v->as.agg.items[i]) return false;
+        memset(v->as.agg.items[i], 0, sizeof(EmpConstValue));
+    }
+    return true;
+}
+
+// Aggregates are values: every binding gets its own copy, so writes through one never show
+// through another.
+static EmpConstValue v_copy(CeCtx *c, EmpConstValue v) {
+    if (v.kind != EMP_CONST_TUPLE && v.kind != EMP_CONST_ARRAY) return v;
+    EmpConstValue out;
+    if (!v_agg(c, &out, v.kind, v.as.agg.len)) {
+        ce_fail(c, (EmpSpan){0}, "const: out of memory%s", (EmpSlice){0});
+        return v_none();
+    }
+    out.as.agg.ty = v.as.agg.ty;
+    for (size_t i = 0; i < v.as.agg.len; i++) *out.as.agg.items[i] = v_copy(c, *v.as.agg.items[i]);
+    return out;
+}
+
+static bool v_is_int(const EmpConstValue *v) {
+    return v->kind == EMP_CONST_INT;
+}
+
+static int64_t v_signed(const EmpConstValue *v) {
+    return (int64_t)v->as.i;
+}
+
+// Numeric value of an INT as a double, honoring its signedness.
+static double v_int_to_double(const EmpConstValue *v) {
+    return v->is_unsigned ? (double)v->as.i : (double)(int64_t)v->as.i;
+}
+
+// Converts `v` to `ty` the way an implicit conversion at a binding, argument or return does:
+// integers wrap to the width of the type, untyped literals become floats, aggregates convert
+// element by element. Other types cannot hold a compile-time value.
+static bool v_convert(CeCtx *c, EmpConstValue *v, const EmpType *ty, EmpSpan span) {
+    if (!ty || ty->kind == EMP_TYPE_AUTO || v->kind == 0) return true;
+    switch (ty->kind) {
+        case EMP_TYPE_NAME: {
+            bool is_unsigned = false;
+            int bits = int_name_bits(ty->as.name, &is_unsigned);
+            if (bits) {
+                if (v->kind == EMP_CONST_INT) {
+                    *v = v_int_named(v->as.i, ty->as.name);
+                    return true;
+                }
+                break;
+            }
+            int fbits = float_name_bits(ty->as.name);
+            if (fbits) {
+                if (v->kind == EMP_CONST_FLOAT) {
+                    *v = v_float(v->as.f, fbits);
+                    return true;
+                }
+                if (v->kind == EMP_CONST_INT) {
+                    *v = v_float(v_int_to_double(v), fbits);
+                    return true;
+                }
+                break;
+            }
+            if (slice_is(ty->as.name, "bool") && v->kind == EMP_CONST_BOOL) return true;
+            if (slice_is(ty->as.name, "char") && v->kind == EMP_CONST_CHAR) return true;
+            if (slice_is(ty->as.name, "string")) {
+                ce_fail(c, span, "const: a `string` owns heap memory and cannot be computed at compile time (use `*u8`)%s", (EmpSlice){0});
+                return false;
+            }
+            if (!slice_is(ty->as.name, "bool") && !slice_is(ty->as.name, "char")) {
+                ce_fail(c, span, "const: values of type `%s` cannot be computed at compile time", ty->as.name);
+                return false;
+            }
+            break;
+        }
+        case EMP_TYPE_PTR:
+            if (type_is_cstr(ty) && v->kind == EMP_CONST_STRING) return true;
+            ce_fail(c, span, "const: pointers cannot be computed at compile time (only `*u8` string literals)%s", (EmpSlice){0});
+            return false;
+        case EMP_TYPE_ARRAY: {
+            uint64_t n = 0;
+            if (v->kind != EMP_CONST_ARRAY) break;
+            if (array_size(ty, &n) && n != v->as.agg.len) {
+                ce_fail(c, span, "const: array length does not match its type%s", (EmpSlice){0});
+                return false;
+            }
+            for (size_t i = 0; i < v->as.agg.len; i++) {
+                if (!v_convert(c, v->as.agg.items[i], ty->as.array.elem, span)) return false;
+            }
+            return true;
+        }
+        case EMP_TYPE_TUPLE:
+            if (v->kind != EMP_CONST_TUPLE || v->as.agg.len != ty->as.tuple.fields.len) break;
+            for (size_t i = 0; i < v->as.agg.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)ty->as.tuple.fields.items[i];
+                if (f && !v_convert(c, v->as.agg.items[i], f->ty, span)) return false;
+            }
+            v->as.agg.ty = ty;
+            return true;
+        case EMP_TYPE_LIST:
+            ce_fail(c, span, "const: lists live on the heap and cannot be computed at compile time (use an array `T[N]`)%s", (EmpSlice){0});
+            return false;
+        default:
+            ce_fail(c, span, "const: values of this type cannot be computed at compile time%s", (EmpSlice){0});
+            return false;
+    }
+    ce_fail(c, span, "const: value does not match its type%s", (EmpSlice){0});
+    return false;
+}
+
+// `let x: T;` starts from zero, like a zero-initialized local.
+static bool v_zero(CeCtx *c, EmpConstValue *out, const EmpType *ty, EmpSpan span) {
+    *out = v_none();
+    if (!ty) {
+        ce_fail(c, span, "const: a binding without initializer needs a type%s", (EmpSlice){0});
+        return false;
+    }
+    if (ty->kind == EMP_TYPE_NAME) {
+        bool is_unsigned = false;
+        int bits = int_name_bits(ty->as.name, &is_unsigned);
+        if (bits) {
+            *out = v_int_named(0, ty->as.name);
+            return true;
+        }
+        int fbits = float_name_bits(ty->as.name);
+        if (fbits) {
+            *out = v_float(0.0, fbits);
+            return true;
+        }
+        if (slice_is(ty->as.name, "bool")) {
+            *out = v_bool(false);
+            return true;
+        }
+        if (slice_is(ty->as.name, "char")) {
+            out->kind = EMP_CONST_CHAR;
+            return true;
+        }
+    } else if (ty->kind == EMP_TYPE_ARRAY) {
+        uint64_t n = 0;
+        if (array_size(ty, &n)) {
+            if (n > CE_MAX_ELEMS) {
+                ce_fail(c, span, "const: array is too large to build at compile time%s", (EmpSlice){0});
+                return false;
+            }
+            if (!v_agg(c, out, EMP_CONST_ARRAY, (size_t)n)) return false;
+            for (size_t i = 0; i < (size_t)n; i++) {
+                if (!v_zero(c, out->as.agg.items[i], ty->as.array.elem, span)) return false;
+            }
+            return true;
+        }
+    } else if (ty->kind == EMP_TYPE_TUPLE) {
+        if (!v_agg(c, out, EMP_CONST_TUPLE, ty->as.tuple.fields.len)) return false;
+        out->as.agg.ty = ty;
+        for (size_t i = 0; i < ty->as.tuple.fields.len; i++) {
+            const EmpTupleField *f = (const EmpTupleField *)ty->as.tuple.fields.items[i];
+            if (!v_zero(c, out->as.agg.items[i], f ? f->ty : NULL, span)) return false;
+        }
+        return true;
+    }
+    ce_fail(c, span, "const: a binding of this type needs an initializer at compile time%s", (EmpSlice){0});
+    return false;
+}
+
+static bool v_equal(const EmpConstValue *a, const EmpConstValue *b) {
+    if (a->kind != b->kind) return false;
+    switch (a->kind) {
+        case EMP_CONST_INT: return a->as.i == b->as.i;
+        case EMP_CONST_FLOAT: return a->as.f == b->as.f;
+        case EMP_CONST_BOOL: return a->as.b == b->as.b;
+        case EMP_CONST_CHAR: return a->as.ch == b->as.ch;
+        case EMP_CONST_STRING:
+            return a->as.str.len == b->as.str.len && (a->as.str.len == 0 || memcmp(a->as.str.ptr, b->as.str.ptr, a->as.str.len) == 0);
+        case EMP_CONST_TUPLE:
+        case EMP_CONST_ARRAY:
+            if (a->as.agg.len != b->as.agg.len) return false;
+            for (size_t i = 0; i < a->as.agg.len; i++) {
+                if (!v_equal(a->as.agg.items[i], b->as.agg.items[i])) return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+// ===== Literals =====
+
+static bool lit_int(EmpSlice lit, EmpConstValue *out) {
+    const char *p = lit.ptr;
+    size_t n = lit.len;
+    size_t i = 0;
+    unsigned base = 10;
+    if (!p || !n) return false;
+    if (n >= 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        base = 16;
+        i = 2;
+    } else if (n >= 2 && p[0] == '0' && (p[1] == 'b' || p[1] == 'B')) {
+        base = 2;
+        i = 2;
+    } else if (n >= 2 && p[0] == '0' && (p[1] == 'o' || p[1] == 'O')) {
+        base = 8;
+        i = 2;
+    }
+
+    uint64_t v = 0;
+    bool saw_digit = false;
+    for (; i < n; i++) {
+        char ch = p[i];
+        unsigned d;
+        if (ch == '_') continue;
+        if (ch >= '0' && ch <= '9') d = (unsigned)(ch - '0');
+        else if (ch >= 'a' && ch <= 'f') d = (unsigned)(ch - 'a' + 10);
+        else if (ch >= 'A' && ch <= 'F') d = (unsigned)(ch - 'A' + 10);
+        else break;
+        if (d >= base) break;
+        if (v > (UINT64_MAX - d) / base) return false;
+        v = v * base + d;
+        saw_digit = true;
+    }
+    if (!saw_digit) return false;
+
+    // Optional type suffix (`255u8`, `1i64`).
+    int bits = 0;
+    bool is_unsigned = false;
+    if (i < n) {
+        EmpSlice suffix = {p + i, n - i};
+        bits = int_name_bits(suffix, &is_unsigned);
+        if (!bits) return false;
+        *out = v_int_named(v, suffix);
+        return true;
+    }
+    *out = v_int(v, 0, false);
+    return true;
+}
+
+static bool lit_float(EmpSlice lit, EmpConstValue *out) {
+    char buf[128];
+    size_t n = 0;
+    for (size_t i = 0; i < lit.len && n + 1 < sizeof(buf); i++) {
+        if (lit.ptr[i] != '_') buf[n++] = lit.ptr[i];
+    }
+    buf[n] = '\0';
+    char *end = NULL;
+    double f = strtod(buf, &end);
+    if (end == buf) return false;
+    int bits = 0;
+    if (*end) {
+        bits = float_name_bits((EmpSlice){end, strlen(end)});
+        if (!bits) return false;
+    }
+    *out = v_float(f, bits);
+    return true;
+}
+
+static int hex_digit(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+static size_t utf8_encode(uint32_t cp, char *out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Decodes the escapes the lexer accepts (`\\ \" \' \n \r \t \0 \xHH \u{H..}`) in the text
+// between the quotes of a string or char literal. `out` holds at least `lit.len` bytes.
+static size_t lit_decode(EmpSlice lit, char *out) {
+    size_t n = 0;
+    if (lit.len < 2) return 0;
+    const char *p = lit.ptr + 1;
+    const char *end = lit.ptr + lit.len - 1;
+    while (p < end) {
+        if (*p != '\\' || p + 1 >= end) {
+            out[n++] = *p++;
+            continue;
+        }
+        p++;
+        char esc = *p++;
+        switch (esc) {
+            case 'n': out[n++] = '\n'; break;
+            case 'r': out[n++] = '\r'; break;
+            case 't': out[n++] = '\t'; break;
+            case '0': out[n++] = '\0'; break;
+            case 'x':
+                if (p + 1 < end && hex_digit(p[0]) >= 0 && hex_digit(p[1]) >= 0) {
+                    out[n++] = (char)(hex_digit(p[0]) * 16 + hex_digit(p[1]));
+                    p += 2;
+                }
+                break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (p < end && *p == '{') p++;
+                while (p < end && *p != '}') cp = cp * 16u + (uint32_t)(hex_digit(*p++) & 0xF);
+                if (p < end) p++;
+                n += utf8_encode(cp, out + n);
+                break;
+            }
+            default: out[n++] = esc; break;
+        }
+    }
+    return n;
+}
+
+static bool lit_string(CeCtx *c, EmpSlice lit, EmpConstValue *out) {
+    char *buf = (char *)emp_arena_alloc(c->arena, lit.len + 1, 1);
+    if (!buf) return false;
+    size_t n = lit_decode(lit, buf);
+    buf[n] = '\0';
+    *out = v_none();
+    out->kind = EMP_CONST_STRING;
+    out->as.str.ptr = buf;
+    out->as.str.len = n;
+    return true;
+}
+
+static bool lit_char(EmpSlice lit, EmpConstValue *out) {
+    char buf[16];
+    if (lit.len < 3 || lit.len > sizeof(buf)) return false;
+    size_t n = lit_decode(lit, buf);
+    if (!n) return false;
+    const unsigned char *u = (const unsigned char *)buf;
+    uint32_t cp = u[0];
+    if (u[0] >= 0xF0 && n >= 4) cp = (uint32_t)(u[0] & 0x07) << 18 | (uint32_t)(u[1] & 0x3F) << 12 | (uint32_t)(u[2] & 0x3F) << 6 | (uint32_t)(u[3] & 0x3F);
+    else if (u[0] >= 0xE0 && n >= 3) cp = (uint32_t)(u[0] & 0x0F) << 12 | (uint32_t)(u[1] & 0x3F) << 6 | (uint32_t)(u[2] & 0x3F);
+    else if (u[0] >= 0xC0 && n >= 2) cp = (uint32_t)(u[0] & 0x1F) << 6 | (uint32_t)(u[1] & 0x3F);
+    *out = v_none();
+    out->kind = EMP_CONST_CHAR;
+    out->as.ch = cp;
+    return true;
+}
+
+// ===== Names =====
+
+static EmpItem *scope_item(const CeScope *s, size_t i) {
+    size_t own = s->program ? s->program->items.len : 0;
+    if (i < own) return (EmpItem *)s->program->items.items[i];
+    return s->scope ? (EmpItem *)s->scope->items[i - own] : NULL;
+}
+
+static size_t scope_len(const CeScope *s) {
+    return (s->program ? s->program->items.len : 0) + (s->scope ? s->scope->len : 0);
+}
+
+static EmpItemConst *find_const(const CeScope *s, EmpSlice name) {
+    for (size_t i = 0; i < scope_len(s); i++) {
+        EmpItem *it = scope_item(s, i);
+        if (it && it->kind == EMP_ITEM_CONST && slice_eq(it->as.const_decl.name, name)) return &it->as.const_decl;
+    }
+    return NULL;
+}
+
+static bool value_fits_param(const EmpConstValue *v, const EmpType *ty) {
+    if (!ty || ty->kind == EMP_TYPE_AUTO) return true;
+    switch (v->kind) {
+        case EMP_CONST_INT:
+            return ty->kind == EMP_TYPE_NAME && (int_name_bits(ty->as.name, NULL) || (v->bits == 0 && float_name_bits(ty->as.name)));
+        case EMP_CONST_FLOAT: return ty->kind == EMP_TYPE_NAME && float_name_bits(ty->as.name);
+        case EMP_CONST_BOOL: return type_is_name(ty, "bool");
+        case EMP_CONST_CHAR: return type_is_name(ty, "char");
+        case EMP_CONST_STRING: return type_is_cstr(ty);
+        case EMP_CONST_TUPLE: return ty->kind == EMP_TYPE_TUPLE && ty->as.tuple.fields.len == v->as.agg.len;
+        case EMP_CONST_ARRAY: return ty->kind == EMP_TYPE_ARRAY;
+    }
+    return false;
+}
+
+// The fn a call runs: by name and arity; among overloads, the first whose parameter types
+// accept the argument values.
+static EmpItemFn *find_fn(const CeScope *s, EmpSlice name, const EmpConstValue *args, size_t argc, bool *out_found_name) {
+    EmpItemFn *first = NULL;
+    *out_found_name = false;
+    for (size_t i = 0; i < scope_len(s); i++) {
+        EmpItem *it = scope_item(s, i);
+        if (!it || it->kind != EMP_ITEM_FN || !slice_eq(it->as.fn.name, name)) continue;
+        *out_found_name = true;
+        if (it->as.fn.params.len != argc || it->as.fn.type_params.len) continue;
+        bool fits = true;
+        for (size_t j = 0; j < argc && fits; j++) {
+            const EmpParam *p = (const EmpParam *)it->as.fn.params.items[j];
+            fits = p && value_fits_param(&args[j], p->ty);
+        }
+        if (fits) return &it->as.fn;
+        if (!first) first = &it->as.fn;
+    }
+    return first;
+}
+
+// ===== Interpreter =====
+
+static bool ce_step(CeCtx *c, EmpSpan span) {
+    if (c->failed) return false;
+    if (++c->steps > EMP_CONST_MAX_STEPS) {
+        ce_fail(c, span, "const: evaluation takes more than 10000000 steps (does a loop not terminate?)%s", (EmpSlice){0});
+        return false;
+    }
+    return true;
+}
+
+static bool var_push(CeCtx *c, EmpSlice name, EmpConstValue v, const EmpType *ty) {
+    if (c->vars_len == c->vars_cap) {
+        size_t cap = c->vars_cap ? c->vars_cap * 2 : 16;
+        CeVar *grown = (CeVar *)realloc(c->vars, cap * sizeof(CeVar));
+        if (!grown) return false;
+        c->vars = grown;
+        c->vars_cap = cap;
+    }
+    c->vars[c->vars_len].name = name;
+    c->vars[c->vars_len].val = v;
+    c->vars[c->vars_len].ty = ty;
+    c->vars_len++;
+    return true;
+}
+
+static CeVar *var_find(CeCtx *c, EmpSlice name) {
+    for (size_t i = c->vars_len; i > c->frame; i--) {
+        if (slice_eq(c->vars[i - 1].name, name)) return &c->vars[i - 1];
+    }
+    return NULL;
+}
+
+static bool ce_expr(CeCtx *c, const EmpExpr *e, EmpConstValue *out);
+static CeFlow ce_stmt(CeCtx *c, const EmpStmt *s);
+static const EmpConstValue *ce_const_item(CeCtx *c, EmpItemConst *k, EmpSpan use_span);
+
+// Place for an assignment: a local, or an element/field path below one.
+static EmpConstValue *ce_place(CeCtx *c, const EmpExpr *e) {
+    e = strip_group(e);
+    if (!e) return NULL;
+    if (e->kind == EMP_EXPR_IDENT) {
+        CeVar *v = var_find(c, e->as.lit);
+        if (!v) {
+            if (find_const(&c->names, e->as.lit)) ce_fail(c, e->span, "const: cannot assign to const `%s`", e->as.lit);
+            else ce_fail(c, e->span, "const: `%s` is not a local of this evaluation", e->as.lit);
+            return NULL;
+        }
+        return &v->val;
+    }
+    if (e->kind == EMP_EXPR_INDEX) {
+        EmpConstValue *base = ce_place(c, e->as.index.base);
+        if (!base) return NULL;
+        EmpConstValue idx;
+        if (!ce_expr(c, e->as.index.index, &idx)) return NULL;
+        if ((base->kind != EMP_CONST_ARRAY && base->kind != EMP_CONST_TUPLE) || !v_is_int(&idx)) {
+            ce_fail(c, e->span, "const: only arrays and tuples can be indexed at compile time%s", (EmpSlice){0});
+            return NULL;
+        }
+        if ((!idx.is_unsigned && v_signed(&idx) < 0) || idx.as.i >= base->as.agg.len) {
+            ce_fail(c, e->span, "const: index out of bounds%s", (EmpSlice){0});
+            return NULL;
+        }
+        return base->as.agg.items[idx.as.i];
+    }
+    if (e->kind == EMP_EXPR_MEMBER) {
+        EmpConstValue *base = ce_place(c, e->as.member.base);
+        if (!base) return NULL;
+        if (base->kind == EMP_CONST_TUPLE && base->as.agg.ty) {
+            for (size_t i = 0; i < base->as.agg.ty->as.tuple.fields.len && i < base->as.agg.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)base->as.agg.ty->as.tuple.fields.items[i];
+                if (f && f->name.len && slice_eq(f->name, e->as.member.member)) return base->as.agg.items[i];
+            }
+        }
+        ce_fail(c, e->span, "const: unknown field `%s`", e->as.member.member);
+        return NULL;
+    }
+    ce_fail(c, e->span, "const: cannot assign to this expression at compile time%s", (EmpSlice){0});
+    return NULL;
+}
+
+// Type of integer arithmetic (a zero of it), by the rule typecheck's tc_binary_numeric uses:
+// i32, except that under --len64 a usize operand makes it usize. Compile-time results must
+// match what the same expression computes at run time.
+static EmpConstValue int_result_type(const EmpConstValue *a, const EmpConstValue *b) {
+    if (emp_len_abi() == EMP_LEN_ABI_64 && (a->is_usize || b->is_usize)) return a->is_usize ? v_int_like(0, a) : v_int_like(0, b);
+    return v_int(0, 32, false);
+}
+
+// Type of a range-for index (a zero of it), as typecheck picks it: the typed bound, the wider
+// one if both are typed (the end on ties); i32 for literal-only ranges.
+static EmpConstValue range_index_type(const EmpConstValue *lo, const EmpConstValue *hi) {
+    if (hi->bits && hi->bits >= lo->bits) return v_int_like(0, hi);
+    if (lo->bits) return v_int_like(0, lo);
+    return v_int(0, 32, false);
+}
+
+static bool ce_binop(CeCtx *c, EmpBinOp op, EmpConstValue a, EmpConstValue b, EmpSpan span, EmpConstValue *out) {
+    // An untyped integer literal next to a float is a float.
+    if (a.kind == EMP_CONST_INT && b.kind == EMP_CONST_FLOAT && a.bits == 0) a = v_float(v_int_to_double(&a), b.bits);
+    if (b.kind == EMP_CONST_INT && a.kind == EMP_CONST_FLOAT && b.bits == 0) b = v_float(v_int_to_double(&b), a.bits);
+
+    if (op == EMP_BIN_EQ || op == EMP_BIN_NE) {
+        if (a.kind != b.kind) {
+            ce_fail(c, span, "const: comparison of different kinds of values%s", (EmpSlice){0});
+            return false;
+        }
+        bool eq = v_equal(&a, &b);
+        *out = v_bool(op == EMP_BIN_EQ ? eq : !eq);
+        return true;
+    }
+
+    if (a.kind == EMP_CONST_INT && b.kind == EMP_CONST_INT) {
+        // Comparisons look at the operands as they are (the typed one's signedness); arithmetic
+        // converts both to the result type first.
+        const EmpConstValue *typed = a.bits ? &a : &b;
+        bool cmp_uns = typed->is_unsigned;
+        uint64_t cx = a.as.i, cy = b.as.i;
+        int64_t scx = (int64_t)cx, scy = (int64_t)cy;
+        switch (op) {
+            case EMP_BIN_LT: *out = v_bool(cmp_uns ? cx < cy : scx < scy); return true;
+            case EMP_BIN_LE: *out = v_bool(cmp_uns ? cx <= cy : scx <= scy); return true;
+            case EMP_BIN_GT: *out = v_bool(cmp_uns ? cx > cy : scx > scy); return true;
+            case EMP_BIN_GE: *out = v_bool(cmp_uns ? cx >= cy : scx >= scy); return true;
+            default: break;
+        }
+
+        EmpConstValue rt = int_result_type(&a, &b);
+        bool uns = rt.is_unsigned;
+        int width = rt.bits;
+        uint64_t x = v_int_like(a.as.i, &rt).as.i, y = v_int_like(b.as.i, &rt).as.i;
+        int64_t sx = (int64_t)x, sy = (int64_t)y;
+        switch (op) {
+            case EMP_BIN_ADD: *out = v_int_like(x + y, &rt); return true;
+            case EMP_BIN_SUB: *out = v_int_like(x - y, &rt); return true;
+            case EMP_BIN_MUL: *out = v_int_like(x * y, &rt); return true;
+            case EMP_BIN_DIV:
+            case EMP_BIN_REM:
+                if (y == 0) {
+                    ce_fail(c, span, "const: division by zero%s", (EmpSlice){0});
+                    return false;
+                }
+                if (uns) *out = v_int_like(op == EMP_BIN_DIV ? x / y : x % y, &rt);
+                else if (sy == -1) *out = v_int_like(op == EMP_BIN_DIV ? 0 - x : 0, &rt); // MIN / -1 wraps
+                else *out = v_int_like((uint64_t)(op == EMP_BIN_DIV ? sx / sy : sx % sy), &rt);
+                return true;
+            case EMP_BIN_BITAND: *out = v_int_like(x & y, &rt); return true;
+            case EMP_BIN_BITOR: *out = v_int_like(x | y, &rt); return true;
+            case EMP_BIN_BITXOR: *out = v_int_like(x ^ y, &rt); return true;
+            case EMP_BIN_SHL:
+            case EMP_BIN_SHR:
+                if ((!b.is_unsigned && scy < 0) || cy >= (uint64_t)width) {
+                    ce_fail(c, span, "const: shift amount out of range%s", (EmpSlice){0});
+                    return false;
+                }
+                if (op == EMP_BIN_SHL) *out = v_int_like(x << cy, &rt);
+                else if (uns) *out = v_int_like(wrap_int(x, width, true) >> cy, &rt);
+                else *out = v_int_like((uint64_t)(sx >> cy), &rt);
+                return true;
+            default: break;
+        }
+    } else if (a.kind == EMP_CONST_FLOAT && b.kind == EMP_CONST_FLOAT) {
+        // Like typecheck: float arithmetic is f64.
+        int bits = 64;
+        double x = a.as.f, y = b.as.f;
+        switch (op) {
+            case EMP_BIN_ADD: *out = v_float(x + y, bits); return true;
+            case EMP_BIN_SUB: *out = v_float(x - y, bits); return true;
+            case EMP_BIN_MUL: *out = v_float(x * y, bits); return true;
+            case EMP_BIN_DIV: *out = v_float(x / y, bits); return true;
+            case EMP_BIN_REM: *out = v_float(fmod(x, y), bits); return true;
+            case EMP_BIN_LT: *out = v_bool(x < y); return true;
+            case EMP_BIN_LE: *out = v_bool(x <= y); return true;
+            case EMP_BIN_GT: *out = v_bool(x > y); return true;
+            case EMP_BIN_GE: *out = v_bool(x >= y); return true;
+            default: break;
+        }
+    } else if (a.kind == EMP_CONST_BOOL && b.kind == EMP_CONST_BOOL) {
+        switch (op) {
+            case EMP_BIN_AND:
+            case EMP_BIN_BITAND: *out = v_bool(a.as.b && b.as.b); return true;
+            case EMP_BIN_OR:
+            case EMP_BIN_BITOR: *out = v_bool(a.as.b || b.as.b); return true;
+            case EMP_BIN_BITXOR: *out = v_bool(a.as.b != b.as.b); return true;
+            default: break;
+        }
+    } else if (a.kind == EMP_CONST_CHAR && b.kind == EMP_CONST_CHAR) {
+        switch (op) {
+            case EMP_BIN_LT: *out = v_bool(a.as.ch < b.as.ch); return true;
+            case EMP_BIN_LE: *out = v_bool(a.as.ch <= b.as.ch); return true;
+            case EMP_BIN_GT: *out = v_bool(a.as.ch > b.as.ch); return true;
+            case EMP_BIN_GE: *out = v_bool(a.as.ch >= b.as.ch); return true;
+            default: break;
+        }
+    }
+    ce_fail(c, span, "const: operator not supported on these values at compile time%s", (EmpSlice){0});
+    return false;
+}
+
+static EmpBinOp assign_base_op(EmpBinOp op) {
+    switch (op) {
+        case EMP_BIN_ADD_ASSIGN: return EMP_BIN_ADD;
+        case EMP_BIN_SUB_ASSIGN: return EMP_BIN_SUB;
+        case EMP_BIN_MUL_ASSIGN: return EMP_BIN_MUL;
+        case EMP_BIN_DIV_ASSIGN: return EMP_BIN_DIV;
+        case EMP_BIN_REM_ASSIGN: return EMP_BIN_REM;
+        case EMP_BIN_SHL_ASSIGN: return EMP_BIN_SHL;
+        case EMP_BIN_SHR_ASSIGN: return EMP_BIN_SHR;
+        case EMP_BIN_BITAND_ASSIGN: return EMP_BIN_BITAND;
+        case EMP_BIN_BITOR_ASSIGN: return EMP_BIN_BITOR;
+        case EMP_BIN_BITXOR_ASSIGN: return EMP_BIN_BITXOR;
+        default: return EMP_BIN_ASSIGN;
+    }
+}
+
+static bool ce_cast(CeCtx *c, EmpConstValue v, const EmpType *ty, EmpSpan span, EmpConstValue *out) {
+    if (ty && ty->kind == EMP_TYPE_NAME) {
+        bool uns = false;
+        int bits = int_name_bits(ty->as.name, &uns);
+        if (bits) {
+            if (v.kind == EMP_CONST_INT) {
+                *out = v_int_named(v.as.i, ty->as.name);
+                return true;
+            }
+            if (v.kind == EMP_CONST_BOOL || v.kind == EMP_CONST_CHAR) {
+                *out = v_int_named(v.kind == EMP_CONST_BOOL ? (uint64_t)v.as.b : (uint64_t)v.as.ch, ty->as.name);
+                return true;
+            }
+            if (v.kind == EMP_CONST_FLOAT) {
+                double f = trunc(v.as.f);
+                double lo = uns ? 0.0 : -ldexp(1.0, bits - 1);
+                double hi = uns ? ldexp(1.0, bits) : ldexp(1.0, bits - 1);
+                if (!(f >= lo && f < hi)) {
+                    ce_fail(c, span, "const: float value out of range of the integer type%s", (EmpSlice){0});
+                    return false;
+                }
+                *out = v_int_named(uns ? (uint64_t)f : (uint64_t)(int64_t)f, ty->as.name);
+                return true;
+            }
+        }
+        int fbits = float_name_bits(ty->as.name);
+        if (fbits && (v.kind == EMP_CONST_FLOAT || v.kind == EMP_CONST_INT)) {
+            *out = v_float(v.kind == EMP_CONST_INT ? v_int_to_double(&v) : v.as.f, fbits);
+            return true;
+        }
+        if (slice_is(ty->as.name, "char") && v.kind == EMP_CONST_INT) {
+            *out = v_none();
+            out->kind = EMP_CONST_CHAR;
+            out->as.ch = (uint32_t)v.as.i;
+            return true;
+        }
+    }
+    *out = v;
+    return v_convert(c, out, ty, span);
+}
+
+static bool ce_call_fn(CeCtx *c, const EmpItemFn *fn, const CeScope *names, EmpConstValue *args, size_t argc, EmpSpan span, EmpConstValue *out) {
+    if (fn->is_extern) {
+        ce_fail(c, span, "const: `%s` is an extern fn and cannot run at compile time", fn->name);
+        return false;
+    }
+    if (fn->coro) {
+        ce_fail(c, span, "const: `%s` is a generator or async fn and cannot run at compile time", fn->name);
+        return false;
+    }
+    CeScope fn_names = *names;
+    if (!fn->body && fn->const_origin) {
+        fn_names.program = fn->const_origin_program;
+        fn_names.scope = NULL;
+        fn = fn->const_origin;
+    }
+    if (!fn->body) {
+        ce_fail(c, span, "const: `%s` is defined in another module; mark it `const fn` to call it at compile time", fn->name);
+        return false;
+    }
+    if (c->depth >= CE_MAX_DEPTH) {
+        ce_fail(c, span, "const: calls nested too deeply (unbounded recursion?)%s", (EmpSlice){0});
+        return false;
+    }
+
+    CeScope saved_names = c->names;
+    size_t saved_frame = c->frame;
+    size_t saved_len = c->vars_len;
+    c->names = fn_names;
+    c->frame = c->vars_len;
+    c->depth++;
+
+    bool ok = true;
+    for (size_t i = 0; i < argc && ok; i++) {
+        const EmpParam *p = (const EmpParam *)fn->params.items[i];
+        EmpConstValue v = v_copy(c, args[i]);
+        ok = p && v_convert(c, &v, p->ty, span) && var_push(c, p->name, v, p->ty);
+    }
+    CeFlow flow = ok ? ce_stmt(c, fn->body) : CE_FAIL;
+    EmpConstValue result = flow == CE_RETURN ? c->ret : v_none();
+    c->ret = v_none();
+
+    c->depth--;
+    c->vars_len = saved_len;
+    c->frame = saved_frame;
+    c->names = saved_names;
+
+    if (flow == CE_FAIL || c->failed) return false;
+    if (fn->ret_ty && !v_convert(c, &result, fn->ret_ty, span)) return false;
+    *out = result;
+    return true;
+}
+
+static bool ce_call(CeCtx *c, const EmpExpr *e, EmpConstValue *out) {
+    if (e->as.call.folded) {
+        *out = v_copy(c, *e->as.call.folded);
+        return true;
+    }
+    const EmpExpr *callee = strip_group(e->as.call.callee);
+    if (!callee || callee->kind != EMP_EXPR_IDENT) {
+        ce_fail(c, e->span, "const: only calls of plain functions can run at compile time%s", (EmpSlice){0});
+        return false;
+    }
+    size_t argc = e->as.call.args.len;
+    EmpConstValue stack_args[8];
+    EmpConstValue *args = argc <= 8 ? stack_args : (EmpConstValue *)calloc(argc, sizeof(EmpConstValue));
+    if (!args) return false;
+    bool ok = true;
+    for (size_t i = 0; i < argc && ok; i++) ok = ce_expr(c, (const EmpExpr *)e->as.call.args.items[i], &args[i]);
+
+    if (ok) {
+        bool found_name = false;
+        EmpItemFn *fn = find_fn(&c->names, callee->as.lit, args, argc, &found_name);
+        if (!fn) {
+            if (found_name) ce_fail(c, e->span, "const: no overload of `%s` takes these arguments", callee->as.lit);
+            else ce_fail(c, e->span, "const: `%s` cannot run at compile time", callee->as.lit);
+            ok = false;
+        } else {
+            ok = ce_call_fn(c, fn, &c->names, args, argc, e->span, out);
+        }
+    }
+    if (args != stack_args) free(args);
+    return ok;
+}
+
+static bool ce_expr(CeCtx *c, const EmpExpr *e, EmpConstValue *out) {
+    *out = v_none();
+    if (!e) {
+        ce_fail(c, (EmpSpan){0}, "const: missing expression%s", (EmpSlice){0});
+        return false;
+    }
+    if (!ce_step(c, e->span)) return false;
+    switch (e->kind) {
+        case EMP_EXPR_INT:
+            if (!lit_int(e->as.lit, out)) {
+                ce_fail(c, e->span, "const: integer literal out of range%s", (EmpSlice){0});
+                return false;
+            }
+            return true;
+        case EMP_EXPR_FLOAT:
+            if (!lit_float(e->as.lit, out)) {
+                ce_fail(c, e->span, "const: malformed float literal%s", (EmpSlice){0});
+                return false;
+            }
+            return true;
+        case EMP_EXPR_STRING:
+            return lit_string(c, e->as.lit, out);
+        case EMP_EXPR_CHAR:
+            if (!lit_char(e->as.lit, out)) {
+                ce_fail(c, e->span, "const: malformed char literal%s", (EmpSlice){0});
+                return false;
+            }
+            return true;
+        case EMP_EXPR_FSTRING:
+            ce_fail(c, e->span, "const: f-strings build heap strings and cannot be computed at compile time%s", (EmpSlice){0});
+            return false;
+
+        case EMP_EXPR_IDENT: {
+            if (slice_is(e->as.lit, "true") || slice_is(e->as.lit, "false")) {
+                *out = v_bool(slice_is(e->as.lit, "true"));
+                return true;
+            }
+            CeVar *v = var_find(c, e->as.lit);
+            if (v) {
+                *out = v->val;
+                return true;
+            }
+            EmpItemConst *k = find_const(&c->names, e->as.lit);
+            if (k) {
+                const EmpConstValue *kv = ce_const_item(c, k, e->span);
+                if (!kv) return false;
+                *out = *kv;
+                return true;
+            }
+            ce_fail(c, e->span, "const: `%s` is not a constant", e->as.lit);
+            return false;
+        }
+
+        case EMP_EXPR_GROUP:
+            return ce_expr(c, e->as.group.inner, out);
+
+        case EMP_EXPR_UNARY: {
+            if (e->as.unary.op == EMP_UN_BORROW || e->as.unary.op == EMP_UN_BORROW_MUT) {
+                ce_fail(c, e->span, "const: borrows cannot be taken at compile time%s", (EmpSlice){0});
+                return false;
+            }
+            EmpConstValue v;
+            if (!ce_expr(c, e->as.unary.rhs, &v)) return false;
+            if (e->as.unary.op == EMP_UN_NEG && v.kind == EMP_CONST_INT) {
+                *out = v_int_like(0 - v.as.i, &v);
+                return true;
+            }
+            if (e->as.unary.op == EMP_UN_NEG && v.kind == EMP_CONST_FLOAT) {
+                *out = v_float(-v.as.f, v.bits);
+                return true;
+            }
+            if (e->as.unary.op == EMP_UN_NOT && v.kind == EMP_CONST_BOOL) {
+                *out = v_bool(!v.as.b);
+                return true;
+            }
+            if ((e->as.unary.op == EMP_UN_BITNOT || e->as.unary.op == EMP_UN_NOT) && v.kind == EMP_CONST_INT) {
+                *out = v_int_like(~v.as.i, &v);
+                return true;
+            }
+            ce_fail(c, e->span, "const: operator not supported on this value at compile time%s", (EmpSlice){0});
+            return false;
+        }
+
+        case EMP_EXPR_BINARY: {
+            EmpBinOp op = e->as.binary.op;
+            if (op == EMP_BIN_ASSIGN) {
+                EmpConstValue v;
+                if (!ce_expr(c, e->as.binary.rhs, &v)) return false;
+                EmpConstValue *dst = ce_place(c, e->as.binary.lhs);
+                if (!dst) return false;
+                // The destination keeps its type.
+                v = v_copy(c, v);
+                if (dst->kind == EMP_CONST_INT && v.kind == EMP_CONST_INT) {
+                    v = v_int_like(v.as.i, dst);
+                } else if (dst->kind == EMP_CONST_FLOAT && (v.kind == EMP_CONST_INT || v.kind == EMP_CONST_FLOAT)) {
+                    v = v_float(v.kind == EMP_CONST_INT ? v_int_to_double(&v) : v.as.f, dst->bits);
+                } else if (dst->kind != v.kind) {
+                    ce_fail(c, e->span, "const: assignment changes the kind of value%s", (EmpSlice){0});
+                    return false;
+                }
+                *dst = v;
+                *out = v;
+                return true;
+            }
+            if (op > EMP_BIN_ASSIGN) {
+                EmpConstValue rhs;
+                if (!ce_expr(c, e->as.binary.rhs, &rhs)) return false;
+                EmpConstValue *dst = ce_place(c, e->as.binary.lhs);
+                if (!dst) return false;
+                EmpConstValue r;
+                if (!ce_binop(c, assign_base_op(op), *dst, rhs, e->span, &r)) return false;
+                if (r.kind == EMP_CONST_INT && dst->kind == EMP_CONST_INT) r = v_int_like(r.as.i, dst);
+                *dst = r;
+                *out = r;
+                return true;
+            }
+            EmpConstValue a;
+            if (!ce_expr(c, e->as.binary.lhs, &a)) return false;
+            // `&&` / `||` short-circuit.
+            if ((op == EMP_BIN_AND || op == EMP_BIN_OR) && a.kind == EMP_CONST_BOOL && a.as.b == (op == EMP_BIN_OR)) {
+                *out = a;
+                return true;
+            }
+            EmpConstValue b;
+            if (!ce_expr(c, e->as.binary.rhs, &b)) return false;
+            return ce_binop(c, op, a, b, e->span, out);
+        }
+
+        case EMP_EXPR_CALL:
+            return ce_call(c, e, out);
+
+        case EMP_EXPR_CAST: {
+            EmpConstValue v;
+            if (!ce_expr(c, e->as.cast.expr, &v)) return false;
+            return ce_cast(c, v, e->as.cast.ty, e->span, out);
+        }
+
+        case EMP_EXPR_TUPLE:
+        case EMP_EXPR_LIST: {
+            const EmpVec *items = e->kind == EMP_EXPR_TUPLE ? &e->as.tuple.items : &e->as.list.items;
+            EmpConstValue v;
+            if (!v_agg(c, &v, e->kind == EMP_EXPR_TUPLE ? EMP_CONST_TUPLE : EMP_CONST_ARRAY, items->len)) return false;
+            for (size_t i = 0; i < items->len; i++) {
+                EmpConstValue item;
+                if (!ce_expr(c, (const EmpExpr *)items->items[i], &item)) return false;
+                *v.as.agg.items[i] = v_copy(c, item);
+            }
+            *out = v;
+            return true;
+        }
+
+        case EMP_EXPR_INDEX: {
+            EmpConstValue base, idx;
+            if (!ce_expr(c, e->as.index.base, &base) || !ce_expr(c, e->as.index.index, &idx)) return false;
+            if ((base.kind != EMP_CONST_ARRAY && base.kind != EMP_CONST_TUPLE) || !v_is_int(&idx)) {
+                ce_fail(c, e->span, "const: only arrays and tuples can be indexed at compile time%s", (EmpSlice){0});
+                return false;
+            }
+            if ((!idx.is_unsigned && v_signed(&idx) < 0) || idx.as.i >= base.as.agg.len) {
+                ce_fail(c, e->span, "const: index out of bounds%s", (EmpSlice){0});
+                return false;
+            }
+            *out = *base.as.agg.items[idx.as.i];
+            return true;
+        }
+
+        case EMP_EXPR_MEMBER: {
+            EmpConstValue base;
+            if (!ce_expr(c, e->as.member.base, &base)) return false;
+            if (base.kind == EMP_CONST_TUPLE && base.as.agg.ty) {
+                for (size_t i = 0; i < base.as.agg.ty->as.tuple.fields.len && i < base.as.agg.len; i++) {
+                    const EmpTupleField *f = (const EmpTupleField *)base.as.agg.ty->as.tuple.fields.items[i];
+                    if (f && f->name.len && slice_eq(f->name, e->as.member.member)) {
+                        *out = *base.as.agg.items[i];
+                        return true;
+                    }
+                }
+            }
+            ce_fail(c, e->span, "const: field `%s` cannot be read at compile time", e->as.member.member);
+            return false;
+        }
+
+        case EMP_EXPR_TERNARY: {
+            EmpConstValue cond;
+            if (!ce_expr(c, e->as.ternary.cond, &cond)) return false;
+            if (cond.kind != EMP_CONST_BOOL) {
+                ce_fail(c, e->span, "const: condition is not a bool%s", (EmpSlice){0});
+                return false;
+            }
+            return ce_expr(c, cond.as.b ? e->as.ternary.then_expr : e->as.ternary.else_expr, out);
+        }
+
+        case EMP_EXPR_NEW:
+            ce_fail(c, e->span, "const: `new` allocates and cannot run at compile time%s", (EmpSlice){0});
+            return false;
+        case EMP_EXPR_RANGE:
+            ce_fail(c, e->span, "const: a range is only allowed as a `for` iterable%s", (EmpSlice){0});
+            return false;
+    }
+    ce_fail(c, e->span, "const: expression cannot be evaluated at compile time%s", (EmpSlice){0});
+    return false;
+}
+
+static CeFlow ce_block(CeCtx *c, const EmpStmt *s) {
+    size_t mark = c->vars_len;
+    CeFlow flow = CE_NEXT;
+    for (size_t i = 0; i < s->as.block.stmts.len && flow == CE_NEXT; i++) {
+        flow = ce_stmt(c, (const EmpStmt *)s->as.block.stmts.items[i]);
+    }
+    c->vars_len = mark;
+    return flow;
+}
+
+static bool ce_cond(CeCtx *c, const EmpExpr *e, bool *out) {
+    EmpConstValue v;
+    if (!ce_expr(c, e, &v)) return false;
+    if (v.kind != EMP_CONST_BOOL) {
+        ce_fail(c, e->span, "const: condition is not a bool%s", (EmpSlice){0});
+        return false;
+    }
+    *out = v.as.b;
+    return true;
+}
+
+// One iteration of a `for` body with its bindings; returns the flow for the loop.
+static CeFlow ce_for_iter(CeCtx *c, const EmpStmt *s, EmpConstValue idx, const EmpConstValue *val) {
+    size_t mark = c->vars_len;
+    CeFlow flow = CE_FAIL;
+    if (var_push(c, s->as.for_stmt.idx_name, idx, NULL) && (!val || var_push(c, s->as.for_stmt.val_name, v_copy(c, *val), NULL))) {
+        flow = ce_stmt(c, s->as.for_stmt.body);
+    }
+    c->vars_len = mark;
+    return flow;
+}
+
+static CeFlow ce_for(CeCtx *c, const EmpStmt *s) {
+    const EmpExpr *it = strip_group(s->as.for_stmt.iterable);
+    if (it && it->kind == EMP_EXPR_RANGE) {
+        EmpConstValue lo, hi;
+        if (!ce_expr(c, it->as.range.start, &lo) || !ce_expr(c, it->as.range.end, &hi)) return CE_FAIL;
+        if (lo.kind != EMP_CONST_INT || hi.kind != EMP_CONST_INT) {
+            ce_fail(c, it->span, "const: range bounds must be integers%s", (EmpSlice){0});
+            return CE_FAIL;
+        }
+        EmpConstValue ity = range_index_type(&lo, &hi);
+        EmpConstValue i = v_int_like(lo.as.i, &ity);
+        EmpConstValue end = v_int_like(hi.as.i, &ity);
+        for (;;) {
+            EmpConstValue in_range;
+            if (!ce_binop(c, it->as.range.inclusive ? EMP_BIN_LE : EMP_BIN_LT, i, end, it->span, &in_range)) return CE_FAIL;
+            if (!in_range.as.b) break;
+            CeFlow flow = ce_for_iter(c, s, i, NULL);
+            if (flow == CE_FAIL || flow == CE_RETURN) return flow;
+            if (flow == CE_BREAK) break;
+            // An inclusive range may end at the type's maximum.
+            if (it->as.range.inclusive && i.as.i == end.as.i) break;
+            i = v_int_like(i.as.i + 1u, &ity);
+        }
+        return CE_NEXT;
+    }
+
+    EmpConstValue arr;
+    if (!ce_expr(c, it, &arr)) return CE_FAIL;
+    if (arr.kind != EMP_CONST_ARRAY) {
+        ce_fail(c, s->span, "const: only ranges and arrays can be iterated at compile time%s", (EmpSlice){0});
+        return CE_FAIL;
+    }
+    for (size_t i = 0; i < arr.as.agg.len; i++) {
+        const EmpConstValue *val = s->as.for_stmt.val_name.len ? arr.as.agg.items[i] : NULL;
+        CeFlow flow = ce_for_iter(c, s, v_int(i, 32, false), val);
+        if (flow == CE_FAIL || flow == CE_RETURN) return flow;
+        if (flow == CE_BREAK) break;
+    }
+    return CE_NEXT;
+}
+
+static CeFlow ce_stmt(CeCtx *c, const EmpStmt *s) {
+    if (!s) return CE_NEXT;
+    if (!ce_step(c, s->span)) return CE_FAIL;
+    switch (s->kind) {
+        case EMP_STMT_BLOCK:
+            return ce_block(c, s);
+
+        case EMP_STMT_VAR: {
+            EmpConstValue v;
+            if (s->as.let_stmt.init) {
+                if (!ce_expr(c, s->as.let_stmt.init, &v)) return CE_FAIL;
+                v = v_copy(c, v);
+                if (!v_convert(c, &v, s->as.let_stmt.ty, s->span)) return CE_FAIL;
+            } else if (!v_zero(c, &v, s->as.let_stmt.ty, s->span)) {
+                return CE_FAIL;
+            }
+            if (s->as.let_stmt.is_destructure) {
+                if (v.kind != EMP_CONST_TUPLE || v.as.agg.len != s->as.let_stmt.destruct_names.len) {
+                    ce_fail(c, s->span, "const: destructuring needs a tuple of the same arity%s", (EmpSlice){0});
+                    return CE_FAIL;
+                }
+                for (size_t i = 0; i < v.as.agg.len; i++) {
+                    const EmpSlice *nm = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                    if (nm && !var_push(c, *nm, *v.as.agg.items[i], NULL)) return CE_FAIL;
+                }
+                return CE_NEXT;
+            }
+            return var_push(c, s->as.let_stmt.name, v, s->as.let_stmt.ty) ? CE_NEXT : CE_FAIL;
+        }
+
+        case EMP_STMT_EXPR: {
+            EmpConstValue v;
+            return ce_expr(c, s->as.expr.expr, &v) ? CE_NEXT : CE_FAIL;
+        }
+
+        case EMP_STMT_RETURN: {
+            EmpConstValue v = v_none();
+            if (s->as.ret.value && !ce_expr(c, s->as.ret.value, &v)) return CE_FAIL;
+            c->ret = v_copy(c, v);
+            return CE_RETURN;
+        }
+
+        case EMP_STMT_IF: {
+            bool cond = false;
+            if (!ce_cond(c, s->as.if_stmt.cond, &cond)) return CE_FAIL;
+            if (cond) return ce_stmt(c, s->as.if_stmt.then_branch);
+            return ce_stmt(c, s->as.if_stmt.else_branch);
+        }
+
+        case EMP_STMT_WHILE:
+            for (;;) {
+                bool cond = false;
+                if (!ce_cond(c, s->as.while_stmt.cond, &cond)) return CE_FAIL;
+                if (!cond) return CE_NEXT;
+                CeFlow flow = ce_stmt(c, s->as.while_stmt.body);
+                if (flow == CE_FAIL || flow == CE_RETURN) return flow;
+                if (flow == CE_BREAK) return CE_NEXT;
+            }
+
+        case EMP_STMT_FOR:
+            if (s->as.for_stmt.is_parallel) {
+                ce_fail(c, s->span, "const: `parallel for` cannot run at compile time%s", (EmpSlice){0});
+                return CE_FAIL;
+            }
+            return ce_for(c, s);
+
+        case EMP_STMT_BREAK:
+            return CE_BREAK;
+        case EMP_STMT_CONTINUE:
+            return CE_CONTINUE;
+
+        case EMP_STMT_MATCH: {
+            EmpConstValue v;
+            if (!ce_expr(c, s->as.match_stmt.scrutinee, &v)) return CE_FAIL;
+            if (v.kind != EMP_CONST_INT && v.kind != EMP_CONST_CHAR && v.kind != EMP_CONST_BOOL) {
+                ce_fail(c, s->span, "const: only integer, char and bool matches run at compile time%s", (EmpSlice){0});
+                return CE_FAIL;
+            }
+            const EmpMatchArm *fallback = NULL;
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                if (arm->is_default) {
+                    if (!fallback) fallback = arm;
+                    continue;
+                }
+                EmpConstValue pat;
+                if (!ce_expr(c, arm->pat, &pat)) return CE_FAIL;
+                if (pat.kind == EMP_CONST_INT && v.kind == EMP_CONST_INT) pat = v_int_like(pat.as.i, &v);
+                if (v_equal(&v, &pat)) return ce_stmt(c, arm->body);
+            }
+            return fallback ? ce_stmt(c, fallback->body) : CE_NEXT;
+        }
+
+        // Lowered defers, drops and tags have no effect on compile-time values.
+        case EMP_STMT_DEFER:
+        case EMP_STMT_DROP:
+        case EMP_STMT_TAG:
+            return CE_NEXT;
+
+        case EMP_STMT_EMP_OFF:
+        case EMP_STMT_EMP_MM_OFF:
+            ce_fail(c, s->span, "const: `@emp off` code cannot run at compile time%s", (EmpSlice){0});
+            return CE_FAIL;
+
+        case EMP_STMT_YIELD:
+            ce_fail(c, s->span, "const: `yield` cannot run at compile time%s", (EmpSlice){0});
+            return CE_FAIL;
+    }
+    return CE_NEXT;
+}
+
+// Evaluates const `k` (its definition, for import decls) once; NULL after a diagnostic.
+static const EmpConstValue *ce_const_item(CeCtx *c, EmpItemConst *k, EmpSpan use_span) {
+    if (k->value) return k->value;
+    EmpItemConst *def = k->origin ? (EmpItemConst *)k->origin : k;
+    if (def->value) {
+        k->value = def->value;
+        return k->value;
+    }
+    for (size_t i = 0; i < c->bad.len; i++) {
+        if (c->bad.items[i] == def) {
+            c->failed = true;
+            return NULL;
+        }
+    }
+    for (size_t i = 0; i < c->busy.len; i++) {
+        if (c->busy.items[i] == def) {
+            ce_fail(c, use_span, "const: `%s` depends on its own value", def->name);
+            return NULL;
+        }
+    }
+    if (!def->init) {
+        ce_fail(c, use_span, "const: `%s` has no initializer", def->name);
+        return NULL;
+    }
+
+    // The initializer runs in the scope of its own module, with no locals.
+    CeScope saved_names = c->names;
+    size_t saved_frame = c->frame;
+    if (k->origin) {
+        c->names.program = k->origin_program;
+        c->names.scope = NULL;
+    }
+    c->frame = c->vars_len;
+    (void)emp_vec_push(&c->busy, def);
+
+    EmpConstValue v;
+    bool ok = ce_expr(c, def->init, &v);
+    if (ok) {
+        v = v_copy(c, v);
+        ok = v_convert(c, &v, def->ty, def->span);
+    }
+
+    c->busy.len--;
+    c->frame = saved_frame;
+    c->names = saved_names;
+    if (!ok || c->failed) {
+        if (c->diags) (void)emp_vec_push(&c->bad, def);
+        return NULL;
+    }
+
+    EmpConstValue *node = (EmpConstValue *)emp_arena_alloc(c->arena, sizeof(EmpConstValue), sizeof(void *));
+    if (!node) return NULL;
+    *node = v;
+    // Only a value of the const's final type is kept: an untyped const is evaluated again once
+    // typecheck has inferred its type.
+    if (def->ty && def->ty->kind != EMP_TYPE_AUTO) {
+        def->value = node;
+        k->value = node;
+    }
+    return node;
+}
+
+static void ce_init(CeCtx *c, EmpArena *arena, EmpDiags *diags, const EmpProgram *program, const EmpVec *scope) {
+    memset(c, 0, sizeof(*c));
+    c->arena = arena;
+    c->diags = diags;
+    c->names.program = program;
+    c->names.scope = scope;
+    emp_vec_init(&c->busy);
+    emp_vec_init(&c->bad);
+}
+
+static void ce_free(CeCtx *c) {
+    free(c->vars);
+    emp_vec_free(&c->busy);
+    emp_vec_free(&c->bad);
+}
+
+// Each top-level evaluation gets a fresh budget and error state.
+static void ce_reset(CeCtx *c) {
+    c->failed = false;
+    c->steps = 0;
+    c->depth = 0;
+    c->vars_len = 0;
+    c->frame = 0;
+    c->busy.len = 0;
+}
+
+// ===== Array sizes =====
+
+static bool size_is_digits(EmpSlice s) {
+    for (size_t i = 0; i < s.len; i++) {
+        if ((s.ptr[i] < '0' || s.ptr[i] > '9') && s.ptr[i] != '_') return false;
+    }
+    return s.len > 0;
+}
+
+static void sz_type(CeCtx *c, EmpType *t);
+static void sz_expr(CeCtx *c, EmpExpr *e);
+static void sz_stmt(CeCtx *c, EmpStmt *s);
+
+static void sz_types(CeCtx *c, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) sz_type(c, (EmpType *)v->items[i]);
+}
+
+static void sz_params(CeCtx *c, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) {
+        EmpParam *p = (EmpParam *)v->items[i];
+        if (p) sz_type(c, p->ty);
+    }
+}
+
+static void sz_type(CeCtx *c, EmpType *t) {
+    if (!t) return;
+    switch (t->kind) {
+        case EMP_TYPE_PTR:
+            sz_type(c, t->as.ptr.pointee);
+            return;
+        case EMP_TYPE_LIST:
+            sz_type(c, t->as.array.elem);
+            return;
+        case EMP_TYPE_GENERIC:
+            sz_types(c, &t->as.generic.args);
+            return;
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                EmpTupleField *f = (EmpTupleField *)t->as.tuple.fields.items[i];
+                if (f) sz_type(c, f->ty);
+            }
+            return;
+        case EMP_TYPE_ARRAY:
+            break;
+        default:
+            return;
+    }
+    sz_type(c, t->as.array.elem);
+    EmpSlice n = t->as.array.size_text;
+    if (!n.len || size_is_digits(n)) return;
+
+    EmpItemConst *k = find_const(&c->names, n);
+    if (!k) {
+        diagf(c->arena, c->diags, t->span, "const: array size `%s` is not a const", n);
+        return;
+    }
+    ce_reset(c);
+    const EmpConstValue *v = ce_const_item(c, k, t->span);
+    if (!v) return;
+    if (v->kind != EMP_CONST_INT || (!v->is_unsigned && (int64_t)v->as.i < 0) || v->as.i > 0x7fffffffu) {
+        diagf(c->arena, c->diags, t->span, "const: array size `%s` must be an integer from 0 to 2147483647", n);
+        return;
+    }
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v->as.i);
+    char *digits = arena_strdup(c->arena, buf);
+    if (!digits) return;
+    t->as.array.size_text.ptr = digits;
+    t->as.array.size_text.len = strlen(digits);
+}
+
+static void sz_exprs(CeCtx *c, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) sz_expr(c, (EmpExpr *)v->items[i]);
+}
+
+static void sz_expr(CeCtx *c, EmpExpr *e) {
+    if (!e) return;
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *p = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (p && p->is_expr) sz_expr(c, p->expr);
+            }
+            return;
+        case EMP_EXPR_UNARY: sz_expr(c, e->as.unary.rhs); return;
+        case EMP_EXPR_BINARY:
+            sz_expr(c, e->as.binary.lhs);
+            sz_expr(c, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            sz_expr(c, e->as.call.callee);
+            sz_exprs(c, &e->as.call.args);
+            sz_types(c, &e->as.call.type_args);
+            return;
+        case EMP_EXPR_GROUP: sz_expr(c, e->as.group.inner); return;
+        case EMP_EXPR_CAST:
+            sz_type(c, e->as.cast.ty);
+            sz_expr(c, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE: sz_exprs(c, &e->as.tuple.items); return;
+        case EMP_EXPR_LIST: sz_exprs(c, &e->as.list.items); return;
+        case EMP_EXPR_INDEX:
+            sz_expr(c, e->as.index.base);
+            sz_expr(c, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER: sz_expr(c, e->as.member.base); return;
+        case EMP_EXPR_NEW: sz_exprs(c, &e->as.new_expr.args); return;
+        case EMP_EXPR_TERNARY:
+            sz_expr(c, e->as.ternary.cond);
+            sz_expr(c, e->as.ternary.then_expr);
+            sz_expr(c, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            sz_expr(c, e->as.range.start);
+            sz_expr(c, e->as.range.end);
+            return;
+        default: return;
+    }
+}
+
+static void sz_stmt(CeCtx *c, EmpStmt *s) {
+    if (!s) return;
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            sz_type(c, s->as.let_stmt.ty);
+            sz_expr(c, s->as.let_stmt.init);
+            return;
+        case EMP_STMT_DEFER: sz_stmt(c, s->as.defer_stmt.body); return;
+        case EMP_STMT_RETURN: sz_expr(c, s->as.ret.value); return;
+        case EMP_STMT_YIELD: sz_expr(c, s->as.yield_stmt.value); return;
+        case EMP_STMT_EXPR: sz_expr(c, s->as.expr.expr); return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) sz_stmt(c, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            sz_expr(c, s->as.if_stmt.cond);
+            sz_stmt(c, s->as.if_stmt.then_branch);
+            sz_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            sz_expr(c, s->as.while_stmt.cond);
+            sz_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            sz_expr(c, s->as.for_stmt.iterable);
+            sz_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            sz_expr(c, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *a = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!a) continue;
+                sz_expr(c, a->pat);
+                sz_stmt(c, a->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF: sz_stmt(c, s->as.emp_off.body); return;
+        case EMP_STMT_EMP_MM_OFF: sz_stmt(c, s->as.emp_mm_off.body); return;
+        default: return;
+    }
+}
+
+static void sz_item(CeCtx *c, EmpItem *it) {
+    if (!it) return;
+    switch (it->kind) {
+        case EMP_ITEM_FN:
+            sz_params(c, &it->as.fn.params);
+            sz_type(c, it->as.fn.ret_ty);
+            sz_stmt(c, it->as.fn.body);
+            return;
+        case EMP_ITEM_CONST:
+            sz_type(c, it->as.const_decl.ty);
+            sz_expr(c, it->as.const_decl.init);
+            return;
+        case EMP_ITEM_STRUCT:
+            for (size_t i = 0; i < it->as.struct_decl.fields.len; i++) {
+                EmpStructField *f = (EmpStructField *)it->as.struct_decl.fields.items[i];
+                if (f) sz_type(c, f->ty);
+            }
+            return;
+        case EMP_ITEM_ENUM:
+            for (size_t i = 0; i < it->as.enum_decl.variants.len; i++) {
+                EmpEnumVariant *v = (EmpEnumVariant *)it->as.enum_decl.variants.items[i];
+                if (v) sz_types(c, &v->fields);
+            }
+            return;
+        case EMP_ITEM_CLASS:
+            for (size_t i = 0; i < it->as.class_decl.fields.len; i++) {
+                EmpClassField *f = (EmpClassField *)it->as.class_decl.fields.items[i];
+                if (f) sz_type(c, f->ty);
+            }
+            for (size_t i = 0; i < it->as.class_decl.methods.len; i++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[i];
+                if (!m) continue;
+                sz_params(c, &m->params);
+                sz_type(c, m->ret_ty);
+                sz_stmt(c, m->body);
+            }
+            return;
+        case EMP_ITEM_TRAIT:
+            for (size_t i = 0; i < it->as.trait_decl.methods.len; i++) {
+                EmpTraitMethod *m = (EmpTraitMethod *)it->as.trait_decl.methods.items[i];
+                if (!m) continue;
+                sz_params(c, &m->params);
+                sz_type(c, m->ret_ty);
+                sz_stmt(c, m->body);
+            }
+            return;
+        case EMP_ITEM_IMPL:
+            for (size_t i = 0; i < it->as.impl_decl.methods.len; i++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[i];
+                if (!m) continue;
+                sz_params(c, &m->params);
+                sz_type(c, m->ret_ty);
+                sz_stmt(c, m->body);
+            }
+            return;
+        default: return;
+    }
+}
+
+void emp_sem_resolve_const_sizes(EmpArena *arena, EmpProgram *program, const EmpVec *scope, EmpDiags *diags) {
+    if (!program) return;
+    CeCtx c;
+    ce_init(&c, arena, diags, program, scope);
+    for (size_t i = 0; i < program->items.len; i++) sz_item(&c, (EmpItem *)program->items.items[i]);
+    for (size_t i = 0; i < program->generics.len; i++) sz_item(&c, (EmpItem *)program->generics.items[i]);
+    ce_free(&c);
+}
+
+// ===== Checked program =====
+
+typedef struct CeWalk {
+    CeCtx *c;
+    EmpVec locals; // EmpSlice*: every parameter and local name of the fn being walked
+    const EmpItemFn *const_fn; // set while checking the body of a `const fn`
+    size_t folded;
+} CeWalk;
+
+typedef void (*CeVisitExpr)(CeWalk *w, EmpExpr *e);
+typedef void (*CeVisitStmt)(CeWalk *w, EmpStmt *s);
+
+static void walk_stmt(CeWalk *w, EmpStmt *s, CeVisitStmt vs, CeVisitExpr ve);
+
+// Visits every expression under `e`, operands before the expression itself.
+static void walk_expr(CeWalk *w, EmpExpr *e, CeVisitExpr ve) {
+    if (!e) return;
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *p = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (p && p->is_expr) walk_expr(w, p->expr, ve);
+            }
+            break;
+        case EMP_EXPR_UNARY: walk_expr(w, e->as.unary.rhs, ve); break;
+        case EMP_EXPR_BINARY:
+            walk_expr(w, e->as.binary.lhs, ve);
+            walk_expr(w, e->as.binary.rhs, ve);
+            break;
+        case EMP_EXPR_CALL:
+            walk_expr(w, e->as.call.callee, ve);
+            for (size_t i = 0; i < e->as.call.args.len; i++) walk_expr(w, (EmpExpr *)e->as.call.args.items[i], ve);
+            break;
+        case EMP_EXPR_GROUP: walk_expr(w, e->as.group.inner, ve); break;
+        case EMP_EXPR_CAST: walk_expr(w, e->as.cast.expr, ve); break;
+        case EMP_EXPR_TUPLE:
+            for (size_t i = 0; i < e->as.tuple.items.len; i++) walk_expr(w, (EmpExpr *)e->as.tuple.items.items[i], ve);
+            break;
+        case EMP_EXPR_LIST:
+            for (size_t i = 0; i < e->as.list.items.len; i++) walk_expr(w, (EmpExpr *)e->as.list.items.items[i], ve);
+            break;
+        case EMP_EXPR_INDEX:
+            walk_expr(w, e->as.index.base, ve);
+            walk_expr(w, e->as.index.index, ve);
+            break;
+        case EMP_EXPR_MEMBER: walk_expr(w, e->as.member.base, ve); break;
+        case EMP_EXPR_NEW:
+            for (size_t i = 0; i < e->as.new_expr.args.len; i++) walk_expr(w, (EmpExpr *)e->as.new_expr.args.items[i], ve);
+            break;
+        case EMP_EXPR_TERNARY:
+            walk_expr(w, e->as.ternary.cond, ve);
+            walk_expr(w, e->as.ternary.then_expr, ve);
+            walk_expr(w, e->as.ternary.else_expr, ve);
+            break;
+        case EMP_EXPR_RANGE:
+            walk_expr(w, e->as.range.start, ve);
+            walk_expr(w, e->as.range.end, ve);
+            break;
+        default: break;
+    }
+    ve(w, e);
+}
+
+static void walk_stmt(CeWalk *w, EmpStmt *s, CeVisitStmt vs, CeVisitExpr ve) {
+    if (!s) return;
+    if (vs) vs(w, s);
+    switch (s->kind) {
+        case EMP_STMT_VAR: walk_expr(w, s->as.let_stmt.init, ve); return;
+        case EMP_STMT_DEFER: walk_stmt(w, s->as.defer_stmt.body, vs, ve); return;
+        case EMP_STMT_RETURN: walk_expr(w, s->as.ret.value, ve); return;
+        case EMP_STMT_YIELD: walk_expr(w, s->as.yield_stmt.value, ve); return;
+        case EMP_STMT_EXPR: walk_expr(w, s->as.expr.expr, ve); return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) walk_stmt(w, (EmpStmt *)s->as.block.stmts.items[i], vs, ve);
+            return;
+        case EMP_STMT_IF:
+            walk_expr(w, s->as.if_stmt.cond, ve);
+            walk_stmt(w, s->as.if_stmt.then_branch, vs, ve);
+            walk_stmt(w, s->as.if_stmt.else_branch, vs, ve);
+            return;
+        case EMP_STMT_WHILE:
+            walk_expr(w, s->as.while_stmt.cond, ve);
+            walk_stmt(w, s->as.while_stmt.body, vs, ve);
+            return;
+        case EMP_STMT_FOR:
+            walk_expr(w, s->as.for_stmt.iterable, ve);
+            walk_stmt(w, s->as.for_stmt.body, vs, ve);
+            return;
+        case EMP_STMT_MATCH:
+            walk_expr(w, s->as.match_stmt.scrutinee, ve);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *a = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (a) walk_stmt(w, a->body, vs, ve);
+            }
+            return;
+        case EMP_STMT_EMP_OFF: walk_stmt(w, s->as.emp_off.body, vs, ve); return;
+        case EMP_STMT_EMP_MM_OFF: walk_stmt(w, s->as.emp_mm_off.body, vs, ve); return;
+        default: return;
+    }
+}
+
+static void visit_no_expr(CeWalk *w, EmpExpr *e) {
+    (void)w;
+    (void)e;
+}
+
+static void collect_local(CeWalk *w, EmpStmt *s) {
+    if (s->kind == EMP_STMT_VAR) {
+        if (s->as.let_stmt.is_destructure) {
+            for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) (void)emp_vec_push(&w->locals, s->as.let_stmt.destruct_names.items[i]);
+        } else {
+            (void)emp_vec_push(&w->locals, &s->as.let_stmt.name);
+        }
+    } else if (s->kind == EMP_STMT_FOR) {
+        (void)emp_vec_push(&w->locals, &s->as.for_stmt.idx_name);
+        if (s->as.for_stmt.val_name.len) (void)emp_vec_push(&w->locals, &s->as.for_stmt.val_name);
+    }
+}
+
+static void collect_locals(CeWalk *w, EmpVec *params, EmpStmt *body) {
+    w->locals.len = 0;
+    for (size_t i = 0; i < params->len; i++) {
+        EmpParam *p = (EmpParam *)params->items[i];
+        if (p) (void)emp_vec_push(&w->locals, &p->name);
+    }
+    walk_stmt(w, body, collect_local, visit_no_expr);
+}
+
+static bool is_local(const CeWalk *w, EmpSlice name) {
+    for (size_t i = 0; i < w->locals.len; i++) {
+        if (slice_eq(*(const EmpSlice *)w->locals.items[i], name)) return true;
+    }
+    return false;
+}
+
+// ----- `const fn` bodies -----
+
+static bool type_is_const_value(const EmpType *t) {
+    if (!t || t->kind == EMP_TYPE_AUTO) return true;
+    switch (t->kind) {
+        case EMP_TYPE_NAME:
+            return int_name_bits(t->as.name, NULL) || float_name_bits(t->as.name) || slice_is(t->as.name, "bool") || slice_is(t->as.name, "char");
+        case EMP_TYPE_PTR: return type_is_cstr(t);
+        case EMP_TYPE_ARRAY: return type_is_const_value(t->as.array.elem);
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                if (f && !type_is_const_value(f->ty)) return false;
+            }
+            return true;
+        default: return false;
+    }
+}
+
+static void check_const_stmt(CeWalk *w, EmpStmt *s) {
+    CeCtx *c = w->c;
+    if (s->kind == EMP_STMT_EMP_OFF || s->kind == EMP_STMT_EMP_MM_OFF) {
+        diagf(c->arena, c->diags, s->span, "const: `const fn %s` cannot contain `@emp off` blocks", w->const_fn->name);
+    } else if (s->kind == EMP_STMT_FOR && s->as.for_stmt.is_parallel) {
+        diagf(c->arena, c->diags, s->span, "const: `const fn %s` cannot use `parallel for`", w->const_fn->name);
+    } else if (s->kind == EMP_STMT_VAR && !s->as.let_stmt.is_destructure && !type_is_const_value(s->as.let_stmt.ty)) {
+        diagf(c->arena, c->diags, s->span, "const: locals of `const fn %s` must be numbers, bool, char, `*u8`, tuples or arrays", w->const_fn->name);
+    }
+}
+
+static void check_const_expr(CeWalk *w, EmpExpr *e) {
+    CeCtx *c = w->c;
+    const EmpSlice name = w->const_fn->name;
+    switch (e->kind) {
+        case EMP_EXPR_NEW:
+            diagf(c->arena, c->diags, e->span, "const: `const fn %s` cannot allocate with `new`", name);
+            return;
+        case EMP_EXPR_FSTRING:
+            diagf(c->arena, c->diags, e->span, "const: `const fn %s` cannot build f-strings", name);
+            return;
+        case EMP_EXPR_UNARY:
+            if (e->as.unary.op == EMP_UN_BORROW || e->as.unary.op == EMP_UN_BORROW_MUT) {
+                diagf(c->arena, c->diags, e->span, "const: `const fn %s` cannot take borrows", name);
+            } else if (e->as.unary.op == EMP_UN_AWAIT) {
+                diagf(c->arena, c->diags, e->span, "const: `const fn %s` cannot `await`", name);
+            }
+            return;
+        case EMP_EXPR_CALL: {
+            const EmpExpr *callee = strip_group(e->as.call.callee);
+            if (!callee || callee->kind != EMP_EXPR_IDENT) {
+                diagf(c->arena, c->diags, e->span, "const: `const fn %s` can only call plain functions", name);
+                return;
+            }
+            // Every fn of that name is extern (or a builtin): nothing the interpreter can run.
+            bool runnable = false;
+            for (size_t i = 0; i < scope_len(&c->names) && !runnable; i++) {
+                const EmpItem *it = scope_item(&c->names, i);
+                runnable = it && it->kind == EMP_ITEM_FN && slice_eq(it->as.fn.name, callee->as.lit) && !it->as.fn.is_extern;
+            }
+            if (!runnable) diagf(c->arena, c->diags, e->span, "const: `%s` cannot be called from a `const fn`", callee->as.lit);
+            return;
+        }
+        default: return;
+    }
+}
+
+static void check_const_fn(CeWalk *w, const EmpItemFn *fn) {
+    CeCtx *c = w->c;
+    if (fn->is_extern) {
+        diagf(c->arena, c->diags, fn->span, "const: extern fn `%s` cannot be `const`", fn->name);
+        return;
+    }
+    if (fn->coro) {
+        diagf(c->arena, c->diags, fn->span, "const: generator or async fn `%s` cannot be `const`", fn->name);
+        return;
+    }
+    bool types_ok = type_is_const_value(fn->ret_ty);
+    for (size_t i = 0; i < fn->params.len && types_ok; i++) {
+        const EmpParam *p = (const EmpParam *)fn->params.items[i];
+        types_ok = !p || type_is_const_value(p->ty);
+    }
+    if (!types_ok) {
+        diagf(c->arena, c->diags, fn->span, "const: parameters and result of `const fn %s` must be numbers, bool, char, `*u8`, tuples or arrays", fn->name);
+    }
+    w->const_fn = fn;
+    walk_stmt(w, fn->body, check_const_stmt, check_const_expr);
+    w->const_fn = NULL;
+}
+
+// ----- Folding `const fn` calls -----
+
+// Built from literals, consts and folded calls only.
+static bool is_const_expr(const CeWalk *w, const EmpExpr *e) {
+    if (!e) return false;
+    switch (e->kind) {
+        case EMP_EXPR_INT:
+        case EMP_EXPR_FLOAT:
+        case EMP_EXPR_STRING:
+        case EMP_EXPR_CHAR: return true;
+        case EMP_EXPR_IDENT:
+            if (slice_is(e->as.lit, "true") || slice_is(e->as.lit, "false")) return true;
+            return !is_local(w, e->as.lit) && find_const(&w->c->names, e->as.lit) != NULL;
+        case EMP_EXPR_GROUP: return is_const_expr(w, e->as.group.inner);
+        case EMP_EXPR_UNARY:
+            return e->as.unary.op != EMP_UN_BORROW && e->as.unary.op != EMP_UN_BORROW_MUT && is_const_expr(w, e->as.unary.rhs);
+        case EMP_EXPR_BINARY:
+            return e->as.binary.op < EMP_BIN_ASSIGN && is_const_expr(w, e->as.binary.lhs) && is_const_expr(w, e->as.binary.rhs);
+        case EMP_EXPR_CAST: return is_const_expr(w, e->as.cast.expr);
+        case EMP_EXPR_TERNARY:
+            return is_const_expr(w, e->as.ternary.cond) && is_const_expr(w, e->as.ternary.then_expr) && is_const_expr(w, e->as.ternary.else_expr);
+        case EMP_EXPR_TUPLE:
+        case EMP_EXPR_LIST: {
+            const EmpVec *items = e->kind == EMP_EXPR_TUPLE ? &e->as.tuple.items : &e->as.list.items;
+            for (size_t i = 0; i < items->len; i++) {
+                if (!is_const_expr(w, (const EmpExpr *)items->items[i])) return false;
+            }
+            return true;
+        }
+        case EMP_EXPR_CALL: return e->as.call.folded != NULL;
+        default: return false;
+    }
+}
+
+static bool names_const_fn(const CeScope *s, EmpSlice name) {
+    for (size_t i = 0; i < scope_len(s); i++) {
+        const EmpItem *it = scope_item(s, i);
+        if (it && it->kind == EMP_ITEM_FN && it->as.fn.is_const && slice_eq(it->as.fn.name, name)) return true;
+    }
+    return false;
+}
+
+static void fold_call(CeWalk *w, EmpExpr *e) {
+    if (e->kind != EMP_EXPR_CALL || e->as.call.folded) return;
+    const EmpExpr *callee = strip_group(e->as.call.callee);
+    if (!callee || callee->kind != EMP_EXPR_IDENT || is_local(w, callee->as.lit) || !names_const_fn(&w->c->names, callee->as.lit)) return;
+    for (size_t i = 0; i < e->as.call.args.len; i++) {
+        if (!is_const_expr(w, (const EmpExpr *)e->as.call.args.items[i])) return;
+    }
+
+    // A call that cannot be evaluated (it would trap, or runs too long) stays a runtime call.
+    CeCtx *c = w->c;
+    EmpDiags *diags = c->diags;
+    c->diags = NULL;
+    ce_reset(c);
+    EmpConstValue v;
+    bool ok = ce_call(c, e, &v) && !c->failed && v.kind != 0;
+    c->diags = diags;
+    if (!ok) return;
+
+    EmpConstValue *node = (EmpConstValue *)emp_arena_alloc(c->arena, sizeof(EmpConstValue), sizeof(void *));
+    if (!node) return;
+    *node = v_copy(c, v);
+    e->as.call.folded = node;
+    w->folded++;
+}
+
+// Constant `match` patterns get their value (converted to the scrutinee type), so the match can
+// become a `switch` (emp_sem_plan_matches). Enum patterns are not expressions of a value.
+static void fold_match_patterns(CeWalk *w, EmpStmt *s) {
+    if (s->kind != EMP_STMT_MATCH || !s->as.match_stmt.scrutinee_ty) return;
+    CeCtx *c = w->c;
+    for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+        EmpMatchArm *a = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+        if (!a || a->is_default || a->value || !is_const_expr(w, a->pat)) continue;
+        EmpDiags *diags = c->diags;
+        c->diags = NULL;
+        ce_reset(c);
+        EmpConstValue v;
+        bool ok = ce_expr(c, a->pat, &v) && v_convert(c, &v, s->as.match_stmt.scrutinee_ty, a->span) && !c->failed;
+        c->diags = diags;
+        if (!ok) continue;
+        EmpConstValue *node = (EmpConstValue *)emp_arena_alloc(c->arena, sizeof(EmpConstValue), sizeof(void *));
+        if (!node) continue;
+        *node = v_copy(c, v);
+        a->value = node;
+    }
+}
+
+static void fold_body(CeWalk *w, EmpVec *params, EmpStmt *body) {
+    if (!body) return;
+    collect_locals(w, params, body);
+    walk_stmt(w, body, fold_match_patterns, fold_call);
+}
+
+void emp_sem_eval_consts(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
+    if (!program) return;
+    CeCtx c;
+    ce_init(&c, arena, diags, program, NULL);
+    CeWalk w;
+    memset(&w, 0, sizeof(w));
+    w.c = &c;
+    emp_vec_init(&w.locals);
+
+    // 1) Const items, in any order: each evaluates the consts it names first.
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_CONST || !it->as.const_decl.init) continue;
+        ce_reset(&c);
+        (void)ce_const_item(&c, &it->as.const_decl, it->as.const_decl.span);
+    }
+
+    // 2) `const fn` bodies.
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (it && it->kind == EMP_ITEM_FN && it->as.fn.is_const && (it->as.fn.body || it->as.fn.is_extern)) check_const_fn(&w, &it->as.fn);
+    }
+
+    // 3) Fold `const fn` calls with constant arguments, and constant `match` patterns.
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_FN) {
+            fold_body(&w, &it->as.fn.params, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) fold_body(&w, &m->params, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) fold_body(&w, &m->params, m->body);
+            }
+        }
+    }
+
+    emp_vec_free(&w.locals);
+    ce_free(&c);
+}
+
+// ===== Stats =====
+
+static size_t value_bytes(const EmpConstValue *v) {
+    if (!v) return 0;
+    switch (v->kind) {
+        case EMP_CONST_INT:
+        case EMP_CONST_FLOAT: return v->bits ? (size_t)v->bits / 8u : 8u;
+        case EMP_CONST_BOOL: return 1;
+        case EMP_CONST_CHAR: return 4;
+        case EMP_CONST_STRING: return v->as.str.len + 1u;
+        case EMP_CONST_TUPLE:
+        case EMP_CONST_ARRAY: {
+            size_t n = 0;
+            for (size_t i = 0; i < v->as.agg.len; i++) n += value_bytes(v->as.agg.items[i]);
+            return n;
+        }
+    }
+    return 0;
+}
+
+static void count_folded(CeWalk *w, EmpExpr *e) {
+    if (e->kind == EMP_EXPR_CALL && e->as.call.folded) w->folded++;
+}
+
+static void count_body(CeWalk *w, EmpStmt *body) {
+    walk_stmt(w, body, NULL, count_folded);
+}
+
+void emp_sem_const_stats(const EmpProgram *program, EmpConstStats *out_stats) {
+    if (!out_stats) return;
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+    CeWalk w;
+    memset(&w, 0, sizeof(w));
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_CONST && it->as.const_decl.init && it->as.const_decl.value) {
+            out_stats->consts++;
+            out_stats->bytes += value_bytes(it->as.const_decl.value);
+        } else if (it->kind == EMP_ITEM_FN) {
+            count_body(&w, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) count_body(&w, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) count_body(&w, m->body);
+            }
+        }
+    }
+    out_stats->folded = w.folded;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EmpConstStats {
+    size_t consts; // `const` items with a value (EmpItemConst.value)
+    size_t bytes;  // bytes of constant data those values emit
+    size_t folded; // `const fn` calls replaced by their value (EmpExpr.call.folded)
+} EmpConstStats;
+
+// Compile-time evaluation.
+//
+// An interpreter over the AST runs `const` initializers and the functions they call: integers
+// (operators typed as typecheck types them, wrapping at that width), floats, bool, char, `*u8` string literals, tuples and
+// arrays, with locals, assignments, `if`/`while`/`for` and `return`. Calls may go to any function
+// whose body only does those things ("inferred pure"); `const fn` marks functions meant for it,
+// and only their calls are folded in ordinary code. Evaluation stops with a diagnostic at
+// anything that needs the running program: heap values (`string`, lists, `new`), pointers and
+// borrows, `extern` calls, `@emp off` blocks, or more than EMP_CONST_MAX_STEPS steps.
+//
+// Import decls evaluate their definition (EmpItemConst.origin / EmpItemFn.const_origin), whose
+// body sees the names of its own module.
+#define EMP_CONST_MAX_STEPS 10000000u
+
+// Rewrites every array size in `program` that names a `const` (`T[N]`) to the digits of its
+// value, so types compare and lay out as if written with a literal; the const must be an integer
+// from 0 to 2^31-1. Names resolve in `program`, then in the import decls `scope` (may be NULL).
+// The driver runs it on every module before any module is typechecked: import decls share their
+// types with the definition, which its own module resolves.
+void emp_sem_resolve_const_sizes(EmpArena *arena, EmpProgram *program, const EmpVec *scope, EmpDiags *diags);
+
+// After typecheck: sets EmpItemConst.value for every const (converted to its checked type),
+// checks that `const fn` bodies only do what the interpreter can, and folds calls of `const fn`s
+// whose arguments are all constant (EmpExpr.call.folded). Codegen emits each value once as an
+// internal `constant` global (exported consts keep their name), so tables cost nothing at
+// startup; scalar uses may be emitted as immediates.
+void emp_sem_eval_consts(EmpArena *arena, EmpProgram *program, EmpDiags *diags);
+
+// Counts what emp_sem_eval_consts computed for `--stats`.
+void emp_sem_const_stats(const EmpProgram *program, EmpConstStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
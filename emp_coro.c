@@ -0,0 +1,381 @@
+#include "emp_coro.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct CoCtx {
+    const EmpProgram *program;
+    uint32_t next; // suspend points numbered so far in the current body
+    EmpCoroStats stats;
+} CoCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static bool slice_is(EmpSlice s, const char *lit) {
+    size_t n = strlen(lit);
+    return s.len == n && s.ptr && memcmp(s.ptr, lit, n) == 0;
+}
+
+bool emp_fn_is_coroutine(const EmpItemFn *fn) {
+    if (!fn) return false;
+    if (fn->coro || fn->is_async) return true;
+    const EmpType *t = fn->ret_ty;
+    return t && t->kind == EMP_TYPE_GENERIC && slice_is(t->as.generic.name, "Gen");
+}
+
+static EmpExpr *strip_group(EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+static bool is_coro_call(const CoCtx *c, const EmpExpr *e) {
+    if (!e || e->kind != EMP_EXPR_CALL) return false;
+    const EmpExpr *callee = e->as.call.callee;
+    if (!callee || callee->kind != EMP_EXPR_IDENT) return false;
+    for (size_t i = 0; i < c->program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)c->program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_FN || !emp_fn_is_coroutine(&it->as.fn)) continue;
+        if (slice_eq(it->as.fn.name, callee->as.lit) || slice_eq(it->as.fn.name, e->as.call.resolved_name)) return true;
+    }
+    return false;
+}
+
+static bool is_block_on(const EmpExpr *e) {
+    return e && e->kind == EMP_EXPR_CALL && e->as.call.callee && e->as.call.callee->kind == EMP_EXPR_IDENT &&
+           slice_is(e->as.call.callee->as.lit, "block_on") && e->as.call.args.len == 1;
+}
+
+static void set_elide(CoCtx *c, EmpExpr *call) {
+    if (call->as.call.coro_elide) return;
+    call->as.call.coro_elide = true;
+    c->stats.elided++;
+}
+
+// A coroutine call whose handle is consumed where it is made.
+static void elide_direct(CoCtx *c, EmpExpr *e) {
+    e = strip_group(e);
+    if (is_coro_call(c, e)) set_elide(c, e);
+}
+
+// ----- Uses of a local handle -----
+
+typedef struct CoUses {
+    EmpSlice name;
+    size_t all;      // identifier uses of `name`
+    size_t consumed; // of those, as a `for` iterable, `await` operand or `block_on` argument
+} CoUses;
+
+static bool is_name(const EmpExpr *e, EmpSlice name) {
+    e = strip_group((EmpExpr *)e);
+    return e && e->kind == EMP_EXPR_IDENT && slice_eq(e->as.lit, name);
+}
+
+static void uses_expr(CoUses *u, const EmpExpr *e);
+static void uses_stmt(CoUses *u, const EmpStmt *s);
+
+static void uses_exprs(CoUses *u, const EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) uses_expr(u, (const EmpExpr *)v->items[i]);
+}
+
+static void uses_expr(CoUses *u, const EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_IDENT:
+            if (slice_eq(e->as.lit, u->name)) u->all++;
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) uses_expr(u, pt->expr);
+            }
+            return;
+        case EMP_EXPR_UNARY:
+            if (e->as.unary.op == EMP_UN_AWAIT && is_name(e->as.unary.rhs, u->name)) u->consumed++;
+            uses_expr(u, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            uses_expr(u, e->as.binary.lhs);
+            uses_expr(u, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            if (is_block_on(e) && is_name((const EmpExpr *)e->as.call.args.items[0], u->name)) u->consumed++;
+            uses_expr(u, e->as.call.callee);
+            uses_exprs(u, &e->as.call.args);
+            return;
+        case EMP_EXPR_GROUP:
+            uses_expr(u, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            uses_expr(u, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE:
+            uses_exprs(u, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            uses_exprs(u, &e->as.list.items);
+            return;
+        case EMP_EXPR_INDEX:
+            uses_expr(u, e->as.index.base);
+            uses_expr(u, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER:
+            uses_expr(u, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            uses_exprs(u, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TERNARY:
+            uses_expr(u, e->as.ternary.cond);
+            uses_expr(u, e->as.ternary.then_expr);
+            uses_expr(u, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            uses_expr(u, e->as.range.start);
+            uses_expr(u, e->as.range.end);
+            return;
+        default:
+            return;
+    }
+}
+
+static void uses_stmt(CoUses *u, const EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            uses_expr(u, s->as.let_stmt.init);
+            return;
+        case EMP_STMT_DEFER:
+            uses_stmt(u, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            uses_expr(u, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            uses_expr(u, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            uses_expr(u, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) uses_stmt(u, (const EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            uses_expr(u, s->as.if_stmt.cond);
+            uses_stmt(u, s->as.if_stmt.then_branch);
+            uses_stmt(u, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            uses_expr(u, s->as.while_stmt.cond);
+            uses_stmt(u, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            if (s->as.for_stmt.lowering == EMP_FOR_GEN && is_name(s->as.for_stmt.iterable, u->name)) u->consumed++;
+            uses_expr(u, s->as.for_stmt.iterable);
+            uses_stmt(u, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            uses_expr(u, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm) uses_stmt(u, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            uses_stmt(u, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            uses_stmt(u, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+// ----- Planning -----
+
+typedef struct CoFn {
+    CoCtx *c;
+    const EmpStmt *body; // where uses of locals are counted
+} CoFn;
+
+static void plan_expr(CoFn *f, EmpExpr *e);
+static void plan_stmt(CoFn *f, EmpStmt *s);
+
+static void plan_exprs(CoFn *f, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) plan_expr(f, (EmpExpr *)v->items[i]);
+}
+
+static void plan_expr(CoFn *f, EmpExpr *e) {
+    if (!e) return;
+    CoCtx *c = f->c;
+
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) plan_expr(f, pt->expr);
+            }
+            return;
+        case EMP_EXPR_UNARY:
+            plan_expr(f, e->as.unary.rhs);
+            if (e->as.unary.op == EMP_UN_AWAIT) {
+                // The child task runs to completion before the parent moves on.
+                elide_direct(c, e->as.unary.rhs);
+                e->as.unary.suspend_index = ++c->next;
+            }
+            return;
+        case EMP_EXPR_BINARY:
+            plan_expr(f, e->as.binary.lhs);
+            plan_expr(f, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            e->as.call.coro_elide = false; // set again below by whatever consumes the handle
+            plan_expr(f, e->as.call.callee);
+            plan_exprs(f, &e->as.call.args);
+            if (is_block_on(e)) elide_direct(c, (EmpExpr *)e->as.call.args.items[0]);
+            if (is_coro_call(c, e)) c->stats.calls++;
+            return;
+        case EMP_EXPR_GROUP:
+            plan_expr(f, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            plan_expr(f, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE:
+            plan_exprs(f, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            plan_exprs(f, &e->as.list.items);
+            return;
+        case EMP_EXPR_INDEX:
+            plan_expr(f, e->as.index.base);
+            plan_expr(f, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER:
+            plan_expr(f, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            plan_exprs(f, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TERNARY:
+            plan_expr(f, e->as.ternary.cond);
+            plan_expr(f, e->as.ternary.then_expr);
+            plan_expr(f, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            plan_expr(f, e->as.range.start);
+            plan_expr(f, e->as.range.end);
+            return;
+        default:
+            return;
+    }
+}
+
+static void plan_stmt(CoFn *f, EmpStmt *s) {
+    if (!s) return;
+    CoCtx *c = f->c;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR: {
+            plan_expr(f, s->as.let_stmt.init);
+            EmpExpr *init = strip_group(s->as.let_stmt.init);
+            if (!s->as.let_stmt.is_destructure && is_coro_call(c, init)) {
+                CoUses u;
+                memset(&u, 0, sizeof(u));
+                u.name = s->as.let_stmt.name;
+                uses_stmt(&u, f->body);
+                if (u.all == u.consumed) set_elide(c, init);
+            }
+            return;
+        }
+        case EMP_STMT_DEFER:
+            plan_stmt(f, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            plan_expr(f, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            plan_expr(f, s->as.yield_stmt.value);
+            s->as.yield_stmt.index = ++c->next;
+            return;
+        case EMP_STMT_EXPR:
+            plan_expr(f, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) plan_stmt(f, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            plan_expr(f, s->as.if_stmt.cond);
+            plan_stmt(f, s->as.if_stmt.then_branch);
+            plan_stmt(f, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            plan_expr(f, s->as.while_stmt.cond);
+            plan_stmt(f, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            plan_expr(f, s->as.for_stmt.iterable);
+            if (s->as.for_stmt.lowering == EMP_FOR_GEN) elide_direct(c, s->as.for_stmt.iterable);
+            plan_stmt(f, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            plan_expr(f, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm) plan_stmt(f, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            plan_stmt(f, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            plan_stmt(f, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+static void plan_body(CoCtx *c, EmpStmt *body, EmpItemFn *fn) {
+    CoFn f;
+    f.c = c;
+    f.body = body;
+    c->next = 0;
+    plan_stmt(&f, body);
+    if (!fn) return;
+    fn->suspends = c->next;
+    if (fn->coro == EMP_CORO_GEN) c->stats.generators++;
+    else if (fn->coro == EMP_CORO_TASK) c->stats.tasks++;
+    if (fn->coro) c->stats.suspends += c->next;
+}
+
+void emp_sem_plan_coroutines(EmpProgram *program, EmpCoroStats *out_stats) {
+    CoCtx c;
+    memset(&c, 0, sizeof(c));
+    c.program = program;
+    for (size_t i = 0; program && i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_FN) {
+            plan_body(&c, it->as.fn.body, &it->as.fn);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) plan_body(&c, m->body, NULL);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) plan_body(&c, m->body, NULL);
+            }
+        }
+    }
+    if (out_stats) *out_stats = c.stats;
+}
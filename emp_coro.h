@@ -0,0 +1,41 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EmpCoroStats {
+    size_t generators; // fns returning `Gen[T]` (EMP_CORO_GEN)
+    size_t tasks;      // `async fn`s (EMP_CORO_TASK)
+    size_t suspends;   // `yield` / `await` points over all of them
+    size_t calls;      // calls of generators and async fns
+    size_t elided;     // of those, frames kept off the heap (EmpExpr.call.coro_elide)
+} EmpCoroStats;
+
+// True for a generator or `async fn`, including import decls of one (which have no body, so
+// typecheck leaves their `coro` unset): a call returns a handle to a frame that keeps the
+// arguments.
+bool emp_fn_is_coroutine(const EmpItemFn *fn);
+
+// Coroutine planning (run on the checked program, after emp_sem_insert_drops).
+//
+// Every generator and async fn becomes a `switch`-ABI LLVM coroutine (Mds/ABI.md,
+// "Coroutines"). This pass numbers the suspend points of each body in source order
+// (yield_stmt.index, unary.suspend_index for `await`, EmpItemFn.suspends): suspend point k is
+// case k of the resume `switch`, so codegen and the frame layout agree on it.
+//
+// A call gets coro_elide when the handle it returns cannot outlive the caller:
+// - it is the iterable of a `for`, the operand of `await`, or the argument of `block_on`;
+// - or it initializes a local whose only uses are those.
+// Codegen then inlines the ramp into the caller, and LLVM's CoroElide replaces
+// `llvm.coro.alloc`/`free` with a slot in the caller's frame (in a coroutine caller, its own
+// frame). Other handles are stored, returned or passed on and keep their heap frame.
+//
+// `out_stats` may be NULL.
+void emp_sem_plan_coroutines(EmpProgram *program, EmpCoroStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
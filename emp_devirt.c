@@ -0,0 +1,451 @@
+#include "emp_devirt.h"
+
+#include "emp_typecheck.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum DvMode {
+    DV_CASTS, // collect (base, concrete) pairs from `*Concrete as dyn Base`
+    DV_FACTS, // collect per-local definitions
+    DV_CALLS, // annotate dyn calls
+} DvMode;
+
+typedef struct DvPair {
+    EmpSlice base;
+    EmpSlice concrete;
+} DvPair;
+
+typedef struct DvVar {
+    EmpSlice name;
+    size_t bindings;
+    EmpSlice concrete; // class every definition casts from
+    bool unknown;
+} DvVar;
+
+typedef struct DvCtx {
+    EmpProgram *program;
+    DvMode mode;
+    unsigned unsafe_depth;
+
+    DvPair *pairs;
+    size_t npairs;
+    size_t pairs_cap;
+
+    EmpSlice *open; // bases a vtable may come from outside the program for
+    size_t nopen;
+    size_t open_cap;
+
+    DvVar *vars;
+    size_t nvars;
+    size_t vars_cap;
+
+    EmpDevirtStats stats;
+} DvCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static const EmpExpr *strip_group(const EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+static bool grow(void **items, size_t *cap, size_t need, size_t elem) {
+    if (need <= *cap) return true;
+    size_t nc = *cap ? *cap * 2 : 16;
+    while (nc < need) nc *= 2;
+    void *p = realloc(*items, nc * elem);
+    if (!p) return false;
+    *items = p;
+    *cap = nc;
+    return true;
+}
+
+// ===== Class hierarchy facts =====
+
+static void pair_add(DvCtx *c, EmpSlice base, EmpSlice concrete) {
+    if (!base.len || !concrete.len) return;
+    for (size_t i = 0; i < c->npairs; i++) {
+        if (slice_eq(c->pairs[i].base, base) && slice_eq(c->pairs[i].concrete, concrete)) return;
+    }
+    if (!grow((void **)&c->pairs, &c->pairs_cap, c->npairs + 1, sizeof(DvPair))) return;
+    c->pairs[c->npairs++] = (DvPair){ .base = base, .concrete = concrete };
+}
+
+static bool base_is_open(const DvCtx *c, EmpSlice base) {
+    for (size_t i = 0; i < c->nopen; i++) {
+        if (slice_eq(c->open[i], base)) return true;
+    }
+    return false;
+}
+
+static void mark_open_type(DvCtx *c, const EmpType *t) {
+    if (!t) return;
+    switch (t->kind) {
+        case EMP_TYPE_DYN:
+            if (base_is_open(c, t->as.dyn.base_name)) return;
+            if (!grow((void **)&c->open, &c->open_cap, c->nopen + 1, sizeof(EmpSlice))) return;
+            c->open[c->nopen++] = t->as.dyn.base_name;
+            return;
+        case EMP_TYPE_PTR:
+            mark_open_type(c, t->as.ptr.pointee);
+            return;
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            mark_open_type(c, t->as.array.elem);
+            return;
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                if (f) mark_open_type(c, f->ty);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static void mark_open_sig(DvCtx *c, const EmpVec *params, const EmpType *ret_ty) {
+    for (size_t i = 0; params && i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (p) mark_open_type(c, p->ty);
+    }
+    mark_open_type(c, ret_ty);
+}
+
+// ===== Locals =====
+
+static DvVar *var_get(DvCtx *c, EmpSlice name, bool create) {
+    for (size_t i = 0; i < c->nvars; i++) {
+        if (slice_eq(c->vars[i].name, name)) return &c->vars[i];
+    }
+    if (!create || !name.len) return NULL;
+    if (!grow((void **)&c->vars, &c->vars_cap, c->nvars + 1, sizeof(DvVar))) return NULL;
+    DvVar *v = &c->vars[c->nvars++];
+    memset(v, 0, sizeof(*v));
+    v->name = name;
+    return v;
+}
+
+static void var_unknown(DvCtx *c, EmpSlice name) {
+    DvVar *v = var_get(c, name, true);
+    if (v) v->unknown = true;
+}
+
+// Records one definition `name = rhs`.
+static void var_def(DvCtx *c, EmpSlice name, const EmpExpr *rhs) {
+    DvVar *v = var_get(c, name, true);
+    if (!v) return;
+    rhs = strip_group(rhs);
+    if (c->unsafe_depth || !rhs || rhs->kind != EMP_EXPR_CAST || !rhs->as.cast.dyn_concrete_name.len) {
+        v->unknown = true;
+    } else if (!v->concrete.len) {
+        v->concrete = rhs->as.cast.dyn_concrete_name;
+    } else if (!slice_eq(v->concrete, rhs->as.cast.dyn_concrete_name)) {
+        v->unknown = true;
+    }
+}
+
+static void var_declare(DvCtx *c, EmpSlice name, bool unknown) {
+    DvVar *v = var_get(c, name, true);
+    if (!v) return;
+    v->bindings++;
+    if (unknown) v->unknown = true;
+}
+
+// Concrete class of a dyn receiver, when known locally.
+static EmpSlice receiver_class(DvCtx *c, const EmpExpr *recv) {
+    recv = strip_group(recv);
+    if (!recv) return (EmpSlice){0};
+    if (recv->kind == EMP_EXPR_CAST) return recv->as.cast.dyn_concrete_name;
+    if (recv->kind == EMP_EXPR_IDENT) {
+        const DvVar *v = var_get(c, recv->as.lit, false);
+        if (v && v->bindings == 1 && !v->unknown) return v->concrete;
+    }
+    return (EmpSlice){0};
+}
+
+static void annotate_call(DvCtx *c, EmpExpr *e) {
+    const EmpClassMethod *vm = e->as.call.dyn_method;
+    e->as.call.devirt_count = 0;
+    e->as.call.devirt_guarded = false;
+    if (!vm) return;
+    c->stats.dyn_calls++;
+
+    const EmpExpr *callee = strip_group(e->as.call.callee);
+    EmpSlice known = (callee && callee->kind == EMP_EXPR_MEMBER) ? receiver_class(c, callee->as.member.base) : (EmpSlice){0};
+    if (known.len) {
+        if (!emp_sem_has_exact_override(c->program, known, vm)) return;
+        e->as.call.devirt_class[0] = known;
+        e->as.call.devirt_count = 1;
+        c->stats.direct++;
+        return;
+    }
+
+    EmpSlice base = e->as.call.dyn_base_name;
+    size_t n = 0;
+    for (size_t i = 0; i < c->npairs; i++) {
+        if (!slice_eq(c->pairs[i].base, base)) continue;
+        if (n == EMP_DEVIRT_MAX_CLASSES || !emp_sem_has_exact_override(c->program, c->pairs[i].concrete, vm)) {
+            e->as.call.devirt_count = 0;
+            return;
+        }
+        e->as.call.devirt_class[n] = c->pairs[i].concrete;
+        e->as.call.devirt_count = (uint8_t)++n;
+    }
+    if (!n) return;
+
+    if (n == 1 && !base_is_open(c, base)) {
+        c->stats.direct++;
+    } else {
+        e->as.call.devirt_guarded = true;
+        c->stats.guarded++;
+    }
+}
+
+// ===== Walk =====
+
+static void walk_expr(DvCtx *c, EmpExpr *e);
+
+static void walk_exprs(DvCtx *c, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) walk_expr(c, (EmpExpr *)v->items[i]);
+}
+
+static void walk_expr(DvCtx *c, EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_IDENT:
+            if (c->mode == DV_FACTS && c->unsafe_depth) var_unknown(c, e->as.lit);
+            return;
+        case EMP_EXPR_GROUP:
+            walk_expr(c, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            if (c->mode == DV_CASTS && e->as.cast.ty && e->as.cast.ty->kind == EMP_TYPE_DYN) {
+                pair_add(c, e->as.cast.ty->as.dyn.base_name, e->as.cast.dyn_concrete_name);
+            }
+            walk_expr(c, e->as.cast.expr);
+            return;
+        case EMP_EXPR_UNARY:
+            if (c->mode == DV_FACTS && e->as.unary.op == EMP_UN_BORROW_MUT) {
+                const EmpExpr *rhs = strip_group(e->as.unary.rhs);
+                if (rhs && rhs->kind == EMP_EXPR_IDENT) var_unknown(c, rhs->as.lit);
+            }
+            walk_expr(c, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            if (c->mode == DV_FACTS && e->as.binary.op >= EMP_BIN_ASSIGN && e->as.binary.op <= EMP_BIN_BITXOR_ASSIGN) {
+                const EmpExpr *lhs = strip_group(e->as.binary.lhs);
+                if (lhs && lhs->kind == EMP_EXPR_IDENT) {
+                    if (e->as.binary.op == EMP_BIN_ASSIGN) var_def(c, lhs->as.lit, e->as.binary.rhs);
+                    else var_unknown(c, lhs->as.lit);
+                }
+            }
+            walk_expr(c, e->as.binary.lhs);
+            walk_expr(c, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            if (c->mode == DV_CALLS) annotate_call(c, e);
+            walk_expr(c, e->as.call.callee);
+            walk_exprs(c, &e->as.call.args);
+            return;
+        case EMP_EXPR_MEMBER:
+            walk_expr(c, e->as.member.base);
+            return;
+        case EMP_EXPR_INDEX:
+            walk_expr(c, e->as.index.base);
+            walk_expr(c, e->as.index.index);
+            return;
+        case EMP_EXPR_NEW:
+            walk_exprs(c, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TUPLE:
+            walk_exprs(c, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            walk_exprs(c, &e->as.list.items);
+            return;
+        case EMP_EXPR_TERNARY:
+            walk_expr(c, e->as.ternary.cond);
+            walk_expr(c, e->as.ternary.then_expr);
+            walk_expr(c, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            walk_expr(c, e->as.range.start);
+            walk_expr(c, e->as.range.end);
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) walk_expr(c, pt->expr);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static void walk_pattern(DvCtx *c, const EmpExpr *pat) {
+    if (!pat || c->mode != DV_FACTS) return;
+    if (pat->kind == EMP_EXPR_IDENT) {
+        var_declare(c, pat->as.lit, true);
+    } else if (pat->kind == EMP_EXPR_CALL) {
+        for (size_t i = 0; i < pat->as.call.args.len; i++) walk_pattern(c, (const EmpExpr *)pat->as.call.args.items[i]);
+    } else if (pat->kind == EMP_EXPR_TUPLE) {
+        for (size_t i = 0; i < pat->as.tuple.items.len; i++) walk_pattern(c, (const EmpExpr *)pat->as.tuple.items.items[i]);
+    } else if (pat->kind == EMP_EXPR_GROUP) {
+        walk_pattern(c, pat->as.group.inner);
+    }
+}
+
+static void walk_stmt(DvCtx *c, EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            walk_expr(c, s->as.let_stmt.init);
+            if (c->mode != DV_FACTS) return;
+            if (s->as.let_stmt.is_destructure) {
+                for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                    const EmpSlice *nm = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                    if (nm) var_declare(c, *nm, true);
+                }
+                return;
+            }
+            var_declare(c, s->as.let_stmt.name, false);
+            var_def(c, s->as.let_stmt.name, s->as.let_stmt.init);
+            return;
+        case EMP_STMT_DEFER:
+            walk_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            walk_expr(c, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            walk_expr(c, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            walk_expr(c, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) walk_stmt(c, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            walk_expr(c, s->as.if_stmt.cond);
+            walk_stmt(c, s->as.if_stmt.then_branch);
+            walk_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            walk_expr(c, s->as.while_stmt.cond);
+            walk_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            if (c->mode == DV_FACTS) {
+                if (s->as.for_stmt.idx_name.len) var_declare(c, s->as.for_stmt.idx_name, true);
+                if (s->as.for_stmt.val_name.len) var_declare(c, s->as.for_stmt.val_name, true);
+            }
+            walk_expr(c, s->as.for_stmt.iterable);
+            walk_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            walk_expr(c, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                walk_pattern(c, arm->pat);
+                walk_stmt(c, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            c->unsafe_depth++;
+            walk_stmt(c, s->as.emp_off.body);
+            c->unsafe_depth--;
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            c->unsafe_depth++;
+            walk_stmt(c, s->as.emp_mm_off.body);
+            c->unsafe_depth--;
+            return;
+        default:
+            return;
+    }
+}
+
+static void walk_body(DvCtx *c, const EmpVec *params, EmpStmt *body) {
+    if (!body) return;
+    if (c->mode == DV_CASTS) {
+        walk_stmt(c, body);
+        return;
+    }
+
+    c->nvars = 0;
+    c->unsafe_depth = 0;
+    c->mode = DV_FACTS;
+    for (size_t i = 0; params && i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (p) var_declare(c, p->name, true);
+    }
+    walk_stmt(c, body);
+
+    c->unsafe_depth = 0;
+    c->mode = DV_CALLS;
+    walk_stmt(c, body);
+}
+
+static void walk_program(DvCtx *c) {
+    EmpProgram *p = c->program;
+    for (size_t i = 0; i < p->items.len; i++) {
+        EmpItem *it = (EmpItem *)p->items.items[i];
+        if (!it) continue;
+
+        if (it->kind == EMP_ITEM_FN) {
+            if (c->mode == DV_CASTS && (it->as.fn.is_exported || it->as.fn.is_extern)) {
+                mark_open_sig(c, &it->as.fn.params, it->as.fn.ret_ty);
+            }
+            walk_body(c, &it->as.fn.params, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (!m) continue;
+                if (c->mode == DV_CASTS && (it->as.class_decl.is_exported || m->is_exported)) {
+                    mark_open_sig(c, &m->params, m->ret_ty);
+                }
+                walk_body(c, &m->params, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (!m) continue;
+                if (c->mode == DV_CASTS && m->is_exported) mark_open_sig(c, &m->params, m->ret_ty);
+                walk_body(c, &m->params, m->body);
+            }
+        }
+    }
+}
+
+void emp_sem_devirtualize(EmpProgram *program, EmpDevirtStats *out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+
+    DvCtx c;
+    memset(&c, 0, sizeof(c));
+    c.program = program;
+
+    c.mode = DV_CASTS;
+    walk_program(&c);
+
+    c.mode = DV_FACTS;
+    walk_program(&c);
+
+    free(c.pairs);
+    free(c.open);
+    free(c.vars);
+    if (out_stats) *out_stats = c.stats;
+}
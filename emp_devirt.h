@@ -0,0 +1,33 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EmpDevirtStats {
+    size_t dyn_calls; // calls through a `dyn Base` vtable
+    size_t direct;    // turned into a direct call (one possible target)
+    size_t guarded;   // speculated on a few classes, indirect call kept as fallback
+} EmpDevirtStats;
+
+// Devirtualization of `dyn Base` method calls over the checked program (run after typecheck,
+// which records dyn_method/dyn_slot on calls and dyn_concrete_name on casts).
+//
+// The concrete class of a receiver is known when it is:
+// - a cast itself: `(&c as dyn Base).m()`;
+// - a local whose every definition (`let d = &c as dyn Base`, `d = &c2 as dyn Base`) casts from
+//   the same class, and which is never borrowed mutably or touched in `@emp off`.
+// Otherwise class hierarchy analysis collects the classes cast to `dyn Base` anywhere in the
+// program. `dyn Base` is closed when no exported or extern function/method mentions it in its
+// signature (nothing outside the program can hand us another vtable); a closed base with one
+// such class gets a direct call, and up to EMP_DEVIRT_MAX_CLASSES classes (closed or not) get
+// guarded speculative calls.
+//
+// Results go to EmpExpr.call.devirt_class/devirt_count/devirt_guarded. `out_stats` may be NULL.
+void emp_sem_devirtualize(EmpProgram *program, EmpDevirtStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
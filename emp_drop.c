@@ -5,6 +5,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+static bool g_drop_flags = false;
+
+void emp_set_drop_flags(bool enabled) {
+    g_drop_flags = enabled;
+}
+
+bool emp_drop_flags(void) {
+    return g_drop_flags;
+}
+
 typedef enum EmpDropState {
     EMP_DROP_UNINIT = 0,
     EMP_DROP_LIVE = 1,
@@ -17,6 +27,8 @@ typedef struct EmpDropBind {
     EmpSpan decl_span;
     bool owned;
     int state; // EmpDropState
+    const void *id; // declaring node (let stmt, param, ...): identity across scopes
+    bool *flag;     // let_stmt.drop_flag / EmpParam.drop_flag; NULL when the binding cannot have one
 } EmpDropBind;
 
 typedef struct EmpDropStack {
@@ -29,6 +41,46 @@ typedef struct EmpDropStack {
     size_t scopes_cap;
 } EmpDropStack;
 
+// A move of an outer binding inside a branch; becomes a FORGET drop after the statement.
+typedef struct EmpDropMove {
+    EmpSlice name;
+    bool *flag;
+    EmpSpan span;
+} EmpDropMove;
+
+typedef struct EmpDropMoves {
+    EmpDropMove *items;
+    size_t len;
+    size_t cap;
+} EmpDropMoves;
+
+typedef struct EmpDropForget {
+    EmpStmt *stmt;
+    const bool *flag;
+} EmpDropForget;
+
+typedef struct EmpDropForgets {
+    EmpDropForget *items;
+    size_t len;
+    size_t cap;
+} EmpDropForgets;
+
+// Drop sequence in front of a `return`/`break`/`continue`, interned per function so exits that
+// clean up identically share one EmpStmt.drop_stmt.cleanup id.
+typedef struct EmpDropExit {
+    EmpStmtKind kind;
+    size_t loop_depth; // break/continue target
+    const void **ids;
+    EmpDropMode *modes;
+    size_t n;
+} EmpDropExit;
+
+typedef struct EmpDropExits {
+    EmpDropExit *items;
+    size_t len;
+    size_t cap;
+} EmpDropExits;
+
 typedef enum EmpUseKind {
     EMP_USE_READ,
     EMP_USE_MOVE,
@@ -45,6 +97,14 @@ typedef struct EmpDropCtx {
     // Used to insert drops on `break`/`continue` for loop-local bindings.
     size_t loop_marks[64];
     size_t loop_depth;
+
+    // ds.len when the innermost branch (if/match arm/loop body) was entered; bindings below it
+    // that are moved inside the branch may need a drop flag. Shared per-function state below
+    // survives the context copies made for branches.
+    size_t branch_mark;
+    EmpDropMoves *moves;
+    EmpDropForgets *forgets;
+    EmpDropExits *exits;
 } EmpDropCtx;
 
 static void loop_push(EmpDropCtx *c) {
@@ -150,13 +210,68 @@ static const EmpEnumVariant *drop_find_enum_variant(const EmpItem *en, EmpSlice
                     "f32",
                     "f64",
                 };
-                return slice_is_one_of(ty->as.name, copy_names, sizeof(copy_names) / sizeof(copy_names[0]));
+                return slice_is_one_of(ty->as.name, copy_names, sizeof(copy_names) / sizeof(copy_names[0])) || emp_simd_type_parse(ty->as.name, NULL, NULL);
             }
             default:
                 return false;
         }
     }
 
+static bool fields_are_trivial(const EmpVec *types_or_fields, bool struct_fields, unsigned depth);
+
+// Values that own nothing never need a drop: copy-like scalars and raw pointers, and arrays,
+// tuples, structs and enums built only from such types. Classes, lists, strings and `dyn` own
+// storage. Unknown names are assumed to own something.
+static bool type_is_trivial_depth(const EmpType *ty, unsigned depth) {
+    if (!ty || depth > 16) return false;
+    if (type_is_copy_like(ty)) return true;
+
+    switch (ty->kind) {
+        case EMP_TYPE_ARRAY:
+            return type_is_trivial_depth(ty->as.array.elem, depth + 1);
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < ty->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)ty->as.tuple.fields.items[i];
+                if (!f || !type_is_trivial_depth(f->ty, depth + 1)) return false;
+            }
+            return true;
+        case EMP_TYPE_NAME: {
+            if (emp_atomic_type_parse(ty->as.name, NULL)) return true;
+            if (!g_drop_program) return false;
+            for (size_t i = 0; i < g_drop_program->items.len; i++) {
+                const EmpItem *it = (const EmpItem *)g_drop_program->items.items[i];
+                if (!it) continue;
+                if (it->kind == EMP_ITEM_STRUCT && slice_eq(it->as.struct_decl.name, ty->as.name)) {
+                    return fields_are_trivial(&it->as.struct_decl.fields, true, depth + 1);
+                }
+                if (it->kind == EMP_ITEM_ENUM && slice_eq(it->as.enum_decl.name, ty->as.name)) {
+                    for (size_t vi = 0; vi < it->as.enum_decl.variants.len; vi++) {
+                        const EmpEnumVariant *v = (const EmpEnumVariant *)it->as.enum_decl.variants.items[vi];
+                        if (v && !fields_are_trivial(&v->fields, false, depth + 1)) return false;
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+static bool fields_are_trivial(const EmpVec *types_or_fields, bool struct_fields, unsigned depth) {
+    for (size_t i = 0; i < types_or_fields->len; i++) {
+        const void *p = types_or_fields->items[i];
+        const EmpType *ty = struct_fields ? (p ? ((const EmpStructField *)p)->ty : NULL) : (const EmpType *)p;
+        if (!type_is_trivial_depth(ty, depth)) return false;
+    }
+    return true;
+}
+
+static bool type_is_trivial(const EmpType *ty) {
+    return type_is_trivial_depth(ty, 0);
+}
+
 static void diagf(EmpArena *arena, EmpDiags *diags, EmpSpan span, const char *fmt, EmpSlice name) {
     char name_buf[128];
     size_t n = 0;
@@ -208,11 +323,11 @@ static void ds_pop_scope(EmpDropStack *ds) {
     if (mark <= ds->len) ds->len = mark;
 }
 
-static bool ds_push_bind(EmpDropStack *ds, EmpSlice name, EmpSpan decl_span, bool owned, EmpDropState init_state) {
+static EmpDropBind *ds_push_bind(EmpDropStack *ds, EmpSlice name, EmpSpan decl_span, bool owned, EmpDropState init_state) {
     if (ds->len + 1 > ds->cap) {
         size_t new_cap = ds->cap ? ds->cap * 2 : 32;
         EmpDropBind *p = (EmpDropBind *)realloc(ds->items, new_cap * sizeof(EmpDropBind));
-        if (!p) return false;
+        if (!p) return NULL;
         ds->items = p;
         ds->cap = new_cap;
     }
@@ -221,7 +336,18 @@ static bool ds_push_bind(EmpDropStack *ds, EmpSlice name, EmpSpan decl_span, boo
     b->decl_span = decl_span;
     b->owned = owned;
     b->state = (int)init_state;
-    return true;
+    b->id = NULL;
+    b->flag = NULL;
+    return b;
+}
+
+// Binds `name` and records its declaring node and drop-flag slot.
+static void ds_push_decl(EmpDropStack *ds, EmpSlice name, EmpSpan decl_span, bool owned, EmpDropState init_state, const void *id, bool *flag) {
+    EmpDropBind *b = ds_push_bind(ds, name, decl_span, owned, init_state);
+    if (!b) return;
+    b->id = id;
+    b->flag = g_drop_flags ? flag : NULL;
+    if (b->flag) *b->flag = false;
 }
 
 static EmpDropBind *ds_lookup(EmpDropStack *ds, EmpSlice name) {
@@ -342,6 +468,42 @@ static EmpSlice make_tmp_name(EmpDropCtx *c) {
 static void visit_expr(EmpDropCtx *c, const EmpExpr *e, EmpUseKind use);
 static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated);
 
+static void queue_branch_move(EmpDropCtx *c, const EmpDropBind *b, EmpSpan span) {
+    EmpDropMoves *m = c->moves;
+    if (!m || !b->flag) return;
+    if (m->len + 1 > m->cap) {
+        size_t nc = m->cap ? m->cap * 2 : 16;
+        EmpDropMove *p = (EmpDropMove *)realloc(m->items, nc * sizeof(EmpDropMove));
+        if (!p) return;
+        m->items = p;
+        m->cap = nc;
+    }
+    m->items[m->len++] = (EmpDropMove){b->name, b->flag, span};
+}
+
+// Appends FORGET drops for the branch moves queued since `mark` (only the flags that end up
+// needed survive; see prune_forgets).
+static void append_forgets(EmpDropCtx *c, EmpVec *out, size_t mark) {
+    EmpDropMoves *m = c->moves;
+    EmpDropForgets *f = c->forgets;
+    if (!m || !f) return;
+    for (size_t i = mark; i < m->len; i++) {
+        EmpStmt *d = make_drop_stmt(c->arena, m->items[i].span, m->items[i].name);
+        if (!d) continue;
+        d->as.drop_stmt.mode = EMP_DROP_MODE_FORGET;
+        if (f->len + 1 > f->cap) {
+            size_t nc = f->cap ? f->cap * 2 : 16;
+            EmpDropForget *p = (EmpDropForget *)realloc(f->items, nc * sizeof(EmpDropForget));
+            if (!p) continue;
+            f->items = p;
+            f->cap = nc;
+        }
+        f->items[f->len++] = (EmpDropForget){d, m->items[i].flag};
+        (void)emp_vec_push(out, d);
+    }
+    m->len = mark;
+}
+
 static void use_ident(EmpDropCtx *c, EmpSpan span, EmpSlice name, EmpUseKind use) {
     EmpDropBind *b = ds_lookup(&c->ds, name);
     if (!b) return;
@@ -350,6 +512,7 @@ static void use_ident(EmpDropCtx *c, EmpSpan span, EmpSlice name, EmpUseKind use
     if (use == EMP_USE_MOVE) {
         if (b->state == EMP_DROP_LIVE) {
             b->state = EMP_DROP_MOVED;
+            if ((size_t)(b - c->ds.items) < c->branch_mark) queue_branch_move(c, b, span);
         } else if (b->state == EMP_DROP_UNINIT) {
             // moving an uninitialized value isn't handled yet; ownership pass should diagnose
             b->state = EMP_DROP_MOVED;
@@ -421,6 +584,9 @@ static void visit_expr(EmpDropCtx *c, const EmpExpr *e, EmpUseKind use) {
         case EMP_EXPR_UNARY:
             if (e->as.unary.op == EMP_UN_BORROW || e->as.unary.op == EMP_UN_BORROW_MUT) {
                 visit_expr(c, e->as.unary.rhs, EMP_USE_READ);
+            } else if (e->as.unary.op == EMP_UN_AWAIT) {
+                // The task runs to completion and its frame is freed inside the await.
+                visit_expr(c, e->as.unary.rhs, EMP_USE_MOVE);
             } else {
                 visit_expr(c, e->as.unary.rhs, use);
             }
@@ -450,17 +616,29 @@ static void visit_expr(EmpDropCtx *c, const EmpExpr *e, EmpUseKind use) {
     }
 }
 
+// Appends the drop of `b` if it still owns a value. A maybe-moved binding gets a drop guarded by
+// its drop flag instead; returns false when it cannot have one (loop/destructured bindings).
+static bool append_drop(EmpDropCtx *c, EmpVec *out, EmpDropBind *b, EmpSpan at_span) {
+    EmpDropState st = (EmpDropState)b->state;
+    if (st != EMP_DROP_LIVE && st != EMP_DROP_MAYBE_MOVED) return true;
+    if (st == EMP_DROP_MAYBE_MOVED && !b->flag) return false;
+
+    EmpStmt *d = make_drop_stmt(c->arena, at_span, b->name);
+    if (!d) return true;
+    if (st == EMP_DROP_MAYBE_MOVED) {
+        d->as.drop_stmt.mode = EMP_DROP_MODE_IF_FLAG;
+        *b->flag = true;
+    }
+    (void)emp_vec_push(out, d);
+    return true;
+}
+
 static void append_scope_end_drops(EmpDropCtx *c, EmpVec *out) {
     size_t mark = ds_scope_mark(&c->ds);
     for (size_t i = c->ds.len; i > mark; i--) {
         EmpDropBind *b = &c->ds.items[i - 1];
         if (!b->owned) continue;
-
-        EmpDropState st = (EmpDropState)b->state;
-        if (st == EMP_DROP_LIVE) {
-            EmpStmt *d = make_drop_stmt(c->arena, b->decl_span, b->name);
-            if (d) (void)emp_vec_push(out, d);
-        } else if (st == EMP_DROP_MAYBE_MOVED) {
+        if (!append_drop(c, out, b, b->decl_span)) {
             diagf(c->arena, c->diags, b->decl_span, "drop: cannot insert drop for '%s' because it may be moved on some path", b->name);
         }
     }
@@ -470,32 +648,78 @@ static void append_drops_since_mark(EmpDropCtx *c, EmpVec *out, size_t mark, Emp
     for (size_t i = c->ds.len; i > mark; i--) {
         EmpDropBind *b = &c->ds.items[i - 1];
         if (!b->owned) continue;
-
-        EmpDropState st = (EmpDropState)b->state;
-        if (st == EMP_DROP_LIVE) {
-            EmpStmt *d = make_drop_stmt(c->arena, at_span, b->name);
-            if (d) (void)emp_vec_push(out, d);
-        } else if (st == EMP_DROP_MAYBE_MOVED) {
+        if (!append_drop(c, out, b, at_span)) {
             diagf(c->arena, c->diags, at_span, "drop: value '%s' may be moved at break/continue", b->name);
         }
     }
 }
 
-static void append_return_drops(EmpDropCtx *c, EmpVec *out, EmpSpan at_span) {
+static void append_all_drops(EmpDropCtx *c, EmpVec *out, EmpSpan at_span, const char *moved_fmt) {
     // Drop all live owned bindings in reverse order.
     // NOTE: We do not mutate states here, because this is path-specific.
     for (size_t i = c->ds.len; i > 0; i--) {
         EmpDropBind *b = &c->ds.items[i - 1];
         if (!b->owned) continue;
-        if ((EmpDropState)b->state == EMP_DROP_LIVE) {
-            EmpStmt *d = make_drop_stmt(c->arena, at_span, b->name);
-            if (d) (void)emp_vec_push(out, d);
-        } else if ((EmpDropState)b->state == EMP_DROP_MAYBE_MOVED) {
-            diagf(c->arena, c->diags, at_span, "drop: value '%s' may be moved at return", b->name);
+        if (!append_drop(c, out, b, at_span)) {
+            diagf(c->arena, c->diags, at_span, moved_fmt, b->name);
         }
     }
 }
 
+static bool exit_matches(const EmpDropExit *x, EmpStmtKind kind, size_t loop_depth, const void **ids, const EmpDropMode *modes, size_t n) {
+    if (x->kind != kind || x->n != n) return false;
+    if (kind != EMP_STMT_RETURN && x->loop_depth != loop_depth) return false;
+    for (size_t i = 0; i < n; i++) {
+        if (x->ids[i] != ids[i] || x->modes[i] != modes[i]) return false;
+    }
+    return true;
+}
+
+// Gives the drops in front of exit `s` (the last statement of `stmts`) a shared cleanup id.
+static void assign_exit_cleanup(EmpDropCtx *c, EmpVec *stmts, EmpStmtKind kind) {
+    EmpDropExits *xs = c->exits;
+    size_t n = stmts->len ? stmts->len - 1 : 0;
+    if (!xs || n == 0) return;
+
+    const void **ids = (const void **)malloc(n * sizeof(void *));
+    EmpDropMode *modes = (EmpDropMode *)malloc(n * sizeof(EmpDropMode));
+    if (!ids || !modes) {
+        free(ids);
+        free(modes);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        const EmpStmt *d = (const EmpStmt *)stmts->items[i];
+        const EmpDropBind *b = ds_lookup(&c->ds, d->as.drop_stmt.name);
+        ids[i] = b && b->id ? b->id : (const void *)d;
+        modes[i] = d->as.drop_stmt.mode;
+    }
+
+    EmpStmt *first = (EmpStmt *)stmts->items[0];
+    for (size_t i = 0; i < xs->len; i++) {
+        if (exit_matches(&xs->items[i], kind, c->loop_depth, ids, modes, n)) {
+            first->as.drop_stmt.cleanup = (uint32_t)(i + 1);
+            free(ids);
+            free(modes);
+            return;
+        }
+    }
+
+    if (xs->len + 1 > xs->cap) {
+        size_t nc = xs->cap ? xs->cap * 2 : 8;
+        EmpDropExit *p = (EmpDropExit *)realloc(xs->items, nc * sizeof(EmpDropExit));
+        if (!p) {
+            free(ids);
+            free(modes);
+            return;
+        }
+        xs->items = p;
+        xs->cap = nc;
+    }
+    xs->items[xs->len++] = (EmpDropExit){kind, c->loop_depth, ids, modes, n};
+    first->as.drop_stmt.cleanup = (uint32_t)xs->len;
+}
+
 static bool rewrite_block_scoped(EmpDropCtx *c, EmpStmt *block, bool push_new_scope) {
     if (!block || block->kind != EMP_STMT_BLOCK) return false;
 
@@ -512,12 +736,15 @@ static bool rewrite_block_scoped(EmpDropCtx *c, EmpStmt *block, bool push_new_sc
         EmpStmt *s = (EmpStmt *)block->as.block.stmts.items[i];
         if (!s) continue;
         bool term = false;
+        size_t moves_mark = c->moves ? c->moves->len : 0;
         EmpStmt *out = rewrite_stmt(c, s, &term);
         (void)emp_vec_push(&new_stmts, out);
         if (term) {
+            if (c->moves) c->moves->len = moves_mark;
             terminated = true;
             break;
         }
+        append_forgets(c, &new_stmts, moves_mark);
     }
 
     if (!terminated) {
@@ -616,8 +843,8 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
                 init_state = EMP_DROP_LIVE;
             }
 
-            // Copy-like types do not require drops.
-            if (type_is_copy_like(s->as.let_stmt.ty)) {
+            // Trivially destructible types do not require drops.
+            if (type_is_trivial(s->as.let_stmt.ty)) {
                 owned = false;
             }
 
@@ -629,13 +856,13 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
                     const EmpTupleField *f = (const EmpTupleField *)s->as.let_stmt.ty->as.tuple.fields.items[i];
                     if (!nm || !f) continue;
                     bool elem_owned = owned;
-                    if (type_is_copy_like(f->ty)) elem_owned = false;
-                    (void)ds_push_bind(&c->ds, *nm, s->span, elem_owned, init_state);
+                    if (type_is_trivial(f->ty)) elem_owned = false;
+                    ds_push_decl(&c->ds, *nm, s->span, elem_owned, init_state, nm, NULL);
                 }
                 return s;
             }
 
-            (void)ds_push_bind(&c->ds, s->as.let_stmt.name, s->span, owned, init_state);
+            ds_push_decl(&c->ds, s->as.let_stmt.name, s->span, owned, init_state, s, &s->as.let_stmt.drop_flag);
             return s;
         }
 
@@ -678,13 +905,23 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
                 if (s->as.ret.value) {
                     visit_expr(c, s->as.ret.value, EMP_USE_MOVE);
                 }
-                append_return_drops(c, &wrap->as.block.stmts, s->span);
+                append_all_drops(c, &wrap->as.block.stmts, s->span, "drop: value '%s' may be moved at return");
                 (void)emp_vec_push(&wrap->as.block.stmts, s);
+                assign_exit_cleanup(c, &wrap->as.block.stmts, s->kind);
             }
             if (out_terminated) *out_terminated = true;
             return wrap ? wrap : s;
         }
 
+        case EMP_STMT_YIELD: {
+            // The value moves to the consumer. If the consumer drops the generator while it is
+            // suspended here, the destroy edge cleans up like a `return` from this point.
+            visit_expr(c, s->as.yield_stmt.value, EMP_USE_MOVE);
+            emp_vec_init(&s->as.yield_stmt.drops);
+            append_all_drops(c, &s->as.yield_stmt.drops, s->span, "drop: value '%s' may be moved at yield");
+            return s;
+        }
+
         case EMP_STMT_BREAK:
         case EMP_STMT_CONTINUE: {
             if (!loop_active(c)) {
@@ -700,6 +937,7 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
                 emp_vec_init(&wrap->as.block.stmts);
                 append_drops_since_mark(c, &wrap->as.block.stmts, loop_mark(c), s->span);
                 (void)emp_vec_push(&wrap->as.block.stmts, s);
+                assign_exit_cleanup(c, &wrap->as.block.stmts, s->kind);
             }
             if (out_terminated) *out_terminated = true;
             return wrap ? wrap : s;
@@ -728,6 +966,8 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
             EmpDropCtx else_c = *c;
             then_c.ds = then_ds;
             else_c.ds = else_ds;
+            then_c.branch_mark = prefix;
+            else_c.branch_mark = prefix;
 
             bool then_term = false;
             (void)rewrite_stmt(&then_c, s->as.if_stmt.then_branch, &then_term);
@@ -757,6 +997,7 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
 
             EmpDropCtx body_c = *c;
             body_c.ds = body_ds;
+            body_c.branch_mark = prefix;
             {
                 loop_push(&body_c);
                 bool t = false;
@@ -784,6 +1025,7 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
 
             EmpDropCtx body_c = *c;
             body_c.ds = body_ds;
+            body_c.branch_mark = prefix;
 
             // Track loop-local drops for break/continue.
             loop_push(&body_c);
@@ -792,10 +1034,12 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
             if (s->as.for_stmt.body && s->as.for_stmt.body->kind == EMP_STMT_BLOCK) {
                 (void)ds_push_scope(&body_c.ds);
                 if (s->as.for_stmt.idx_name.ptr && s->as.for_stmt.idx_name.len && !(s->as.for_stmt.idx_name.len == 1 && s->as.for_stmt.idx_name.ptr[0] == '_')) {
-                    (void)ds_push_bind(&body_c.ds, s->as.for_stmt.idx_name, s->span, true, EMP_DROP_LIVE);
+                    // The induction variable is an integer (EmpStmt.for_stmt.idx_ty) once typecheck has run.
+                    bool idx_owned = !type_is_trivial(s->as.for_stmt.idx_ty);
+                    ds_push_decl(&body_c.ds, s->as.for_stmt.idx_name, s->span, idx_owned, EMP_DROP_LIVE, &s->as.for_stmt.idx_name, NULL);
                 }
                 if (s->as.for_stmt.val_name.ptr && s->as.for_stmt.val_name.len && !(s->as.for_stmt.val_name.len == 1 && s->as.for_stmt.val_name.ptr[0] == '_')) {
-                    (void)ds_push_bind(&body_c.ds, s->as.for_stmt.val_name, s->span, true, EMP_DROP_LIVE);
+                    ds_push_decl(&body_c.ds, s->as.for_stmt.val_name, s->span, true, EMP_DROP_LIVE, &s->as.for_stmt.val_name, NULL);
                 }
                 {
                     bool t = false;
@@ -839,6 +1083,7 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
 
                 EmpDropCtx arm_c = *c;
                 arm_c.ds = arm_ds;
+                arm_c.branch_mark = prefix;
                 bool term = false;
                 (void)rewrite_stmt(&arm_c, (EmpStmt *)a->body, &term);
                 if (!term) all_term = false;
@@ -942,6 +1187,109 @@ static EmpStmt *rewrite_stmt(EmpDropCtx *c, EmpStmt *s, bool *out_terminated) {
     }
 }
 
+static bool forget_is_unneeded(const EmpDropForgets *f, const EmpStmt *s) {
+    for (size_t i = 0; i < f->len; i++) {
+        if (f->items[i].stmt == s) return !*f->items[i].flag;
+    }
+    return false;
+}
+
+// Removes FORGET drops of bindings that never got a drop flag (every path moved them).
+static void prune_forgets(EmpStmt *s, const EmpDropForgets *f) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_BLOCK: {
+            size_t n = 0;
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) {
+                EmpStmt *st = (EmpStmt *)s->as.block.stmts.items[i];
+                if (st && st->kind == EMP_STMT_DROP && st->as.drop_stmt.mode == EMP_DROP_MODE_FORGET && forget_is_unneeded(f, st)) continue;
+                prune_forgets(st, f);
+                s->as.block.stmts.items[n++] = st;
+            }
+            s->as.block.stmts.len = n;
+            return;
+        }
+        case EMP_STMT_IF:
+            prune_forgets(s->as.if_stmt.then_branch, f);
+            prune_forgets(s->as.if_stmt.else_branch, f);
+            return;
+        case EMP_STMT_WHILE:
+            prune_forgets(s->as.while_stmt.body, f);
+            return;
+        case EMP_STMT_FOR:
+            prune_forgets(s->as.for_stmt.body, f);
+            return;
+        case EMP_STMT_YIELD: {
+            size_t n = 0;
+            for (size_t i = 0; i < s->as.yield_stmt.drops.len; i++) {
+                EmpStmt *d = (EmpStmt *)s->as.yield_stmt.drops.items[i];
+                if (d && d->as.drop_stmt.mode == EMP_DROP_MODE_FORGET && forget_is_unneeded(f, d)) continue;
+                s->as.yield_stmt.drops.items[n++] = d;
+            }
+            s->as.yield_stmt.drops.len = n;
+            return;
+        }
+        case EMP_STMT_MATCH:
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *a = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (a) prune_forgets(a->body, f);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+// `entry_drops` (coroutines only, else NULL) gets the drops for a destroy before the first resume.
+static void rewrite_fn_body(EmpDropCtx *c, EmpVec *params, EmpStmt *body, bool has_self, EmpSpan self_span, EmpVec *entry_drops) {
+    static const EmpSlice self_name = {(const char *)"self", 4};
+
+    while (c->ds.scopes_len) ds_pop_scope(&c->ds);
+    (void)ds_push_scope(&c->ds);
+
+    EmpDropMoves moves;
+    EmpDropForgets forgets;
+    EmpDropExits exits;
+    memset(&moves, 0, sizeof(moves));
+    memset(&forgets, 0, sizeof(forgets));
+    memset(&exits, 0, sizeof(exits));
+    c->branch_mark = 0;
+    c->moves = &moves;
+    c->forgets = &forgets;
+    c->exits = &exits;
+
+    // `self` is a pointer-like binding; never drop it.
+    if (has_self) (void)ds_push_bind(&c->ds, self_name, self_span, false, EMP_DROP_LIVE);
+
+    for (size_t j = 0; j < params->len; j++) {
+        EmpParam *p = (EmpParam *)params->items[j];
+        if (!p) continue;
+        bool owned = !type_is_trivial(p->ty);
+        ds_push_decl(&c->ds, p->name, p->span, owned, EMP_DROP_LIVE, p, &p->drop_flag);
+    }
+    if (entry_drops) {
+        emp_vec_init(entry_drops);
+        append_all_drops(c, entry_drops, self_span, "drop: value '%s' may be moved before the first resume");
+    }
+    (void)rewrite_block_scoped(c, body, false);
+
+    bool unneeded = false;
+    for (size_t i = 0; i < forgets.len; i++) unneeded = unneeded || !*forgets.items[i].flag;
+    if (unneeded) prune_forgets(body, &forgets);
+
+    for (size_t i = 0; i < exits.len; i++) {
+        free(exits.items[i].ids);
+        free(exits.items[i].modes);
+    }
+    free(exits.items);
+    free(forgets.items);
+    free(moves.items);
+    c->moves = NULL;
+    c->forgets = NULL;
+    c->exits = NULL;
+}
+
 void emp_sem_insert_drops(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
     if (!arena || !program || !diags) return;
 
@@ -963,23 +1311,12 @@ void emp_sem_insert_drops(EmpArena *arena, EmpProgram *program, EmpDiags *diags)
     ds_init(&c.ds);
     (void)ds_push_scope(&c.ds);
 
-    EmpSlice self_name = {(const char *)"self", 4};
-
     for (size_t i = 0; i < program->items.len; i++) {
         EmpItem *it = (EmpItem *)program->items.items[i];
         if (!it) continue;
 
         if (it->kind == EMP_ITEM_FN && it->as.fn.body) {
-            while (c.ds.scopes_len) ds_pop_scope(&c.ds);
-            (void)ds_push_scope(&c.ds);
-
-            for (size_t j = 0; j < it->as.fn.params.len; j++) {
-                EmpParam *p = (EmpParam *)it->as.fn.params.items[j];
-                if (!p) continue;
-                bool owned = !type_is_copy_like(p->ty);
-                (void)ds_push_bind(&c.ds, p->name, p->span, owned, EMP_DROP_LIVE);
-            }
-            (void)rewrite_block_scoped(&c, it->as.fn.body, false);
+            rewrite_fn_body(&c, &it->as.fn.params, it->as.fn.body, false, it->span, it->as.fn.coro ? &it->as.fn.coro_entry_drops : NULL);
             continue;
         }
 
@@ -987,20 +1324,7 @@ void emp_sem_insert_drops(EmpArena *arena, EmpProgram *program, EmpDiags *diags)
             for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
                 EmpClassMethod *mth = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
                 if (!mth || !mth->body) continue;
-
-                while (c.ds.scopes_len) ds_pop_scope(&c.ds);
-                (void)ds_push_scope(&c.ds);
-
-                // `self` is a pointer-like binding; never drop it.
-                (void)ds_push_bind(&c.ds, self_name, mth->span, false, EMP_DROP_LIVE);
-
-                for (size_t j = 0; j < mth->params.len; j++) {
-                    EmpParam *p = (EmpParam *)mth->params.items[j];
-                    if (!p) continue;
-                    bool owned = !type_is_copy_like(p->ty);
-                    (void)ds_push_bind(&c.ds, p->name, p->span, owned, EMP_DROP_LIVE);
-                }
-                (void)rewrite_block_scoped(&c, mth->body, false);
+                rewrite_fn_body(&c, &mth->params, mth->body, true, mth->span, NULL);
             }
             continue;
         }
@@ -1009,25 +1333,97 @@ void emp_sem_insert_drops(EmpArena *arena, EmpProgram *program, EmpDiags *diags)
             for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
                 EmpImplMethod *mth = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
                 if (!mth || !mth->body) continue;
+                rewrite_fn_body(&c, &mth->params, mth->body, true, mth->span, NULL);
+            }
+            continue;
+        }
+    }
 
-                while (c.ds.scopes_len) ds_pop_scope(&c.ds);
-
+    ds_free(&c.ds);
     g_drop_program = NULL;
-                (void)ds_push_scope(&c.ds);
+}
 
-                (void)ds_push_bind(&c.ds, self_name, mth->span, false, EMP_DROP_LIVE);
+typedef struct EmpDropCount {
+    EmpDropStats stats;
+    uint32_t max_cleanup; // per function
+} EmpDropCount;
 
-                for (size_t j = 0; j < mth->params.len; j++) {
-                    EmpParam *p = (EmpParam *)mth->params.items[j];
-                    if (!p) continue;
-                    bool owned = !type_is_copy_like(p->ty);
-                    (void)ds_push_bind(&c.ds, p->name, p->span, owned, EMP_DROP_LIVE);
-                }
-                (void)rewrite_block_scoped(&c, mth->body, false);
+static void count_stmt(EmpDropCount *n, const EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            if (s->as.let_stmt.drop_flag) n->stats.flags++;
+            return;
+        case EMP_STMT_DROP:
+            if (s->as.drop_stmt.mode == EMP_DROP_MODE_FORGET || s->as.drop_stmt.elided) return;
+            n->stats.drops++;
+            if (s->as.drop_stmt.mode == EMP_DROP_MODE_IF_FLAG) n->stats.conditional++;
+            if (s->as.drop_stmt.cleanup) {
+                n->stats.exits++;
+                if (s->as.drop_stmt.cleanup > n->max_cleanup) n->max_cleanup = s->as.drop_stmt.cleanup;
             }
-            continue;
-        }
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) count_stmt(n, (const EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            count_stmt(n, s->as.if_stmt.then_branch);
+            count_stmt(n, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            count_stmt(n, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            count_stmt(n, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_YIELD:
+            for (size_t i = 0; i < s->as.yield_stmt.drops.len; i++) count_stmt(n, (const EmpStmt *)s->as.yield_stmt.drops.items[i]);
+            return;
+        case EMP_STMT_MATCH:
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *a = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (a) count_stmt(n, a->body);
+            }
+            return;
+        default:
+            return;
     }
+}
 
-    ds_free(&c.ds);
+static void count_fn(EmpDropCount *n, const EmpVec *params, const EmpStmt *body) {
+    for (size_t i = 0; i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (p && p->drop_flag) n->stats.flags++;
+    }
+    n->max_cleanup = 0;
+    count_stmt(n, body);
+    n->stats.cleanups += n->max_cleanup;
+}
+
+void emp_sem_drop_stats(const EmpProgram *program, EmpDropStats *out_stats) {
+    if (!out_stats) return;
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+
+    EmpDropCount n;
+    memset(&n, 0, sizeof(n));
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_FN && it->as.fn.body) {
+            count_fn(&n, &it->as.fn.params, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                const EmpClassMethod *m = (const EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m && m->body) count_fn(&n, &m->params, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                const EmpImplMethod *m = (const EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m && m->body) count_fn(&n, &m->params, m->body);
+            }
+        }
+    }
+    *out_stats = n.stats;
 }
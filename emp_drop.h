@@ -8,12 +8,43 @@ extern "C" {
 
 // Drop insertion pass:
 // - inserts explicit `drop` statements for owned bindings
-// - runs after ownership+borrow checking (but does not rely on type checking)
+// - runs after ownership+borrow checking; types are only used to skip trivially destructible bindings
 // - does NOT insert drops inside `@emp off` blocks
 //
 // Diagnostics are appended to `diags` and message strings are allocated in `arena`.
+//
+// Drops are kept to what codegen must actually emit:
+// - bindings of trivially destructible types (scalars, raw pointers, borrows, and arrays/tuples/
+//   structs/enums made only of those) are never tracked, so they get no drops at all;
+// - with emp_drop_flags() on, a binding moved on only some paths gets one drop flag
+//   (`let_stmt.drop_flag` / `EmpParam.drop_flag`) and EMP_DROP_MODE_IF_FLAG drops, with an
+//   EMP_DROP_MODE_FORGET after each conditional move, instead of being rejected;
+// - the drops in front of each `return`/`break`/`continue` get a per-function `cleanup` id, equal
+//   for exits that clean up identically, so codegen emits each cleanup sequence once.
+// Coroutines (EmpItemFn.coro) can be destroyed while suspended: each `yield` gets the drops of
+// everything live at that point (EmpStmt.yield_stmt.drops) and the fn gets the drops of its
+// owned parameters for a destroy before the first resume (EmpItemFn.coro_entry_drops); codegen
+// runs them on the destroy edges. `await t` moves t, so an awaited task is never dropped.
 void emp_sem_insert_drops(EmpArena *arena, EmpProgram *program, EmpDiags *diags);
 
+// Drop flags are opt-in (`--drop-flags`): only a backend that honors EMP_DROP_MODE_IF_FLAG /
+// EMP_DROP_MODE_FORGET may turn them on. Off by default, so a binding moved on only some paths
+// is rejected ("may be moved on some path"). Process-wide: set once by the driver before any
+// semantic pass runs.
+void emp_set_drop_flags(bool enabled);
+bool emp_drop_flags(void);
+
+typedef struct EmpDropStats {
+    size_t drops;       // drops codegen emits (ALWAYS + IF_FLAG, not elided)
+    size_t conditional; // of those, guarded by a drop flag
+    size_t flags;       // bindings with a drop flag
+    size_t exits;       // return/break/continue sites with drops in front
+    size_t cleanups;    // distinct cleanup sequences among those exits
+} EmpDropStats;
+
+// Counts the drops planned by emp_sem_insert_drops (and emp_sem_plan_strings) for `--stats`.
+void emp_sem_drop_stats(const EmpProgram *program, EmpDropStats *out_stats);
+
 #ifdef __cplusplus
 }
 #endif
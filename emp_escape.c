@@ -0,0 +1,541 @@
+#include "emp_escape.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum EsUse {
+    ES_READ,   // value is inspected (field access, comparison, condition)
+    ES_ESCAPE, // value is copied somewhere that may outlive the function
+} EsUse;
+
+typedef struct EsVar {
+    EmpSlice name;
+    size_t bindings;   // declarations of this name in the body
+    EmpSlice class_name;
+    bool dynamic;      // `self`: the dynamic class may be any subclass
+    EmpExpr *new_expr; // `let name = new C(...)`; NULL for `self`
+    bool escapes;
+} EsVar;
+
+typedef struct EsCtx {
+    const EmpProgram *program;
+    EsVar *vars;
+    size_t len;
+    size_t cap;
+    unsigned unsafe_depth;
+    EmpEscapeStats stats;
+} EsCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static const EmpExpr *strip_group(const EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+static EsVar *var_get(EsCtx *c, EmpSlice name, bool create) {
+    for (size_t i = 0; i < c->len; i++) {
+        if (slice_eq(c->vars[i].name, name)) return &c->vars[i];
+    }
+    if (!create || !name.len) return NULL;
+    if (c->len + 1 > c->cap) {
+        size_t nc = c->cap ? c->cap * 2 : 32;
+        EsVar *p = (EsVar *)realloc(c->vars, nc * sizeof(EsVar));
+        if (!p) return NULL;
+        c->vars = p;
+        c->cap = nc;
+    }
+    EsVar *v = &c->vars[c->len++];
+    memset(v, 0, sizeof(*v));
+    v->name = name;
+    return v;
+}
+
+static void var_declare(EsCtx *c, EmpSlice name) {
+    EsVar *v = var_get(c, name, true);
+    if (v) v->bindings++;
+}
+
+static void var_escape(EsCtx *c, EmpSlice name) {
+    EsVar *v = var_get(c, name, false);
+    if (v) v->escapes = true;
+}
+
+// ===== Class/method lookup =====
+
+static const EmpItemClass *find_class(const EmpProgram *p, EmpSlice name) {
+    for (size_t i = 0; i < p->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)p->items.items[i];
+        if (it && it->kind == EMP_ITEM_CLASS && slice_eq(it->as.class_decl.name, name)) return &it->as.class_decl;
+    }
+    return NULL;
+}
+
+static const EmpClassMethod *find_own_method(const EmpItemClass *cls, EmpSlice name) {
+    for (size_t i = 0; i < cls->methods.len; i++) {
+        const EmpClassMethod *m = (const EmpClassMethod *)cls->methods.items[i];
+        if (m && slice_eq(m->name, name)) return m;
+    }
+    return NULL;
+}
+
+// Method `name` as seen from class `cls`: its own, else the nearest base's.
+static const EmpClassMethod *find_method(const EmpProgram *p, const EmpItemClass *cls, EmpSlice name) {
+    for (unsigned depth = 0; cls && depth < 32; depth++) {
+        const EmpClassMethod *m = find_own_method(cls, name);
+        if (m) return m;
+        cls = cls->base_name.len ? find_class(p, cls->base_name) : NULL;
+    }
+    return NULL;
+}
+
+static bool derives_from(const EmpProgram *p, const EmpItemClass *cls, EmpSlice base) {
+    for (unsigned depth = 0; cls && cls->base_name.len && depth < 32; depth++) {
+        if (slice_eq(cls->base_name, base)) return true;
+        cls = find_class(p, cls->base_name);
+    }
+    return false;
+}
+
+// Does calling `name` on a receiver of class `cls_name` keep `self` inside the call? `dynamic`
+// receivers may be any subclass, so virtual methods must be self_nocapture in every override.
+static bool method_keeps_self(const EmpProgram *p, EmpSlice cls_name, bool dynamic, EmpSlice name) {
+    const EmpItemClass *cls = find_class(p, cls_name);
+    const EmpClassMethod *m = cls ? find_method(p, cls, name) : NULL;
+    if (!m || !m->self_nocapture) return false;
+    if (!dynamic || !m->is_virtual) return true;
+
+    for (size_t i = 0; i < p->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)p->items.items[i];
+        if (!it || it->kind != EMP_ITEM_CLASS || !derives_from(p, &it->as.class_decl, cls_name)) continue;
+        const EmpClassMethod *o = find_own_method(&it->as.class_decl, name);
+        if (o && !o->self_nocapture) return false;
+    }
+    return true;
+}
+
+// Is parameter `idx` of every free function named `name` marked is_nocapture?
+static bool fn_param_nocapture(const EmpProgram *p, EmpSlice name, size_t idx) {
+    bool found = false;
+    for (size_t i = 0; i < p->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)p->items.items[i];
+        if (!it || it->kind != EMP_ITEM_FN || !slice_eq(it->as.fn.name, name)) continue;
+        if (idx >= it->as.fn.params.len) return false;
+        const EmpParam *pr = (const EmpParam *)it->as.fn.params.items[idx];
+        if (!pr || !pr->is_nocapture) return false;
+        found = true;
+    }
+    return found;
+}
+
+static bool method_param_nocapture(const EmpClassMethod *m, size_t idx) {
+    if (!m || idx >= m->params.len) return false;
+    const EmpParam *pr = (const EmpParam *)m->params.items[idx];
+    return pr && pr->is_nocapture;
+}
+
+// ===== Body scan =====
+
+static void scan_expr(EsCtx *c, const EmpExpr *e, EsUse use);
+
+static void scan_exprs(EsCtx *c, const EmpVec *v, EsUse use) {
+    for (size_t i = 0; i < v->len; i++) scan_expr(c, (const EmpExpr *)v->items[i], use);
+}
+
+// Call arguments are moved into the callee, except `&x` passed to a nocapture parameter.
+static void scan_args(EsCtx *c, const EmpVec *args, const EmpExpr *callee_ident, const EmpClassMethod *method) {
+    for (size_t i = 0; i < args->len; i++) {
+        const EmpExpr *a = strip_group((const EmpExpr *)args->items[i]);
+        if (!a) continue;
+        bool borrow = a->kind == EMP_EXPR_UNARY && (a->as.unary.op == EMP_UN_BORROW || a->as.unary.op == EMP_UN_BORROW_MUT);
+        bool nocapture = method ? method_param_nocapture(method, i) : callee_ident && fn_param_nocapture(c->program, callee_ident->as.lit, i);
+        scan_expr(c, a, borrow && nocapture ? ES_READ : ES_ESCAPE);
+    }
+}
+
+static void scan_call(EsCtx *c, const EmpExpr *e) {
+    const EmpExpr *callee = strip_group(e->as.call.callee);
+
+    if (callee && callee->kind == EMP_EXPR_MEMBER) {
+        const EmpExpr *recv = strip_group(callee->as.member.base);
+        const EsVar *v = recv && recv->kind == EMP_EXPR_IDENT ? var_get(c, recv->as.lit, false) : NULL;
+        const EmpClassMethod *m = NULL;
+        if (v && v->class_name.len) {
+            const EmpItemClass *cls = find_class(c->program, v->class_name);
+            m = cls ? find_method(c->program, cls, callee->as.member.member) : NULL;
+            if (!method_keeps_self(c->program, v->class_name, v->dynamic, callee->as.member.member)) {
+                var_escape(c, recv->as.lit);
+            }
+        } else {
+            scan_expr(c, callee->as.member.base, ES_READ);
+        }
+        scan_args(c, &e->as.call.args, NULL, m);
+        return;
+    }
+
+    if (callee && callee->kind == EMP_EXPR_IDENT) {
+        scan_args(c, &e->as.call.args, callee, NULL);
+        return;
+    }
+    scan_expr(c, callee, ES_ESCAPE);
+    scan_args(c, &e->as.call.args, NULL, NULL);
+}
+
+static void scan_expr(EsCtx *c, const EmpExpr *e, EsUse use) {
+    if (!e) return;
+    if (c->unsafe_depth) use = ES_ESCAPE;
+
+    switch (e->kind) {
+        case EMP_EXPR_IDENT:
+            if (use == ES_ESCAPE) var_escape(c, e->as.lit);
+            return;
+        case EMP_EXPR_GROUP:
+            scan_expr(c, e->as.group.inner, use);
+            return;
+        case EMP_EXPR_CAST:
+            scan_expr(c, e->as.cast.expr, ES_ESCAPE);
+            return;
+        case EMP_EXPR_UNARY:
+            if (e->as.unary.op == EMP_UN_BORROW || e->as.unary.op == EMP_UN_BORROW_MUT) {
+                scan_expr(c, e->as.unary.rhs, use);
+            } else {
+                scan_expr(c, e->as.unary.rhs, ES_READ);
+            }
+            return;
+        case EMP_EXPR_BINARY:
+            if (e->as.binary.op >= EMP_BIN_ASSIGN && e->as.binary.op <= EMP_BIN_BITXOR_ASSIGN) {
+                const EmpExpr *lhs = strip_group(e->as.binary.lhs);
+                // Rebinding `x` would make its drops refer to another object.
+                if (lhs && lhs->kind == EMP_EXPR_IDENT) var_escape(c, lhs->as.lit);
+                else scan_expr(c, lhs, ES_READ);
+                scan_expr(c, e->as.binary.rhs, ES_ESCAPE);
+                return;
+            }
+            scan_expr(c, e->as.binary.lhs, ES_READ);
+            scan_expr(c, e->as.binary.rhs, ES_READ);
+            return;
+        case EMP_EXPR_CALL:
+            scan_call(c, e);
+            return;
+        case EMP_EXPR_MEMBER:
+            // Field values are separate from the object; reading them never leaks it.
+            scan_expr(c, e->as.member.base, ES_READ);
+            return;
+        case EMP_EXPR_INDEX:
+            scan_expr(c, e->as.index.base, ES_READ);
+            scan_expr(c, e->as.index.index, ES_READ);
+            return;
+        case EMP_EXPR_NEW:
+            scan_exprs(c, &e->as.new_expr.args, ES_ESCAPE);
+            return;
+        case EMP_EXPR_TUPLE:
+            scan_exprs(c, &e->as.tuple.items, ES_ESCAPE);
+            return;
+        case EMP_EXPR_LIST:
+            scan_exprs(c, &e->as.list.items, ES_ESCAPE);
+            return;
+        case EMP_EXPR_TERNARY:
+            scan_expr(c, e->as.ternary.cond, ES_READ);
+            scan_expr(c, e->as.ternary.then_expr, use);
+            scan_expr(c, e->as.ternary.else_expr, use);
+            return;
+        case EMP_EXPR_RANGE:
+            scan_expr(c, e->as.range.start, ES_READ);
+            scan_expr(c, e->as.range.end, ES_READ);
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) scan_expr(c, pt->expr, ES_READ);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static void scan_pattern(EsCtx *c, const EmpExpr *pat) {
+    if (!pat) return;
+    if (pat->kind == EMP_EXPR_IDENT) {
+        var_declare(c, pat->as.lit);
+    } else if (pat->kind == EMP_EXPR_CALL) {
+        for (size_t i = 0; i < pat->as.call.args.len; i++) scan_pattern(c, (const EmpExpr *)pat->as.call.args.items[i]);
+    } else if (pat->kind == EMP_EXPR_TUPLE) {
+        for (size_t i = 0; i < pat->as.tuple.items.len; i++) scan_pattern(c, (const EmpExpr *)pat->as.tuple.items.items[i]);
+    } else if (pat->kind == EMP_EXPR_GROUP) {
+        scan_pattern(c, pat->as.group.inner);
+    }
+}
+
+static void scan_stmt(EsCtx *c, const EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR: {
+            const EmpExpr *init = strip_group(s->as.let_stmt.init);
+            if (s->as.let_stmt.is_destructure) {
+                scan_expr(c, init, ES_ESCAPE);
+                for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                    const EmpSlice *nm = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                    if (nm) var_declare(c, *nm);
+                }
+                return;
+            }
+            if (init && init->kind == EMP_EXPR_NEW) {
+                scan_exprs(c, &init->as.new_expr.args, ES_ESCAPE);
+            } else {
+                scan_expr(c, init, ES_ESCAPE);
+            }
+            EsVar *v = var_get(c, s->as.let_stmt.name, true);
+            if (!v) return;
+            v->bindings++;
+            if (v->bindings == 1 && init && init->kind == EMP_EXPR_NEW && !c->unsafe_depth) {
+                v->new_expr = (EmpExpr *)init;
+                v->class_name = init->as.new_expr.class_name;
+            }
+            return;
+        }
+        case EMP_STMT_DEFER:
+            scan_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            scan_expr(c, s->as.ret.value, ES_ESCAPE);
+            return;
+        case EMP_STMT_YIELD:
+            scan_expr(c, s->as.yield_stmt.value, ES_ESCAPE);
+            return;
+        case EMP_STMT_EXPR:
+            scan_expr(c, s->as.expr.expr, ES_READ);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) scan_stmt(c, (const EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            scan_expr(c, s->as.if_stmt.cond, ES_READ);
+            scan_stmt(c, s->as.if_stmt.then_branch);
+            scan_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            scan_expr(c, s->as.while_stmt.cond, ES_READ);
+            scan_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            if (s->as.for_stmt.idx_name.len) var_declare(c, s->as.for_stmt.idx_name);
+            if (s->as.for_stmt.val_name.len) var_declare(c, s->as.for_stmt.val_name);
+            scan_expr(c, s->as.for_stmt.iterable, ES_READ);
+            scan_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            scan_expr(c, s->as.match_stmt.scrutinee, ES_READ);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                scan_pattern(c, arm->pat);
+                scan_stmt(c, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            c->unsafe_depth++;
+            scan_stmt(c, s->as.emp_off.body);
+            c->unsafe_depth--;
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            c->unsafe_depth++;
+            scan_stmt(c, s->as.emp_mm_off.body);
+            c->unsafe_depth--;
+            return;
+        default:
+            return;
+    }
+}
+
+static void begin_body(EsCtx *c, const EmpVec *params) {
+    c->len = 0;
+    c->unsafe_depth = 0;
+    for (size_t i = 0; params && i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (p) var_declare(c, p->name);
+    }
+}
+
+// ===== Promotion =====
+
+static void mark_drops(EmpStmt *s, EmpSlice name) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_DROP:
+            if (slice_eq(s->as.drop_stmt.name, name)) s->as.drop_stmt.in_place = true;
+            return;
+        case EMP_STMT_YIELD:
+            for (size_t i = 0; i < s->as.yield_stmt.drops.len; i++) mark_drops((EmpStmt *)s->as.yield_stmt.drops.items[i], name);
+            return;
+        case EMP_STMT_DEFER:
+            mark_drops(s->as.defer_stmt.body, name);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) mark_drops((EmpStmt *)s->as.block.stmts.items[i], name);
+            return;
+        case EMP_STMT_IF:
+            mark_drops(s->as.if_stmt.then_branch, name);
+            mark_drops(s->as.if_stmt.else_branch, name);
+            return;
+        case EMP_STMT_WHILE:
+            mark_drops(s->as.while_stmt.body, name);
+            return;
+        case EMP_STMT_FOR:
+            mark_drops(s->as.for_stmt.body, name);
+            return;
+        case EMP_STMT_MATCH:
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm) mark_drops(arm->body, name);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static bool body_has_unsafe(const EmpStmt *s) {
+    if (!s) return false;
+
+    switch (s->kind) {
+        case EMP_STMT_EMP_OFF:
+        case EMP_STMT_EMP_MM_OFF:
+            return true;
+        case EMP_STMT_DEFER:
+            return body_has_unsafe(s->as.defer_stmt.body);
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) {
+                if (body_has_unsafe((const EmpStmt *)s->as.block.stmts.items[i])) return true;
+            }
+            return false;
+        case EMP_STMT_IF:
+            return body_has_unsafe(s->as.if_stmt.then_branch) || body_has_unsafe(s->as.if_stmt.else_branch);
+        case EMP_STMT_WHILE:
+            return body_has_unsafe(s->as.while_stmt.body);
+        case EMP_STMT_FOR:
+            return body_has_unsafe(s->as.for_stmt.body);
+        case EMP_STMT_MATCH:
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm && body_has_unsafe(arm->body)) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+static void promote_body(EsCtx *c, const EmpVec *params, EmpStmt *body) {
+    begin_body(c, params);
+    scan_stmt(c, body);
+
+    for (size_t i = 0; i < c->len; i++) {
+        EsVar *v = &c->vars[i];
+        if (!v->new_expr) continue;
+        c->stats.news++;
+        if (v->bindings != 1 || v->escapes) continue;
+
+        const EmpItemClass *cls = find_class(c->program, v->class_name);
+        if (!cls) continue;
+        const EmpClassMethod *init = NULL;
+        for (size_t mi = 0; mi < cls->methods.len; mi++) {
+            const EmpClassMethod *m = (const EmpClassMethod *)cls->methods.items[mi];
+            if (m && m->is_init) init = m;
+        }
+        if (init && !init->self_nocapture) continue;
+
+        v->new_expr->as.new_expr.on_stack = true;
+        mark_drops(body, v->name);
+        c->stats.on_stack++;
+    }
+}
+
+// Greatest fixpoint: assume every method keeps `self`, then drop the assumption for methods
+// whose body leaks it, until nothing changes.
+static void infer_self_nocapture(EsCtx *c, EmpProgram *program) {
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_CLASS) continue;
+        for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+            EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+            if (m) m->self_nocapture = m->body && !m->is_unsafe && !body_has_unsafe(m->body);
+        }
+    }
+
+    static const EmpSlice self_name = {(const char *)"self", 4};
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < program->items.len; i++) {
+            EmpItem *it = (EmpItem *)program->items.items[i];
+            if (!it || it->kind != EMP_ITEM_CLASS) continue;
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (!m || !m->self_nocapture) continue;
+
+                begin_body(c, &m->params);
+                EsVar *self = var_get(c, self_name, true);
+                if (!self) continue;
+                self->bindings++;
+                self->class_name = it->as.class_decl.name;
+                self->dynamic = true;
+                scan_stmt(c, m->body);
+
+                self = var_get(c, self_name, false);
+                if (self && (self->escapes || self->bindings != 1)) {
+                    m->self_nocapture = false;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+void emp_sem_promote_new_to_stack(EmpProgram *program, EmpEscapeStats *out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (it && it->kind == EMP_ITEM_EMP_MM_OFF) return;
+    }
+
+    EsCtx c;
+    memset(&c, 0, sizeof(c));
+    c.program = program;
+
+    infer_self_nocapture(&c, program);
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+
+        if (it->kind == EMP_ITEM_FN && it->as.fn.body && !it->as.fn.is_unsafe) {
+            promote_body(&c, &it->as.fn.params, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (!m || !m->body) continue;
+                if (m->self_nocapture) c.stats.self_nocapture++;
+                if (!m->is_unsafe) promote_body(&c, &m->params, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m && m->body && !m->is_unsafe) promote_body(&c, &m->params, m->body);
+            }
+        }
+    }
+
+    free(c.vars);
+    if (out_stats) *out_stats = c.stats;
+}
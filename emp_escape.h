@@ -0,0 +1,36 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EmpEscapeStats {
+    size_t news;            // `let x = new C(...)` bindings considered
+    size_t on_stack;        // of those, proven not to escape (EmpExpr.new_expr.on_stack)
+    size_t self_nocapture;  // class methods whose `self` never outlives the call
+} EmpEscapeStats;
+
+// Escape analysis for class instances (run on the final program after emp_sem_insert_drops and
+// emp_sem_infer_alias_facts, only when the checks produced no diagnostics).
+//
+// First, every class method gets EmpClassMethod.self_nocapture when its body never lets `self`
+// outlive the call: `self` is only used for field access, compared, or as the receiver of
+// methods that are themselves self_nocapture (every override, for virtual ones).
+//
+// Then a `let x = new C(...)` binding whose object provably dies with the function is promoted:
+// - `x` is declared once, never reassigned, and only used for field reads/writes, comparisons,
+//   calls of self_nocapture methods of C (resolved through its bases), and `&x` arguments to
+//   `is_nocapture` parameters;
+// - C's `init` (if any) is self_nocapture, and `x` is not used inside `@emp off` regions.
+// The `new` gets EmpExpr.new_expr.on_stack (codegen allocates the object in an entry-block
+// stack slot, reused across loop iterations since `x` is dropped at the end of each), and the
+// drops of `x` get `in_place` (destroy the fields, free nothing).
+//
+// `out_stats` may be NULL.
+void emp_sem_promote_new_to_stack(EmpProgram *program, EmpEscapeStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,211 @@
+#include "emp_fstring.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Pieces every program may need (bool values, null `*u8`, empty result); ids 0..3.
+static const EmpSlice k_shared_pieces[] = {
+    {"", 0},
+    {"true", 4},
+    {"false", 5},
+    {"<null>", 6},
+};
+
+typedef struct FsCtx {
+    EmpProgram *program;
+    EmpFStringStats stats;
+} FsCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static uint32_t pool_intern(FsCtx *c, const EmpSlice *piece) {
+    EmpVec *pool = &c->program->fmt_consts;
+    c->stats.pieces++;
+    for (size_t i = 0; i < pool->len; i++) {
+        if (slice_eq(*(const EmpSlice *)pool->items[i], *piece)) return (uint32_t)i;
+    }
+    (void)emp_vec_push(pool, (void *)piece);
+    return (uint32_t)(pool->len - 1);
+}
+
+static void plan_fstring(FsCtx *c, EmpExpr *e) {
+    uint32_t static_len = 0;
+    uint32_t dynamic_parts = 0;
+
+    for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+        EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+        if (!pt) continue;
+        if (!pt->is_expr) pt->const_id = pool_intern(c, &pt->text);
+        else if (pt->fmt == EMP_FMT_BOOL) c->stats.pieces += 2;
+        else if (pt->fmt == EMP_FMT_CSTR) c->stats.pieces++;
+        static_len += pt->max_len;
+        if (pt->is_expr && pt->max_len == 0) dynamic_parts++;
+    }
+
+    e->as.fstring.static_len = static_len;
+    e->as.fstring.dynamic_parts = dynamic_parts;
+    c->stats.fstrings++;
+    if (e->as.fstring.is_temp && dynamic_parts == 0 && static_len <= EMP_FSTR_STACK_MAX) c->stats.on_stack++;
+}
+
+static void walk_expr(FsCtx *c, EmpExpr *e);
+static void walk_stmt(FsCtx *c, EmpStmt *s);
+
+static void walk_exprs(FsCtx *c, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) walk_expr(c, (EmpExpr *)v->items[i]);
+}
+
+static void walk_expr(FsCtx *c, EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) walk_expr(c, pt->expr);
+            }
+            plan_fstring(c, e);
+            return;
+        case EMP_EXPR_UNARY:
+            walk_expr(c, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            walk_expr(c, e->as.binary.lhs);
+            walk_expr(c, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            walk_expr(c, e->as.call.callee);
+            walk_exprs(c, &e->as.call.args);
+            return;
+        case EMP_EXPR_GROUP:
+            walk_expr(c, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            walk_expr(c, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE:
+            walk_exprs(c, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            walk_exprs(c, &e->as.list.items);
+            return;
+        case EMP_EXPR_INDEX:
+            walk_expr(c, e->as.index.base);
+            walk_expr(c, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER:
+            walk_expr(c, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            walk_exprs(c, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TERNARY:
+            walk_expr(c, e->as.ternary.cond);
+            walk_expr(c, e->as.ternary.then_expr);
+            walk_expr(c, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            walk_expr(c, e->as.range.start);
+            walk_expr(c, e->as.range.end);
+            return;
+        default:
+            return;
+    }
+}
+
+static void walk_stmt(FsCtx *c, EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            walk_expr(c, s->as.let_stmt.init);
+            return;
+        case EMP_STMT_DEFER:
+            walk_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            walk_expr(c, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            walk_expr(c, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            walk_expr(c, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) walk_stmt(c, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            walk_expr(c, s->as.if_stmt.cond);
+            walk_stmt(c, s->as.if_stmt.then_branch);
+            walk_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            walk_expr(c, s->as.while_stmt.cond);
+            walk_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            walk_expr(c, s->as.for_stmt.iterable);
+            walk_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            walk_expr(c, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm) walk_stmt(c, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            walk_stmt(c, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            walk_stmt(c, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+void emp_sem_plan_fstrings(EmpProgram *program, EmpFStringStats *out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+
+    FsCtx c;
+    memset(&c, 0, sizeof(c));
+    c.program = program;
+
+    program->fmt_consts.len = 0;
+    for (size_t i = 0; i < sizeof(k_shared_pieces) / sizeof(k_shared_pieces[0]); i++) {
+        (void)emp_vec_push(&program->fmt_consts, (void *)&k_shared_pieces[i]);
+    }
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+
+        if (it->kind == EMP_ITEM_FN) {
+            walk_stmt(&c, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CONST) {
+            walk_expr(&c, it->as.const_decl.init);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) walk_stmt(&c, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) walk_stmt(&c, m->body);
+            }
+        }
+    }
+
+    c.stats.unique = program->fmt_consts.len;
+    if (out_stats) *out_stats = c.stats;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest f-string (bytes, without the NUL) that codegen formats into a stack buffer when the
+// f-string is a temporary (EmpExpr.fstring.is_temp). Larger or non-temporary results get
+// exactly one heap allocation of the computed length, or none when the result fits inline
+// (emp_string_inline_max(); `dynamic_parts == 0` lets codegen decide that statically).
+#define EMP_FSTR_STACK_MAX 256u
+
+typedef struct EmpFStringStats {
+    size_t fstrings;     // f-string expressions
+    size_t on_stack;     // temporaries whose static bound fits EMP_FSTR_STACK_MAX
+    size_t pieces;       // constant pieces referenced (text parts + shared fallbacks)
+    size_t unique;       // entries in EmpProgram.fmt_consts
+} EmpFStringStats;
+
+// Plans f-string lowering for codegen (run after type checking, which fills the per-part
+// EmpFmtKind/max_len and `is_temp`):
+// - `static_len` = sum of part bounds, `dynamic_parts` = parts whose length (strings) is only
+//   known at runtime. The exact output length is `static_len` plus those lengths, so codegen
+//   sizes one buffer up front and formats every part straight into it (integers via
+//   `emp.fmt.i64`/`emp.fmt.u64` from the runtime module) with no intermediate strings.
+// - Literal text parts get `const_id`, an index into `program->fmt_consts`, which holds every
+//   distinct constant piece of the program once. The pool always starts with the shared
+//   pieces `""`, `"true"`, `"false"` and `"<null>"` (ids 0..3), so codegen emits one global per
+//   piece instead of one per f-string.
+//
+// `program->fmt_consts` is rebuilt on each call. `out_stats` may be NULL.
+void emp_sem_plan_fstrings(EmpProgram *program, EmpFStringStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
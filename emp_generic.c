@@ -0,0 +1,274 @@
+#include "emp_generic.h"
+
+#include <string.h>
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static void *dup_node(EmpArena *arena, const void *src, size_t size) {
+    void *p = emp_arena_alloc(arena, size, sizeof(void *));
+    if (p) memcpy(p, src, size);
+    return p;
+}
+
+// ===== Types =====
+
+EmpType *emp_clone_type(EmpArena *arena, const EmpType *t, const EmpTypeSubst *subst) {
+    if (!t) return NULL;
+
+    if (t->kind == EMP_TYPE_NAME && subst) {
+        for (size_t i = 0; i < subst->len; i++) {
+            if (slice_eq(t->as.name, subst->params[i])) return emp_clone_type(arena, subst->args[i], NULL);
+        }
+    }
+
+    EmpType *out = (EmpType *)dup_node(arena, t, sizeof(EmpType));
+    if (!out) return NULL;
+
+    switch (t->kind) {
+        case EMP_TYPE_PTR:
+            out->as.ptr.pointee = emp_clone_type(arena, t->as.ptr.pointee, subst);
+            break;
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            out->as.array.elem = emp_clone_type(arena, t->as.array.elem, subst);
+            break;
+        case EMP_TYPE_TUPLE:
+            emp_vec_init(&out->as.tuple.fields);
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                EmpTupleField *nf = f ? (EmpTupleField *)dup_node(arena, f, sizeof(EmpTupleField)) : NULL;
+                if (!nf) continue;
+                nf->ty = emp_clone_type(arena, f->ty, subst);
+                (void)emp_vec_push(&out->as.tuple.fields, nf);
+            }
+            break;
+        case EMP_TYPE_GENERIC:
+            emp_vec_init(&out->as.generic.args);
+            for (size_t i = 0; i < t->as.generic.args.len; i++) {
+                (void)emp_vec_push(&out->as.generic.args, emp_clone_type(arena, (const EmpType *)t->as.generic.args.items[i], subst));
+            }
+            break;
+        default:
+            break;
+    }
+    return out;
+}
+
+static void clone_types(EmpArena *arena, EmpVec *dst, const EmpVec *src, const EmpTypeSubst *subst) {
+    emp_vec_init(dst);
+    for (size_t i = 0; i < src->len; i++) {
+        (void)emp_vec_push(dst, emp_clone_type(arena, (const EmpType *)src->items[i], subst));
+    }
+}
+
+static void clone_params(EmpArena *arena, EmpVec *dst, const EmpVec *src, const EmpTypeSubst *subst) {
+    emp_vec_init(dst);
+    for (size_t i = 0; i < src->len; i++) {
+        const EmpParam *p = (const EmpParam *)src->items[i];
+        EmpParam *np = p ? (EmpParam *)dup_node(arena, p, sizeof(EmpParam)) : NULL;
+        if (!np) continue;
+        np->ty = emp_clone_type(arena, p->ty, subst);
+        (void)emp_vec_push(dst, np);
+    }
+}
+
+// ===== Expressions / statements =====
+
+static void clone_exprs(EmpArena *arena, EmpVec *dst, const EmpVec *src, const EmpTypeSubst *subst) {
+    emp_vec_init(dst);
+    for (size_t i = 0; i < src->len; i++) {
+        (void)emp_vec_push(dst, emp_clone_expr(arena, (const EmpExpr *)src->items[i], subst));
+    }
+}
+
+EmpExpr *emp_clone_expr(EmpArena *arena, const EmpExpr *e, const EmpTypeSubst *subst) {
+    if (!e) return NULL;
+    EmpExpr *out = (EmpExpr *)dup_node(arena, e, sizeof(EmpExpr));
+    if (!out) return NULL;
+
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            emp_vec_init(&out->as.fstring.parts);
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                EmpFStringPart *np = pt ? (EmpFStringPart *)dup_node(arena, pt, sizeof(EmpFStringPart)) : NULL;
+                if (!np) continue;
+                if (pt->is_expr) np->expr = emp_clone_expr(arena, pt->expr, subst);
+                (void)emp_vec_push(&out->as.fstring.parts, np);
+            }
+            break;
+        case EMP_EXPR_UNARY:
+            out->as.unary.rhs = emp_clone_expr(arena, e->as.unary.rhs, subst);
+            break;
+        case EMP_EXPR_BINARY:
+            out->as.binary.lhs = emp_clone_expr(arena, e->as.binary.lhs, subst);
+            out->as.binary.rhs = emp_clone_expr(arena, e->as.binary.rhs, subst);
+            break;
+        case EMP_EXPR_CALL:
+            out->as.call.callee = emp_clone_expr(arena, e->as.call.callee, subst);
+            clone_exprs(arena, &out->as.call.args, &e->as.call.args, subst);
+            clone_types(arena, &out->as.call.type_args, &e->as.call.type_args, subst);
+            break;
+        case EMP_EXPR_GROUP:
+            out->as.group.inner = emp_clone_expr(arena, e->as.group.inner, subst);
+            break;
+        case EMP_EXPR_CAST:
+            out->as.cast.ty = emp_clone_type(arena, e->as.cast.ty, subst);
+            out->as.cast.expr = emp_clone_expr(arena, e->as.cast.expr, subst);
+            break;
+        case EMP_EXPR_TUPLE:
+            clone_exprs(arena, &out->as.tuple.items, &e->as.tuple.items, subst);
+            break;
+        case EMP_EXPR_LIST:
+            clone_exprs(arena, &out->as.list.items, &e->as.list.items, subst);
+            break;
+        case EMP_EXPR_INDEX:
+            out->as.index.base = emp_clone_expr(arena, e->as.index.base, subst);
+            out->as.index.index = emp_clone_expr(arena, e->as.index.index, subst);
+            break;
+        case EMP_EXPR_MEMBER:
+            out->as.member.base = emp_clone_expr(arena, e->as.member.base, subst);
+            break;
+        case EMP_EXPR_NEW:
+            clone_exprs(arena, &out->as.new_expr.args, &e->as.new_expr.args, subst);
+            break;
+        case EMP_EXPR_TERNARY:
+            out->as.ternary.cond = emp_clone_expr(arena, e->as.ternary.cond, subst);
+            out->as.ternary.then_expr = emp_clone_expr(arena, e->as.ternary.then_expr, subst);
+            out->as.ternary.else_expr = emp_clone_expr(arena, e->as.ternary.else_expr, subst);
+            break;
+        case EMP_EXPR_RANGE:
+            out->as.range.start = emp_clone_expr(arena, e->as.range.start, subst);
+            out->as.range.end = emp_clone_expr(arena, e->as.range.end, subst);
+            break;
+        default:
+            break;
+    }
+    return out;
+}
+
+EmpStmt *emp_clone_stmt(EmpArena *arena, const EmpStmt *s, const EmpTypeSubst *subst) {
+    if (!s) return NULL;
+    EmpStmt *out = (EmpStmt *)dup_node(arena, s, sizeof(EmpStmt));
+    if (!out) return NULL;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            out->as.let_stmt.ty = emp_clone_type(arena, s->as.let_stmt.ty, subst);
+            out->as.let_stmt.init = emp_clone_expr(arena, s->as.let_stmt.init, subst);
+            emp_vec_init(&out->as.let_stmt.destruct_names);
+            for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                (void)emp_vec_push(&out->as.let_stmt.destruct_names, s->as.let_stmt.destruct_names.items[i]);
+            }
+            break;
+        case EMP_STMT_DEFER:
+            out->as.defer_stmt.body = emp_clone_stmt(arena, s->as.defer_stmt.body, subst);
+            break;
+        case EMP_STMT_RETURN:
+            out->as.ret.value = emp_clone_expr(arena, s->as.ret.value, subst);
+            break;
+        case EMP_STMT_YIELD:
+            out->as.yield_stmt.value = emp_clone_expr(arena, s->as.yield_stmt.value, subst);
+            emp_vec_init(&out->as.yield_stmt.drops);
+            break;
+        case EMP_STMT_EXPR:
+            out->as.expr.expr = emp_clone_expr(arena, s->as.expr.expr, subst);
+            break;
+        case EMP_STMT_BLOCK:
+            emp_vec_init(&out->as.block.stmts);
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) {
+                (void)emp_vec_push(&out->as.block.stmts, emp_clone_stmt(arena, (const EmpStmt *)s->as.block.stmts.items[i], subst));
+            }
+            break;
+        case EMP_STMT_IF:
+            out->as.if_stmt.cond = emp_clone_expr(arena, s->as.if_stmt.cond, subst);
+            out->as.if_stmt.then_branch = emp_clone_stmt(arena, s->as.if_stmt.then_branch, subst);
+            out->as.if_stmt.else_branch = emp_clone_stmt(arena, s->as.if_stmt.else_branch, subst);
+            break;
+        case EMP_STMT_WHILE:
+            out->as.while_stmt.cond = emp_clone_expr(arena, s->as.while_stmt.cond, subst);
+            out->as.while_stmt.body = emp_clone_stmt(arena, s->as.while_stmt.body, subst);
+            break;
+        case EMP_STMT_FOR:
+            out->as.for_stmt.iterable = emp_clone_expr(arena, s->as.for_stmt.iterable, subst);
+            out->as.for_stmt.body = emp_clone_stmt(arena, s->as.for_stmt.body, subst);
+            out->as.for_stmt.idx_ty = emp_clone_type(arena, s->as.for_stmt.idx_ty, subst);
+            break;
+        case EMP_STMT_MATCH:
+            out->as.match_stmt.scrutinee = emp_clone_expr(arena, s->as.match_stmt.scrutinee, subst);
+            emp_vec_init(&out->as.match_stmt.arms);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                EmpMatchArm *na = arm ? (EmpMatchArm *)dup_node(arena, arm, sizeof(EmpMatchArm)) : NULL;
+                if (!na) continue;
+                na->pat = emp_clone_expr(arena, arm->pat, subst);
+                na->body = emp_clone_stmt(arena, arm->body, subst);
+                (void)emp_vec_push(&out->as.match_stmt.arms, na);
+            }
+            break;
+        case EMP_STMT_EMP_OFF:
+            out->as.emp_off.body = emp_clone_stmt(arena, s->as.emp_off.body, subst);
+            break;
+        case EMP_STMT_EMP_MM_OFF:
+            out->as.emp_mm_off.body = emp_clone_stmt(arena, s->as.emp_mm_off.body, subst);
+            break;
+        default:
+            break;
+    }
+    return out;
+}
+
+// ===== Items =====
+
+EmpItem *emp_clone_item(EmpArena *arena, const EmpItem *it, EmpSlice name, const EmpTypeSubst *subst) {
+    if (!it) return NULL;
+    if (it->kind != EMP_ITEM_FN && it->kind != EMP_ITEM_STRUCT && it->kind != EMP_ITEM_IMPL) return NULL;
+
+    EmpItem *out = (EmpItem *)dup_node(arena, it, sizeof(EmpItem));
+    if (!out) return NULL;
+
+    switch (it->kind) {
+        case EMP_ITEM_FN:
+            out->as.fn.name = name;
+            emp_vec_init(&out->as.fn.type_params);
+            clone_params(arena, &out->as.fn.params, &it->as.fn.params, subst);
+            out->as.fn.ret_ty = emp_clone_type(arena, it->as.fn.ret_ty, subst);
+            out->as.fn.body = emp_clone_stmt(arena, it->as.fn.body, subst);
+            emp_vec_init(&out->as.fn.coro_entry_drops);
+            break;
+        case EMP_ITEM_STRUCT:
+            out->as.struct_decl.name = name;
+            emp_vec_init(&out->as.struct_decl.type_params);
+            emp_vec_init(&out->as.struct_decl.fields);
+            for (size_t i = 0; i < it->as.struct_decl.fields.len; i++) {
+                const EmpStructField *f = (const EmpStructField *)it->as.struct_decl.fields.items[i];
+                EmpStructField *nf = f ? (EmpStructField *)dup_node(arena, f, sizeof(EmpStructField)) : NULL;
+                if (!nf) continue;
+                nf->ty = emp_clone_type(arena, f->ty, subst);
+                (void)emp_vec_push(&out->as.struct_decl.fields, nf);
+            }
+            break;
+        case EMP_ITEM_IMPL:
+            out->as.impl_decl.target_name = name;
+            emp_vec_init(&out->as.impl_decl.type_params);
+            emp_vec_init(&out->as.impl_decl.methods);
+            for (size_t i = 0; i < it->as.impl_decl.methods.len; i++) {
+                const EmpImplMethod *m = (const EmpImplMethod *)it->as.impl_decl.methods.items[i];
+                EmpImplMethod *nm = m ? (EmpImplMethod *)dup_node(arena, m, sizeof(EmpImplMethod)) : NULL;
+                if (!nm) continue;
+                clone_params(arena, &nm->params, &m->params, subst);
+                nm->ret_ty = emp_clone_type(arena, m->ret_ty, subst);
+                nm->body = emp_clone_stmt(arena, m->body, subst);
+                (void)emp_vec_push(&out->as.impl_decl.methods, nm);
+            }
+            break;
+        default:
+            break;
+    }
+    return out;
+}
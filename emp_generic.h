@@ -0,0 +1,30 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Type parameter substitution used while cloning: every `NAME` type equal to `params[i]` becomes
+// a copy of `args[i]`.
+typedef struct EmpTypeSubst {
+    const EmpSlice *params;
+    EmpType *const *args;
+    size_t len;
+} EmpTypeSubst;
+
+// Deep copies of AST nodes (nodes in `arena`, vectors on the heap as usual), applying `subst`
+// (may be NULL) to every type on the way. Annotations that later passes compute (drops, alias
+// facts, resolved overloads, ...) are copied as-is, so clone before those passes run.
+EmpType *emp_clone_type(EmpArena *arena, const EmpType *t, const EmpTypeSubst *subst);
+EmpExpr *emp_clone_expr(EmpArena *arena, const EmpExpr *e, const EmpTypeSubst *subst);
+EmpStmt *emp_clone_stmt(EmpArena *arena, const EmpStmt *s, const EmpTypeSubst *subst);
+
+// Clones a fn, struct or impl item under a new name (the impl's target name), without its
+// type parameters. Other item kinds are not supported (returns NULL).
+EmpItem *emp_clone_item(EmpArena *arena, const EmpItem *it, EmpSlice name, const EmpTypeSubst *subst);
+
+#ifdef __cplusplus
+}
+#endif
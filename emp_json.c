@@ -56,6 +56,26 @@ static void emit_type(EmpJsonW *w, const EmpType *t);
 static void emit_expr(EmpJsonW *w, const EmpExpr *e);
 static void emit_stmt(EmpJsonW *w, const EmpStmt *s);
 
+static void emit_types(EmpJsonW *w, const EmpVec *types) {
+    fputc('[', w->out);
+    for (size_t i = 0; i < types->len; i++) {
+        if (i) fputc(',', w->out);
+        emit_type(w, (const EmpType *)types->items[i]);
+    }
+    fputc(']', w->out);
+}
+
+// `"typeParams":[...]` of a generic fn/struct/impl; omitted for ordinary items.
+static void emit_type_params(EmpJsonW *w, const EmpVec *tps) {
+    if (!tps->len) return;
+    fputs(",\"typeParams\":[", w->out);
+    for (size_t i = 0; i < tps->len; i++) {
+        if (i) fputc(',', w->out);
+        jw_slice(w, *(const EmpSlice *)tps->items[i]);
+    }
+    fputc(']', w->out);
+}
+
 static void emit_type(EmpJsonW *w, const EmpType *t) {
     if (!t) {
         fputs("null", w->out);
@@ -73,6 +93,11 @@ static void emit_type(EmpJsonW *w, const EmpType *t) {
     } else if (t->kind == EMP_TYPE_DYN) {
         fputs(",\"baseName\":", w->out);
         jw_slice(w, t->as.dyn.base_name);
+    } else if (t->kind == EMP_TYPE_GENERIC) {
+        fputs(",\"name\":", w->out);
+        jw_slice(w, t->as.generic.name);
+        fputs(",\"args\":", w->out);
+        emit_types(w, &t->as.generic.args);
     } else if (t->kind == EMP_TYPE_PTR) {
         fputs(",\"pointee\":", w->out);
         emit_type(w, t->as.ptr.pointee);
@@ -190,6 +215,10 @@ static void emit_expr(EmpJsonW *w, const EmpExpr *e) {
             emit_expr(w, (const EmpExpr *)e->as.call.args.items[i]);
         }
         fputc(']', w->out);
+        if (e->as.call.type_args.len) {
+            fputs(",\"typeArgs\":", w->out);
+            emit_types(w, &e->as.call.type_args);
+        }
     } else if (e->kind == EMP_EXPR_GROUP) {
         fputs(",\"inner\":", w->out);
         emit_expr(w, e->as.group.inner);
@@ -250,6 +279,7 @@ static void emit_stmt(EmpJsonW *w, const EmpStmt *s) {
         case EMP_STMT_DROP: jw_str(w, "Drop", 4); break;
         case EMP_STMT_DEFER: jw_str(w, "Defer", 5); break;
         case EMP_STMT_RETURN: jw_str(w, "Return", 6); break;
+        case EMP_STMT_YIELD: jw_str(w, "Yield", 5); break;
         case EMP_STMT_EXPR: jw_str(w, "Expr", 4); break;
         case EMP_STMT_TAG: jw_str(w, "Tag", 3); break;
         case EMP_STMT_BLOCK: jw_str(w, "Block", 5); break;
@@ -296,6 +326,9 @@ static void emit_stmt(EmpJsonW *w, const EmpStmt *s) {
     } else if (s->kind == EMP_STMT_RETURN) {
         fputs(",\"value\":", w->out);
         emit_expr(w, s->as.ret.value);
+    } else if (s->kind == EMP_STMT_YIELD) {
+        fputs(",\"value\":", w->out);
+        emit_expr(w, s->as.yield_stmt.value);
     } else if (s->kind == EMP_STMT_EXPR) {
         fputs(",\"expr\":", w->out);
         emit_expr(w, s->as.expr.expr);
@@ -325,6 +358,8 @@ static void emit_stmt(EmpJsonW *w, const EmpStmt *s) {
         if (s->as.for_stmt.val_name.ptr && s->as.for_stmt.val_name.len) jw_slice(w, s->as.for_stmt.val_name); else fputs("null", w->out);
         fputs(",\"in\":", w->out);
         emit_expr(w, s->as.for_stmt.iterable);
+        fputs(",\"parallel\":", w->out);
+        fputs(s->as.for_stmt.is_parallel ? "true" : "false", w->out);
         fputs(",\"body\":", w->out);
         emit_stmt(w, s->as.for_stmt.body);
     } else if (s->kind == EMP_STMT_MATCH) {
@@ -402,6 +437,7 @@ void emp_program_to_json(FILE *out, const EmpProgram *p, const EmpDiags *diags)
             } else if (it->kind == EMP_ITEM_FN) {
                 fputs("{\"kind\":\"Fn\",\"name\":", out);
                 jw_slice(&w, it->as.fn.name);
+                emit_type_params(&w, &it->as.fn.type_params);
                 fputs(",\"isExported\":", out);
                 fputs(it->as.fn.is_exported ? "true" : "false", out);
                 fputs(",\"isExtern\":", out);
@@ -411,6 +447,10 @@ void emp_program_to_json(FILE *out, const EmpProgram *p, const EmpDiags *diags)
                 else fputs("null", out);
                 fputs(",\"isUnsafe\":", out);
                 fputs(it->as.fn.is_unsafe ? "true" : "false", out);
+                fputs(",\"isConst\":", out);
+                fputs(it->as.fn.is_const ? "true" : "false", out);
+                fputs(",\"isAsync\":", out);
+                fputs(it->as.fn.is_async ? "true" : "false", out);
                 fputs(",\"params\":[", out);
                 for (size_t j = 0; j < it->as.fn.params.len; j++) {
                     if (j) fputc(',', out);
@@ -594,8 +634,16 @@ void emp_program_to_json(FILE *out, const EmpProgram *p, const EmpDiags *diags)
             } else if (it->kind == EMP_ITEM_STRUCT) {
                 fputs("{\"kind\":\"Struct\",\"name\":", out);
                 jw_slice(&w, it->as.struct_decl.name);
+                emit_type_params(&w, &it->as.struct_decl.type_params);
                 fputs(",\"isExported\":", out);
                 fputs(it->as.struct_decl.is_exported ? "true" : "false", out);
+                fprintf(out, ",\"align\":%u", (unsigned)it->as.struct_decl.attr_align);
+                fputs(",\"packed\":", out);
+                fputs(it->as.struct_decl.is_packed ? "true" : "false", out);
+                fputs(",\"cacheline\":", out);
+                fputs(it->as.struct_decl.is_cacheline ? "true" : "false", out);
+                fputs(",\"soa\":", out);
+                fputs(it->as.struct_decl.is_soa ? "true" : "false", out);
                 fputs(",\"fields\":[", out);
                 for (size_t j = 0; j < it->as.struct_decl.fields.len; j++) {
                     if (j) fputc(',', out);
@@ -645,6 +693,7 @@ void emp_program_to_json(FILE *out, const EmpProgram *p, const EmpDiags *diags)
             } else if (it->kind == EMP_ITEM_IMPL) {
                 fputs("{\"kind\":\"Impl\",\"target\":", out);
                 jw_slice(&w, it->as.impl_decl.target_name);
+                emit_type_params(&w, &it->as.impl_decl.type_params);
                 fputs(",\"trait\":", out);
                 if (it->as.impl_decl.trait_name.ptr && it->as.impl_decl.trait_name.len) {
                     jw_slice(&w, it->as.impl_decl.trait_name);
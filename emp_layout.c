@@ -0,0 +1,672 @@
+#include "emp_layout.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LY_MAX_DEPTH 64
+
+typedef struct LyCtx {
+    const EmpProgram *program;
+    EmpVec c_visible; // EmpItem*: structs and enums whose layout C code may see
+    EmpLayoutStats stats;
+} LyCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static bool slice_is(EmpSlice s, const char *lit) {
+    size_t n = strlen(lit);
+    return s.len == n && s.ptr && memcmp(s.ptr, lit, n) == 0;
+}
+
+static uint64_t align_up(uint64_t v, uint64_t a) {
+    return a > 1 ? (v + a - 1) / a * a : v;
+}
+
+static bool struct_is_planned(const EmpItem *it) {
+    return it && it->kind == EMP_ITEM_STRUCT && it->as.struct_decl.type_params.len == 0;
+}
+
+static const EmpItem *find_type_item(const LyCtx *c, EmpSlice name) {
+    for (size_t i = 0; i < c->program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)c->program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_STRUCT && it->as.struct_decl.type_params.len == 0 && slice_eq(it->as.struct_decl.name, name)) return it;
+        if (it->kind == EMP_ITEM_ENUM && slice_eq(it->as.enum_decl.name, name)) return it;
+        if (it->kind == EMP_ITEM_CLASS && slice_eq(it->as.class_decl.name, name)) return it;
+    }
+    return NULL;
+}
+
+// Scalars, vectors and atomics (Mds/ABI.md, "Canonical Data Layout"). 64-bit targets.
+static bool builtin_layout(EmpSlice n, uint64_t *size, uint32_t *align) {
+    static const struct {
+        const char *name;
+        uint32_t size;
+    } scalars[] = {
+        {"bool", 1}, {"i8", 1}, {"u8", 1}, {"int8", 1}, {"uint8", 1},
+        {"i16", 2}, {"u16", 2}, {"int16", 2}, {"uint16", 2},
+        {"i32", 4}, {"u32", 4}, {"int32", 4}, {"uint32", 4}, {"int", 4}, {"char", 4}, {"f32", 4}, {"float", 4},
+        {"i64", 8}, {"u64", 8}, {"int64", 8}, {"uint64", 8}, {"isize", 8}, {"usize", 8}, {"f64", 8}, {"double", 8},
+    };
+    for (size_t i = 0; i < sizeof(scalars) / sizeof(scalars[0]); i++) {
+        if (slice_is(n, scalars[i].name)) {
+            *size = scalars[i].size;
+            *align = scalars[i].size;
+            return true;
+        }
+    }
+    if (slice_is(n, "string")) {
+        *size = emp_len_abi() == EMP_LEN_ABI_64 ? 24 : 16;
+        *align = 8;
+        return true;
+    }
+    EmpSlice elem;
+    uint32_t lanes = 0;
+    if (emp_simd_type_parse(n, &elem, &lanes)) {
+        uint64_t es = 0;
+        uint32_t ea = 0;
+        (void)builtin_layout(elem, &es, &ea);
+        *size = es * lanes;
+        *align = (uint32_t)(*size > 64 ? 64 : *size);
+        return true;
+    }
+    EmpSlice value;
+    if (emp_atomic_type_parse(n, &value)) {
+        if (slice_is(value, "ptr") || !builtin_layout(value, size, align)) {
+            *size = 8;
+            *align = 8;
+        }
+        return true;
+    }
+    return false;
+}
+
+static void struct_layout(LyCtx *c, EmpItem *it, int depth);
+static void enum_layout(LyCtx *c, EmpItem *it, int depth);
+
+static void type_layout(LyCtx *c, const EmpType *t, int depth, uint64_t *size, uint32_t *align) {
+    *size = 8;
+    *align = 8;
+    if (!t || depth > LY_MAX_DEPTH) return;
+    switch (t->kind) {
+        case EMP_TYPE_PTR:
+            return;
+        case EMP_TYPE_DYN:
+            *size = 16; // {data, vtbl}
+            return;
+        case EMP_TYPE_LIST:
+            *size = emp_len_abi() == EMP_LEN_ABI_64 ? 24 : 16;
+            return;
+        case EMP_TYPE_ARRAY: {
+            uint64_t n = 0;
+            for (size_t i = 0; i < t->as.array.size_text.len; i++) {
+                char ch = t->as.array.size_text.ptr[i];
+                if (ch >= '0' && ch <= '9') n = n * 10 + (uint64_t)(ch - '0');
+            }
+            type_layout(c, t->as.array.elem, depth + 1, size, align);
+            *size *= n;
+            return;
+        }
+        case EMP_TYPE_TUPLE: {
+            uint64_t off = 0;
+            uint32_t al = 1;
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                uint64_t fs = 0;
+                uint32_t fa = 1;
+                if (f) type_layout(c, f->ty, depth + 1, &fs, &fa);
+                off = align_up(off, fa) + fs;
+                if (fa > al) al = fa;
+            }
+            *size = align_up(off, al);
+            *align = al;
+            return;
+        }
+        case EMP_TYPE_NAME: {
+            if (builtin_layout(t->as.name, size, align)) return;
+            const EmpItem *it = find_type_item(c, t->as.name);
+            if (!it || it->kind == EMP_ITEM_CLASS) return; // class values are object pointers
+            if (it->kind == EMP_ITEM_STRUCT) {
+                struct_layout(c, (EmpItem *)it, depth + 1);
+                *size = it->as.struct_decl.size;
+                *align = it->as.struct_decl.align;
+                return;
+            }
+            enum_layout(c, (EmpItem *)it, depth + 1);
+            *size = it->as.enum_decl.size;
+            *align = it->as.enum_decl.align;
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+static uint64_t place_fields(LyCtx *c, EmpItemStruct *s, int depth, uint32_t *out_align) {
+    uint64_t off = 0;
+    uint32_t al = 1;
+    for (size_t i = 0; i < s->fields.len; i++) {
+        EmpStructField *f = (EmpStructField *)s->fields.items[i];
+        if (!f) continue;
+        uint64_t fs = 0;
+        uint32_t fa = 1;
+        type_layout(c, f->ty, depth, &fs, &fa);
+        if (s->is_packed) fa = 1;
+        off = align_up(off, fa);
+        f->offset = off;
+        off += fs;
+        if (fa > al) al = fa;
+    }
+    if (s->attr_align > al) al = s->attr_align;
+    if (s->is_cacheline && al < EMP_CACHELINE_SIZE) al = EMP_CACHELINE_SIZE;
+    *out_align = al;
+    return align_up(off, al);
+}
+
+// `align` doubles as the "planned" mark: every finished layout has align >= 1.
+static void struct_layout(LyCtx *c, EmpItem *it, int depth) {
+    EmpItemStruct *s = &it->as.struct_decl;
+    if (s->align || depth > LY_MAX_DEPTH) return;
+    s->size = place_fields(c, s, depth, &s->align);
+}
+
+static bool c_visible_has(const LyCtx *c, const EmpItem *it) {
+    for (size_t i = 0; i < c->c_visible.len; i++) {
+        if (c->c_visible.items[i] == it) return true;
+    }
+    return false;
+}
+
+// Structs and enums that reach C: named by an `extern` signature, by value or behind
+// pointers/arrays/lists, and every struct or enum such a type contains.
+static void mark_c_visible(LyCtx *c, const EmpType *t, int depth) {
+    if (!t || depth > LY_MAX_DEPTH) return;
+    switch (t->kind) {
+        case EMP_TYPE_PTR:
+            mark_c_visible(c, t->as.ptr.pointee, depth + 1);
+            return;
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            mark_c_visible(c, t->as.array.elem, depth + 1);
+            return;
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                if (f) mark_c_visible(c, f->ty, depth + 1);
+            }
+            return;
+        case EMP_TYPE_NAME: {
+            const EmpItem *it = find_type_item(c, t->as.name);
+            if (!it || c_visible_has(c, it)) return;
+            if (it->kind == EMP_ITEM_ENUM) {
+                if (!emp_vec_push(&c->c_visible, (void *)it)) return;
+                for (size_t vi = 0; vi < it->as.enum_decl.variants.len; vi++) {
+                    const EmpEnumVariant *v = (const EmpEnumVariant *)it->as.enum_decl.variants.items[vi];
+                    for (size_t fi = 0; v && fi < v->fields.len; fi++) mark_c_visible(c, (const EmpType *)v->fields.items[fi], depth + 1);
+                }
+                return;
+            }
+            if (it->kind != EMP_ITEM_STRUCT || !emp_vec_push(&c->c_visible, (void *)it)) return;
+            for (size_t i = 0; i < it->as.struct_decl.fields.len; i++) {
+                const EmpStructField *f = (const EmpStructField *)it->as.struct_decl.fields.items[i];
+                if (f) mark_c_visible(c, f->ty, depth + 1);
+            }
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+// ----- Enums -----
+
+// Bit patterns a value of some type never holds: `count` unsigned values from `start` of the
+// `bytes`-byte integer at `offset`. An enum can store its tag there instead of in a field.
+typedef struct LyNiche {
+    uint64_t offset;
+    uint8_t bytes;
+    uint64_t start;
+    uint64_t count; // 0: no niche
+} LyNiche;
+
+static LyNiche niche_none(void) {
+    LyNiche n;
+    memset(&n, 0, sizeof(n));
+    return n;
+}
+
+static LyNiche niche_at(uint64_t offset, uint8_t bytes, uint64_t start, uint64_t count) {
+    LyNiche n;
+    n.offset = offset;
+    n.bytes = bytes;
+    n.start = start;
+    n.count = count;
+    return n;
+}
+
+static uint64_t tag_values(uint8_t bytes) {
+    return bytes >= 8 ? UINT64_MAX : (uint64_t)1 << (8u * bytes);
+}
+
+static LyNiche type_niche(LyCtx *c, const EmpType *t, int depth);
+
+// The largest niche among values laid out one after another (struct fields, tuple items,
+// variant payloads).
+static LyNiche fields_niche(LyCtx *c, const EmpVec *types, bool tuple_fields, int depth) {
+    LyNiche best = niche_none();
+    uint64_t off = 0;
+    for (size_t i = 0; i < types->len; i++) {
+        const EmpType *ft = NULL;
+        if (tuple_fields) {
+            const EmpTupleField *f = (const EmpTupleField *)types->items[i];
+            ft = f ? f->ty : NULL;
+        } else {
+            ft = (const EmpType *)types->items[i];
+        }
+        uint64_t fs = 0;
+        uint32_t fa = 1;
+        type_layout(c, ft, depth + 1, &fs, &fa);
+        off = align_up(off, fa);
+        LyNiche n = type_niche(c, ft, depth + 1);
+        if (n.count > best.count) best = niche_at(off + n.offset, n.bytes, n.start, n.count);
+        off += fs;
+    }
+    return best;
+}
+
+static LyNiche type_niche(LyCtx *c, const EmpType *t, int depth) {
+    if (!t || depth > LY_MAX_DEPTH) return niche_none();
+    switch (t->kind) {
+        case EMP_TYPE_DYN:
+            return niche_at(0, 8, 0, 1); // the data pointer is never null
+        case EMP_TYPE_GENERIC:
+            return niche_at(0, 8, 0, 1); // `Gen[T]` / `Task[T]` frame handles are never null
+        case EMP_TYPE_TUPLE:
+            return fields_niche(c, &t->as.tuple.fields, true, depth);
+        case EMP_TYPE_ARRAY: {
+            bool empty = true;
+            for (size_t i = 0; i < t->as.array.size_text.len; i++) {
+                if (t->as.array.size_text.ptr[i] > '0' && t->as.array.size_text.ptr[i] <= '9') empty = false;
+            }
+            return empty ? niche_none() : type_niche(c, t->as.array.elem, depth + 1);
+        }
+        case EMP_TYPE_NAME: {
+            if (slice_is(t->as.name, "bool")) return niche_at(0, 1, 2, 254);
+            if (slice_is(t->as.name, "char")) return niche_at(0, 4, 0x110000u, 0x100000000ull - 0x110000u);
+            const EmpItem *it = find_type_item(c, t->as.name);
+            if (!it) return niche_none();
+            if (it->kind == EMP_ITEM_CLASS) return niche_at(0, 8, 0, 1); // object pointers are never null
+            if (it->kind == EMP_ITEM_STRUCT) {
+                struct_layout(c, (EmpItem *)it, depth + 1);
+                LyNiche best = niche_none();
+                for (size_t i = 0; i < it->as.struct_decl.fields.len; i++) {
+                    const EmpStructField *f = (const EmpStructField *)it->as.struct_decl.fields.items[i];
+                    if (!f) continue;
+                    LyNiche n = type_niche(c, f->ty, depth + 1);
+                    if (n.count > best.count) best = niche_at(f->offset + n.offset, n.bytes, n.start, n.count);
+                }
+                // A misaligned niche in a packed struct is still fine: it is read byte-wise.
+                return best;
+            }
+            enum_layout(c, (EmpItem *)it, depth + 1);
+            const EmpItemEnum *en = &it->as.enum_decl;
+            size_t nv = en->variants.len;
+            if (en->tag_size) {
+                uint64_t all = tag_values(en->tag_size);
+                return all > nv ? niche_at(0, en->tag_size, nv, all - nv) : niche_none();
+            }
+            // Niche layout: what is left of the payload's niche after the other variants.
+            const EmpEnumVariant *v = (const EmpEnumVariant *)en->variants.items[en->niche_variant];
+            LyNiche n = fields_niche(c, &v->fields, false, depth);
+            uint64_t used = nv - 1;
+            return n.count > used ? niche_at(n.offset, n.bytes, n.start + used, n.count - used) : niche_none();
+        }
+        default:
+            return niche_none(); // raw pointers may be null; lists and strings use every pattern
+    }
+}
+
+// The u32-tag layout of Mds/ABI.md, "Enums": tag, then a union of the variant payloads.
+static uint64_t enum_canonical(LyCtx *c, EmpItemEnum *en, int depth, uint8_t tag_size, uint64_t *out_psize, uint32_t *out_palign) {
+    uint64_t psize = 0;
+    uint32_t palign = 1;
+    for (size_t vi = 0; vi < en->variants.len; vi++) {
+        const EmpEnumVariant *v = (const EmpEnumVariant *)en->variants.items[vi];
+        uint64_t off = 0;
+        for (size_t fi = 0; v && fi < v->fields.len; fi++) {
+            uint64_t fs = 0;
+            uint32_t fa = 1;
+            type_layout(c, (const EmpType *)v->fields.items[fi], depth + 1, &fs, &fa);
+            off = align_up(off, fa) + fs;
+            if (fa > palign) palign = fa;
+        }
+        if (off > psize) psize = off;
+    }
+    *out_psize = psize;
+    *out_palign = palign;
+    uint32_t al = palign > tag_size ? palign : tag_size;
+    en->tag_size = tag_size;
+    en->payload_offset = (uint32_t)align_up(tag_size, palign);
+    en->align = al;
+    return align_up(en->payload_offset + psize, al);
+}
+
+// Enums C can see, and exported ones, keep the canonical layout. Others get the smallest tag
+// that counts their variants, or no tag at all when exactly one variant has a payload and the
+// payload has enough never-used values to name the other variants (a class or `dyn` payload:
+// null is the other variant; `bool`, `char`, compact enums).
+static void enum_layout(LyCtx *c, EmpItem *it, int depth) {
+    EmpItemEnum *en = &it->as.enum_decl;
+    if (en->align || depth > LY_MAX_DEPTH) return;
+    en->align = 4; // provisional, so a (rejected) recursive enum terminates
+    en->tag_size = 4;
+    uint64_t psize = 0;
+    uint32_t palign = 1;
+    if (en->is_exported || c_visible_has(c, it)) {
+        en->size = enum_canonical(c, en, depth, 4, &psize, &palign);
+        return;
+    }
+
+    size_t nv = en->variants.len;
+    size_t dataful = 0;
+    uint32_t dataful_index = 0;
+    for (size_t vi = 0; vi < nv; vi++) {
+        const EmpEnumVariant *v = (const EmpEnumVariant *)en->variants.items[vi];
+        if (v && v->fields.len) {
+            dataful++;
+            dataful_index = (uint32_t)vi;
+        }
+    }
+    if (dataful == 1 && nv > 1) {
+        const EmpEnumVariant *v = (const EmpEnumVariant *)en->variants.items[dataful_index];
+        LyNiche n = fields_niche(c, &v->fields, false, depth);
+        if (n.count >= nv - 1) {
+            (void)enum_canonical(c, en, depth, 1, &psize, &palign);
+            en->tag_size = 0;
+            en->payload_offset = 0;
+            en->align = palign;
+            en->size = align_up(psize, palign);
+            en->niche_variant = dataful_index;
+            en->niche_size = n.bytes;
+            en->niche_offset = n.offset;
+            en->niche_start = n.start;
+            return;
+        }
+    }
+    en->size = enum_canonical(c, en, depth, nv <= 256 ? 1 : nv <= 65536 ? 2 : 4, &psize, &palign);
+}
+
+static bool enum_is_planned(const EmpItem *it) {
+    return it && it->kind == EMP_ITEM_ENUM;
+}
+
+// The layout Mds/ABI.md gives every enum C can see, for the report.
+static uint64_t enum_canonical_size(LyCtx *c, const EmpItem *it) {
+    EmpItemEnum copy = it->as.enum_decl;
+    uint64_t psize = 0;
+    uint32_t palign = 1;
+    return enum_canonical(c, &copy, 1, 4, &psize, &palign);
+}
+
+// `@soa` lists keep column k at `data + cap * (sizes of columns 0..k-1)`. Columns go in
+// decreasing alignment so every column start stays aligned for any `cap`.
+static void plan_soa_columns(LyCtx *c, EmpItemStruct *s) {
+    uint64_t row = 0;
+    for (uint32_t a = 64; a >= 1; a /= 2) {
+        for (size_t i = 0; i < s->fields.len; i++) {
+            EmpStructField *f = (EmpStructField *)s->fields.items[i];
+            if (!f) continue;
+            uint64_t fs = 0;
+            uint32_t fa = 1;
+            type_layout(c, f->ty, 1, &fs, &fa);
+            if (fa > 64) fa = 64;
+            if (fa != a) continue;
+            f->soa_column = row;
+            row += fs;
+        }
+    }
+}
+
+static bool can_reorder(const LyCtx *c, const EmpItem *it) {
+    const EmpItemStruct *s = &it->as.struct_decl;
+    return !s->is_exported && !s->is_packed && s->fields.len > 2 && !c_visible_has(c, it);
+}
+
+// Stable sort of `fields` by decreasing alignment; kept only when the struct gets smaller.
+static void reorder_fields(LyCtx *c, EmpItem *it) {
+    EmpItemStruct *s = &it->as.struct_decl;
+    size_t n = s->fields.len;
+    void **saved = (void **)malloc(n * sizeof(void *));
+    uint32_t *aligns = (uint32_t *)malloc(n * sizeof(uint32_t));
+    if (!saved || !aligns) {
+        free(saved);
+        free(aligns);
+        return;
+    }
+    memcpy(saved, s->fields.items, n * sizeof(void *));
+    for (size_t i = 0; i < n; i++) {
+        const EmpStructField *f = (const EmpStructField *)s->fields.items[i];
+        uint64_t fs = 0;
+        aligns[i] = 1;
+        if (f) type_layout(c, f->ty, 1, &fs, &aligns[i]);
+    }
+    for (size_t i = 1; i < n; i++) {
+        void *f = s->fields.items[i];
+        uint32_t a = aligns[i];
+        size_t j = i;
+        for (; j > 0 && aligns[j - 1] < a; j--) {
+            s->fields.items[j] = s->fields.items[j - 1];
+            aligns[j] = aligns[j - 1];
+        }
+        s->fields.items[j] = f;
+        aligns[j] = a;
+    }
+
+    uint32_t al = 1;
+    uint64_t size = place_fields(c, s, 1, &al);
+    if (size < s->size) {
+        c->stats.reordered++;
+        c->stats.bytes_saved += (size_t)(s->size - size);
+        s->size = size;
+        s->fields_reordered = true;
+    } else {
+        memcpy(s->fields.items, saved, n * sizeof(void *));
+        (void)place_fields(c, s, 1, &al);
+    }
+    free(saved);
+    free(aligns);
+}
+
+static uint64_t struct_padding(const EmpItemStruct *s, const LyCtx *c) {
+    uint64_t used = 0;
+    for (size_t i = 0; i < s->fields.len; i++) {
+        const EmpStructField *f = (const EmpStructField *)s->fields.items[i];
+        uint64_t fs = 0;
+        uint32_t fa = 1;
+        if (f) type_layout((LyCtx *)c, f->ty, 1, &fs, &fa);
+        used += fs;
+    }
+    return s->size > used ? s->size - used : 0;
+}
+
+void emp_sem_plan_layouts(EmpProgram *program, bool reorder, EmpLayoutStats *out_stats) {
+    LyCtx c;
+    memset(&c, 0, sizeof(c));
+    c.program = program;
+    emp_vec_init(&c.c_visible);
+    if (!program) {
+        if (out_stats) *out_stats = c.stats;
+        return;
+    }
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_FN || !it->as.fn.is_extern) continue;
+        for (size_t pi = 0; pi < it->as.fn.params.len; pi++) {
+            const EmpParam *p = (const EmpParam *)it->as.fn.params.items[pi];
+            if (p) mark_c_visible(&c, p->ty, 0);
+        }
+        mark_c_visible(&c, it->as.fn.ret_ty, 0);
+    }
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (struct_is_planned(it)) it->as.struct_decl.align = 0;
+        if (enum_is_planned(it)) it->as.enum_decl.align = 0;
+    }
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (struct_is_planned(it)) struct_layout(&c, it, 0);
+        if (enum_is_planned(it)) enum_layout(&c, it, 0);
+    }
+    if (reorder) {
+        for (size_t i = 0; i < program->items.len; i++) {
+            EmpItem *it = (EmpItem *)program->items.items[i];
+            if (struct_is_planned(it) && can_reorder(&c, it)) reorder_fields(&c, it);
+        }
+        // Containing structs were measured with the old sizes; plan everything again.
+        for (size_t i = 0; i < program->items.len; i++) {
+            EmpItem *it = (EmpItem *)program->items.items[i];
+            if (struct_is_planned(it)) it->as.struct_decl.align = 0;
+            if (enum_is_planned(it)) it->as.enum_decl.align = 0;
+        }
+        for (size_t i = 0; i < program->items.len; i++) {
+            EmpItem *it = (EmpItem *)program->items.items[i];
+            if (struct_is_planned(it)) struct_layout(&c, it, 0);
+            if (enum_is_planned(it)) enum_layout(&c, it, 0);
+        }
+    }
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!struct_is_planned(it)) continue;
+        if (it->as.struct_decl.is_soa) plan_soa_columns(&c, &it->as.struct_decl);
+        c.stats.structs++;
+        c.stats.padding += (size_t)struct_padding(&it->as.struct_decl, &c);
+    }
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (!enum_is_planned(it)) continue;
+        uint64_t canonical = enum_canonical_size(&c, it);
+        c.stats.enums++;
+        if (!it->as.enum_decl.tag_size) c.stats.enums_niche++;
+        if (canonical > it->as.enum_decl.size) c.stats.enum_bytes_saved += (size_t)(canonical - it->as.enum_decl.size);
+    }
+
+    emp_vec_free(&c.c_visible);
+    if (out_stats) *out_stats = c.stats;
+}
+
+// ===== --print-layouts =====
+
+static void type_text(char *buf, size_t cap, const EmpType *t) {
+    if (!cap) return;
+    buf[0] = 0;
+    if (!t) {
+        snprintf(buf, cap, "?");
+        return;
+    }
+    char inner[128];
+    switch (t->kind) {
+        case EMP_TYPE_NAME:
+            snprintf(buf, cap, "%.*s", (int)t->as.name.len, t->as.name.ptr);
+            return;
+        case EMP_TYPE_PTR:
+            type_text(inner, sizeof(inner), t->as.ptr.pointee);
+            snprintf(buf, cap, "*%s", inner);
+            return;
+        case EMP_TYPE_ARRAY:
+            type_text(inner, sizeof(inner), t->as.array.elem);
+            snprintf(buf, cap, "%s[%.*s]", inner, (int)t->as.array.size_text.len, t->as.array.size_text.ptr);
+            return;
+        case EMP_TYPE_LIST:
+            type_text(inner, sizeof(inner), t->as.array.elem);
+            snprintf(buf, cap, "%s[]", inner);
+            return;
+        case EMP_TYPE_DYN:
+            snprintf(buf, cap, "dyn %.*s", (int)t->as.dyn.base_name.len, t->as.dyn.base_name.ptr);
+            return;
+        case EMP_TYPE_GENERIC:
+            snprintf(buf, cap, "%.*s[...]", (int)t->as.generic.name.len, t->as.generic.name.ptr);
+            return;
+        case EMP_TYPE_TUPLE:
+            snprintf(buf, cap, "(%zu-tuple)", t->as.tuple.fields.len);
+            return;
+        default:
+            snprintf(buf, cap, "auto");
+            return;
+    }
+}
+
+static void print_hole(FILE *out, uint64_t at, uint64_t bytes, const char *what) {
+    if (bytes) fprintf(out, "    %6llu  -- %llu byte %s\n", (unsigned long long)at, (unsigned long long)bytes, what);
+}
+
+void emp_layout_print(FILE *out, const EmpProgram *program) {
+    if (!out || !program) return;
+    LyCtx c;
+    memset(&c, 0, sizeof(c));
+    c.program = program;
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (!struct_is_planned(it) || !it->as.struct_decl.align) continue;
+        const EmpItemStruct *s = &it->as.struct_decl;
+
+        fprintf(out, "struct %.*s: size %llu, align %u, %llu padding byte(s)", (int)s->name.len, s->name.ptr,
+                (unsigned long long)s->size, (unsigned)s->align, (unsigned long long)struct_padding(s, &c));
+        if (s->is_packed) fputs(", @packed", out);
+        if (s->is_cacheline) fputs(", @cacheline", out);
+        if (s->is_soa) fputs(", @soa", out);
+        if (s->attr_align) fprintf(out, ", @align(%u)", (unsigned)s->attr_align);
+        if (s->fields_reordered) fputs(", fields reordered", out);
+        fputc('\n', out);
+
+        uint64_t end = 0;
+        for (size_t fi = 0; fi < s->fields.len; fi++) {
+            const EmpStructField *f = (const EmpStructField *)s->fields.items[fi];
+            if (!f) continue;
+            uint64_t fs = 0;
+            uint32_t fa = 1;
+            type_layout(&c, f->ty, 1, &fs, &fa);
+            print_hole(out, end, f->offset - end, "hole");
+            char ty[160];
+            type_text(ty, sizeof(ty), f->ty);
+            fprintf(out, "    %6llu  %.*s: %s (size %llu, align %u)", (unsigned long long)f->offset, (int)f->name.len, f->name.ptr, ty,
+                    (unsigned long long)fs, (unsigned)(s->is_packed ? 1 : fa));
+            if (s->is_soa) fprintf(out, ", list column at data + cap * %llu", (unsigned long long)f->soa_column);
+            fputc('\n', out);
+            end = f->offset + fs;
+        }
+        print_hole(out, end, s->size - end, "tail padding");
+    }
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (!enum_is_planned(it) || !it->as.enum_decl.align) continue;
+        const EmpItemEnum *en = &it->as.enum_decl;
+        fprintf(out, "enum %.*s: size %llu, align %u, ", (int)en->name.len, en->name.ptr, (unsigned long long)en->size, (unsigned)en->align);
+        if (en->tag_size) {
+            fprintf(out, "u%u tag at 0, payload at %u%s\n", (unsigned)en->tag_size * 8u, (unsigned)en->payload_offset,
+                    en->tag_size == 4 ? "" : " (compact)");
+        } else {
+            fprintf(out, "no tag: u%u niche at %llu\n", (unsigned)en->niche_size * 8u, (unsigned long long)en->niche_offset);
+        }
+        uint64_t niche_value = en->niche_start;
+        for (size_t vi = 0; vi < en->variants.len; vi++) {
+            const EmpEnumVariant *v = (const EmpEnumVariant *)en->variants.items[vi];
+            if (!v) continue;
+            fprintf(out, "    %.*s: ", (int)v->name.len, v->name.ptr);
+            if (en->tag_size) fprintf(out, "tag %zu", vi);
+            else if (vi == en->niche_variant) fputs("payload at 0", out);
+            else fprintf(out, "niche value %llu", (unsigned long long)niche_value++);
+            if (v->fields.len) fprintf(out, ", %zu payload field(s)", v->fields.len);
+            fputc('\n', out);
+        }
+    }
+}
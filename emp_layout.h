@@ -0,0 +1,56 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMP_CACHELINE_SIZE 64u
+
+typedef struct EmpLayoutStats {
+    size_t structs;     // struct layouts computed
+    size_t padding;     // padding bytes (holes + tail) left in those layouts
+    size_t reordered;   // structs whose fields were reordered (EmpItemStruct.fields_reordered)
+    size_t bytes_saved; // bytes those structs lost through reordering
+    size_t enums;            // enum layouts computed
+    size_t enums_niche;      // of those, enums whose tag lives in a niche of the payload
+    size_t enum_bytes_saved; // bytes saved against the canonical u32-tag layout
+} EmpLayoutStats;
+
+// Struct layout planning (run on the final program after the checks produced no diagnostics).
+//
+// Sets EmpItemStruct.size/align and EmpStructField.offset for every non-generic struct, using
+// the rules of Mds/ABI.md: C order and natural alignment by default; `@packed` puts every field
+// at the next byte; `@align(N)` raises the alignment to N and `@cacheline` to 64, and the size is
+// always rounded up to the alignment. Codegen emits the same shape: a packed LLVM struct for
+// `@packed` (accesses use `align 1`), and an explicit `[pad x i8]` tail plus `align` on allocas,
+// globals and heap allocations for raised alignments.
+//
+// Fields of `@soa` structs also get EmpStructField.soa_column: lists of them store one array per
+// field in a single block, in decreasing alignment, column k starting at `data + cap * soa_column`.
+//
+// Enums get EmpItemEnum.size/align/tag_size/payload_offset. An enum C code cannot observe (not
+// `export`, not reachable from an `extern` fn signature) uses the smallest tag that counts its
+// variants (u8 up to 256), and no tag at all when one variant alone has a payload with enough
+// never-used bit patterns to name the others: `null` for a class or `dyn` payload, values past
+// 1 in a `bool`, past U+10FFFF in a `char`, past the last variant of a compact enum tag. Every
+// other enum keeps the canonical u32 tag.
+//
+// With `reorder`, a struct whose layout C code cannot observe (not `export`, not `@packed`, and
+// not reachable by value or through pointers from an `extern` fn signature) has its `fields`
+// stably sorted by decreasing alignment when that makes it smaller. Fields are only ever
+// accessed by name, so nothing else changes; `fields_reordered` records it for the report.
+//
+// `out_stats` may be NULL.
+void emp_sem_plan_layouts(EmpProgram *program, bool reorder, EmpLayoutStats *out_stats);
+
+// `--print-layouts`: size, alignment, field offsets and holes of every planned struct, and the
+// tag or niche of every enum.
+void emp_layout_print(FILE *out, const EmpProgram *program);
+
+#ifdef __cplusplus
+}
+#endif
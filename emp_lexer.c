@@ -239,6 +239,9 @@ static EmpTokenKind emp_keyword_kind(EmpSlice s) {
     KW("impl", EMP_TOK_KW_IMPL);
     KW("const", EMP_TOK_KW_CONST);
     KW("dyn", EMP_TOK_KW_DYN);
+    KW("yield", EMP_TOK_KW_YIELD);
+    KW("await", EMP_TOK_KW_AWAIT);
+    KW("async", EMP_TOK_KW_ASYNC);
 
     #undef KW
     return EMP_TOK_IDENT;
@@ -840,6 +843,9 @@ const char *emp_token_kind_name(EmpTokenKind kind) {
         case EMP_TOK_KW_IMPL: return "KW_IMPL";
         case EMP_TOK_KW_CONST: return "KW_CONST";
         case EMP_TOK_KW_DYN: return "KW_DYN";
+        case EMP_TOK_KW_YIELD: return "KW_YIELD";
+        case EMP_TOK_KW_AWAIT: return "KW_AWAIT";
+        case EMP_TOK_KW_ASYNC: return "KW_ASYNC";
 
         case EMP_TOK_INT: return "INT";
         case EMP_TOK_FLOAT: return "FLOAT";
@@ -64,6 +64,9 @@ typedef enum EmpTokenKind {
     EMP_TOK_KW_IMPL,
     EMP_TOK_KW_CONST,
     EMP_TOK_KW_DYN,
+    EMP_TOK_KW_YIELD,
+    EMP_TOK_KW_AWAIT,
+    EMP_TOK_KW_ASYNC,
 
     // Literals
     EMP_TOK_INT,
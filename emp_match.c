@@ -0,0 +1,264 @@
+#include "emp_match.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct MtCtx {
+    const EmpProgram *program;
+    EmpMatchStats stats;
+} MtCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static const EmpItemEnum *find_enum(const MtCtx *c, const EmpType *t) {
+    if (!t || t->kind != EMP_TYPE_NAME) return NULL;
+    for (size_t i = 0; i < c->program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)c->program->items.items[i];
+        if (it && it->kind == EMP_ITEM_ENUM && slice_eq(it->as.enum_decl.name, t->as.name)) return &it->as.enum_decl;
+    }
+    return NULL;
+}
+
+// The bits of a constant pattern, and its width and signedness. False for anything that is not
+// an integer, `char` or `bool`.
+static bool pattern_bits(const EmpConstValue *v, uint64_t *out, int *bits, bool *is_signed) {
+    if (!v) return false;
+    switch (v->kind) {
+        case EMP_CONST_INT:
+            *out = v->as.i;
+            *bits = v->bits ? v->bits : 64;
+            *is_signed = !v->is_unsigned;
+            return true;
+        case EMP_CONST_CHAR:
+            *out = v->as.ch;
+            *bits = 32;
+            *is_signed = false;
+            return true;
+        case EMP_CONST_BOOL:
+            *out = v->as.b ? 1u : 0u;
+            *bits = 1;
+            *is_signed = false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Orders case values as the scrutinee type does: signed values are sign-extended and biased so
+// that unsigned comparison of the keys is signed comparison of the values.
+static uint64_t order_key(uint64_t v, int bits, bool is_signed) {
+    if (!is_signed) return v;
+    if (bits < 64 && (v >> (bits - 1) & 1u)) v |= ~(((uint64_t)1 << bits) - 1);
+    return v ^ ((uint64_t)1 << 63);
+}
+
+// Jump table or compare tree, from the keys of the cases.
+static EmpMatchLowering switch_kind(const uint64_t *keys, size_t n) {
+    if (n < EMP_MATCH_TABLE_MIN_CASES) return EMP_MATCH_SWITCH;
+    uint64_t lo = keys[0];
+    uint64_t hi = keys[0];
+    for (size_t i = 1; i < n; i++) {
+        if (keys[i] < lo) lo = keys[i];
+        if (keys[i] > hi) hi = keys[i];
+    }
+    uint64_t span = hi - lo;
+    if (span >= UINT64_MAX / 100u) return EMP_MATCH_SWITCH;
+    return (uint64_t)n * 100u >= (span + 1u) * EMP_MATCH_TABLE_MIN_DENSITY ? EMP_MATCH_TABLE : EMP_MATCH_SWITCH;
+}
+
+static EmpMatchArm *arm_at(EmpStmt *s, size_t i) {
+    return (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+}
+
+static void plan_enum_match(MtCtx *c, EmpStmt *s, const EmpItemEnum *en) {
+    size_t nv = en->variants.len;
+    size_t narms = s->as.match_stmt.arms.len;
+    bool *covered = (bool *)calloc(nv ? nv : 1, sizeof(bool));
+    uint64_t *keys = (uint64_t *)calloc(nv ? nv : 1, sizeof(uint64_t));
+    if (!covered || !keys) {
+        free(covered);
+        free(keys);
+        return;
+    }
+
+    EmpMatchArm *else_arm = NULL;
+    size_t ncases = 0;
+    for (size_t i = 0; i < narms; i++) {
+        EmpMatchArm *a = arm_at(s, i);
+        if (!a) continue;
+        if (a->is_default) {
+            if (!else_arm) else_arm = a;
+            continue;
+        }
+        if (a->variant >= nv) continue;
+        covered[a->variant] = true;
+        if (en->tag_size) {
+            a->case_value = a->variant;
+            a->is_case = true;
+            keys[ncases++] = a->case_value;
+        } else if (a->variant != en->niche_variant) {
+            a->case_value = en->niche_start + a->variant - (a->variant > en->niche_variant ? 1u : 0u);
+            a->is_case = true;
+            keys[ncases++] = a->case_value;
+        }
+    }
+
+    bool all = true;
+    for (size_t vi = 0; vi < nv; vi++) all = all && covered[vi];
+    if (!en->tag_size) {
+        // Every variant without a payload is a case: its own arm's, or the `else` arm's.
+        ncases = 0;
+        for (size_t vi = 0; vi + 1 < nv; vi++) keys[ncases++] = en->niche_start + vi;
+    }
+    if (all && else_arm) {
+        else_arm->is_dead = true;
+        c->stats.dead_arms++;
+    }
+    // A niche enum's default is its payload variant, which is always reachable.
+    s->as.match_stmt.default_unreachable = all && en->tag_size;
+    s->as.match_stmt.lowering = switch_kind(keys, ncases);
+    free(covered);
+    free(keys);
+}
+
+static void plan_value_match(MtCtx *c, EmpStmt *s) {
+    size_t narms = s->as.match_stmt.arms.len;
+    int bits = 64;
+    bool is_signed = false;
+    for (size_t i = 0; i < narms; i++) {
+        EmpMatchArm *a = arm_at(s, i);
+        if (!a || a->is_default) continue;
+        uint64_t v = 0;
+        if (!pattern_bits(a->value, &v, &bits, &is_signed)) return; // stays a compare chain
+    }
+
+    uint64_t *keys = (uint64_t *)calloc(narms ? narms : 1, sizeof(uint64_t));
+    if (!keys) return;
+    EmpMatchArm *else_arm = NULL;
+    size_t ncases = 0;
+    for (size_t i = 0; i < narms; i++) {
+        EmpMatchArm *a = arm_at(s, i);
+        if (!a) continue;
+        if (a->is_default) {
+            if (!else_arm) else_arm = a;
+            continue;
+        }
+        uint64_t v = 0;
+        (void)pattern_bits(a->value, &v, &bits, &is_signed);
+        uint64_t key = order_key(v, bits, is_signed);
+        bool seen = false;
+        for (size_t k = 0; k < ncases && !seen; k++) seen = keys[k] == key;
+        if (seen) {
+            // The first arm with a value wins.
+            a->is_dead = true;
+            c->stats.dead_arms++;
+            continue;
+        }
+        a->case_value = v;
+        a->is_case = true;
+        keys[ncases++] = key;
+    }
+    if (!ncases) {
+        free(keys);
+        return;
+    }
+
+    // Small types can be covered completely (`true` and `false`, all 256 `u8`s).
+    bool all = bits <= 16 && ncases == (size_t)1 << bits;
+    if (all && else_arm) {
+        else_arm->is_dead = true;
+        c->stats.dead_arms++;
+    }
+    s->as.match_stmt.default_unreachable = all;
+    s->as.match_stmt.lowering = switch_kind(keys, ncases);
+    free(keys);
+}
+
+static void plan_match(MtCtx *c, EmpStmt *s) {
+    s->as.match_stmt.lowering = EMP_MATCH_CHAIN;
+    s->as.match_stmt.default_unreachable = false;
+    for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+        EmpMatchArm *a = arm_at(s, i);
+        if (!a) continue;
+        a->case_value = 0;
+        a->is_case = false;
+        a->is_dead = false;
+    }
+
+    const EmpItemEnum *en = find_enum(c, s->as.match_stmt.scrutinee_ty);
+    if (en && en->align) plan_enum_match(c, s, en);
+    else if (!en) plan_value_match(c, s);
+
+    c->stats.matches++;
+    if (s->as.match_stmt.lowering == EMP_MATCH_TABLE) c->stats.tables++;
+    else if (s->as.match_stmt.lowering == EMP_MATCH_SWITCH) c->stats.switches++;
+    else c->stats.chains++;
+    if (s->as.match_stmt.default_unreachable) c->stats.unreachable++;
+}
+
+static void walk_stmt(MtCtx *c, EmpStmt *s) {
+    if (!s) return;
+    switch (s->kind) {
+        case EMP_STMT_DEFER:
+            walk_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) walk_stmt(c, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            walk_stmt(c, s->as.if_stmt.then_branch);
+            walk_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            walk_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            walk_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            plan_match(c, s);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *a = arm_at(s, i);
+                if (a) walk_stmt(c, a->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            walk_stmt(c, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            walk_stmt(c, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+void emp_sem_plan_matches(EmpProgram *program, EmpMatchStats *out_stats) {
+    MtCtx c;
+    memset(&c, 0, sizeof(c));
+    c.program = program;
+    for (size_t i = 0; program && i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_FN) {
+            walk_stmt(&c, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) walk_stmt(&c, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) walk_stmt(&c, m->body);
+            }
+        }
+    }
+    if (out_stats) *out_stats = c.stats;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A `switch` becomes a jump table from this many cases up, when at least this percent of the
+// values between its smallest and largest case have one (LLVM's own defaults).
+#define EMP_MATCH_TABLE_MIN_CASES 4u
+#define EMP_MATCH_TABLE_MIN_DENSITY 40u
+
+typedef struct EmpMatchStats {
+    size_t matches;     // `match` statements planned
+    size_t tables;      // of those, EMP_MATCH_TABLE
+    size_t switches;    // EMP_MATCH_SWITCH
+    size_t chains;      // EMP_MATCH_CHAIN
+    size_t unreachable; // matches whose `switch` default is `unreachable`
+    size_t dead_arms;   // arms that can never run (EmpMatchArm.is_dead)
+} EmpMatchStats;
+
+// Match lowering (run on the checked program after emp_sem_plan_layouts, which it needs for
+// enum tags).
+//
+// Patterns are one level deep (`Enum::Variant(a, b)`, or a value), so the decision tree of a
+// match is a single test of the scrutinee:
+// - An enum match switches on the stored tag: arm k gets case_value = its variant index. For a
+//   niche enum (EmpItemEnum.tag_size == 0) codegen switches on the niche integer instead: the
+//   variants without a payload are cases niche_start + 0, 1, ..., and the payload variant is the
+//   `switch` default. An `else` arm takes the variants that have no arm of their own.
+// - A match on an integer, `char` or `bool` whose patterns are all constants (literals, consts,
+//   folded `const fn` calls; EmpMatchArm.value) switches on the value. A later arm with the
+//   value of an earlier one is dead.
+// - Anything else (strings, runtime patterns) stays EMP_MATCH_CHAIN.
+// A switch with dense cases is EMP_MATCH_TABLE: codegen emits the `switch` as is and LLVM
+// builds a jump table. Sparse ones are EMP_MATCH_SWITCH, which LLVM splits into clusters under
+// a balanced compare tree. When the arms cover every value (all variants, both `bool`s, all 256
+// `u8`s), the match gets default_unreachable, any `else` arm is dead, and codegen emits the
+// default as `unreachable`, so no range check guards the table.
+//
+// `out_stats` may be NULL.
+void emp_sem_plan_matches(EmpProgram *program, EmpMatchStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
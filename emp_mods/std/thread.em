@@ -0,0 +1,8 @@
+// Threads. The supported way to use several cores is `parallel for i in a..b { ... }`
+// (docs/08_control_flow.md): iterations run on a work-stealing pool of cpu_count() workers
+// that exists only for the duration of the loop, so there are still no background threads.
+
+// Number of CPUs the scheduler will use (at least 1).
+export fn cpu_count() -> i32 {
+  return thread_count();
+}
@@ -0,0 +1,456 @@
+#include "emp_reach.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Set of referenced names (deduplicated). Names are slices into source/arena memory.
+typedef struct EmpReachNames {
+    EmpSlice *items;
+    size_t len;
+    size_t cap;
+} EmpReachNames;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static bool slice_is(EmpSlice s, const char *lit) {
+    size_t n = strlen(lit);
+    return s.len == n && s.ptr && memcmp(s.ptr, lit, n) == 0;
+}
+
+static bool names_contains(const EmpReachNames *ns, EmpSlice name) {
+    for (size_t i = 0; i < ns->len; i++) {
+        if (slice_eq(ns->items[i], name)) return true;
+    }
+    return false;
+}
+
+// True when `name` itself, or an overload-mangled form `name__...`, was referenced.
+static bool names_contains_fn(const EmpReachNames *ns, EmpSlice name) {
+    for (size_t i = 0; i < ns->len; i++) {
+        EmpSlice r = ns->items[i];
+        if (slice_eq(r, name)) return true;
+        if (r.len > name.len + 2 && memcmp(r.ptr, name.ptr, name.len) == 0 && r.ptr[name.len] == '_' && r.ptr[name.len + 1] == '_') {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void names_add(EmpReachNames *ns, EmpSlice name) {
+    if (!name.ptr || !name.len) return;
+    if (names_contains(ns, name)) return;
+    if (ns->len + 1 > ns->cap) {
+        size_t new_cap = ns->cap ? ns->cap * 2 : 64;
+        EmpSlice *p = (EmpSlice *)realloc(ns->items, new_cap * sizeof(EmpSlice));
+        if (!p) return;
+        ns->items = p;
+        ns->cap = new_cap;
+    }
+    ns->items[ns->len++] = name;
+}
+
+static void scan_expr(EmpReachNames *ns, const EmpExpr *e);
+static void scan_stmt(EmpReachNames *ns, const EmpStmt *s);
+
+static void scan_type(EmpReachNames *ns, const EmpType *t) {
+    if (!t) return;
+    switch (t->kind) {
+        case EMP_TYPE_NAME:
+            names_add(ns, t->as.name);
+            return;
+        case EMP_TYPE_DYN:
+            names_add(ns, t->as.dyn.base_name);
+            return;
+        case EMP_TYPE_PTR:
+            scan_type(ns, t->as.ptr.pointee);
+            return;
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            scan_type(ns, t->as.array.elem);
+            return;
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                if (f) scan_type(ns, f->ty);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static void scan_exprs(EmpReachNames *ns, const EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) {
+        scan_expr(ns, (const EmpExpr *)v->items[i]);
+    }
+}
+
+static void scan_expr(EmpReachNames *ns, const EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_IDENT:
+            names_add(ns, e->as.lit);
+            return;
+
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) scan_expr(ns, pt->expr);
+            }
+            return;
+
+        case EMP_EXPR_UNARY:
+            scan_expr(ns, e->as.unary.rhs);
+            return;
+
+        case EMP_EXPR_BINARY:
+            scan_expr(ns, e->as.binary.lhs);
+            scan_expr(ns, e->as.binary.rhs);
+            return;
+
+        case EMP_EXPR_CALL:
+            scan_expr(ns, e->as.call.callee);
+            scan_exprs(ns, &e->as.call.args);
+            names_add(ns, e->as.call.resolved_name);
+            names_add(ns, e->as.call.dyn_base_name);
+            return;
+
+        case EMP_EXPR_GROUP:
+            scan_expr(ns, e->as.group.inner);
+            return;
+
+        case EMP_EXPR_CAST:
+            scan_type(ns, e->as.cast.ty);
+            scan_expr(ns, e->as.cast.expr);
+            names_add(ns, e->as.cast.dyn_concrete_name);
+            return;
+
+        case EMP_EXPR_TUPLE:
+            scan_exprs(ns, &e->as.tuple.items);
+            return;
+
+        case EMP_EXPR_LIST:
+            scan_exprs(ns, &e->as.list.items);
+            return;
+
+        case EMP_EXPR_INDEX:
+            scan_expr(ns, e->as.index.base);
+            scan_expr(ns, e->as.index.index);
+            return;
+
+        case EMP_EXPR_MEMBER:
+            // Method names are recorded too so impls reached only via `x.method()` / UFCS survive.
+            scan_expr(ns, e->as.member.base);
+            names_add(ns, e->as.member.member);
+            return;
+
+        case EMP_EXPR_NEW:
+            names_add(ns, e->as.new_expr.class_name);
+            scan_exprs(ns, &e->as.new_expr.args);
+            return;
+
+        case EMP_EXPR_TERNARY:
+            scan_expr(ns, e->as.ternary.cond);
+            scan_expr(ns, e->as.ternary.then_expr);
+            scan_expr(ns, e->as.ternary.else_expr);
+            return;
+
+        case EMP_EXPR_RANGE:
+            scan_expr(ns, e->as.range.start);
+            scan_expr(ns, e->as.range.end);
+            return;
+
+        default:
+            return;
+    }
+}
+
+static void scan_stmt(EmpReachNames *ns, const EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            scan_type(ns, s->as.let_stmt.ty);
+            scan_expr(ns, s->as.let_stmt.init);
+            return;
+
+        case EMP_STMT_DEFER:
+            scan_stmt(ns, s->as.defer_stmt.body);
+            return;
+
+        case EMP_STMT_RETURN:
+            scan_expr(ns, s->as.ret.value);
+            return;
+
+        case EMP_STMT_YIELD:
+            scan_expr(ns, s->as.yield_stmt.value);
+            return;
+
+        case EMP_STMT_EXPR:
+            scan_expr(ns, s->as.expr.expr);
+            return;
+
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) {
+                scan_stmt(ns, (const EmpStmt *)s->as.block.stmts.items[i]);
+            }
+            return;
+
+        case EMP_STMT_IF:
+            scan_expr(ns, s->as.if_stmt.cond);
+            scan_stmt(ns, s->as.if_stmt.then_branch);
+            scan_stmt(ns, s->as.if_stmt.else_branch);
+            return;
+
+        case EMP_STMT_WHILE:
+            scan_expr(ns, s->as.while_stmt.cond);
+            scan_stmt(ns, s->as.while_stmt.body);
+            return;
+
+        case EMP_STMT_FOR:
+            scan_expr(ns, s->as.for_stmt.iterable);
+            scan_stmt(ns, s->as.for_stmt.body);
+            return;
+
+        case EMP_STMT_MATCH:
+            scan_expr(ns, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *a = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!a) continue;
+                scan_expr(ns, a->pat);
+                scan_stmt(ns, a->body);
+            }
+            return;
+
+        case EMP_STMT_EMP_OFF:
+            scan_stmt(ns, s->as.emp_off.body);
+            return;
+
+        case EMP_STMT_EMP_MM_OFF:
+            scan_stmt(ns, s->as.emp_mm_off.body);
+            return;
+
+        default:
+            return;
+    }
+}
+
+static void scan_params(EmpReachNames *ns, const EmpVec *params) {
+    for (size_t i = 0; i < params->len; i++) {
+        const EmpParam *p = (const EmpParam *)params->items[i];
+        if (p) scan_type(ns, p->ty);
+    }
+}
+
+static void scan_item(EmpReachNames *ns, const EmpItem *it) {
+    switch (it->kind) {
+        case EMP_ITEM_FN:
+            scan_params(ns, &it->as.fn.params);
+            scan_type(ns, it->as.fn.ret_ty);
+            scan_stmt(ns, it->as.fn.body);
+            return;
+
+        case EMP_ITEM_CLASS:
+            // A live class keeps its whole vtable (and therefore every method) alive.
+            names_add(ns, it->as.class_decl.base_name);
+            for (size_t i = 0; i < it->as.class_decl.fields.len; i++) {
+                const EmpClassField *f = (const EmpClassField *)it->as.class_decl.fields.items[i];
+                if (f) scan_type(ns, f->ty);
+            }
+            for (size_t i = 0; i < it->as.class_decl.methods.len; i++) {
+                const EmpClassMethod *m = (const EmpClassMethod *)it->as.class_decl.methods.items[i];
+                if (!m) continue;
+                scan_params(ns, &m->params);
+                scan_type(ns, m->ret_ty);
+                scan_stmt(ns, m->body);
+            }
+            return;
+
+        case EMP_ITEM_TRAIT:
+            for (size_t i = 0; i < it->as.trait_decl.methods.len; i++) {
+                const EmpTraitMethod *m = (const EmpTraitMethod *)it->as.trait_decl.methods.items[i];
+                if (!m) continue;
+                scan_params(ns, &m->params);
+                scan_type(ns, m->ret_ty);
+                scan_stmt(ns, m->body);
+            }
+            return;
+
+        case EMP_ITEM_CONST:
+            scan_type(ns, it->as.const_decl.ty);
+            scan_expr(ns, it->as.const_decl.init);
+            return;
+
+        case EMP_ITEM_STRUCT:
+            for (size_t i = 0; i < it->as.struct_decl.fields.len; i++) {
+                const EmpStructField *f = (const EmpStructField *)it->as.struct_decl.fields.items[i];
+                if (f) scan_type(ns, f->ty);
+            }
+            return;
+
+        case EMP_ITEM_ENUM:
+            for (size_t i = 0; i < it->as.enum_decl.variants.len; i++) {
+                const EmpEnumVariant *v = (const EmpEnumVariant *)it->as.enum_decl.variants.items[i];
+                if (!v) continue;
+                for (size_t j = 0; j < v->fields.len; j++) {
+                    scan_type(ns, (const EmpType *)v->fields.items[j]);
+                }
+            }
+            return;
+
+        case EMP_ITEM_IMPL:
+            names_add(ns, it->as.impl_decl.trait_name);
+            names_add(ns, it->as.impl_decl.target_name);
+            for (size_t i = 0; i < it->as.impl_decl.methods.len; i++) {
+                const EmpImplMethod *m = (const EmpImplMethod *)it->as.impl_decl.methods.items[i];
+                if (!m) continue;
+                scan_params(ns, &m->params);
+                scan_type(ns, m->ret_ty);
+                scan_stmt(ns, m->body);
+            }
+            return;
+
+        default:
+            return;
+    }
+}
+
+static bool item_is_directive(const EmpItem *it) {
+    return it->kind == EMP_ITEM_TAG || it->kind == EMP_ITEM_EMP_MM_OFF || it->kind == EMP_ITEM_USE;
+}
+
+static bool program_contains_item(const EmpProgram *p, const EmpItem *it) {
+    if (!p) return false;
+    for (size_t i = 0; i < p->items.len; i++) {
+        if ((const EmpItem *)p->items.items[i] == it) return true;
+    }
+    return false;
+}
+
+static bool item_is_root(const EmpItem *it, const EmpProgram *entry) {
+    bool exported = false;
+    switch (it->kind) {
+        case EMP_ITEM_FN:
+            if (slice_is(it->as.fn.name, "main")) return true;
+            if (it->as.fn.is_extern && it->as.fn.body) return true;
+            exported = it->as.fn.is_exported;
+            break;
+        case EMP_ITEM_CLASS: exported = it->as.class_decl.is_exported; break;
+        case EMP_ITEM_TRAIT: exported = it->as.trait_decl.is_exported; break;
+        case EMP_ITEM_CONST: exported = it->as.const_decl.is_exported; break;
+        case EMP_ITEM_STRUCT: exported = it->as.struct_decl.is_exported; break;
+        case EMP_ITEM_ENUM: exported = it->as.enum_decl.is_exported; break;
+        default: return false;
+    }
+    if (!exported) return false;
+    return !entry || program_contains_item(entry, it);
+}
+
+static bool item_is_referenced(const EmpItem *it, const EmpReachNames *ns) {
+    switch (it->kind) {
+        case EMP_ITEM_FN:
+            return names_contains_fn(ns, it->as.fn.name);
+        case EMP_ITEM_CLASS:
+            return names_contains(ns, it->as.class_decl.name);
+        case EMP_ITEM_TRAIT:
+            return names_contains(ns, it->as.trait_decl.name);
+        case EMP_ITEM_CONST:
+            return names_contains(ns, it->as.const_decl.name);
+        case EMP_ITEM_STRUCT:
+            return names_contains(ns, it->as.struct_decl.name);
+        case EMP_ITEM_ENUM:
+            return names_contains(ns, it->as.enum_decl.name);
+        case EMP_ITEM_IMPL: {
+            if (names_contains(ns, it->as.impl_decl.target_name)) return true;
+            // Impls on builtin/foreign targets: keep when any method name is used (UFCS / method call).
+            for (size_t i = 0; i < it->as.impl_decl.methods.len; i++) {
+                const EmpImplMethod *m = (const EmpImplMethod *)it->as.impl_decl.methods.items[i];
+                if (m && names_contains(ns, m->name)) return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+static void mark_linkage(EmpItem *it) {
+    if (it->kind == EMP_ITEM_FN) {
+        EmpItemFn *fn = &it->as.fn;
+        fn->is_internal = !fn->is_exported && !fn->is_extern && !slice_is(fn->name, "main");
+        return;
+    }
+    if (it->kind == EMP_ITEM_CLASS) {
+        for (size_t i = 0; i < it->as.class_decl.methods.len; i++) {
+            EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[i];
+            if (m) m->is_internal = !it->as.class_decl.is_exported && !m->is_exported;
+        }
+        return;
+    }
+    if (it->kind == EMP_ITEM_IMPL) {
+        for (size_t i = 0; i < it->as.impl_decl.methods.len; i++) {
+            EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[i];
+            if (m) m->is_internal = !m->is_exported;
+        }
+        return;
+    }
+}
+
+size_t emp_sem_eliminate_dead_items(EmpProgram *program, const EmpProgram *entry) {
+    if (!program || !program->items.len) return 0;
+
+    size_t n = program->items.len;
+    bool *live = (bool *)calloc(n, sizeof(bool));
+    if (!live) return 0;
+
+    EmpReachNames ns;
+    memset(&ns, 0, sizeof(ns));
+
+    for (size_t i = 0; i < n; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (item_is_directive(it) || item_is_root(it, entry)) {
+            live[i] = true;
+            scan_item(&ns, it);
+        }
+    }
+
+    // Fixpoint: names are only ever added, so an item that becomes referenced stays live.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < n; i++) {
+            const EmpItem *it = (const EmpItem *)program->items.items[i];
+            if (!it || live[i]) continue;
+            if (!item_is_referenced(it, &ns)) continue;
+            live[i] = true;
+            scan_item(&ns, it);
+            changed = true;
+        }
+    }
+
+    size_t kept = 0;
+    size_t removed = 0;
+    for (size_t i = 0; i < n; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (!live[i]) {
+            removed++;
+            continue;
+        }
+        mark_linkage(it);
+        program->items.items[kept++] = it;
+    }
+    program->items.len = kept;
+
+    free(ns.items);
+    free(live);
+    return removed;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reachability / dead-item elimination over a merged (whole-program) EmpProgram.
+//
+// Roots:
+// - `fn main`
+// - `extern` functions that have a body (callable from C)
+// - exported items of `entry` (the module being built); exports of imported modules
+//   are only kept when something reachable refers to them
+//
+// Items not reachable from a root are removed from `program->items` (the nodes are
+// arena-owned and are not freed). Functions/methods that survive but are neither
+// exported, extern nor the entry point are marked `is_internal` so codegen can emit
+// them with internal linkage.
+//
+// `entry` may be NULL, in which case every exported item is a root.
+// Returns the number of removed items.
+size_t emp_sem_eliminate_dead_items(EmpProgram *program, const EmpProgram *entry);
+
+#ifdef __cplusplus
+}
+#endif
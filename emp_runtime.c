@@ -0,0 +1,751 @@
+#include "emp_runtime.h"
+
+#include <string.h>
+
+// IR templates. List and string headers must match codegen's layout, so layout-dependent bits
+// are placeholders expanded by `emp_runtime_ir` for the selected EmpLenAbi:
+// `iLEN` (i32/i64), `LENEXT` (widening to i64: zext/bitcast), `LENALIGN` (4/8), and for inline
+// strings `SSOMAX` (14/22) and `SSOTAG` (offset of the tag byte, 15/23).
+
+// Platform part: the heap primitives everything else allocates through, and OS threads
+// (spawn/join/count/yield) for the work-stealing scheduler below.
+#ifdef _WIN32
+static const char k_rt_platform[] =
+    "; EMP runtime: list growth, strings, integer formatting, threads.\n"
+    "source_filename = \"emp_rt\"\n"
+    "\n"
+    "declare ptr @GetProcessHeap()\n"
+    "declare ptr @HeapAlloc(ptr, i32, i64)\n"
+    "declare ptr @HeapReAlloc(ptr, i32, ptr, i64)\n"
+    "declare i32 @HeapFree(ptr, i32, ptr)\n"
+    "declare void @ExitProcess(i32) noreturn\n"
+    "\n"
+    "; Allocate (`p` null) or resize `p` to `bytes`; exits on out-of-memory.\n"
+    "define internal ptr @emp.heap.realloc(ptr %p, i64 %bytes) #0 {\n"
+    "entry:\n"
+    "  %heap = call ptr @GetProcessHeap()\n"
+    "  %isnull = icmp eq ptr %p, null\n"
+    "  br i1 %isnull, label %alloc, label %realloc\n"
+    "alloc:\n"
+    "  %mem0 = call ptr @HeapAlloc(ptr %heap, i32 0, i64 %bytes)\n"
+    "  br label %merge\n"
+    "realloc:\n"
+    "  %mem1 = call ptr @HeapReAlloc(ptr %heap, i32 0, ptr %p, i64 %bytes)\n"
+    "  br label %merge\n"
+    "merge:\n"
+    "  %mem = phi ptr [ %mem0, %alloc ], [ %mem1, %realloc ]\n"
+    "  %oom = icmp eq ptr %mem, null\n"
+    "  br i1 %oom, label %fail, label %ok\n"
+    "fail:\n"
+    "  call void @ExitProcess(i32 3)\n"
+    "  unreachable\n"
+    "ok:\n"
+    "  ret ptr %mem\n"
+    "}\n"
+    "\n"
+    "define internal void @emp.heap.free(ptr %p) #0 {\n"
+    "entry:\n"
+    "  %heap = call ptr @GetProcessHeap()\n"
+    "  %ok = call i32 @HeapFree(ptr %heap, i32 0, ptr %p)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "declare ptr @CreateThread(ptr, i64, ptr, ptr, i32, ptr)\n"
+    "declare i32 @WaitForSingleObject(ptr, i32)\n"
+    "declare i32 @CloseHandle(ptr)\n"
+    "declare i32 @GetActiveProcessorCount(i16)\n"
+    "declare i32 @SwitchToThread()\n"
+    "\n"
+    "; Start `fn(arg)` (a `ptr (ptr)` thread routine) on a new thread; exits if it cannot.\n"
+    "define ptr @emp.thread.spawn(ptr %fn, ptr %arg) #0 {\n"
+    "entry:\n"
+    "  %h = call ptr @CreateThread(ptr null, i64 0, ptr %fn, ptr %arg, i32 0, ptr null)\n"
+    "  %bad = icmp eq ptr %h, null\n"
+    "  br i1 %bad, label %fail, label %ok\n"
+    "fail:\n"
+    "  call void @ExitProcess(i32 3)\n"
+    "  unreachable\n"
+    "ok:\n"
+    "  ret ptr %h\n"
+    "}\n"
+    "\n"
+    "; Wait for a thread from @emp.thread.spawn and release its handle.\n"
+    "define void @emp.thread.join(ptr %h) #0 {\n"
+    "entry:\n"
+    "  %w = call i32 @WaitForSingleObject(ptr %h, i32 -1)\n"
+    "  %c = call i32 @CloseHandle(ptr %h)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Online CPUs across all processor groups (at least 1).\n"
+    "define i32 @emp.thread.count() #1 {\n"
+    "entry:\n"
+    "  %n = call i32 @GetActiveProcessorCount(i16 -1)\n"
+    "  %few = icmp slt i32 %n, 1\n"
+    "  %n1 = select i1 %few, i32 1, i32 %n\n"
+    "  ret i32 %n1\n"
+    "}\n"
+    "\n"
+    "define void @emp.thread.yield() #1 {\n"
+    "entry:\n"
+    "  %r = call i32 @SwitchToThread()\n"
+    "  ret void\n"
+    "}\n"
+    "\n";
+#else
+// sysconf(_SC_NPROCESSORS_ONLN); the constant differs between libcs.
+#ifdef __APPLE__
+#define EMP_RT_SC_NPROCESSORS_ONLN "58"
+#else
+#define EMP_RT_SC_NPROCESSORS_ONLN "84"
+#endif
+static const char k_rt_platform[] =
+    "; EMP runtime: list growth, strings, integer formatting, threads.\n"
+    "source_filename = \"emp_rt\"\n"
+    "\n"
+    "declare ptr @realloc(ptr, i64)\n"
+    "declare void @free(ptr)\n"
+    "declare void @abort() noreturn\n"
+    "\n"
+    "; Allocate (`p` null) or resize `p` to `bytes`; aborts on out-of-memory.\n"
+    "define internal ptr @emp.heap.realloc(ptr %p, i64 %bytes) #0 {\n"
+    "entry:\n"
+    "  %mem = call ptr @realloc(ptr %p, i64 %bytes)\n"
+    "  %oom = icmp eq ptr %mem, null\n"
+    "  br i1 %oom, label %fail, label %ok\n"
+    "fail:\n"
+    "  call void @abort()\n"
+    "  unreachable\n"
+    "ok:\n"
+    "  ret ptr %mem\n"
+    "}\n"
+    "\n"
+    "define internal void @emp.heap.free(ptr %p) #0 {\n"
+    "entry:\n"
+    "  call void @free(ptr %p)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "declare i32 @pthread_create(ptr, ptr, ptr, ptr)\n"
+    "declare i32 @pthread_join(i64, ptr)\n"
+    "declare i64 @sysconf(i32)\n"
+    "declare i32 @sched_yield()\n"
+    "\n"
+    "; Start `fn(arg)` (a `ptr (ptr)` thread routine) on a new thread; aborts if it cannot.\n"
+    "define ptr @emp.thread.spawn(ptr %fn, ptr %arg) #0 {\n"
+    "entry:\n"
+    "  %h = call ptr @emp.heap.realloc(ptr null, i64 8)\n"
+    "  %rc = call i32 @pthread_create(ptr %h, ptr null, ptr %fn, ptr %arg)\n"
+    "  %bad = icmp ne i32 %rc, 0\n"
+    "  br i1 %bad, label %fail, label %ok\n"
+    "fail:\n"
+    "  call void @abort()\n"
+    "  unreachable\n"
+    "ok:\n"
+    "  ret ptr %h\n"
+    "}\n"
+    "\n"
+    "; Wait for a thread from @emp.thread.spawn and release its handle.\n"
+    "define void @emp.thread.join(ptr %h) #0 {\n"
+    "entry:\n"
+    "  %t = load i64, ptr %h, align 8\n"
+    "  %rc = call i32 @pthread_join(i64 %t, ptr null)\n"
+    "  call void @emp.heap.free(ptr %h)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Online CPUs (at least 1).\n"
+    "define i32 @emp.thread.count() #1 {\n"
+    "entry:\n"
+    "  %n = call i64 @sysconf(i32 " EMP_RT_SC_NPROCESSORS_ONLN ")\n"
+    "  %few = icmp slt i64 %n, 1\n"
+    "  %n1 = select i1 %few, i64 1, i64 %n\n"
+    "  %n32 = trunc i64 %n1 to i32\n"
+    "  ret i32 %n32\n"
+    "}\n"
+    "\n"
+    "define void @emp.thread.yield() #1 {\n"
+    "entry:\n"
+    "  %rc = call i32 @sched_yield()\n"
+    "  ret void\n"
+    "}\n"
+    "\n";
+#endif
+
+// Target-independent part.
+static const char k_rt_common[] =
+    "%emp.list = type { ptr, iLEN, iLEN }\n"
+    "%emp.string = type { ptr, iLEN, iLEN }\n"
+    "\n"
+    "define internal void @emp.list.realloc(ptr %list, iLEN %cap, i64 %elem_size) #0 {\n"
+    "entry:\n"
+    "  %data.addr = getelementptr inbounds %emp.list, ptr %list, i32 0, i32 0\n"
+    "  %cap.addr = getelementptr inbounds %emp.list, ptr %list, i32 0, i32 2\n"
+    "  %data = load ptr, ptr %data.addr, align 8\n"
+    "  %cap64 = LENEXT iLEN %cap to i64\n"
+    "  %bytes = mul i64 %cap64, %elem_size\n"
+    "  %mem = call ptr @emp.heap.realloc(ptr %data, i64 %bytes)\n"
+    "  store ptr %mem, ptr %data.addr, align 8\n"
+    "  store iLEN %cap, ptr %cap.addr, align LENALIGN\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Grow so the list holds at least `need` elements (push/insert slow path).\n"
+    "define void @emp.list.grow(ptr %list, iLEN %need, i64 %elem_size) #0 {\n"
+    "entry:\n"
+    "  %cap.addr = getelementptr inbounds %emp.list, ptr %list, i32 0, i32 2\n"
+    "  %cap = load iLEN, ptr %cap.addr, align LENALIGN\n"
+    "  %cap0 = icmp eq iLEN %cap, 0\n"
+    "  %cap2 = mul iLEN %cap, 2\n"
+    "  %geo = select i1 %cap0, iLEN 4, iLEN %cap2\n"
+    "  %short = icmp ult iLEN %geo, %need\n"
+    "  %newcap = select i1 %short, iLEN %need, iLEN %geo\n"
+    "  call void @emp.list.realloc(ptr %list, iLEN %newcap, i64 %elem_size)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Grow to exactly `need` elements (reserve slow path).\n"
+    "define void @emp.list.reserve.slow(ptr %list, iLEN %need, i64 %elem_size) #0 {\n"
+    "entry:\n"
+    "  call void @emp.list.realloc(ptr %list, iLEN %need, i64 %elem_size)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; @soa lists keep every column in one block: column k of `cols` at data + cap * (bytes per\n"
+    "; element of columns 0..k-1). A new capacity moves each column to its new start.\n"
+    "define internal void @emp.soa.realloc(ptr %list, iLEN %cap, ptr %cols, i32 %ncols) #0 {\n"
+    "entry:\n"
+    "  %data.addr = getelementptr inbounds %emp.list, ptr %list, i32 0, i32 0\n"
+    "  %len.addr = getelementptr inbounds %emp.list, ptr %list, i32 0, i32 1\n"
+    "  %cap.addr = getelementptr inbounds %emp.list, ptr %list, i32 0, i32 2\n"
+    "  %old = load ptr, ptr %data.addr, align 8\n"
+    "  %len = load iLEN, ptr %len.addr, align LENALIGN\n"
+    "  %oldcap = load iLEN, ptr %cap.addr, align LENALIGN\n"
+    "  %len64 = LENEXT iLEN %len to i64\n"
+    "  %old64 = LENEXT iLEN %oldcap to i64\n"
+    "  %new64 = LENEXT iLEN %cap to i64\n"
+    "  br label %row\n"
+    "row:\n"
+    "  %k = phi i32 [ 0, %entry ], [ %k1, %row.col ]\n"
+    "  %bytes.row = phi i64 [ 0, %entry ], [ %bytes.row1, %row.col ]\n"
+    "  %row.more = icmp ult i32 %k, %ncols\n"
+    "  br i1 %row.more, label %row.col, label %alloc\n"
+    "row.col:\n"
+    "  %ksz.addr = getelementptr inbounds i64, ptr %cols, i32 %k\n"
+    "  %ksz = load i64, ptr %ksz.addr, align 8\n"
+    "  %bytes.row1 = add i64 %bytes.row, %ksz\n"
+    "  %k1 = add i32 %k, 1\n"
+    "  br label %row\n"
+    "alloc:\n"
+    "  %bytes = mul i64 %new64, %bytes.row\n"
+    "  %mem = call ptr @emp.heap.realloc(ptr null, i64 %bytes)\n"
+    "  br label %move\n"
+    "move:\n"
+    "  %c = phi i32 [ 0, %alloc ], [ %c1, %move.col ]\n"
+    "  %pre = phi i64 [ 0, %alloc ], [ %pre1, %move.col ]\n"
+    "  %move.more = icmp ult i32 %c, %ncols\n"
+    "  br i1 %move.more, label %move.col, label %release\n"
+    "move.col:\n"
+    "  %csz.addr = getelementptr inbounds i64, ptr %cols, i32 %c\n"
+    "  %csz = load i64, ptr %csz.addr, align 8\n"
+    "  %src.off = mul i64 %old64, %pre\n"
+    "  %dst.off = mul i64 %new64, %pre\n"
+    "  %src = getelementptr inbounds i8, ptr %old, i64 %src.off\n"
+    "  %dst = getelementptr inbounds i8, ptr %mem, i64 %dst.off\n"
+    "  %n = mul i64 %len64, %csz\n"
+    "  call void @llvm.memcpy.p0.p0.i64(ptr %dst, ptr %src, i64 %n, i1 false)\n"
+    "  %pre1 = add i64 %pre, %csz\n"
+    "  %c1 = add i32 %c, 1\n"
+    "  br label %move\n"
+    "release:\n"
+    "  %had = icmp ne ptr %old, null\n"
+    "  br i1 %had, label %free, label %store\n"
+    "free:\n"
+    "  call void @emp.heap.free(ptr %old)\n"
+    "  br label %store\n"
+    "store:\n"
+    "  store ptr %mem, ptr %data.addr, align 8\n"
+    "  store iLEN %cap, ptr %cap.addr, align LENALIGN\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; @soa counterpart of @emp.list.grow; `cols` lists the column element sizes in storage order.\n"
+    "define void @emp.soa.grow(ptr %list, iLEN %need, ptr %cols, i32 %ncols) #0 {\n"
+    "entry:\n"
+    "  %cap.addr = getelementptr inbounds %emp.list, ptr %list, i32 0, i32 2\n"
+    "  %cap = load iLEN, ptr %cap.addr, align LENALIGN\n"
+    "  %cap0 = icmp eq iLEN %cap, 0\n"
+    "  %cap2 = mul iLEN %cap, 2\n"
+    "  %geo = select i1 %cap0, iLEN 4, iLEN %cap2\n"
+    "  %short = icmp ult iLEN %geo, %need\n"
+    "  %newcap = select i1 %short, iLEN %need, iLEN %geo\n"
+    "  call void @emp.soa.realloc(ptr %list, iLEN %newcap, ptr %cols, i32 %ncols)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "define void @emp.soa.reserve.slow(ptr %list, iLEN %need, ptr %cols, i32 %ncols) #0 {\n"
+    "entry:\n"
+    "  call void @emp.soa.realloc(ptr %list, iLEN %need, ptr %cols, i32 %ncols)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Inline strings keep their bytes and a NUL in the header itself; the tag byte at offset\n"
+    "; SSOTAG (top byte of `cap`) is 0x80 | len. Heap strings never set that bit.\n"
+    "define ptr @emp.string.data(ptr %s) #1 {\n"
+    "entry:\n"
+    "  %tag.addr = getelementptr inbounds i8, ptr %s, i64 SSOTAG\n"
+    "  %tag = load i8, ptr %tag.addr, align 1\n"
+    "  %inline = icmp slt i8 %tag, 0\n"
+    "  br i1 %inline, label %small, label %heap\n"
+    "small:\n"
+    "  ret ptr %s\n"
+    "heap:\n"
+    "  %data = load ptr, ptr %s, align 8\n"
+    "  ret ptr %data\n"
+    "}\n"
+    "\n"
+    "define iLEN @emp.string.len(ptr %s) #1 {\n"
+    "entry:\n"
+    "  %tag.addr = getelementptr inbounds i8, ptr %s, i64 SSOTAG\n"
+    "  %tag = load i8, ptr %tag.addr, align 1\n"
+    "  %inline = icmp slt i8 %tag, 0\n"
+    "  br i1 %inline, label %small, label %heap\n"
+    "small:\n"
+    "  %len7 = and i8 %tag, 127\n"
+    "  %slen = zext i8 %len7 to iLEN\n"
+    "  ret iLEN %slen\n"
+    "heap:\n"
+    "  %len.addr = getelementptr inbounds %emp.string, ptr %s, i32 0, i32 1\n"
+    "  %hlen = load iLEN, ptr %len.addr, align LENALIGN\n"
+    "  ret iLEN %hlen\n"
+    "}\n"
+    "\n"
+    "; Heap path of emp.string.from_bytes; cap counts the allocated bytes (len + NUL).\n"
+    "define internal void @emp.string.alloc(ptr %out, ptr %src, iLEN %n) #0 {\n"
+    "entry:\n"
+    "  %n64 = LENEXT iLEN %n to i64\n"
+    "  %bytes = add i64 %n64, 1\n"
+    "  %mem = call ptr @emp.heap.realloc(ptr null, i64 %bytes)\n"
+    "  call void @llvm.memcpy.p0.p0.i64(ptr %mem, ptr %src, i64 %n64, i1 false)\n"
+    "  %nul = getelementptr inbounds i8, ptr %mem, i64 %n64\n"
+    "  store i8 0, ptr %nul, align 1\n"
+    "  %len.addr = getelementptr inbounds %emp.string, ptr %out, i32 0, i32 1\n"
+    "  %cap.addr = getelementptr inbounds %emp.string, ptr %out, i32 0, i32 2\n"
+    "  %cap = add iLEN %n, 1\n"
+    "  store ptr %mem, ptr %out, align 8\n"
+    "  store iLEN %n, ptr %len.addr, align LENALIGN\n"
+    "  store iLEN %cap, ptr %cap.addr, align LENALIGN\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Initialize `out` with a copy of `n` bytes at `src`; allocates only when n > SSOMAX.\n"
+    "define void @emp.string.from_bytes(ptr %out, ptr %src, iLEN %n) #1 {\n"
+    "entry:\n"
+    "  %fits = icmp ule iLEN %n, SSOMAX\n"
+    "  br i1 %fits, label %small, label %heap\n"
+    "small:\n"
+    "  %n64 = LENEXT iLEN %n to i64\n"
+    "  call void @llvm.memcpy.p0.p0.i64(ptr %out, ptr %src, i64 %n64, i1 false)\n"
+    "  %nul = getelementptr inbounds i8, ptr %out, i64 %n64\n"
+    "  store i8 0, ptr %nul, align 1\n"
+    "  %n8 = trunc iLEN %n to i8\n"
+    "  %tag = or i8 %n8, -128\n"
+    "  %tag.addr = getelementptr inbounds i8, ptr %out, i64 SSOTAG\n"
+    "  store i8 %tag, ptr %tag.addr, align 1\n"
+    "  ret void\n"
+    "heap:\n"
+    "  call void @emp.string.alloc(ptr %out, ptr %src, iLEN %n)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "define void @emp.string.clone(ptr %out, ptr %s) #1 {\n"
+    "entry:\n"
+    "  %data = call ptr @emp.string.data(ptr %s)\n"
+    "  %len = call iLEN @emp.string.len(ptr %s)\n"
+    "  call void @emp.string.from_bytes(ptr %out, ptr %data, iLEN %len)\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Frees heap strings only; inline strings own no memory.\n"
+    "define void @emp.string.drop(ptr %s) #1 {\n"
+    "entry:\n"
+    "  %tag.addr = getelementptr inbounds i8, ptr %s, i64 SSOTAG\n"
+    "  %tag = load i8, ptr %tag.addr, align 1\n"
+    "  %inline = icmp slt i8 %tag, 0\n"
+    "  br i1 %inline, label %done, label %heap\n"
+    "heap:\n"
+    "  %data = load ptr, ptr %s, align 8\n"
+    "  %isnull = icmp eq ptr %data, null\n"
+    "  br i1 %isnull, label %done, label %free\n"
+    "free:\n"
+    "  call void @emp.heap.free(ptr %data)\n"
+    "  br label %done\n"
+    "done:\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Decimal digits of `v` written to `dst` (no NUL); returns the count, 1..20.\n"
+    "define i32 @emp.fmt.u64(ptr %dst, i64 %v) #1 {\n"
+    "entry:\n"
+    "  %tmp = alloca [20 x i8], align 1\n"
+    "  br label %loop\n"
+    "loop:\n"
+    "  %n = phi i32 [ 0, %entry ], [ %n1, %loop ]\n"
+    "  %x = phi i64 [ %v, %entry ], [ %q, %loop ]\n"
+    "  %q = udiv i64 %x, 10\n"
+    "  %r = urem i64 %x, 10\n"
+    "  %r8 = trunc i64 %r to i8\n"
+    "  %digit = add i8 %r8, 48\n"
+    "  %n1 = add i32 %n, 1\n"
+    "  %pos = sub i32 20, %n1\n"
+    "  %pos64 = zext i32 %pos to i64\n"
+    "  %slot = getelementptr inbounds [20 x i8], ptr %tmp, i64 0, i64 %pos64\n"
+    "  store i8 %digit, ptr %slot, align 1\n"
+    "  %more = icmp ne i64 %q, 0\n"
+    "  br i1 %more, label %loop, label %done\n"
+    "done:\n"
+    "  %count = zext i32 %n1 to i64\n"
+    "  call void @llvm.memcpy.p0.p0.i64(ptr %dst, ptr %slot, i64 %count, i1 false)\n"
+    "  ret i32 %n1\n"
+    "}\n"
+    "\n"
+    "; Signed variant: optional '-' followed by the magnitude.\n"
+    "define i32 @emp.fmt.i64(ptr %dst, i64 %v) #1 {\n"
+    "entry:\n"
+    "  %neg = icmp slt i64 %v, 0\n"
+    "  br i1 %neg, label %minus, label %plain\n"
+    "minus:\n"
+    "  store i8 45, ptr %dst, align 1\n"
+    "  %rest = getelementptr inbounds i8, ptr %dst, i64 1\n"
+    "  %mag = sub i64 0, %v\n"
+    "  %nm = call i32 @emp.fmt.u64(ptr %rest, i64 %mag)\n"
+    "  %nm1 = add i32 %nm, 1\n"
+    "  ret i32 %nm1\n"
+    "plain:\n"
+    "  %np = call i32 @emp.fmt.u64(ptr %dst, i64 %v)\n"
+    "  ret i32 %np\n"
+    "}\n"
+    "\n"
+    "; Parallel ranges (`parallel for`): work stealing over per-worker Chase-Lev deques of\n"
+    "; subranges. A worker splits the range it runs in halves, pushing the upper half to the bottom\n"
+    "; of its deque until the rest is at most `grain` long; idle workers steal from the top, i.e.\n"
+    "; the largest pending halves. Halving keeps a deque around log2(len / grain) entries deep, so\n"
+    "; it has a fixed size; when it is full the range just runs unsplit.\n"
+    "%emp.par = type { ptr, ptr, i64, i64, i64, ptr }\n"
+    "%emp.deque = type { i64, [7 x i64], i64, [7 x i64], [128 x { i64, i64 }] }\n"
+    "%emp.par.arg = type { ptr, i64 }\n"
+    "\n"
+    "; Owner: push [lo, hi) at the bottom; false when the deque is full.\n"
+    "define internal i1 @emp.deque.push(ptr %d, i64 %lo, i64 %hi) #1 {\n"
+    "entry:\n"
+    "  %top.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 0\n"
+    "  %bot.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 2\n"
+    "  %b = load atomic i64, ptr %bot.addr monotonic, align 8\n"
+    "  %t = load atomic i64, ptr %top.addr acquire, align 8\n"
+    "  %size = sub i64 %b, %t\n"
+    "  %full = icmp sge i64 %size, 128\n"
+    "  br i1 %full, label %no, label %yes\n"
+    "no:\n"
+    "  ret i1 false\n"
+    "yes:\n"
+    "  %slot = and i64 %b, 127\n"
+    "  %lo.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 4, i64 %slot, i32 0\n"
+    "  %hi.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 4, i64 %slot, i32 1\n"
+    "  store atomic i64 %lo, ptr %lo.addr monotonic, align 8\n"
+    "  store atomic i64 %hi, ptr %hi.addr monotonic, align 8\n"
+    "  fence release\n"
+    "  %b1 = add i64 %b, 1\n"
+    "  store atomic i64 %b1, ptr %bot.addr monotonic, align 8\n"
+    "  ret i1 true\n"
+    "}\n"
+    "\n"
+    "; Owner: pop the bottom range; an empty range (lo == hi) when there is none.\n"
+    "define internal { i64, i64 } @emp.deque.take(ptr %d) #1 {\n"
+    "entry:\n"
+    "  %top.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 0\n"
+    "  %bot.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 2\n"
+    "  %b0 = load atomic i64, ptr %bot.addr monotonic, align 8\n"
+    "  %b = sub i64 %b0, 1\n"
+    "  store atomic i64 %b, ptr %bot.addr monotonic, align 8\n"
+    "  fence seq_cst\n"
+    "  %t = load atomic i64, ptr %top.addr monotonic, align 8\n"
+    "  %nonempty = icmp sle i64 %t, %b\n"
+    "  br i1 %nonempty, label %have, label %empty\n"
+    "empty:\n"
+    "  store atomic i64 %b0, ptr %bot.addr monotonic, align 8\n"
+    "  ret { i64, i64 } zeroinitializer\n"
+    "have:\n"
+    "  %slot = and i64 %b, 127\n"
+    "  %lo.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 4, i64 %slot, i32 0\n"
+    "  %hi.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 4, i64 %slot, i32 1\n"
+    "  %lo = load atomic i64, ptr %lo.addr monotonic, align 8\n"
+    "  %hi = load atomic i64, ptr %hi.addr monotonic, align 8\n"
+    "  %last = icmp eq i64 %t, %b\n"
+    "  br i1 %last, label %race, label %done\n"
+    "race:\n"
+    "  ; Last range: thieves may be after it too.\n"
+    "  %t1 = add i64 %t, 1\n"
+    "  %cx = cmpxchg ptr %top.addr, i64 %t, i64 %t1 seq_cst seq_cst\n"
+    "  %won = extractvalue { i64, i1 } %cx, 1\n"
+    "  store atomic i64 %b0, ptr %bot.addr monotonic, align 8\n"
+    "  br i1 %won, label %done, label %lost\n"
+    "lost:\n"
+    "  ret { i64, i64 } zeroinitializer\n"
+    "done:\n"
+    "  %r0 = insertvalue { i64, i64 } undef, i64 %lo, 0\n"
+    "  %r1 = insertvalue { i64, i64 } %r0, i64 %hi, 1\n"
+    "  ret { i64, i64 } %r1\n"
+    "}\n"
+    "\n"
+    "; Thief: take the top range; an empty range when there is none or another thread won it.\n"
+    "define internal { i64, i64 } @emp.deque.steal(ptr %d) #1 {\n"
+    "entry:\n"
+    "  %top.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 0\n"
+    "  %bot.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 2\n"
+    "  %t = load atomic i64, ptr %top.addr acquire, align 8\n"
+    "  fence seq_cst\n"
+    "  %b = load atomic i64, ptr %bot.addr acquire, align 8\n"
+    "  %nonempty = icmp slt i64 %t, %b\n"
+    "  br i1 %nonempty, label %have, label %empty\n"
+    "empty:\n"
+    "  ret { i64, i64 } zeroinitializer\n"
+    "have:\n"
+    "  %slot = and i64 %t, 127\n"
+    "  %lo.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 4, i64 %slot, i32 0\n"
+    "  %hi.addr = getelementptr inbounds %emp.deque, ptr %d, i32 0, i32 4, i64 %slot, i32 1\n"
+    "  %lo = load atomic i64, ptr %lo.addr monotonic, align 8\n"
+    "  %hi = load atomic i64, ptr %hi.addr monotonic, align 8\n"
+    "  %t1 = add i64 %t, 1\n"
+    "  %cx = cmpxchg ptr %top.addr, i64 %t, i64 %t1 seq_cst seq_cst\n"
+    "  %won = extractvalue { i64, i1 } %cx, 1\n"
+    "  br i1 %won, label %done, label %empty\n"
+    "done:\n"
+    "  %r0 = insertvalue { i64, i64 } undef, i64 %lo, 0\n"
+    "  %r1 = insertvalue { i64, i64 } %r0, i64 %hi, 1\n"
+    "  ret { i64, i64 } %r1\n"
+    "}\n"
+    "\n"
+    "; Run [lo, hi): push upper halves to deque `d` while longer than the grain, then run the rest.\n"
+    "define internal void @emp.par.run(ptr %par, ptr %d, i64 %lo, i64 %hi) #1 {\n"
+    "entry:\n"
+    "  %grain.addr = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 2\n"
+    "  %grain = load i64, ptr %grain.addr, align 8\n"
+    "  br label %split\n"
+    "split:\n"
+    "  %h = phi i64 [ %hi, %entry ], [ %mid, %try ]\n"
+    "  %len = sub i64 %h, %lo\n"
+    "  %big = icmp sgt i64 %len, %grain\n"
+    "  br i1 %big, label %try, label %exec\n"
+    "try:\n"
+    "  %half = lshr i64 %len, 1\n"
+    "  %mid = add i64 %lo, %half\n"
+    "  %pushed = call i1 @emp.deque.push(ptr %d, i64 %mid, i64 %h)\n"
+    "  br i1 %pushed, label %split, label %exec\n"
+    "exec:\n"
+    "  %body.addr = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 0\n"
+    "  %env.addr = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 1\n"
+    "  %body = load ptr, ptr %body.addr, align 8\n"
+    "  %env = load ptr, ptr %env.addr, align 8\n"
+    "  call void %body(ptr %env, i64 %lo, i64 %h)\n"
+    "  %n = sub i64 %h, %lo\n"
+    "  %rem.addr = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 3\n"
+    "  %old = atomicrmw sub ptr %rem.addr, i64 %n acq_rel\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "; Worker `id`: run its own ranges, steal when out of work, stop when every iteration is done.\n"
+    "define internal void @emp.par.work(ptr %par, i64 %id) #1 {\n"
+    "entry:\n"
+    "  %n.addr = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 4\n"
+    "  %deques.addr = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 5\n"
+    "  %rem.addr = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 3\n"
+    "  %n = load i64, ptr %n.addr, align 8\n"
+    "  %deques = load ptr, ptr %deques.addr, align 8\n"
+    "  %own = getelementptr inbounds %emp.deque, ptr %deques, i64 %id\n"
+    "  br label %loop\n"
+    "loop:\n"
+    "  %task = call { i64, i64 } @emp.deque.take(ptr %own)\n"
+    "  %lo = extractvalue { i64, i64 } %task, 0\n"
+    "  %hi = extractvalue { i64, i64 } %task, 1\n"
+    "  %got = icmp slt i64 %lo, %hi\n"
+    "  br i1 %got, label %run, label %steal\n"
+    "run:\n"
+    "  call void @emp.par.run(ptr %par, ptr %own, i64 %lo, i64 %hi)\n"
+    "  br label %loop\n"
+    "steal:\n"
+    "  %k = phi i64 [ 1, %loop ], [ %k1, %steal.next ]\n"
+    "  %more = icmp ult i64 %k, %n\n"
+    "  br i1 %more, label %steal.try, label %idle\n"
+    "steal.try:\n"
+    "  %v0 = add i64 %id, %k\n"
+    "  %v = urem i64 %v0, %n\n"
+    "  %victim = getelementptr inbounds %emp.deque, ptr %deques, i64 %v\n"
+    "  %st = call { i64, i64 } @emp.deque.steal(ptr %victim)\n"
+    "  %slo = extractvalue { i64, i64 } %st, 0\n"
+    "  %shi = extractvalue { i64, i64 } %st, 1\n"
+    "  %sgot = icmp slt i64 %slo, %shi\n"
+    "  br i1 %sgot, label %steal.run, label %steal.next\n"
+    "steal.next:\n"
+    "  %k1 = add i64 %k, 1\n"
+    "  br label %steal\n"
+    "steal.run:\n"
+    "  call void @emp.par.run(ptr %par, ptr %own, i64 %slo, i64 %shi)\n"
+    "  br label %loop\n"
+    "idle:\n"
+    "  %rem = load atomic i64, ptr %rem.addr acquire, align 8\n"
+    "  %finished = icmp sle i64 %rem, 0\n"
+    "  br i1 %finished, label %exit, label %wait\n"
+    "wait:\n"
+    "  call void @emp.thread.yield()\n"
+    "  br label %loop\n"
+    "exit:\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "define internal ptr @emp.par.thread(ptr %arg) #1 {\n"
+    "entry:\n"
+    "  %par.addr = getelementptr inbounds %emp.par.arg, ptr %arg, i32 0, i32 0\n"
+    "  %id.addr = getelementptr inbounds %emp.par.arg, ptr %arg, i32 0, i32 1\n"
+    "  %par = load ptr, ptr %par.addr, align 8\n"
+    "  %id = load i64, ptr %id.addr, align 8\n"
+    "  call void @emp.par.work(ptr %par, i64 %id)\n"
+    "  ret ptr null\n"
+    "}\n"
+    "\n"
+    "; `parallel for`: call body(env, a, b) on disjoint subranges covering [lo, hi), on up to one\n"
+    "; worker per CPU (this thread is worker 0). `grain` <= 0 picks len / (8 * workers).\n"
+    "define void @emp.par.for(i64 %lo, i64 %hi, i64 %grain, ptr %body, ptr %env) #1 {\n"
+    "entry:\n"
+    "  %len = sub i64 %hi, %lo\n"
+    "  %empty = icmp sle i64 %len, 0\n"
+    "  br i1 %empty, label %ret, label %size\n"
+    "size:\n"
+    "  %cpus = call i32 @emp.thread.count()\n"
+    "  %cpus64 = zext i32 %cpus to i64\n"
+    "  %many = icmp ugt i64 %cpus64, 64\n"
+    "  %n0 = select i1 %many, i64 64, i64 %cpus64\n"
+    "  %short = icmp ugt i64 %n0, %len\n"
+    "  %n = select i1 %short, i64 %len, i64 %n0\n"
+    "  %slices = mul i64 %n, 8\n"
+    "  %auto = sdiv i64 %len, %slices\n"
+    "  %given = icmp sgt i64 %grain, 0\n"
+    "  %g0 = select i1 %given, i64 %grain, i64 %auto\n"
+    "  %tiny = icmp slt i64 %g0, 1\n"
+    "  %g = select i1 %tiny, i64 1, i64 %g0\n"
+    "  %one = icmp eq i64 %n, 1\n"
+    "  %small = icmp sle i64 %len, %g\n"
+    "  %serial = or i1 %one, %small\n"
+    "  br i1 %serial, label %inline, label %setup\n"
+    "inline:\n"
+    "  call void %body(ptr %env, i64 %lo, i64 %hi)\n"
+    "  br label %ret\n"
+    "setup:\n"
+    "  %par = alloca %emp.par, align 8\n"
+    "  %dq.bytes = mul i64 %n, 2176\n"
+    "  %deques = call ptr @emp.heap.realloc(ptr null, i64 %dq.bytes)\n"
+    "  call void @llvm.memset.p0.i64(ptr %deques, i8 0, i64 %dq.bytes, i1 false)\n"
+    "  %f0 = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 0\n"
+    "  store ptr %body, ptr %f0, align 8\n"
+    "  %f1 = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 1\n"
+    "  store ptr %env, ptr %f1, align 8\n"
+    "  %f2 = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 2\n"
+    "  store i64 %g, ptr %f2, align 8\n"
+    "  %f3 = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 3\n"
+    "  store i64 %len, ptr %f3, align 8\n"
+    "  %f4 = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 4\n"
+    "  store i64 %n, ptr %f4, align 8\n"
+    "  %f5 = getelementptr inbounds %emp.par, ptr %par, i32 0, i32 5\n"
+    "  store ptr %deques, ptr %f5, align 8\n"
+    "  %seeded = call i1 @emp.deque.push(ptr %deques, i64 %lo, i64 %hi)\n"
+    "  %args.bytes = mul i64 %n, 16\n"
+    "  %args = call ptr @emp.heap.realloc(ptr null, i64 %args.bytes)\n"
+    "  %handles.bytes = mul i64 %n, 8\n"
+    "  %handles = call ptr @emp.heap.realloc(ptr null, i64 %handles.bytes)\n"
+    "  br label %spawn\n"
+    "spawn:\n"
+    "  %i = phi i64 [ 1, %setup ], [ %i1, %spawn.one ]\n"
+    "  %spawn.more = icmp ult i64 %i, %n\n"
+    "  br i1 %spawn.more, label %spawn.one, label %main\n"
+    "spawn.one:\n"
+    "  %a.par = getelementptr inbounds %emp.par.arg, ptr %args, i64 %i, i32 0\n"
+    "  %a.id = getelementptr inbounds %emp.par.arg, ptr %args, i64 %i, i32 1\n"
+    "  store ptr %par, ptr %a.par, align 8\n"
+    "  store i64 %i, ptr %a.id, align 8\n"
+    "  %a = getelementptr inbounds %emp.par.arg, ptr %args, i64 %i\n"
+    "  %h = call ptr @emp.thread.spawn(ptr @emp.par.thread, ptr %a)\n"
+    "  %h.slot = getelementptr inbounds ptr, ptr %handles, i64 %i\n"
+    "  store ptr %h, ptr %h.slot, align 8\n"
+    "  %i1 = add i64 %i, 1\n"
+    "  br label %spawn\n"
+    "main:\n"
+    "  call void @emp.par.work(ptr %par, i64 0)\n"
+    "  br label %join\n"
+    "join:\n"
+    "  %j = phi i64 [ 1, %main ], [ %j1, %join.one ]\n"
+    "  %join.more = icmp ult i64 %j, %n\n"
+    "  br i1 %join.more, label %join.one, label %cleanup\n"
+    "join.one:\n"
+    "  %hj.slot = getelementptr inbounds ptr, ptr %handles, i64 %j\n"
+    "  %hj = load ptr, ptr %hj.slot, align 8\n"
+    "  call void @emp.thread.join(ptr %hj)\n"
+    "  %j1 = add i64 %j, 1\n"
+    "  br label %join\n"
+    "cleanup:\n"
+    "  call void @emp.heap.free(ptr %handles)\n"
+    "  call void @emp.heap.free(ptr %args)\n"
+    "  call void @emp.heap.free(ptr %deques)\n"
+    "  br label %ret\n"
+    "ret:\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "declare void @llvm.memcpy.p0.p0.i64(ptr, ptr, i64, i1)\n"
+    "declare void @llvm.memset.p0.i64(ptr, i8, i64, i1)\n"
+    "\n"
+    "attributes #0 = { cold noinline nounwind }\n"
+    "attributes #1 = { nounwind }\n";
+
+// Append `tmpl` to `out` at `*n` with the layout placeholders replaced.
+static void expand_template(const char *tmpl, EmpLenAbi abi, char *out, size_t *n, size_t cap) {
+    bool wide = abi == EMP_LEN_ABI_64;
+    const struct {
+        const char *token;
+        const char *value;
+    } subst[] = {
+        {"LENALIGN", wide ? "8" : "4"},
+        {"LENEXT", wide ? "bitcast" : "zext"},
+        {"SSOMAX", wide ? "22" : "14"},
+        {"SSOTAG", wide ? "23" : "15"},
+        {"iLEN", wide ? "i64" : "i32"},
+    };
+
+    const char *p = tmpl;
+    while (*p && *n + 1 < cap) {
+        bool replaced = false;
+        for (size_t i = 0; i < sizeof(subst) / sizeof(subst[0]); i++) {
+            size_t tl = strlen(subst[i].token);
+            if (strncmp(p, subst[i].token, tl) != 0) continue;
+            size_t vl = strlen(subst[i].value);
+            if (*n + vl + 1 > cap) break;
+            memcpy(out + *n, subst[i].value, vl);
+            *n += vl;
+            p += tl;
+            replaced = true;
+            break;
+        }
+        if (!replaced) out[(*n)++] = *p++;
+    }
+    out[*n] = '\0';
+}
+
+const char *emp_runtime_ir(EmpLenAbi abi) {
+    // Expansion only ever shortens the text (`iLEN` -> `i32`/`i64`, `SSOMAX` -> `14`, ...).
+    static char expanded[2][sizeof(k_rt_platform) + sizeof(k_rt_common)];
+    int slot = abi == EMP_LEN_ABI_64 ? 1 : 0;
+    if (!expanded[slot][0]) {
+        size_t n = 0;
+        expand_template(k_rt_platform, abi, expanded[slot], &n, sizeof(expanded[slot]));
+        expand_template(k_rt_common, abi, expanded[slot], &n, sizeof(expanded[slot]));
+    }
+    return expanded[slot];
+}
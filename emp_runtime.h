@@ -0,0 +1,87 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Small runtime module linked into every native build (`out/emp_rt.ll` -> object).
+//
+// Lists (`{ ptr data, iLEN len, iLEN cap }`, iLEN = i32/i64 per EmpLenAbi) keep only a fast
+// path at each call site; the allocation work lives here, out of line and marked `cold noinline`:
+//
+//   void @emp.list.grow(ptr %list, iLEN %need, i64 %elem_size)
+//       cap = max(need, cap == 0 ? 4 : cap * 2); used by list_push / list_insert.
+//   void @emp.list.reserve.slow(ptr %list, iLEN %need, i64 %elem_size)
+//       cap = need exactly; used by list_reserve.
+//
+// Both reallocate `data` (process heap on Windows, realloc elsewhere) and exit on
+// out-of-memory. Codegen emits, for `list_push(&mut xs, v)`:
+//
+//   %len = load iLEN len; %cap = load iLEN cap
+//   br (%len uge %cap), label %grow, label %store      ; !prof: %grow is unlikely
+//   grow:  call @emp.list.grow(ptr %xs, iLEN %len + 1, i64 sizeof(T)); br label %store
+//   store: reload data; store v at data[len]; len = len + 1
+//
+// and for `list_reserve(&mut xs, n)` a `n ugt cap` test guarding `@emp.list.reserve.slow`.
+// One routine serves every element type: the size is a call argument, and the multiply it
+// saves would only matter on the cold path.
+//
+// Lists of `@soa` structs keep the header but store one column per field in a single block
+// (Mds/ABI.md, "Struct-of-arrays lists"); growth moves every column, so they use
+//
+//   void @emp.soa.grow(ptr %list, iLEN %need, ptr %cols, i32 %ncols)
+//   void @emp.soa.reserve.slow(ptr %list, iLEN %need, ptr %cols, i32 %ncols)
+//
+// with the same capacity policy. `cols` is a private constant `[ncols x i64]` of column element
+// sizes in storage order (EmpStructField.soa_column), emitted once per struct.
+//
+// Strings share the header layout. Up to emp_string_inline_max() bytes (14 for ABI v1, 22 for
+// v2) are stored in the header itself, NUL-terminated, with the top byte of `cap` set to
+// 0x80 | len (Mds/ABI.md, "Small strings"). Every string builtin goes through
+//
+//   ptr @emp.string.data(ptr %s) / iLEN @emp.string.len(ptr %s)
+//       bytes and length of either representation (string_cstr, string_len, contains,
+//       starts_with/ends_with, replace, parse_* all read through these)
+//   void @emp.string.from_bytes(ptr %out, ptr %src, iLEN %n)
+//       inline when n fits, else one heap allocation (string_from_cstr, replace, f-strings)
+//   void @emp.string.clone(ptr %out, ptr %s)
+//   void @emp.string.drop(ptr %s)
+//       frees heap strings only; not called for drops marked `elided` (emp_string.h)
+//
+// f-strings (see emp_fstring.h) format integers in place with
+//
+//   i32 @emp.fmt.i64(ptr %dst, i64 %v) / i32 @emp.fmt.u64(ptr %dst, i64 %v)
+//
+// which write the decimal digits to `dst` (no NUL) and return how many bytes they wrote.
+// Narrower integers are sign/zero-extended first.
+//
+// Threads (pthreads elsewhere, Win32 threads on Windows):
+//
+//   ptr @emp.thread.spawn(ptr %fn, ptr %arg)   start `ptr fn(ptr arg)`; exits if it cannot
+//   void @emp.thread.join(ptr %h)              wait for it and release the handle
+//   i32 @emp.thread.count()                    online CPUs, at least 1 (`thread_count()`)
+//   void @emp.thread.yield()
+//
+// `parallel for i in a..b { body }` (EmpStmt.for_stmt.is_parallel) outlines the body into
+// `void @body(ptr %env, i64 %lo, i64 %hi)`, which runs iterations [lo, hi) with the captured
+// locals read through `env` (a struct of pointers to them built at the loop), and calls
+//
+//   void @emp.par.for(i64 %a, i64 %b, i64 %grain, ptr @body, ptr %env)
+//
+// with the bounds widened to i64 (`a..=b` passes b + 1) and %grain = 0 (auto: the range over
+// 8 pieces per worker). It returns once every iteration has run. Up to 64 workers, one per CPU,
+// with the calling thread as worker 0. Each worker has a fixed-size Chase-Lev deque of
+// subranges: it splits the range it runs in halves, pushing upper halves to its own bottom,
+// and steals the top (largest) range of another worker when it runs dry. Workers are started
+// and joined per loop, so nothing runs between loops. Ranges no longer than the grain, or a
+// single CPU, run inline with no threads. emp_borrow makes sure iterations only write shared
+// state at distinct `x[i]`, so the body needs no synchronization.
+
+// IR text of the runtime for the host target and list/string layout `abi` (static storage).
+const char *emp_runtime_ir(EmpLenAbi abi);
+
+#ifdef __cplusplus
+}
+#endif
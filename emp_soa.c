@@ -0,0 +1,382 @@
+#include "emp_soa.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Uses of the value binding of one EMP_FOR_SOA loop.
+typedef struct SoaLoop {
+    EmpSlice val;
+    EmpVec reads; // EmpExpr*: `v.f` member reads
+    bool gather;  // `v` is needed as a whole
+} SoaLoop;
+
+typedef struct SoaCtx {
+    EmpSoaStats stats;
+} SoaCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static EmpExpr *strip_group(EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+static bool is_assign_like(EmpBinOp op) {
+    return op >= EMP_BIN_ASSIGN && op <= EMP_BIN_BITXOR_ASSIGN;
+}
+
+static bool is_name(EmpExpr *e, EmpSlice name) {
+    e = strip_group(e);
+    return e && e->kind == EMP_EXPR_IDENT && slice_eq(e->as.lit, name);
+}
+
+// ===== Uses of the loop value =====
+
+static void loop_expr(SoaLoop *l, EmpExpr *e);
+
+static void loop_exprs(SoaLoop *l, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) loop_expr(l, (EmpExpr *)v->items[i]);
+}
+
+// `e` is written or has its address taken: a use of `v` under it needs the whole value.
+static void loop_place(SoaLoop *l, EmpExpr *e) {
+    EmpExpr *root = strip_group(e);
+    while (root && (root->kind == EMP_EXPR_MEMBER || root->kind == EMP_EXPR_INDEX)) {
+        root = strip_group(root->kind == EMP_EXPR_MEMBER ? root->as.member.base : root->as.index.base);
+    }
+    if (root && root->kind == EMP_EXPR_IDENT && slice_eq(root->as.lit, l->val)) l->gather = true;
+    loop_expr(l, e);
+}
+
+static void loop_expr(SoaLoop *l, EmpExpr *e) {
+    if (!e || l->gather) return;
+    switch (e->kind) {
+        case EMP_EXPR_IDENT:
+            if (slice_eq(e->as.lit, l->val)) l->gather = true;
+            return;
+        case EMP_EXPR_MEMBER:
+            if (is_name(e->as.member.base, l->val)) {
+                (void)emp_vec_push(&l->reads, e);
+                return;
+            }
+            loop_expr(l, e->as.member.base);
+            return;
+        case EMP_EXPR_GROUP:
+            loop_expr(l, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            loop_expr(l, e->as.cast.expr);
+            return;
+        case EMP_EXPR_UNARY:
+            if (e->as.unary.op == EMP_UN_BORROW || e->as.unary.op == EMP_UN_BORROW_MUT) loop_place(l, e->as.unary.rhs);
+            else loop_expr(l, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            if (is_assign_like(e->as.binary.op)) loop_place(l, e->as.binary.lhs);
+            else loop_expr(l, e->as.binary.lhs);
+            loop_expr(l, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL: {
+            // `v.method()` passes `v` itself.
+            EmpExpr *callee = strip_group(e->as.call.callee);
+            if (callee && callee->kind == EMP_EXPR_MEMBER && is_name(callee->as.member.base, l->val)) l->gather = true;
+            else loop_expr(l, e->as.call.callee);
+            loop_exprs(l, &e->as.call.args);
+            return;
+        }
+        case EMP_EXPR_INDEX:
+            loop_expr(l, e->as.index.base);
+            loop_expr(l, e->as.index.index);
+            return;
+        case EMP_EXPR_NEW:
+            loop_exprs(l, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TUPLE:
+            loop_exprs(l, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            loop_exprs(l, &e->as.list.items);
+            return;
+        case EMP_EXPR_TERNARY:
+            loop_expr(l, e->as.ternary.cond);
+            loop_expr(l, e->as.ternary.then_expr);
+            loop_expr(l, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            loop_expr(l, e->as.range.start);
+            loop_expr(l, e->as.range.end);
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) loop_expr(l, pt->expr);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static bool pattern_binds(const EmpExpr *pat, EmpSlice name) {
+    if (!pat) return false;
+    switch (pat->kind) {
+        case EMP_EXPR_IDENT:
+            return slice_eq(pat->as.lit, name);
+        case EMP_EXPR_GROUP:
+            return pattern_binds(pat->as.group.inner, name);
+        case EMP_EXPR_CALL:
+            for (size_t i = 0; i < pat->as.call.args.len; i++) {
+                if (pattern_binds((const EmpExpr *)pat->as.call.args.items[i], name)) return true;
+            }
+            return false;
+        case EMP_EXPR_TUPLE:
+            for (size_t i = 0; i < pat->as.tuple.items.len; i++) {
+                if (pattern_binds((const EmpExpr *)pat->as.tuple.items.items[i], name)) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+static void loop_stmt(SoaLoop *l, EmpStmt *s) {
+    if (!s || l->gather) return;
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            loop_expr(l, s->as.let_stmt.init);
+            // Another binding of the same name: keep it simple and assemble `v`.
+            if (slice_eq(s->as.let_stmt.name, l->val)) l->gather = true;
+            for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                const EmpSlice *nm = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                if (nm && slice_eq(*nm, l->val)) l->gather = true;
+            }
+            return;
+        case EMP_STMT_DROP:
+            // The end-of-iteration drop of `v` only releases what a gather copied: without
+            // soa_gather codegen emits nothing for it.
+            return;
+        case EMP_STMT_DEFER:
+            loop_stmt(l, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            loop_expr(l, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            loop_expr(l, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            loop_expr(l, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) loop_stmt(l, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            loop_expr(l, s->as.if_stmt.cond);
+            loop_stmt(l, s->as.if_stmt.then_branch);
+            loop_stmt(l, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            loop_expr(l, s->as.while_stmt.cond);
+            loop_stmt(l, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            if (slice_eq(s->as.for_stmt.idx_name, l->val) || slice_eq(s->as.for_stmt.val_name, l->val)) l->gather = true;
+            loop_expr(l, s->as.for_stmt.iterable);
+            loop_stmt(l, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            loop_expr(l, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                if (pattern_binds(arm->pat, l->val)) l->gather = true;
+                loop_stmt(l, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            // Raw code may take the address of `v`.
+            l->gather = true;
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            loop_stmt(l, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+static void plan_loop(SoaCtx *c, EmpStmt *s) {
+    c->stats.loops++;
+    EmpSlice val = s->as.for_stmt.val_name;
+    if (!val.len || (val.len == 1 && val.ptr[0] == '_')) return;
+
+    SoaLoop l;
+    memset(&l, 0, sizeof(l));
+    l.val = val;
+    emp_vec_init(&l.reads);
+    loop_stmt(&l, s->as.for_stmt.body);
+    s->as.for_stmt.soa_gather = l.gather;
+    if (l.gather) {
+        c->stats.gathered++;
+    } else {
+        for (size_t i = 0; i < l.reads.len; i++) ((EmpExpr *)l.reads.items[i])->as.member.soa_column = true;
+        c->stats.columns += l.reads.len;
+    }
+    emp_vec_free(&l.reads);
+}
+
+// ===== Column accesses `xs[i].f` =====
+
+static void walk_expr(SoaCtx *c, EmpExpr *e);
+
+static void walk_exprs(SoaCtx *c, EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) walk_expr(c, (EmpExpr *)v->items[i]);
+}
+
+static void walk_expr(SoaCtx *c, EmpExpr *e) {
+    if (!e) return;
+    switch (e->kind) {
+        case EMP_EXPR_MEMBER: {
+            EmpExpr *base = strip_group(e->as.member.base);
+            if (base && base->kind == EMP_EXPR_INDEX && base->as.index.soa) {
+                e->as.member.soa_column = true;
+                c->stats.columns++;
+                walk_expr(c, base->as.index.base);
+                walk_expr(c, base->as.index.index);
+                return;
+            }
+            walk_expr(c, e->as.member.base);
+            return;
+        }
+        case EMP_EXPR_INDEX:
+            if (e->as.index.soa) c->stats.gathers++;
+            walk_expr(c, e->as.index.base);
+            walk_expr(c, e->as.index.index);
+            return;
+        case EMP_EXPR_GROUP:
+            walk_expr(c, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            walk_expr(c, e->as.cast.expr);
+            return;
+        case EMP_EXPR_UNARY:
+            walk_expr(c, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            walk_expr(c, e->as.binary.lhs);
+            walk_expr(c, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            walk_expr(c, e->as.call.callee);
+            walk_exprs(c, &e->as.call.args);
+            return;
+        case EMP_EXPR_NEW:
+            walk_exprs(c, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TUPLE:
+            walk_exprs(c, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            walk_exprs(c, &e->as.list.items);
+            return;
+        case EMP_EXPR_TERNARY:
+            walk_expr(c, e->as.ternary.cond);
+            walk_expr(c, e->as.ternary.then_expr);
+            walk_expr(c, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            walk_expr(c, e->as.range.start);
+            walk_expr(c, e->as.range.end);
+            return;
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) walk_expr(c, pt->expr);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static void walk_stmt(SoaCtx *c, EmpStmt *s) {
+    if (!s) return;
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            walk_expr(c, s->as.let_stmt.init);
+            return;
+        case EMP_STMT_DEFER:
+            walk_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            walk_expr(c, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            walk_expr(c, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            walk_expr(c, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) walk_stmt(c, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            walk_expr(c, s->as.if_stmt.cond);
+            walk_stmt(c, s->as.if_stmt.then_branch);
+            walk_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            walk_expr(c, s->as.while_stmt.cond);
+            walk_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            if (s->as.for_stmt.lowering == EMP_FOR_SOA) plan_loop(c, s);
+            walk_expr(c, s->as.for_stmt.iterable);
+            walk_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            walk_expr(c, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm) walk_stmt(c, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            walk_stmt(c, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            walk_stmt(c, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+void emp_sem_plan_soa(EmpProgram *program, EmpSoaStats *out_stats) {
+    SoaCtx c;
+    memset(&c, 0, sizeof(c));
+    for (size_t i = 0; program && i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+        if (it->kind == EMP_ITEM_FN) {
+            walk_stmt(&c, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) walk_stmt(&c, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) walk_stmt(&c, m->body);
+            }
+        }
+    }
+    if (out_stats) *out_stats = c.stats;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EmpSoaStats {
+    size_t columns;  // field accesses that address one column (EmpExpr.member.soa_column)
+    size_t gathers;  // whole-element reads/writes of @soa lists (EmpExpr.index.soa without a column)
+    size_t loops;    // `for` loops over @soa lists (EMP_FOR_SOA)
+    size_t gathered; // of those, loops whose value binding is assembled (for_stmt.soa_gather)
+} EmpSoaStats;
+
+// Struct-of-arrays access planning (run on the checked program, after typecheck has set
+// EmpExpr.index.soa and EMP_FOR_SOA).
+//
+// A list of a `@soa` struct stores each field in its own array (Mds/ABI.md, "Struct-of-arrays
+// lists"), so code should touch the columns it needs and nothing else:
+// - `xs[i].f` (read, write or `&xs[i].f`) gets member.soa_column: codegen addresses
+//   `data + cap * soa_column + i * sizeof(f)` and never builds the element;
+// - in `for i, v in xs`, every `v.f` read gets member.soa_column as well, unless the body uses
+//   `v` as a whole, writes to it, calls a method on it, or declares another `v`; then the loop
+//   gets `soa_gather` and codegen assembles `v` from the columns each iteration. Without it, `v`
+//   never exists and its drops at the end of each iteration emit nothing.
+// Other element accesses (`xs[i]`, `xs[i] = s`, list_push/insert/pop/remove) gather or scatter
+// all columns.
+//
+// `out_stats` may be NULL.
+void emp_sem_plan_soa(EmpProgram *program, EmpSoaStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
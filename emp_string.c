@@ -0,0 +1,378 @@
+#include "emp_string.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct SsVar {
+    EmpSlice name;
+    size_t bindings;     // declarations of this name in the function (params, lets, loop/pattern names)
+    bool is_string;      // declared as `string`
+    bool small;          // the (single) initializer is known to fit inline
+    EmpSlice clone_of;   // initializer is a clone of this binding (small if that one is)
+    bool mutated;        // reassigned or `&mut`-borrowed
+} SsVar;
+
+typedef struct SsCtx {
+    SsVar *vars;
+    size_t len;
+    size_t cap;
+    size_t inline_max;
+    EmpStringStats stats;
+} SsCtx;
+
+static bool slice_eq(EmpSlice a, EmpSlice b) {
+    if (a.len != b.len) return false;
+    if (a.ptr == b.ptr) return true;
+    if (!a.ptr || !b.ptr) return false;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static bool slice_is(EmpSlice s, const char *z) {
+    size_t n = strlen(z);
+    return s.len == n && s.ptr && memcmp(s.ptr, z, n) == 0;
+}
+
+static SsVar *var_get(SsCtx *c, EmpSlice name, bool create) {
+    for (size_t i = 0; i < c->len; i++) {
+        if (slice_eq(c->vars[i].name, name)) return &c->vars[i];
+    }
+    if (!create || !name.len) return NULL;
+    if (c->len + 1 > c->cap) {
+        size_t nc = c->cap ? c->cap * 2 : 32;
+        SsVar *p = (SsVar *)realloc(c->vars, nc * sizeof(SsVar));
+        if (!p) return NULL;
+        c->vars = p;
+        c->cap = nc;
+    }
+    SsVar *v = &c->vars[c->len++];
+    memset(v, 0, sizeof(*v));
+    v->name = name;
+    return v;
+}
+
+static void var_declare(SsCtx *c, EmpSlice name) {
+    SsVar *v = var_get(c, name, true);
+    if (v) v->bindings++;
+}
+
+static bool type_is_string(const EmpType *t) {
+    return t && t->kind == EMP_TYPE_NAME && slice_is(t->as.name, "string");
+}
+
+static const EmpExpr *strip_group(const EmpExpr *e) {
+    while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+    return e;
+}
+
+// Classifies a `string` initializer: true when it fits inline, or (via `clone_of`) when it
+// does if the cloned binding does.
+static bool init_is_small(const SsCtx *c, const EmpExpr *init, EmpSlice *clone_of) {
+    init = strip_group(init);
+    if (!init) return false;
+
+    if (init->kind == EMP_EXPR_FSTRING) {
+        return init->as.fstring.dynamic_parts == 0 && init->as.fstring.static_len <= c->inline_max;
+    }
+    if (init->kind != EMP_EXPR_CALL || !init->as.call.callee) return false;
+
+    const EmpExpr *callee = init->as.call.callee;
+    const EmpVec *args = &init->as.call.args;
+    if (callee->kind == EMP_EXPR_IDENT && args->len == 1) {
+        const EmpExpr *a0 = strip_group((const EmpExpr *)args->items[0]);
+        if (!a0) return false;
+        if (slice_is(callee->as.lit, "string_from_cstr") && a0->kind == EMP_EXPR_STRING) {
+            // Token text includes the quotes; escapes only shrink the decoded bytes.
+            return a0->as.lit.len >= 2 && a0->as.lit.len - 2 <= c->inline_max;
+        }
+        if (slice_is(callee->as.lit, "string_clone") && a0->kind == EMP_EXPR_IDENT) {
+            *clone_of = a0->as.lit;
+        }
+        return false;
+    }
+    if (callee->kind == EMP_EXPR_MEMBER && args->len == 0 && slice_is(callee->as.member.member, "clone")) {
+        const EmpExpr *base = strip_group(callee->as.member.base);
+        if (base && base->kind == EMP_EXPR_IDENT) *clone_of = base->as.lit;
+    }
+    return false;
+}
+
+static void scan_expr(SsCtx *c, const EmpExpr *e);
+static void scan_stmt(SsCtx *c, const EmpStmt *s);
+
+static void scan_exprs(SsCtx *c, const EmpVec *v) {
+    for (size_t i = 0; i < v->len; i++) scan_expr(c, (const EmpExpr *)v->items[i]);
+}
+
+static void mark_mutated(SsCtx *c, const EmpExpr *target) {
+    target = strip_group(target);
+    if (!target || target->kind != EMP_EXPR_IDENT) return;
+    SsVar *v = var_get(c, target->as.lit, true);
+    if (v) v->mutated = true;
+}
+
+static void scan_expr(SsCtx *c, const EmpExpr *e) {
+    if (!e) return;
+
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) scan_expr(c, pt->expr);
+            }
+            return;
+        case EMP_EXPR_UNARY:
+            if (e->as.unary.op == EMP_UN_BORROW_MUT) mark_mutated(c, e->as.unary.rhs);
+            scan_expr(c, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            if (e->as.binary.op >= EMP_BIN_ASSIGN && e->as.binary.op <= EMP_BIN_BITXOR_ASSIGN) {
+                mark_mutated(c, e->as.binary.lhs);
+            }
+            scan_expr(c, e->as.binary.lhs);
+            scan_expr(c, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            scan_expr(c, e->as.call.callee);
+            scan_exprs(c, &e->as.call.args);
+            return;
+        case EMP_EXPR_GROUP:
+            scan_expr(c, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            scan_expr(c, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE:
+            scan_exprs(c, &e->as.tuple.items);
+            return;
+        case EMP_EXPR_LIST:
+            scan_exprs(c, &e->as.list.items);
+            return;
+        case EMP_EXPR_INDEX:
+            scan_expr(c, e->as.index.base);
+            scan_expr(c, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER:
+            scan_expr(c, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            scan_exprs(c, &e->as.new_expr.args);
+            return;
+        case EMP_EXPR_TERNARY:
+            scan_expr(c, e->as.ternary.cond);
+            scan_expr(c, e->as.ternary.then_expr);
+            scan_expr(c, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            scan_expr(c, e->as.range.start);
+            scan_expr(c, e->as.range.end);
+            return;
+        default:
+            return;
+    }
+}
+
+// Every identifier in a match pattern counts as a declaration, so payload bindings that shadow
+// a candidate disqualify it.
+static void scan_pattern(SsCtx *c, const EmpExpr *pat) {
+    if (!pat) return;
+    if (pat->kind == EMP_EXPR_IDENT) {
+        var_declare(c, pat->as.lit);
+        return;
+    }
+    if (pat->kind == EMP_EXPR_CALL) {
+        for (size_t i = 0; i < pat->as.call.args.len; i++) scan_pattern(c, (const EmpExpr *)pat->as.call.args.items[i]);
+    } else if (pat->kind == EMP_EXPR_TUPLE) {
+        for (size_t i = 0; i < pat->as.tuple.items.len; i++) scan_pattern(c, (const EmpExpr *)pat->as.tuple.items.items[i]);
+    } else if (pat->kind == EMP_EXPR_GROUP) {
+        scan_pattern(c, pat->as.group.inner);
+    }
+}
+
+static void scan_stmt(SsCtx *c, const EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_VAR: {
+            scan_expr(c, s->as.let_stmt.init);
+            if (s->as.let_stmt.is_destructure) {
+                for (size_t i = 0; i < s->as.let_stmt.destruct_names.len; i++) {
+                    const EmpSlice *nm = (const EmpSlice *)s->as.let_stmt.destruct_names.items[i];
+                    if (nm) var_declare(c, *nm);
+                }
+                return;
+            }
+            SsVar *v = var_get(c, s->as.let_stmt.name, true);
+            if (!v) return;
+            v->bindings++;
+            v->is_string = v->is_string || type_is_string(s->as.let_stmt.ty);
+            if (v->bindings == 1 && v->is_string) {
+                EmpSlice clone_of = {0};
+                v->small = init_is_small(c, s->as.let_stmt.init, &clone_of);
+                v->clone_of = clone_of;
+            }
+            return;
+        }
+        case EMP_STMT_DEFER:
+            scan_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            scan_expr(c, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            scan_expr(c, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            scan_expr(c, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) scan_stmt(c, (const EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            scan_expr(c, s->as.if_stmt.cond);
+            scan_stmt(c, s->as.if_stmt.then_branch);
+            scan_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            scan_expr(c, s->as.while_stmt.cond);
+            scan_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            if (s->as.for_stmt.idx_name.len) var_declare(c, s->as.for_stmt.idx_name);
+            if (s->as.for_stmt.val_name.len) var_declare(c, s->as.for_stmt.val_name);
+            scan_expr(c, s->as.for_stmt.iterable);
+            scan_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            scan_expr(c, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *arm = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (!arm) continue;
+                scan_pattern(c, arm->pat);
+                scan_stmt(c, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            scan_stmt(c, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            scan_stmt(c, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+static bool var_inline(const SsVar *v) {
+    return v && v->bindings == 1 && v->small && !v->mutated;
+}
+
+// Propagates smallness through `clone_of` chains (a clone of an inline string is inline).
+static void resolve_clones(SsCtx *c) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < c->len; i++) {
+            SsVar *v = &c->vars[i];
+            if (v->small || !v->clone_of.len) continue;
+            if (var_inline(var_get(c, v->clone_of, false))) {
+                v->small = true;
+                changed = true;
+            }
+        }
+    }
+}
+
+static void mark_stmt(SsCtx *c, EmpStmt *s) {
+    if (!s) return;
+
+    switch (s->kind) {
+        case EMP_STMT_DROP: {
+            const SsVar *v = var_get(c, s->as.drop_stmt.name, false);
+            if (!v || !v->is_string || s->as.drop_stmt.mode == EMP_DROP_MODE_FORGET) return;
+            c->stats.drops++;
+            if (var_inline(v)) {
+                s->as.drop_stmt.elided = true;
+                c->stats.elided++;
+            }
+            return;
+        }
+        case EMP_STMT_DEFER:
+            mark_stmt(c, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) mark_stmt(c, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            mark_stmt(c, s->as.if_stmt.then_branch);
+            mark_stmt(c, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            mark_stmt(c, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            mark_stmt(c, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm) mark_stmt(c, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            mark_stmt(c, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            mark_stmt(c, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+static void plan_body(SsCtx *c, const EmpVec *params, EmpStmt *body) {
+    c->len = 0;
+    if (params) {
+        for (size_t i = 0; i < params->len; i++) {
+            const EmpParam *p = (const EmpParam *)params->items[i];
+            if (!p) continue;
+            var_declare(c, p->name);
+            SsVar *v = var_get(c, p->name, false);
+            if (v) v->is_string = type_is_string(p->ty);
+        }
+    }
+    scan_stmt(c, body);
+    resolve_clones(c);
+    mark_stmt(c, body);
+}
+
+void emp_sem_plan_strings(EmpProgram *program, EmpStringStats *out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+    if (!program) return;
+
+    SsCtx c;
+    memset(&c, 0, sizeof(c));
+    c.inline_max = emp_string_inline_max();
+
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it) continue;
+
+        if (it->kind == EMP_ITEM_FN) {
+            plan_body(&c, &it->as.fn.params, it->as.fn.body);
+        } else if (it->kind == EMP_ITEM_CLASS) {
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (m) plan_body(&c, &m->params, m->body);
+            }
+        } else if (it->kind == EMP_ITEM_IMPL) {
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (m) plan_body(&c, &m->params, m->body);
+            }
+        }
+    }
+
+    free(c.vars);
+    if (out_stats) *out_stats = c.stats;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "emp_ast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EmpStringStats {
+    size_t drops;  // `drop` statements of `string` bindings
+    size_t elided; // of those, proven inline and marked `drop_stmt.elided`
+} EmpStringStats;
+
+// Small-string planning (run after emp_sem_insert_drops and emp_sem_plan_fstrings).
+//
+// Strings of at most emp_string_inline_max() bytes live inside the `{ ptr, len, cap }` header
+// and own no memory (Mds/ABI.md, "Small strings"); the runtime's `emp.string.drop` already
+// skips them with one tag test. This pass removes even that test where the representation is
+// known statically: a `string` binding whose only initializer is
+// - `string_from_cstr("...")` with a literal that fits,
+// - an f-string with no runtime-sized parts and `static_len` that fits, or
+// - `string_clone(t)` / `t.clone()` of another such binding,
+// and which is never reassigned, mutably borrowed or shadowed in its function, gets every
+// `drop` statement marked `elided`; codegen emits nothing for those.
+//
+// `out_stats` may be NULL.
+void emp_sem_plan_strings(EmpProgram *program, EmpStringStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
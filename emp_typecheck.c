@@ -1,5 +1,7 @@
 #include "emp_typecheck.h"
 
+#include "emp_generic.h"
+
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -289,6 +291,21 @@ static bool type_is_int(const EmpType *t) {
     return t && t->kind == EMP_TYPE_NAME && type_is_int_name(t->as.name);
 }
 
+// Width of an integer type name in bits (`int` is 32, `isize`/`usize` are 64).
+static int int_type_bits(const EmpType *t) {
+    if (!type_is_int(t)) return 0;
+    EmpSlice n = t->as.name;
+    if (slice_is(n, "i8") || slice_is(n, "u8") || slice_is(n, "int8") || slice_is(n, "uint8")) return 8;
+    if (slice_is(n, "i16") || slice_is(n, "u16") || slice_is(n, "int16") || slice_is(n, "uint16")) return 16;
+    if (slice_is(n, "i64") || slice_is(n, "u64") || slice_is(n, "int64") || slice_is(n, "uint64") || slice_is(n, "isize") || slice_is(n, "usize")) return 64;
+    return 32;
+}
+
+// Type of list/string lengths and capacities under the current length ABI.
+static EmpType *make_len_type(EmpArena *arena, EmpSpan span) {
+    return make_named(arena, span, emp_len_abi() == EMP_LEN_ABI_64 ? "usize" : "i32");
+}
+
 static bool type_is_float(const EmpType *t) {
     return t && t->kind == EMP_TYPE_NAME &&
            (slice_is(t->as.name, "f32") || slice_is(t->as.name, "f64") || slice_is(t->as.name, "float") || slice_is(t->as.name, "double"));
@@ -298,10 +315,48 @@ static bool type_is_auto(const EmpType *t) {
     return t && t->kind == EMP_TYPE_AUTO;
 }
 
+static bool type_is_simd(const EmpType *t) {
+    return t && t->kind == EMP_TYPE_NAME && emp_simd_type_parse(t->as.name, NULL, NULL);
+}
+
+static uint32_t simd_lanes(const EmpType *t) {
+    uint32_t lanes = 0;
+    if (!t || t->kind != EMP_TYPE_NAME || !emp_simd_type_parse(t->as.name, NULL, &lanes)) return 0;
+    return lanes;
+}
+
+// Lane type of vector type `t` (NULL when `t` is not a vector).
+static EmpType *simd_elem_type(EmpArena *arena, const EmpType *t, EmpSpan span) {
+    EmpSlice elem;
+    if (!t || t->kind != EMP_TYPE_NAME || !emp_simd_type_parse(t->as.name, &elem, NULL)) return NULL;
+    EmpType *et = (EmpType *)emp_arena_alloc(arena, sizeof(EmpType), _Alignof(EmpType));
+    if (!et) return NULL;
+    memset(et, 0, sizeof(*et));
+    et->kind = EMP_TYPE_NAME;
+    et->span = span;
+    et->as.name = elem;
+    return et;
+}
+
 static bool type_is_ptr(const EmpType *t) {
     return t && t->kind == EMP_TYPE_PTR;
 }
 
+static bool type_is_atomic(const EmpType *t) {
+    return t && t->kind == EMP_TYPE_NAME && emp_atomic_type_parse(t->as.name, NULL);
+}
+
+// Value type of atomic type `t`: the integer, or `*u8` for `atomic_ptr` (pointers are opaque to
+// the checker anyway). NULL when `t` is not atomic.
+static EmpType *atomic_value_type(EmpArena *arena, const EmpType *t, EmpSpan span) {
+    EmpSlice v;
+    if (!t || t->kind != EMP_TYPE_NAME || !emp_atomic_type_parse(t->as.name, &v)) return NULL;
+    if (slice_is(v, "ptr")) return make_ptr(arena, span, make_named(arena, span, "u8"));
+    EmpType *vt = make_named(arena, span, "i32");
+    if (vt) vt->as.name = v;
+    return vt;
+}
+
 static bool type_is_string(const EmpType *t) {
     return t && t->kind == EMP_TYPE_NAME && slice_is(t->as.name, "string");
 }
@@ -329,6 +384,11 @@ static bool type_eq_shallow(const EmpType *a, const EmpType *b);
 
 static EmpProgram *g_tc_program = NULL;
 static int g_tc_mm_depth = 0;
+static int g_tc_off_depth = 0; // nesting of `@emp off` blocks
+static bool g_tc_packed_member = false; // last member access read a misalignable field of a @packed struct
+static EmpCoroKind g_tc_coro = EMP_CORO_NONE; // kind of the fn whose body is being checked
+static EmpType *g_tc_yield_ty = NULL;         // generators: T of its `Gen[T]`
+static int g_tc_par_depth = 0;                // nesting of `parallel for` bodies
 
 static bool program_has_emp_mm_off(const EmpProgram *program) {
     if (!program) return false;
@@ -492,6 +552,23 @@ static const EmpItem *find_named_decl(EmpProgram *p, EmpSlice name) {
     return NULL;
 }
 
+static EmpItemConst *find_const_item(EmpProgram *p, EmpSlice name) {
+    if (!p || !name.ptr || !name.len) return NULL;
+    for (size_t i = 0; i < p->items.len; i++) {
+        EmpItem *it = (EmpItem *)p->items.items[i];
+        if (it && it->kind == EMP_ITEM_CONST && slice_eq(it->as.const_decl.name, name)) return &it->as.const_decl;
+    }
+    return NULL;
+}
+
+// Type of const `k` once known: declared, inferred from its initializer, or (import decls)
+// the definition's.
+static EmpType *const_item_type(const EmpItemConst *k) {
+    if (k->ty && !type_is_auto(k->ty)) return k->ty;
+    if (k->origin && k->origin->ty && !type_is_auto(k->origin->ty)) return k->origin->ty;
+    return NULL;
+}
+
 static EmpItem *find_fn_item(EmpProgram *p, EmpSlice name) {
     if (!p || !name.ptr || !name.len) return NULL;
     for (size_t i = 0; i < p->items.len; i++) {
@@ -513,8 +590,8 @@ static const EmpType *lookup_field_type(EmpProgram *p, const EmpType *base_ty, E
 
     // Built-in list layout supports `.ptr` and `.len`.
     if (base_ty->kind == EMP_TYPE_LIST) {
-        if (slice_is(field, "len")) return make_named(arena, err_span, "i32");
-        if (slice_is(field, "cap")) return make_named(arena, err_span, "i32");
+        if (slice_is(field, "len")) return make_len_type(arena, err_span);
+        if (slice_is(field, "cap")) return make_len_type(arena, err_span);
         if (slice_is(field, "ptr")) {
             EmpType *pt = (EmpType *)emp_arena_alloc(arena, sizeof(EmpType), sizeof(void *));
             if (!pt) return NULL;
@@ -574,6 +651,46 @@ static const EmpType *lookup_field_type(EmpProgram *p, const EmpType *base_ty, E
     return NULL;
 }
 
+// Types that can live at any address: fields of these are still aligned inside a `@packed`.
+static bool type_is_byte_aligned(EmpProgram *p, const EmpType *t) {
+    if (!t) return false;
+    if (t->kind == EMP_TYPE_ARRAY && t->as.array.size_text.len) return type_is_byte_aligned(p, t->as.array.elem);
+    if (t->kind != EMP_TYPE_NAME) return false;
+    EmpSlice n = t->as.name;
+    if (slice_is(n, "bool") || slice_is(n, "i8") || slice_is(n, "u8") || slice_is(n, "int8") || slice_is(n, "uint8")) return true;
+    const EmpItem *decl = find_named_decl(p, n);
+    return decl && decl->kind == EMP_ITEM_STRUCT && decl->as.struct_decl.is_packed && !decl->as.struct_decl.attr_align &&
+           !decl->as.struct_decl.is_cacheline;
+}
+
+// `S[]` of a `@soa` struct S: one array per field instead of an array of S.
+static bool type_is_soa_list(const EmpType *t) {
+    if (t && t->kind == EMP_TYPE_PTR) t = t->as.ptr.pointee;
+    if (!t || t->kind != EMP_TYPE_LIST || !g_tc_program) return false;
+    const EmpType *el = t->as.array.elem;
+    if (!el || el->kind != EMP_TYPE_NAME) return false;
+    const EmpItem *decl = find_named_decl(g_tc_program, el->as.name);
+    return decl && decl->kind == EMP_ITEM_STRUCT && decl->as.struct_decl.is_soa;
+}
+
+// `Gen[T]` / `Task[T]`: coroutine handles, which stay EMP_TYPE_GENERIC after monomorphization.
+static bool type_is_coro(const EmpType *t, const char *name) {
+    return t && t->kind == EMP_TYPE_GENERIC && slice_is(t->as.generic.name, name) && t->as.generic.args.len == 1;
+}
+
+// T of a coroutine handle; NULL (void) for `Task[void]`.
+static EmpType *coro_value_type(const EmpType *t) {
+    EmpType *v = (EmpType *)t->as.generic.args.items[0];
+    return v && v->kind == EMP_TYPE_NAME && slice_is(v->as.name, "void") ? NULL : v;
+}
+
+static bool field_of_packed_needs_align(EmpProgram *p, const EmpType *base_ty, const EmpType *field_ty) {
+    if (base_ty && base_ty->kind == EMP_TYPE_PTR) base_ty = base_ty->as.ptr.pointee;
+    if (!base_ty || base_ty->kind != EMP_TYPE_NAME) return false;
+    const EmpItem *decl = find_named_decl(p, base_ty->as.name);
+    return decl && decl->kind == EMP_ITEM_STRUCT && decl->as.struct_decl.is_packed && !type_is_byte_aligned(p, field_ty);
+}
+
 static bool type_eq_shallow(const EmpType *a, const EmpType *b) {
     if (a == b) return true;
     if (!a || !b) return false;
@@ -601,6 +718,13 @@ static bool type_eq_shallow(const EmpType *a, const EmpType *b) {
                 if (!type_eq_shallow(fa->ty, fb->ty)) return false;
             }
             return true;
+        case EMP_TYPE_GENERIC:
+            // Only the coroutine handles survive monomorphization.
+            if (!slice_eq(a->as.generic.name, b->as.generic.name) || a->as.generic.args.len != b->as.generic.args.len) return false;
+            for (size_t i = 0; i < a->as.generic.args.len; i++) {
+                if (!type_eq_shallow((const EmpType *)a->as.generic.args.items[i], (const EmpType *)b->as.generic.args.items[i])) return false;
+            }
+            return true;
         default:
             return false;
     }
@@ -865,6 +989,18 @@ static bool env_push(TcEnv *e, EmpSlice name, EmpType *ty) {
     return true;
 }
 
+// `e` writes to or mutably borrows a const: an identifier (or element/field path below one)
+// that names a const and no local.
+static const EmpItemConst *place_names_const(TcEnv *env, const EmpExpr *e) {
+    while (e && (e->kind == EMP_EXPR_GROUP || e->kind == EMP_EXPR_INDEX || e->kind == EMP_EXPR_MEMBER)) {
+        if (e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
+        else if (e->kind == EMP_EXPR_INDEX) e = e->as.index.base;
+        else e = e->as.member.base;
+    }
+    if (!e || e->kind != EMP_EXPR_IDENT || env_lookup(env, e->as.lit)) return NULL;
+    return find_const_item(g_tc_program, e->as.lit);
+}
+
 static const EmpExpr *unwrap_group_expr(const EmpExpr *e) {
     while (e && e->kind == EMP_EXPR_GROUP) e = e->as.group.inner;
     return e;
@@ -947,6 +1083,49 @@ typedef struct TcFns {
     size_t cap;
 } TcFns;
 
+// Callers of an async fn get `Task[ret]`; keeps `sig->ret` in step with an inferred ret_ty.
+static void tc_set_call_ret(EmpArena *arena, TcFnSig *sig, const EmpItemFn *fn) {
+    if (!fn->is_async) {
+        sig->ret = fn->ret_ty;
+        return;
+    }
+    EmpType *v = fn->ret_ty ? fn->ret_ty : make_named(arena, fn->span, "void");
+    if (type_is_coro(sig->ret, "Task")) {
+        sig->ret->as.generic.args.items[0] = v;
+        return;
+    }
+    EmpType *t = (EmpType *)emp_arena_alloc(arena, sizeof(EmpType), _Alignof(EmpType));
+    if (!t) return;
+    memset(t, 0, sizeof(*t));
+    t->kind = EMP_TYPE_GENERIC;
+    t->span = fn->span;
+    t->as.generic.name = slice_from_cstr("Task");
+    emp_vec_init(&t->as.generic.args);
+    if (!emp_vec_push(&t->as.generic.args, v)) return;
+    sig->ret = t;
+}
+
+static void tc_classify_coro(EmpArena *arena, EmpDiags *diags, EmpItemFn *fn) {
+    bool is_gen = type_is_coro(fn->ret_ty, "Gen");
+    fn->coro = EMP_CORO_NONE;
+    bool handle_param = false;
+    for (size_t i = 0; i < fn->params.len; i++) {
+        const EmpParam *p = (const EmpParam *)fn->params.items[i];
+        if (p && (type_is_coro(p->ty, "Gen") || type_is_coro(p->ty, "Task"))) handle_param = true;
+    }
+    if (fn->is_async && fn->is_extern) {
+        diagf(arena, diags, fn->span, "type: ", "an extern fn cannot be async");
+    } else if (fn->is_extern && (is_gen || handle_param || type_is_coro(fn->ret_ty, "Task"))) {
+        diagf(arena, diags, fn->span, "type: ", "Gen[T] and Task[T] cannot cross an extern signature");
+    } else if (fn->is_async && is_gen) {
+        diagf(arena, diags, fn->span, "type: ", "async generators are not supported (return Gen[T] or make the fn async, not both)");
+    } else if (is_gen && !coro_value_type(fn->ret_ty)) {
+        diagf(arena, diags, fn->span, "type: ", "Gen[T] needs a value type");
+    } else if (fn->body) {
+        fn->coro = is_gen ? EMP_CORO_GEN : fn->is_async ? EMP_CORO_TASK : EMP_CORO_NONE;
+    }
+}
+
 static void fns_free(TcFns *f) {
     if (!f) return;
     for (size_t i = 0; i < f->len; i++) {
@@ -1004,6 +1183,38 @@ static TcFnSig *fns_find_by_decl(TcFns *f, const EmpItem *decl) {
 // Forward decl: used by overload resolution helpers.
 static bool tc_check_tuple_literal_against_type(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, const EmpExpr *tuple_lit, const EmpType *expected, bool lenient, bool *io_changed);
 
+// Formatting plan for one interpolated part of type `t` (the widest decimal rendering for ints).
+static void tc_fstring_part_format(EmpFStringPart *pt, const EmpType *t) {
+    pt->bits = 0;
+    pt->max_len = 0;
+    if (type_is_int(t)) {
+        static const uint32_t signed_len[] = {4, 6, 11, 20};   // "-128", "-32768", ...
+        static const uint32_t unsigned_len[] = {3, 5, 10, 20}; // "255", "65535", ...
+        int bits = int_type_bits(t);
+        int w = bits == 8 ? 0 : bits == 16 ? 1 : bits == 32 ? 2 : 3;
+        bool is_unsigned = t->as.name.ptr[0] == 'u'; // u8..u64, uint8..uint64, usize
+        pt->fmt = is_unsigned ? EMP_FMT_UINT : EMP_FMT_INT;
+        pt->bits = (uint8_t)bits;
+        pt->max_len = is_unsigned ? unsigned_len[w] : signed_len[w];
+    } else if (type_is_bool(t)) {
+        pt->fmt = EMP_FMT_BOOL;
+        pt->max_len = 5;
+    } else if (type_is_char(t)) {
+        pt->fmt = EMP_FMT_CHAR;
+        pt->max_len = 4;
+    } else if (type_is_string(t)) {
+        pt->fmt = EMP_FMT_STRING;
+    } else {
+        pt->fmt = EMP_FMT_CSTR;
+    }
+}
+
+// An f-string passed straight to a `*u8` parameter is only borrowed for the call.
+static void tc_note_arg_passing(EmpExpr *arg, const EmpType *param_ty) {
+    while (arg && arg->kind == EMP_EXPR_GROUP) arg = arg->as.group.inner;
+    if (arg && arg->kind == EMP_EXPR_FSTRING) arg->as.fstring.is_temp = type_is_ptr_u8(param_ty);
+}
+
 static bool tc_arg_compatible(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, TcType actual, const EmpExpr *arg_expr, EmpType *expected, bool lenient, bool *io_changed) {
     if (!expected) return false;
 
@@ -1184,6 +1395,8 @@ static bool type_name_is_builtin(EmpSlice s) {
     if (slice_is(s, "string")) return true;
     if (slice_is(s, "f32") || slice_is(s, "f64") || slice_is(s, "float") || slice_is(s, "double")) return true;
     if (type_is_int_name(s)) return true;
+    if (emp_simd_type_parse(s, NULL, NULL)) return true;
+    if (emp_atomic_type_parse(s, NULL)) return true;
     return false;
 }
 
@@ -1257,6 +1470,13 @@ static void validate_type_names_in_type(EmpArena *arena, EmpDiags *diags, const
                 if (f) validate_type_names_in_type(arena, diags, decls, f->ty);
             }
             return;
+        case EMP_TYPE_GENERIC:
+            for (size_t i = 0; i < t->as.generic.args.len; i++) {
+                const EmpType *arg = (const EmpType *)t->as.generic.args.items[i];
+                if (arg && arg->kind == EMP_TYPE_NAME && slice_is(arg->as.name, "void")) continue; // `Task[void]`
+                validate_type_names_in_type(arena, diags, decls, arg);
+            }
+            return;
         default:
             return;
     }
@@ -1342,6 +1562,9 @@ static void validate_type_names_in_stmt(EmpArena *arena, EmpDiags *diags, const
         case EMP_STMT_RETURN:
             validate_type_names_in_expr(arena, diags, decls, s->as.ret.value);
             return;
+        case EMP_STMT_YIELD:
+            validate_type_names_in_expr(arena, diags, decls, s->as.yield_stmt.value);
+            return;
         case EMP_STMT_EXPR:
             validate_type_names_in_expr(arena, diags, decls, s->as.expr.expr);
             return;
@@ -1412,12 +1635,21 @@ static void validate_type_names_in_program(EmpArena *arena, EmpDiags *diags, Emp
                 validate_type_names_in_type(arena, diags, &decls, it->as.const_decl.ty);
                 validate_type_names_in_expr(arena, diags, &decls, it->as.const_decl.init);
                 break;
-            case EMP_ITEM_STRUCT:
+            case EMP_ITEM_STRUCT: {
+                uint32_t al = it->as.struct_decl.attr_align;
+                if (al && ((al & (al - 1)) != 0 || al > 4096)) {
+                    diagf(arena, diags, it->as.struct_decl.span, "type: ", "@align(N) needs a power of two from 1 to 4096");
+                }
                 for (size_t j = 0; j < it->as.struct_decl.fields.len; j++) {
                     const EmpStructField *f = (const EmpStructField *)it->as.struct_decl.fields.items[j];
-                    if (f) validate_type_names_in_type(arena, diags, &decls, f->ty);
+                    if (!f) continue;
+                    validate_type_names_in_type(arena, diags, &decls, f->ty);
+                    if (it->as.struct_decl.is_packed && type_is_atomic(f->ty)) {
+                        diagf(arena, diags, f->span, "type: ", "atomic field in a @packed struct would be misaligned");
+                    }
                 }
                 break;
+            }
             case EMP_ITEM_ENUM:
                 for (size_t vi = 0; vi < it->as.enum_decl.variants.len; vi++) {
                     const EmpEnumVariant *v = (const EmpEnumVariant *)it->as.enum_decl.variants.items[vi];
@@ -1485,7 +1717,616 @@ static void validate_type_names_in_program(EmpArena *arena, EmpDiags *diags, Emp
         }
     }
 
-    tnames_free(&decls);
+    tnames_free(&decls);
+}
+
+// ===== Generics (monomorphization) =====
+//
+// Templates (`fn f[T]`, `struct S[T]`, `impl[T] S[T]`) are moved to `program->generics` before
+// anything else looks at the program. Every `S[A, ...]` type and every call of a generic fn then
+// gets a concrete copy with the type parameters substituted, appended to `program->items` and
+// checked like hand-written code. Instances are keyed by their name, mangled like overloads
+// (`S__A_...`), so each distinct argument list is instantiated once per module and the merged
+// program keeps one copy across modules.
+
+typedef struct TcInstance {
+    EmpSlice tmpl; // template name
+    EmpSlice name; // mangled instance name
+    EmpType **args;
+    size_t nargs;
+} TcInstance;
+
+static TcInstance *g_tc_insts = NULL;
+static size_t g_tc_insts_len = 0;
+static size_t g_tc_insts_cap = 0;
+
+// Upper bound on instances per typecheck run; also catches generics that instantiate themselves
+// with ever-growing arguments (`fn f[T](x: T) { f(&x); }`).
+static const size_t TC_MAX_INSTANCES = 512;
+
+static void tc_mono_type(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpType *t);
+static void tc_mono_item(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpItem *it);
+
+static const EmpVec *item_type_params(const EmpItem *it) {
+    if (!it) return NULL;
+    if (it->kind == EMP_ITEM_FN) return &it->as.fn.type_params;
+    if (it->kind == EMP_ITEM_STRUCT) return &it->as.struct_decl.type_params;
+    if (it->kind == EMP_ITEM_IMPL) return &it->as.impl_decl.type_params;
+    return NULL;
+}
+
+static EmpItem *find_generic(EmpProgram *p, EmpItemKind kind, EmpSlice name) {
+    for (size_t i = 0; i < p->generics.len; i++) {
+        EmpItem *it = (EmpItem *)p->generics.items[i];
+        if (!it || it->kind != kind) continue;
+        if (kind == EMP_ITEM_FN && slice_eq(it->as.fn.name, name)) return it;
+        if (kind == EMP_ITEM_STRUCT && slice_eq(it->as.struct_decl.name, name)) return it;
+    }
+    return NULL;
+}
+
+static const TcInstance *find_instance(EmpSlice name) {
+    for (size_t i = 0; i < g_tc_insts_len; i++) {
+        if (slice_eq(g_tc_insts[i].name, name)) return &g_tc_insts[i];
+    }
+    return NULL;
+}
+
+static void insts_free(void) {
+    for (size_t i = 0; i < g_tc_insts_len; i++) free(g_tc_insts[i].args);
+    free(g_tc_insts);
+    g_tc_insts = NULL;
+    g_tc_insts_len = 0;
+    g_tc_insts_cap = 0;
+}
+
+static bool type_mentions_auto(const EmpType *t) {
+    if (!t) return false;
+    switch (t->kind) {
+        case EMP_TYPE_AUTO:
+            return true;
+        case EMP_TYPE_PTR:
+            return type_mentions_auto(t->as.ptr.pointee);
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            return type_mentions_auto(t->as.array.elem);
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                const EmpTupleField *f = (const EmpTupleField *)t->as.tuple.fields.items[i];
+                if (f && type_mentions_auto(f->ty)) return true;
+            }
+            return false;
+        case EMP_TYPE_GENERIC:
+            for (size_t i = 0; i < t->as.generic.args.len; i++) {
+                if (type_mentions_auto((const EmpType *)t->as.generic.args.items[i])) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+bool emp_sem_fn_is_auto_generic(const EmpProgram *program, const EmpItemFn *fn) {
+    if (!fn || fn->is_extern || fn->is_instance || fn->type_params.len) return false;
+    bool any = false;
+    for (size_t i = 0; i < fn->params.len; i++) {
+        const EmpParam *pa = (const EmpParam *)fn->params.items[i];
+        if (!pa) continue;
+        if (type_is_auto(pa->ty)) {
+            any = true;
+        } else if (type_mentions_auto(pa->ty)) {
+            // `*auto[]` wrappers keep the call-site list element inference.
+            return false;
+        }
+    }
+    if (!any || !program) return any;
+    for (size_t i = 0; i < program->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)program->items.items[i];
+        if (it && it->kind == EMP_ITEM_FN && &it->as.fn != fn && slice_eq(it->as.fn.name, fn->name)) return false;
+    }
+    return true;
+}
+
+// Gives every `auto` parameter of an auto-generic fn its own type parameter (`__auto<i>`), so
+// each distinct argument type tuple gets its own instance. Parameters are replaced, not edited:
+// import decls share them with the defining module.
+static void tc_make_auto_generic(EmpArena *arena, EmpItem *it) {
+    EmpItemFn *fn = &it->as.fn;
+    for (size_t i = 0; i < fn->params.len; i++) {
+        const EmpParam *pa = (const EmpParam *)fn->params.items[i];
+        if (!pa || !type_is_auto(pa->ty)) continue;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "__auto%zu", i);
+        size_t n = strlen(buf);
+        char *nm = (char *)emp_arena_alloc(arena, n, 1);
+        EmpSlice *tp = (EmpSlice *)emp_arena_alloc(arena, sizeof(EmpSlice), sizeof(void *));
+        EmpParam *np = (EmpParam *)emp_arena_alloc(arena, sizeof(EmpParam), sizeof(void *));
+        if (!nm || !tp || !np) return;
+        memcpy(nm, buf, n);
+        *tp = (EmpSlice){ .ptr = nm, .len = n };
+        *np = *pa;
+        np->ty = make_named(arena, pa->ty->span, buf);
+        if (!np->ty) return;
+        np->ty->as.name = *tp;
+        (void)emp_vec_push(&fn->type_params, tp);
+        fn->params.items[i] = np;
+    }
+}
+
+// Moves generic templates out of `items` (they are not checked until instantiated).
+static void tc_split_generics(EmpArena *arena, EmpDiags *diags, EmpProgram *p) {
+    for (size_t i = 0; i < p->items.len; i++) {
+        EmpItem *it = (EmpItem *)p->items.items[i];
+        if (it && it->kind == EMP_ITEM_FN && it->as.fn.body && emp_sem_fn_is_auto_generic(p, &it->as.fn)) tc_make_auto_generic(arena, it);
+    }
+
+    size_t w = 0;
+    for (size_t i = 0; i < p->items.len; i++) {
+        EmpItem *it = (EmpItem *)p->items.items[i];
+        const EmpVec *tps = item_type_params(it);
+        if (tps && tps->len) {
+            (void)emp_vec_push(&p->generics, it);
+            continue;
+        }
+        p->items.items[w++] = it;
+    }
+    p->items.len = w;
+
+    for (size_t i = 0; i < p->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)p->items.items[i];
+        if (it && it->kind == EMP_ITEM_FN && find_generic(p, EMP_ITEM_FN, it->as.fn.name)) {
+            diagf(arena, diags, it->span, "type: ", "generic function cannot be overloaded with a non-generic one");
+        }
+    }
+}
+
+// Instantiates template `tmpl` (fn or struct) for `args`; returns the instance name, or an empty
+// slice after a diagnostic.
+static EmpSlice tc_instantiate(EmpArena *arena, EmpDiags *diags, EmpProgram *p, const EmpItem *tmpl, EmpType **args, size_t nargs, EmpSpan span) {
+    EmpSlice tmpl_name = tmpl->kind == EMP_ITEM_FN ? tmpl->as.fn.name : tmpl->as.struct_decl.name;
+    EmpSlice name = mangle_overload_name(arena, tmpl_name, args, nargs);
+    if (find_instance(name)) return name;
+
+    if (g_tc_insts_len >= TC_MAX_INSTANCES) {
+        diagf(arena, diags, span, "type: ", "too many generic instantiations (recursive generic?)");
+        return (EmpSlice){0};
+    }
+    if (g_tc_insts_len + 1 > g_tc_insts_cap) {
+        size_t nc = g_tc_insts_cap ? g_tc_insts_cap * 2 : 16;
+        TcInstance *np = (TcInstance *)realloc(g_tc_insts, nc * sizeof(TcInstance));
+        if (!np) return (EmpSlice){0};
+        g_tc_insts = np;
+        g_tc_insts_cap = nc;
+    }
+    EmpType **owned = (EmpType **)calloc(nargs, sizeof(EmpType *));
+    if (!owned) return (EmpSlice){0};
+    memcpy(owned, args, nargs * sizeof(EmpType *));
+    g_tc_insts[g_tc_insts_len++] = (TcInstance){ .tmpl = tmpl_name, .name = name, .args = owned, .nargs = nargs };
+
+    const EmpVec *tps = item_type_params(tmpl);
+    EmpSlice *params = (EmpSlice *)calloc(nargs, sizeof(EmpSlice));
+    if (!params) return (EmpSlice){0};
+    for (size_t i = 0; i < nargs; i++) params[i] = *(const EmpSlice *)tps->items[i];
+    EmpTypeSubst subst = { .params = params, .args = owned, .len = nargs };
+
+    EmpItem *inst = emp_clone_item(arena, tmpl, name, &subst);
+    if (inst) {
+        // Instances are private to the module that needs them (imports never see them).
+        if (inst->kind == EMP_ITEM_FN) {
+            inst->as.fn.is_instance = true;
+            inst->as.fn.is_exported = false;
+        } else {
+            inst->as.struct_decl.is_instance = true;
+            inst->as.struct_decl.is_exported = false;
+        }
+        (void)emp_vec_push(&p->items, inst);
+        tc_mono_item(arena, diags, p, inst);
+    }
+
+    // A struct brings along every generic inherent impl written for it.
+    if (tmpl->kind == EMP_ITEM_STRUCT) {
+        for (size_t i = 0; i < p->generics.len; i++) {
+            const EmpItem *im = (const EmpItem *)p->generics.items[i];
+            if (!im || im->kind != EMP_ITEM_IMPL || !slice_eq(im->as.impl_decl.target_name, tmpl_name)) continue;
+            if (im->as.impl_decl.type_params.len != nargs) {
+                diagf(arena, diags, im->span, "type: ", "generic impl must take the same type parameters as its struct");
+                continue;
+            }
+            for (size_t j = 0; j < nargs; j++) params[j] = *(const EmpSlice *)im->as.impl_decl.type_params.items[j];
+            EmpItem *iinst = emp_clone_item(arena, im, name, &subst);
+            if (!iinst) continue;
+            iinst->as.impl_decl.is_instance = true;
+            for (size_t j = 0; j < iinst->as.impl_decl.methods.len; j++) {
+                EmpImplMethod *m = (EmpImplMethod *)iinst->as.impl_decl.methods.items[j];
+                if (m) m->is_exported = false;
+            }
+            (void)emp_vec_push(&p->items, iinst);
+            tc_mono_item(arena, diags, p, iinst);
+        }
+    }
+
+    free(params);
+    return name;
+}
+
+// Rewrites `S[A, ...]` into the NAME of its instance.
+static void tc_mono_type(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpType *t) {
+    if (!t) return;
+    switch (t->kind) {
+        case EMP_TYPE_PTR:
+            tc_mono_type(arena, diags, p, t->as.ptr.pointee);
+            return;
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            tc_mono_type(arena, diags, p, t->as.array.elem);
+            return;
+        case EMP_TYPE_TUPLE:
+            for (size_t i = 0; i < t->as.tuple.fields.len; i++) {
+                EmpTupleField *f = (EmpTupleField *)t->as.tuple.fields.items[i];
+                if (f) tc_mono_type(arena, diags, p, f->ty);
+            }
+            return;
+        case EMP_TYPE_GENERIC: {
+            for (size_t i = 0; i < t->as.generic.args.len; i++) {
+                tc_mono_type(arena, diags, p, (EmpType *)t->as.generic.args.items[i]);
+            }
+            const EmpItem *tmpl = find_generic(p, EMP_ITEM_STRUCT, t->as.generic.name);
+            if (!tmpl && (slice_is(t->as.generic.name, "Gen") || slice_is(t->as.generic.name, "Task"))) {
+                // Coroutine handles stay generic (EmpCoroKind); codegen lowers them to a frame pointer.
+                if (t->as.generic.args.len != 1) diagf(arena, diags, t->span, "type: ", "Gen[T] and Task[T] take one type argument");
+                return;
+            }
+            if (!tmpl && slice_is(t->as.generic.name, "Atomic")) {
+                // Builtin `Atomic[T]` -> `atomic_<T>` (emp_atomic_type_parse).
+                const EmpType *arg = t->as.generic.args.len == 1 ? (const EmpType *)t->as.generic.args.items[0] : NULL;
+                const char *name = NULL;
+                if (arg && arg->kind == EMP_TYPE_PTR) {
+                    name = "atomic_ptr";
+                } else if (arg && arg->kind == EMP_TYPE_NAME) {
+                    char buf[32];
+                    snprintf(buf, sizeof(buf), "atomic_%.*s", (int)arg->as.name.len, arg->as.name.ptr);
+                    if (emp_atomic_type_parse(slice_from_cstr(buf), NULL)) name = slice_to_cstr(arena, slice_from_cstr(buf));
+                }
+                if (!name) {
+                    diagf(arena, diags, t->span, "type: ", "Atomic[T] needs T = i32, i64, u32, u64 or a pointer");
+                    return;
+                }
+                emp_vec_free(&t->as.generic.args);
+                t->kind = EMP_TYPE_NAME;
+                t->as.name = slice_from_cstr(name);
+                return;
+            }
+            if (!tmpl) {
+                diagf(arena, diags, t->span, "type: ", "unknown generic type");
+                return;
+            }
+            if (tmpl->as.struct_decl.type_params.len != t->as.generic.args.len) {
+                diagf(arena, diags, t->span, "type: ", "wrong number of type arguments");
+                return;
+            }
+            EmpSlice name = tc_instantiate(arena, diags, p, tmpl, (EmpType **)t->as.generic.args.items, t->as.generic.args.len, t->span);
+            if (!name.len) return;
+            // The arguments stay reachable through the instance record; only the vector goes.
+            emp_vec_free(&t->as.generic.args);
+            t->kind = EMP_TYPE_NAME;
+            t->as.name = name;
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+static void tc_mono_stmt(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpStmt *s);
+
+static void tc_mono_expr(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpExpr *e) {
+    if (!e) return;
+    switch (e->kind) {
+        case EMP_EXPR_FSTRING:
+            for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (pt && pt->is_expr) tc_mono_expr(arena, diags, p, pt->expr);
+            }
+            return;
+        case EMP_EXPR_UNARY:
+            tc_mono_expr(arena, diags, p, e->as.unary.rhs);
+            return;
+        case EMP_EXPR_BINARY:
+            tc_mono_expr(arena, diags, p, e->as.binary.lhs);
+            tc_mono_expr(arena, diags, p, e->as.binary.rhs);
+            return;
+        case EMP_EXPR_CALL:
+            tc_mono_expr(arena, diags, p, e->as.call.callee);
+            for (size_t i = 0; i < e->as.call.args.len; i++) tc_mono_expr(arena, diags, p, (EmpExpr *)e->as.call.args.items[i]);
+            for (size_t i = 0; i < e->as.call.type_args.len; i++) tc_mono_type(arena, diags, p, (EmpType *)e->as.call.type_args.items[i]);
+            return;
+        case EMP_EXPR_GROUP:
+            tc_mono_expr(arena, diags, p, e->as.group.inner);
+            return;
+        case EMP_EXPR_CAST:
+            tc_mono_type(arena, diags, p, e->as.cast.ty);
+            tc_mono_expr(arena, diags, p, e->as.cast.expr);
+            return;
+        case EMP_EXPR_TUPLE:
+            for (size_t i = 0; i < e->as.tuple.items.len; i++) tc_mono_expr(arena, diags, p, (EmpExpr *)e->as.tuple.items.items[i]);
+            return;
+        case EMP_EXPR_LIST:
+            for (size_t i = 0; i < e->as.list.items.len; i++) tc_mono_expr(arena, diags, p, (EmpExpr *)e->as.list.items.items[i]);
+            return;
+        case EMP_EXPR_INDEX:
+            tc_mono_expr(arena, diags, p, e->as.index.base);
+            tc_mono_expr(arena, diags, p, e->as.index.index);
+            return;
+        case EMP_EXPR_MEMBER:
+            tc_mono_expr(arena, diags, p, e->as.member.base);
+            return;
+        case EMP_EXPR_NEW:
+            for (size_t i = 0; i < e->as.new_expr.args.len; i++) tc_mono_expr(arena, diags, p, (EmpExpr *)e->as.new_expr.args.items[i]);
+            return;
+        case EMP_EXPR_TERNARY:
+            tc_mono_expr(arena, diags, p, e->as.ternary.cond);
+            tc_mono_expr(arena, diags, p, e->as.ternary.then_expr);
+            tc_mono_expr(arena, diags, p, e->as.ternary.else_expr);
+            return;
+        case EMP_EXPR_RANGE:
+            tc_mono_expr(arena, diags, p, e->as.range.start);
+            tc_mono_expr(arena, diags, p, e->as.range.end);
+            return;
+        default:
+            return;
+    }
+}
+
+static void tc_mono_stmt(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpStmt *s) {
+    if (!s) return;
+    switch (s->kind) {
+        case EMP_STMT_VAR:
+            tc_mono_type(arena, diags, p, s->as.let_stmt.ty);
+            tc_mono_expr(arena, diags, p, s->as.let_stmt.init);
+            return;
+        case EMP_STMT_DEFER:
+            tc_mono_stmt(arena, diags, p, s->as.defer_stmt.body);
+            return;
+        case EMP_STMT_RETURN:
+            tc_mono_expr(arena, diags, p, s->as.ret.value);
+            return;
+        case EMP_STMT_YIELD:
+            tc_mono_expr(arena, diags, p, s->as.yield_stmt.value);
+            return;
+        case EMP_STMT_EXPR:
+            tc_mono_expr(arena, diags, p, s->as.expr.expr);
+            return;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) tc_mono_stmt(arena, diags, p, (EmpStmt *)s->as.block.stmts.items[i]);
+            return;
+        case EMP_STMT_IF:
+            tc_mono_expr(arena, diags, p, s->as.if_stmt.cond);
+            tc_mono_stmt(arena, diags, p, s->as.if_stmt.then_branch);
+            tc_mono_stmt(arena, diags, p, s->as.if_stmt.else_branch);
+            return;
+        case EMP_STMT_WHILE:
+            tc_mono_expr(arena, diags, p, s->as.while_stmt.cond);
+            tc_mono_stmt(arena, diags, p, s->as.while_stmt.body);
+            return;
+        case EMP_STMT_FOR:
+            tc_mono_expr(arena, diags, p, s->as.for_stmt.iterable);
+            tc_mono_stmt(arena, diags, p, s->as.for_stmt.body);
+            return;
+        case EMP_STMT_MATCH:
+            tc_mono_expr(arena, diags, p, s->as.match_stmt.scrutinee);
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                EmpMatchArm *arm = (EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                if (arm) tc_mono_stmt(arena, diags, p, arm->body);
+            }
+            return;
+        case EMP_STMT_EMP_OFF:
+            tc_mono_stmt(arena, diags, p, s->as.emp_off.body);
+            return;
+        case EMP_STMT_EMP_MM_OFF:
+            tc_mono_stmt(arena, diags, p, s->as.emp_mm_off.body);
+            return;
+        default:
+            return;
+    }
+}
+
+static void tc_mono_params(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpVec *params) {
+    for (size_t i = 0; i < params->len; i++) {
+        EmpParam *pa = (EmpParam *)params->items[i];
+        if (pa) tc_mono_type(arena, diags, p, pa->ty);
+    }
+}
+
+static void tc_mono_item(EmpArena *arena, EmpDiags *diags, EmpProgram *p, EmpItem *it) {
+    if (!it) return;
+    switch (it->kind) {
+        case EMP_ITEM_FN:
+            tc_mono_params(arena, diags, p, &it->as.fn.params);
+            tc_mono_type(arena, diags, p, it->as.fn.ret_ty);
+            tc_mono_stmt(arena, diags, p, it->as.fn.body);
+            return;
+        case EMP_ITEM_CONST:
+            tc_mono_type(arena, diags, p, it->as.const_decl.ty);
+            tc_mono_expr(arena, diags, p, it->as.const_decl.init);
+            return;
+        case EMP_ITEM_STRUCT:
+            for (size_t i = 0; i < it->as.struct_decl.fields.len; i++) {
+                EmpStructField *f = (EmpStructField *)it->as.struct_decl.fields.items[i];
+                if (f) tc_mono_type(arena, diags, p, f->ty);
+            }
+            return;
+        case EMP_ITEM_ENUM:
+            for (size_t vi = 0; vi < it->as.enum_decl.variants.len; vi++) {
+                EmpEnumVariant *v = (EmpEnumVariant *)it->as.enum_decl.variants.items[vi];
+                for (size_t fi = 0; v && fi < v->fields.len; fi++) tc_mono_type(arena, diags, p, (EmpType *)v->fields.items[fi]);
+            }
+            return;
+        case EMP_ITEM_CLASS:
+            for (size_t i = 0; i < it->as.class_decl.fields.len; i++) {
+                EmpClassField *f = (EmpClassField *)it->as.class_decl.fields.items[i];
+                if (f) tc_mono_type(arena, diags, p, f->ty);
+            }
+            for (size_t mi = 0; mi < it->as.class_decl.methods.len; mi++) {
+                EmpClassMethod *m = (EmpClassMethod *)it->as.class_decl.methods.items[mi];
+                if (!m) continue;
+                tc_mono_params(arena, diags, p, &m->params);
+                tc_mono_type(arena, diags, p, m->ret_ty);
+                tc_mono_stmt(arena, diags, p, m->body);
+            }
+            return;
+        case EMP_ITEM_TRAIT:
+            for (size_t mi = 0; mi < it->as.trait_decl.methods.len; mi++) {
+                EmpTraitMethod *m = (EmpTraitMethod *)it->as.trait_decl.methods.items[mi];
+                if (!m) continue;
+                tc_mono_params(arena, diags, p, &m->params);
+                tc_mono_type(arena, diags, p, m->ret_ty);
+                tc_mono_stmt(arena, diags, p, m->body);
+            }
+            return;
+        case EMP_ITEM_IMPL:
+            for (size_t mi = 0; mi < it->as.impl_decl.methods.len; mi++) {
+                EmpImplMethod *m = (EmpImplMethod *)it->as.impl_decl.methods.items[mi];
+                if (!m) continue;
+                tc_mono_params(arena, diags, p, &m->params);
+                tc_mono_type(arena, diags, p, m->ret_ty);
+                tc_mono_stmt(arena, diags, p, m->body);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+// Binds type parameters by matching parameter type `pt` against argument type `at`.
+// Returns false on a conflicting binding.
+static bool tc_unify(const EmpType *pt, const EmpType *at, const EmpVec *tparams, EmpType **bound) {
+    if (!pt || !at) return true;
+    switch (pt->kind) {
+        case EMP_TYPE_NAME:
+            for (size_t i = 0; i < tparams->len; i++) {
+                if (!slice_eq(pt->as.name, *(const EmpSlice *)tparams->items[i])) continue;
+                if (!bound[i]) {
+                    bound[i] = (EmpType *)at;
+                    return true;
+                }
+                return type_eq_shallow(bound[i], at);
+            }
+            return true;
+        case EMP_TYPE_PTR:
+            return at->kind != EMP_TYPE_PTR || tc_unify(pt->as.ptr.pointee, at->as.ptr.pointee, tparams, bound);
+        case EMP_TYPE_ARRAY:
+        case EMP_TYPE_LIST:
+            return at->kind != pt->kind || tc_unify(pt->as.array.elem, at->as.array.elem, tparams, bound);
+        case EMP_TYPE_TUPLE:
+            if (at->kind != EMP_TYPE_TUPLE || at->as.tuple.fields.len != pt->as.tuple.fields.len) return true;
+            for (size_t i = 0; i < pt->as.tuple.fields.len; i++) {
+                const EmpTupleField *pf = (const EmpTupleField *)pt->as.tuple.fields.items[i];
+                const EmpTupleField *af = (const EmpTupleField *)at->as.tuple.fields.items[i];
+                if (pf && af && !tc_unify(pf->ty, af->ty, tparams, bound)) return false;
+            }
+            return true;
+        case EMP_TYPE_GENERIC: {
+            if (at->kind == EMP_TYPE_GENERIC) {
+                // `Gen[T]` against `Gen[i32]`.
+                if (!slice_eq(pt->as.generic.name, at->as.generic.name) || pt->as.generic.args.len != at->as.generic.args.len) return true;
+                for (size_t i = 0; i < pt->as.generic.args.len; i++) {
+                    if (!tc_unify((const EmpType *)pt->as.generic.args.items[i], (const EmpType *)at->as.generic.args.items[i], tparams, bound)) return false;
+                }
+                return true;
+            }
+            // `S[T]` against an instance name `S__i32`: unify with the instance's arguments.
+            const TcInstance *inst = at->kind == EMP_TYPE_NAME ? find_instance(at->as.name) : NULL;
+            if (!inst || !slice_eq(inst->tmpl, pt->as.generic.name) || inst->nargs != pt->as.generic.args.len) return true;
+            for (size_t i = 0; i < inst->nargs; i++) {
+                if (!tc_unify((const EmpType *)pt->as.generic.args.items[i], inst->args[i], tparams, bound)) return false;
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+// Type an argument gets when it only has a literal type.
+static EmpType *tc_arg_type_for_binding(EmpArena *arena, TcType t, EmpSpan span) {
+    if (t.ty && !type_is_auto(t.ty)) return (EmpType *)t.ty;
+    if (t.lit == TC_LIT_INT || t.lit == TC_LIT_INT_ZERO) return make_named(arena, span, "i32");
+    if (t.lit == TC_LIT_FLOAT) return make_named(arena, span, "f64");
+    if (t.lit == TC_LIT_BOOL) return make_named(arena, span, "bool");
+    if (t.lit == TC_LIT_STRING) return make_ptr(arena, span, make_named(arena, span, "u8"));
+    return NULL;
+}
+
+// For a call of a generic fn: binds its type parameters (explicit `f[A](...)` arguments first,
+// then from the argument types), instantiates it, and points the callee at the instance.
+// Returns false after a diagnostic; calls of ordinary functions are left alone.
+static bool tc_instantiate_generic_call(EmpArena *arena, EmpDiags *diags, TcFns *fns, EmpExpr *e, const TcType *arg_types, size_t argc, bool lenient) {
+    EmpExpr *callee = e->as.call.callee;
+    if (!g_tc_program || !callee || callee->kind != EMP_EXPR_IDENT) return true;
+    EmpItem *tmpl = find_generic(g_tc_program, EMP_ITEM_FN, callee->as.lit);
+    if (!tmpl) return true;
+
+    const EmpVec *tps = &tmpl->as.fn.type_params;
+    if (e->as.call.type_args.len > tps->len) {
+        diagf(arena, diags, e->span, "type: ", "wrong number of type arguments");
+        return false;
+    }
+    if (tmpl->as.fn.params.len != argc) {
+        diagf(arena, diags, e->span, "type: ", "no matching overload");
+        return false;
+    }
+
+    EmpType **bound = (EmpType **)calloc(tps->len, sizeof(EmpType *));
+    if (!bound) return false;
+    for (size_t i = 0; i < e->as.call.type_args.len; i++) bound[i] = (EmpType *)e->as.call.type_args.items[i];
+
+    bool ok = true;
+    for (size_t i = 0; i < argc && ok; i++) {
+        const EmpParam *pa = (const EmpParam *)tmpl->as.fn.params.items[i];
+        const EmpExpr *arg = (const EmpExpr *)e->as.call.args.items[i];
+        EmpType *at = tc_arg_type_for_binding(arena, arg_types[i], arg ? arg->span : e->span);
+        if (!pa || !at) continue;
+        if (!tc_unify(pa->ty, at, tps, bound)) {
+            diagf(arena, diags, arg ? arg->span : e->span, "type: ", "conflicting types for generic parameter");
+            ok = false;
+        }
+    }
+    for (size_t i = 0; i < tps->len && ok; i++) {
+        if (bound[i]) continue;
+        // Lenient passes may not know every argument type yet; try again later.
+        if (!lenient) diagf(arena, diags, e->span, "type: ", "cannot infer generic type argument");
+        ok = false;
+    }
+
+    if (ok) {
+        size_t before = g_tc_program->items.len;
+        EmpSlice name = tc_instantiate(arena, diags, g_tc_program, tmpl, bound, tps->len, e->span);
+        ok = name.len != 0;
+        if (ok) callee->as.lit = name;
+
+        // Register the new instance (and anything it instantiated) for overload resolution.
+        for (size_t i = before; i < g_tc_program->items.len; i++) {
+            EmpItem *it = (EmpItem *)g_tc_program->items.items[i];
+            if (!it || it->kind != EMP_ITEM_FN || fns_find_by_decl(fns, it)) continue;
+            TcFnSig sig;
+            memset(&sig, 0, sizeof(sig));
+            sig.name = it->as.fn.name;
+            sig.span = it->as.fn.span;
+            tc_classify_coro(arena, diags, &it->as.fn);
+            tc_set_call_ret(arena, &sig, &it->as.fn);
+            sig.decl = it;
+            sig.params_len = it->as.fn.params.len;
+            sig.params = sig.params_len ? (EmpType **)calloc(sig.params_len, sizeof(EmpType *)) : NULL;
+            for (size_t j = 0; sig.params && j < sig.params_len; j++) {
+                EmpParam *pa = (EmpParam *)it->as.fn.params.items[j];
+                sig.params[j] = pa ? pa->ty : NULL;
+            }
+            (void)fns_push(fns, sig);
+        }
+    }
+
+    free(bound);
+    return ok;
 }
 
 static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, EmpExpr *e, const EmpType *expected, bool lenient, bool *io_changed);
@@ -1527,8 +2368,35 @@ static bool tc_check_tuple_literal_against_type(EmpArena *arena, EmpDiags *diags
     return ok;
 }
 
+// Element-wise vector arithmetic: both operands of the same vector type, or one vector and a
+// scalar convertible to its lane type (broadcast to every lane).
+static TcType tc_simd_binary(EmpArena *arena, EmpDiags *diags, EmpSpan span, EmpBinOp op, TcType a, TcType b) {
+    const EmpType *vt = type_is_simd(a.ty) ? a.ty : b.ty;
+    const TcType other = type_is_simd(a.ty) ? b : a;
+    EmpType *elem = simd_elem_type(arena, vt, span);
+    if (!elem) return (TcType){0};
+
+    if (type_is_simd(other.ty)) {
+        if (!type_eq_shallow(other.ty, vt)) {
+            diagf(arena, diags, span, "type: ", "vector operands must have the same type");
+            return (TcType){0};
+        }
+    } else if (!can_coerce(other, elem)) {
+        diagf(arena, diags, span, "type: ", "scalar operand does not convert to the vector lane type");
+        return (TcType){0};
+    }
+
+    bool int_only = op == EMP_BIN_REM || op == EMP_BIN_BITAND || op == EMP_BIN_BITOR || op == EMP_BIN_BITXOR || op == EMP_BIN_SHL || op == EMP_BIN_SHR ||
+                    op == EMP_BIN_REM_ASSIGN || op == EMP_BIN_BITAND_ASSIGN || op == EMP_BIN_BITOR_ASSIGN || op == EMP_BIN_BITXOR_ASSIGN || op == EMP_BIN_SHL_ASSIGN || op == EMP_BIN_SHR_ASSIGN;
+    if (int_only && !type_is_int(elem)) {
+        diagf(arena, diags, span, "type: ", "remainder/bitwise/shift operators expect integer vectors");
+        return (TcType){0};
+    }
+    return (TcType){ .ty = vt, .lit = TC_LIT_NONE };
+}
+
 static TcType tc_binary_numeric(EmpArena *arena, EmpDiags *diags, EmpSpan span, EmpBinOp op, TcType a, TcType b, bool lenient) {
-    (void)op;
+    if (type_is_simd(a.ty) || type_is_simd(b.ty)) return tc_simd_binary(arena, diags, span, op, a, b);
 
     // Handle literal -> numeric coercions and pick a result type.
     const EmpType *ta = a.ty;
@@ -1545,7 +2413,12 @@ static TcType tc_binary_numeric(EmpArena *arena, EmpDiags *diags, EmpSpan span,
         if (a_float || b_float) {
             return (TcType){ .ty = make_named(arena, span, "f64"), .lit = TC_LIT_NONE };
         }
-        // integers: default to i32 for now.
+        // integers: default to i32 for now. Under --len64 a `usize` operand (what len()/cap()
+        // return) makes the result usize, so `xs.len() - 1` keeps a 64-bit length; the other
+        // operand converts to usize whatever its width and signedness.
+        if (emp_len_abi() == EMP_LEN_ABI_64 && (type_is_name(ta, "usize") || type_is_name(tb, "usize"))) {
+            return (TcType){ .ty = make_len_type(arena, span), .lit = TC_LIT_NONE };
+        }
         return (TcType){ .ty = make_named(arena, span, "i32"), .lit = TC_LIT_NONE };
     }
 
@@ -1561,6 +2434,322 @@ static TcType tc_expr(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env,
     return tc_expr_expected(arena, diags, fns, env, e, NULL, lenient, io_changed);
 }
 
+typedef enum TcSimdOp {
+    TC_SIMD_SPLAT,
+    TC_SIMD_LOAD,
+    TC_SIMD_LOAD_MASKED,
+    TC_SIMD_STORE,
+    TC_SIMD_STORE_MASKED,
+    TC_SIMD_SHUFFLE,
+    TC_SIMD_REDUCE,
+    TC_SIMD_FMA,
+} TcSimdOp;
+
+// Element type of `*T[]` / `*T[N]` (vector loads and stores go through a borrowed sequence).
+static const EmpType *simd_seq_elem(const EmpType *t) {
+    if (!t || t->kind != EMP_TYPE_PTR || !t->as.ptr.pointee) return NULL;
+    const EmpType *p = t->as.ptr.pointee;
+    return (p->kind == EMP_TYPE_LIST || p->kind == EMP_TYPE_ARRAY) ? p->as.array.elem : NULL;
+}
+
+// Vector intrinsics, free calls named `simd_*`:
+// - `simd_splat[V](x)`, `simd_load[V](&xs, i)`, `simd_load_masked[V](&xs, i, n)`: the vector
+//   type comes from the type argument or the expected type; masked loads read lanes `< n` and
+//   zero the rest (loop tails);
+// - `simd_store(&xs, i, v)`, `simd_store_masked(&xs, i, v, n)`;
+// - `simd_shuffle(a, b, k...)`: lane `k` of `a ++ b` for each constant `k`;
+// - `simd_reduce_add/mul/min/max(v)` -> lane type; `simd_fma(a, b, c)` = `a * b + c` fused.
+// Loads and stores are bounds checked like indexing. Returns false for other calls.
+static bool tc_simd_builtin(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, EmpExpr *e, const EmpType *expected, bool lenient, bool *io_changed, TcType *out) {
+    static const struct {
+        const char *name;
+        TcSimdOp op;
+        size_t nargs; // 0: variadic (shuffle)
+    } k_ops[] = {
+        {"simd_splat", TC_SIMD_SPLAT, 1},
+        {"simd_load", TC_SIMD_LOAD, 2},
+        {"simd_load_masked", TC_SIMD_LOAD_MASKED, 3},
+        {"simd_store", TC_SIMD_STORE, 3},
+        {"simd_store_masked", TC_SIMD_STORE_MASKED, 4},
+        {"simd_shuffle", TC_SIMD_SHUFFLE, 0},
+        {"simd_reduce_add", TC_SIMD_REDUCE, 1},
+        {"simd_reduce_mul", TC_SIMD_REDUCE, 1},
+        {"simd_reduce_min", TC_SIMD_REDUCE, 1},
+        {"simd_reduce_max", TC_SIMD_REDUCE, 1},
+        {"simd_fma", TC_SIMD_FMA, 3},
+    };
+    EmpSlice nm = e->as.call.callee->as.lit;
+    size_t k = 0;
+    while (k < sizeof(k_ops) / sizeof(k_ops[0]) && !slice_is(nm, k_ops[k].name)) k++;
+    if (k == sizeof(k_ops) / sizeof(k_ops[0])) return false;
+    TcSimdOp op = k_ops[k].op;
+    *out = (TcType){0};
+
+    size_t argc = e->as.call.args.len;
+    if (k_ops[k].nargs ? argc != k_ops[k].nargs : argc < 3) {
+        diagf(arena, diags, e->span, "type: ", "wrong number of arguments");
+        return true;
+    }
+    TcType at[4];
+    memset(at, 0, sizeof(at));
+    for (size_t i = 0; i < argc; i++) {
+        TcType t = tc_expr(arena, diags, fns, env, (EmpExpr *)e->as.call.args.items[i], lenient, io_changed);
+        if (i < 4) at[i] = t;
+    }
+    const EmpExpr *a0 = (const EmpExpr *)e->as.call.args.items[0];
+
+    // Result vector type of splat/loads.
+    const EmpType *vt = NULL;
+    if (op == TC_SIMD_SPLAT || op == TC_SIMD_LOAD || op == TC_SIMD_LOAD_MASKED) {
+        if (e->as.call.type_args.len > 1) {
+            diagf(arena, diags, e->span, "type: ", "wrong number of type arguments");
+            return true;
+        }
+        vt = e->as.call.type_args.len ? (const EmpType *)e->as.call.type_args.items[0] : expected;
+        if (!type_is_simd(vt)) {
+            if (!lenient) diagf(arena, diags, e->span, "type: ", "cannot infer the vector type (write e.g. `simd_load[f32x8](...)`)");
+            return true;
+        }
+    } else if (op == TC_SIMD_STORE || op == TC_SIMD_STORE_MASKED) {
+        vt = at[2].ty;
+    } else {
+        vt = at[0].ty;
+    }
+    if (!type_is_simd(vt)) {
+        if (!(lenient && type_is_auto(vt))) diagf(arena, diags, e->span, "type: ", "expected a vector operand");
+        return true;
+    }
+    EmpType *elem = simd_elem_type(arena, vt, e->span);
+
+    switch (op) {
+        case TC_SIMD_SPLAT:
+            if (!can_coerce(at[0], elem)) {
+                diagf(arena, diags, a0 ? a0->span : e->span, "type: ", "simd_splat value does not convert to the lane type");
+                return true;
+            }
+            break;
+        case TC_SIMD_LOAD:
+        case TC_SIMD_LOAD_MASKED:
+        case TC_SIMD_STORE:
+        case TC_SIMD_STORE_MASKED: {
+            const EmpType *se = simd_seq_elem(at[0].ty);
+            if (!se || !type_eq_shallow(se, elem)) {
+                diagf(arena, diags, a0 ? a0->span : e->span, "type: ", "vector load/store expects `&xs` where xs: T[] or T[N] with T the lane type");
+                return true;
+            }
+            bool masked = op == TC_SIMD_LOAD_MASKED || op == TC_SIMD_STORE_MASKED;
+            if (!tc_is_intish(at[1]) || (masked && !tc_is_intish(at[op == TC_SIMD_LOAD_MASKED ? 2 : 3]))) {
+                diagf(arena, diags, e->span, "type: ", "vector load/store index and lane count must be int");
+                return true;
+            }
+            if (op == TC_SIMD_STORE || op == TC_SIMD_STORE_MASKED) {
+                *out = (TcType){ .ty = NULL, .lit = TC_LIT_NONE };
+                return true;
+            }
+            break;
+        }
+        case TC_SIMD_SHUFFLE: {
+            if (!type_eq_shallow(at[1].ty, vt)) {
+                diagf(arena, diags, e->span, "type: ", "simd_shuffle operands must have the same vector type");
+                return true;
+            }
+            for (size_t i = 2; i < argc; i++) {
+                const EmpExpr *ke = unwrap_group_expr((const EmpExpr *)e->as.call.args.items[i]);
+                const char *txt = ke && ke->kind == EMP_EXPR_INT ? slice_to_cstr(arena, ke->as.lit) : NULL;
+                long long lane = txt ? strtoll(txt, NULL, 0) : -1;
+                if (lane < 0 || lane >= 2 * (long long)simd_lanes(vt)) {
+                    diagf(arena, diags, ke ? ke->span : e->span, "type: ", "simd_shuffle lane must be a constant below twice the lane count");
+                    return true;
+                }
+            }
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.*sx%zu", (int)elem->as.name.len, elem->as.name.ptr, argc - 2);
+            EmpType *rt = make_named(arena, e->span, slice_to_cstr(arena, slice_from_cstr(buf)));
+            if (!rt || !type_is_simd(rt)) {
+                diagf(arena, diags, e->span, "type: ", "simd_shuffle result is not a vector type (lane count must be a power of two)");
+                return true;
+            }
+            *out = (TcType){ .ty = rt, .lit = TC_LIT_NONE };
+            return true;
+        }
+        case TC_SIMD_REDUCE:
+            *out = (TcType){ .ty = elem, .lit = TC_LIT_NONE };
+            return true;
+        case TC_SIMD_FMA:
+            if (!type_is_float(elem) || !type_eq_shallow(at[1].ty, vt) || !type_eq_shallow(at[2].ty, vt)) {
+                diagf(arena, diags, e->span, "type: ", "simd_fma expects three float vectors of the same type");
+                return true;
+            }
+            break;
+    }
+    *out = (TcType){ .ty = vt, .lit = TC_LIT_NONE };
+    return true;
+}
+
+typedef enum TcAtomicOp {
+    TC_ATOMIC_LOAD,
+    TC_ATOMIC_STORE,
+    TC_ATOMIC_EXCHANGE,
+    TC_ATOMIC_CAS,
+    TC_ATOMIC_RMW,
+    TC_ATOMIC_FENCE,
+} TcAtomicOp;
+
+// Memory ordering argument: one of the bare names below (LLVM's orderings). -1 otherwise.
+enum { TC_ORD_RELAXED, TC_ORD_ACQUIRE, TC_ORD_RELEASE, TC_ORD_ACQ_REL, TC_ORD_SEQ_CST };
+static int tc_atomic_ordering(const EmpExpr *e) {
+    static const char *const k_names[] = {"relaxed", "acquire", "release", "acq_rel", "seq_cst"};
+    e = unwrap_group_expr(e);
+    if (!e || e->kind != EMP_EXPR_IDENT) return -1;
+    for (int i = 0; i < (int)(sizeof(k_names) / sizeof(k_names[0])); i++) {
+        if (slice_is(e->as.lit, k_names[i])) return i;
+    }
+    return -1;
+}
+
+// Atomic builtins, free calls named `atomic_*` taking `&a` (a: Atomic[T]) and explicit orderings:
+// - `atomic_load(&a, ord)` -> T; `atomic_store(&a, v, ord)`; `atomic_exchange(&a, v, ord)` -> T;
+// - `atomic_cas(&a, expected, desired, success_ord, failure_ord)` -> `(T, bool)`: the value seen
+//   and whether it was replaced (strong compare-and-swap);
+// - `atomic_fetch_add/sub/and/or/xor/min/max(&a, v, ord)` -> previous value (integers only);
+// - `atomic_fence(ord)`.
+// They lower to LLVM load/store atomic, atomicrmw, cmpxchg and fence. A shared borrow is enough:
+// atomics are the one thing several threads may mutate at once. Returns false for other calls.
+static bool tc_atomic_builtin(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, EmpExpr *e, bool lenient, bool *io_changed, TcType *out) {
+    static const struct {
+        const char *name;
+        TcAtomicOp op;
+        size_t nargs;
+    } k_ops[] = {
+        {"atomic_load", TC_ATOMIC_LOAD, 2},
+        {"atomic_store", TC_ATOMIC_STORE, 3},
+        {"atomic_exchange", TC_ATOMIC_EXCHANGE, 3},
+        {"atomic_cas", TC_ATOMIC_CAS, 5},
+        {"atomic_fetch_add", TC_ATOMIC_RMW, 3},
+        {"atomic_fetch_sub", TC_ATOMIC_RMW, 3},
+        {"atomic_fetch_and", TC_ATOMIC_RMW, 3},
+        {"atomic_fetch_or", TC_ATOMIC_RMW, 3},
+        {"atomic_fetch_xor", TC_ATOMIC_RMW, 3},
+        {"atomic_fetch_min", TC_ATOMIC_RMW, 3},
+        {"atomic_fetch_max", TC_ATOMIC_RMW, 3},
+        {"atomic_fence", TC_ATOMIC_FENCE, 1},
+    };
+    EmpSlice nm = e->as.call.callee->as.lit;
+    size_t k = 0;
+    while (k < sizeof(k_ops) / sizeof(k_ops[0]) && !slice_is(nm, k_ops[k].name)) k++;
+    if (k == sizeof(k_ops) / sizeof(k_ops[0])) return false;
+    TcAtomicOp op = k_ops[k].op;
+    *out = (TcType){0};
+
+    size_t argc = e->as.call.args.len;
+    if (argc != k_ops[k].nargs) {
+        diagf(arena, diags, e->span, "type: ", "wrong number of arguments");
+        return true;
+    }
+
+    // Orderings are the trailing arguments (two for cas); they are names, not expressions.
+    size_t nord = op == TC_ATOMIC_CAS ? 2 : 1;
+    int ord[2] = {-1, -1};
+    for (size_t i = 0; i < nord; i++) {
+        const EmpExpr *oe = (const EmpExpr *)e->as.call.args.items[argc - nord + i];
+        ord[i] = tc_atomic_ordering(oe);
+        if (ord[i] < 0) {
+            diagf(arena, diags, oe ? oe->span : e->span, "type: ", "expected a memory ordering: relaxed, acquire, release, acq_rel or seq_cst");
+            return true;
+        }
+    }
+    bool bad_ord = false;
+    switch (op) {
+        case TC_ATOMIC_LOAD: bad_ord = ord[0] == TC_ORD_RELEASE || ord[0] == TC_ORD_ACQ_REL; break;
+        case TC_ATOMIC_STORE: bad_ord = ord[0] == TC_ORD_ACQUIRE || ord[0] == TC_ORD_ACQ_REL; break;
+        case TC_ATOMIC_CAS: bad_ord = ord[1] == TC_ORD_RELEASE || ord[1] == TC_ORD_ACQ_REL; break;
+        case TC_ATOMIC_FENCE: bad_ord = ord[0] == TC_ORD_RELAXED; break;
+        default: break;
+    }
+    if (bad_ord) {
+        diagf(arena, diags, e->span, "type: ", op == TC_ATOMIC_LOAD ? "an atomic load cannot have release semantics"
+                                                : op == TC_ATOMIC_STORE ? "an atomic store cannot have acquire semantics"
+                                                : op == TC_ATOMIC_CAS ? "atomic_cas failure ordering cannot have release semantics"
+                                                                      : "atomic_fence needs an ordering stronger than relaxed");
+        return true;
+    }
+    if (op == TC_ATOMIC_FENCE) {
+        *out = (TcType){ .ty = NULL, .lit = TC_LIT_NONE };
+        return true;
+    }
+
+    const EmpExpr *a0 = (const EmpExpr *)e->as.call.args.items[0];
+    TcType t0 = tc_expr(arena, diags, fns, env, (EmpExpr *)a0, lenient, io_changed);
+    const EmpType *at = t0.ty && t0.ty->kind == EMP_TYPE_PTR ? t0.ty->as.ptr.pointee : NULL;
+    if (!type_is_atomic(at)) {
+        if (!(lenient && type_is_auto(t0.ty))) diagf(arena, diags, a0 ? a0->span : e->span, "type: ", "first argument must point to an atomic (use &a where a: Atomic[T])");
+        return true;
+    }
+    EmpType *vt = atomic_value_type(arena, at, e->span);
+
+    for (size_t i = 1; i < argc - nord; i++) {
+        const EmpExpr *ae = (const EmpExpr *)e->as.call.args.items[i];
+        TcType t = tc_expr_expected(arena, diags, fns, env, (EmpExpr *)ae, vt, lenient, io_changed);
+        if (t.ty && !can_coerce(t, vt)) {
+            diagf(arena, diags, ae ? ae->span : e->span, "type: ", "atomic operand does not convert to the atomic's value type");
+            return true;
+        }
+    }
+
+    switch (op) {
+        case TC_ATOMIC_STORE:
+            *out = (TcType){ .ty = NULL, .lit = TC_LIT_NONE };
+            return true;
+        case TC_ATOMIC_RMW:
+            if (!type_is_int(vt)) {
+                diagf(arena, diags, e->span, "type: ", "atomic_fetch_* needs an integer atomic");
+                return true;
+            }
+            break;
+        case TC_ATOMIC_CAS: {
+            EmpType *tt = make_tuple(arena, e->span);
+            EmpTupleField *f0 = (EmpTupleField *)emp_arena_alloc(arena, sizeof(EmpTupleField), _Alignof(EmpTupleField));
+            EmpTupleField *f1 = (EmpTupleField *)emp_arena_alloc(arena, sizeof(EmpTupleField), _Alignof(EmpTupleField));
+            if (!tt || !f0 || !f1) return true;
+            *f0 = (EmpTupleField){ .ty = vt, .span = e->span };
+            *f1 = (EmpTupleField){ .ty = make_named(arena, e->span, "bool"), .span = e->span };
+            (void)emp_vec_push(&tt->as.tuple.fields, f0);
+            (void)emp_vec_push(&tt->as.tuple.fields, f1);
+            *out = (TcType){ .ty = tt, .lit = TC_LIT_NONE };
+            return true;
+        }
+        default:
+            break;
+    }
+    *out = (TcType){ .ty = vt, .lit = TC_LIT_NONE };
+    return true;
+}
+
+// A const `T[N]` may be written as a literal of exactly N elements (nested for `T[N][M]`).
+static bool tc_check_array_literal(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, EmpExpr *lit, const EmpType *expected) {
+    if (!lit || lit->kind != EMP_EXPR_LIST || !expected || expected->kind != EMP_TYPE_ARRAY) return false;
+    const char *n = slice_to_cstr(arena, expected->as.array.size_text);
+    if (!n[0] || strtoull(n, NULL, 10) != lit->as.list.items.len) {
+        diagf(arena, diags, lit->span, "type: ", "array literal length does not match the array type");
+        return true;
+    }
+    const EmpType *elem = expected->as.array.elem;
+    for (size_t i = 0; i < lit->as.list.items.len; i++) {
+        EmpExpr *it = (EmpExpr *)lit->as.list.items.items[i];
+        if (elem && elem->kind == EMP_TYPE_ARRAY && it && it->kind == EMP_EXPR_LIST) {
+            (void)tc_check_array_literal(arena, diags, fns, env, it, elem);
+            continue;
+        }
+        TcType tt = tc_expr_expected(arena, diags, fns, env, it, elem, /*lenient*/ false, NULL);
+        bool ok = !tt.ty || can_coerce(tt, elem);
+        if (!ok && elem && elem->kind == EMP_TYPE_TUPLE && it && it->kind == EMP_EXPR_TUPLE) {
+            ok = tc_check_tuple_literal_against_type(arena, diags, fns, env, it, elem, /*lenient*/ false, NULL);
+        }
+        if (!ok) diagf(arena, diags, it ? it->span : lit->span, "type: ", "array literal element type mismatch");
+    }
+    return true;
+}
+
 static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, EmpExpr *e, const EmpType *expected, bool lenient, bool *io_changed) {
     if (!e) return (TcType){0};
 
@@ -1630,8 +2819,13 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
         case EMP_EXPR_FSTRING:
             // f-string type: string (owned heap string). Interpolations are formatted at runtime.
             for (size_t i = 0; i < e->as.fstring.parts.len; i++) {
-                const EmpFStringPart *pt = (const EmpFStringPart *)e->as.fstring.parts.items[i];
-                if (!pt || !pt->is_expr) continue;
+                EmpFStringPart *pt = (EmpFStringPart *)e->as.fstring.parts.items[i];
+                if (!pt) continue;
+                if (!pt->is_expr) {
+                    pt->fmt = EMP_FMT_TEXT;
+                    pt->max_len = (uint32_t)pt->text.len;
+                    continue;
+                }
 
                 TcType tt = tc_expr(arena, diags, fns, env, pt->expr, lenient, io_changed);
                 if (!tt.ty) {
@@ -1647,6 +2841,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                         diagf(arena, diags, pt->span, "type: ", "unsupported f-string interpolation type (supported: string, *u8, int, bool, char)");
                     }
                 }
+                tc_fstring_part_format(pt, tt.ty);
             }
 
             return (TcType){ .ty = make_named(arena, e->span, "string"), .lit = TC_LIT_NONE };
@@ -1790,6 +2985,15 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
 
             EmpType *t = env_lookup(env, e->as.lit);
             if (!t) {
+                // Consts: the type is known once the const has been checked (see step 2b).
+                const EmpItemConst *k = find_const_item(g_tc_program, e->as.lit);
+                if (k) {
+                    EmpType *kt = const_item_type(k);
+                    if (kt) return (TcType){ .ty = kt, .lit = TC_LIT_NONE };
+                    if (lenient) return (TcType){ .ty = make_auto(arena, e->span), .lit = TC_LIT_NONE };
+                    diagf(arena, diags, e->span, "type: ", "const used before its type is known (add a type annotation)");
+                    return (TcType){0};
+                }
                 // allow function name as callee only; if referenced as value, error
                 if (fns_find(fns, e->as.lit)) {
                     diagf(arena, diags, e->span, "type: ", "function used as a value is not supported yet");
@@ -1883,6 +3087,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
         }
 
         case EMP_EXPR_UNARY: {
+            g_tc_packed_member = false;
             TcType rhs = tc_expr(arena, diags, fns, env, e->as.unary.rhs, lenient, io_changed);
             if (!rhs.ty) return (TcType){0};
 
@@ -1913,8 +3118,40 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                     return (TcType){ .ty = make_named(arena, e->span, "bool"), .lit = TC_LIT_NONE };
 
                 case EMP_UN_BORROW:
-                case EMP_UN_BORROW_MUT:
+                case EMP_UN_BORROW_MUT: {
+                    // A pointer to a field of a @packed struct may be misaligned.
+                    const EmpExpr *inner = unwrap_group_expr(e->as.unary.rhs);
+                    if (inner && inner->kind == EMP_EXPR_MEMBER && g_tc_packed_member && g_tc_off_depth == 0) {
+                        diagf(arena, diags, e->span, "type: ", "cannot borrow a field of a @packed struct (copy it to a local first)");
+                        return (TcType){0};
+                    }
+                    // Elements of a @soa list are spread over its columns; only fields have an address.
+                    if (inner && inner->kind == EMP_EXPR_INDEX && inner->as.index.soa) {
+                        diagf(arena, diags, e->span, "type: ", "cannot borrow an element of a @soa list; borrow a field instead (`&xs[i].f`)");
+                        return (TcType){0};
+                    }
+                    // Consts live in read-only globals.
+                    if (e->as.unary.op == EMP_UN_BORROW_MUT && place_names_const(env, e->as.unary.rhs)) {
+                        diagf(arena, diags, e->span, "type: ", "cannot borrow a const mutably");
+                        return (TcType){0};
+                    }
                     return (TcType){ .ty = make_ptr(arena, e->span, (EmpType *)rhs.ty), .lit = TC_LIT_NONE };
+                }
+
+                case EMP_UN_AWAIT:
+                    if (g_tc_coro != EMP_CORO_TASK) {
+                        diagf(arena, diags, e->span, "type: ", "'await' outside an async fn (use block_on(t) in sync code)");
+                        return (TcType){0};
+                    }
+                    if (g_tc_par_depth) {
+                        diagf(arena, diags, e->span, "type: ", "'await' inside a parallel for body");
+                        return (TcType){0};
+                    }
+                    if (!type_is_coro(rhs.ty, "Task")) {
+                        diagf(arena, diags, e->span, "type: ", "'await' expects a Task[T] (the result of calling an async fn)");
+                        return (TcType){0};
+                    }
+                    return (TcType){ .ty = coro_value_type(rhs.ty), .lit = TC_LIT_NONE };
 
                 default:
                     return rhs;
@@ -1931,6 +3168,26 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
             TcType lhs = tc_expr(arena, diags, fns, env, e->as.binary.lhs, lenient, io_changed);
             if (!lhs.ty) return (TcType){0};
 
+            if (assign_like && place_names_const(env, e->as.binary.lhs)) {
+                diagf(arena, diags, e->span, "type: ", "cannot assign to a const");
+                return (TcType){0};
+            }
+
+            // Atomics change only through the atomic_* builtins. A plain store is allowed in
+            // `@emp off`, e.g. to reset one that is not shared yet.
+            if (assign_like && type_is_atomic(lhs.ty)) {
+                if (op != EMP_BIN_ASSIGN || (g_tc_off_depth == 0 && g_tc_mm_depth == 0)) {
+                    diagf(arena, diags, e->span, "type: ", "non-atomic write to an atomic; use atomic_store or atomic_fetch_* (plain `=` needs @emp off)");
+                    return (TcType){0};
+                }
+                EmpType *vt = atomic_value_type(arena, lhs.ty, e->span);
+                TcType rv = tc_expr_expected(arena, diags, fns, env, e->as.binary.rhs, vt, lenient, io_changed);
+                if (rv.ty && !can_coerce(rv, vt) && !can_coerce(rv, lhs.ty)) {
+                    diagf(arena, diags, e->span, "type: ", "assignment type mismatch");
+                }
+                return lhs;
+            }
+
             TcType rhs = {0};
             if (!assign_like) {
                 rhs = tc_expr(arena, diags, fns, env, e->as.binary.rhs, lenient, io_changed);
@@ -1958,6 +3215,9 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                         if (!bt.ty) return (TcType){0};
                         if (bt.ty->kind == EMP_TYPE_ARRAY || bt.ty->kind == EMP_TYPE_LIST) {
                             lhs_ty = bt.ty->as.array.elem;
+                        } else if (type_is_simd(bt.ty)) {
+                            // Lane write: `v[i] = x`.
+                            lhs_ty = simd_elem_type(arena, bt.ty, e->span);
                         } else if (bt.ty->kind == EMP_TYPE_TUPLE) {
                             const EmpExpr *idxe = e->as.binary.lhs->as.index.index;
                             if (!idxe || idxe->kind != EMP_EXPR_INT) {
@@ -1997,6 +3257,11 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                         return (TcType){ .ty = lhs_ty, .lit = TC_LIT_NONE };
                     }
 
+                    if (type_is_simd(lhs_ty)) {
+                        TcType r = tc_simd_binary(arena, diags, e->span, op, tctype(lhs_ty), rhs);
+                        return r.ty ? (TcType){ .ty = lhs_ty, .lit = TC_LIT_NONE } : r;
+                    }
+
                     // Compound assigns: numeric for now.
                     if (!type_is_int(lhs_ty) && !type_is_float(lhs_ty)) {
                         diagf(arena, diags, e->span, "type: ", "compound assignment requires numeric lhs");
@@ -2028,6 +3293,9 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                         if (!bt.ty) return (TcType){0};
                         if (bt.ty->kind == EMP_TYPE_ARRAY || bt.ty->kind == EMP_TYPE_LIST) {
                             lhs_ty = bt.ty->as.array.elem;
+                        } else if (type_is_simd(bt.ty)) {
+                            // Lane write: `v[i] = x`.
+                            lhs_ty = simd_elem_type(arena, bt.ty, e->span);
                         } else if (bt.ty->kind == EMP_TYPE_TUPLE) {
                             const EmpExpr *idxe = e->as.binary.lhs->as.index.index;
                             if (!idxe || idxe->kind != EMP_EXPR_INT) {
@@ -2059,6 +3327,11 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                     rhs = tc_expr_expected(arena, diags, fns, env, e->as.binary.rhs, lhs_ty, lenient, io_changed);
                     if (!rhs.ty) return (TcType){0};
 
+                    if (type_is_simd(lhs_ty)) {
+                        TcType r = tc_simd_binary(arena, diags, e->span, op, tctype(lhs_ty), rhs);
+                        return r.ty ? (TcType){ .ty = lhs_ty, .lit = TC_LIT_NONE } : r;
+                    }
+
                     // Integer-only compound assignments.
                     if (!type_is_int(lhs_ty)) {
                         diagf(arena, diags, e->span, "type: ", "bitwise/shift/remainder compound assignment requires integer lhs");
@@ -2095,6 +3368,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                     return tc_binary_numeric(arena, diags, e->span, op, lhs, rhs, lenient);
 
                 case EMP_BIN_REM: {
+                    if (type_is_simd(lhs.ty) || type_is_simd(rhs.ty)) return tc_simd_binary(arena, diags, e->span, op, lhs, rhs);
                     // Integer remainder for now.
                     bool li = (lhs.lit == TC_LIT_INT) || (lhs.ty && type_is_int(lhs.ty));
                     bool ri = (rhs.lit == TC_LIT_INT) || (rhs.ty && type_is_int(rhs.ty));
@@ -2174,6 +3448,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                 case EMP_BIN_BITXOR:
                 case EMP_BIN_SHL:
                 case EMP_BIN_SHR: {
+                    if (type_is_simd(lhs.ty) || type_is_simd(rhs.ty)) return tc_simd_binary(arena, diags, e->span, op, lhs, rhs);
                     bool li = (lhs.lit == TC_LIT_INT) || (lhs.ty && type_is_int(lhs.ty));
                     bool ri = (rhs.lit == TC_LIT_INT) || (rhs.ty && type_is_int(rhs.ty));
                     if (!li || !ri) {
@@ -2207,9 +3482,24 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
             }
 
             if (bt.ty->kind == EMP_TYPE_LIST) {
+                e->as.index.soa = type_is_soa_list(bt.ty);
                 return (TcType){ .ty = bt.ty->as.array.elem, .lit = TC_LIT_NONE };
             }
 
+            if (type_is_simd(bt.ty)) {
+                // Lane read: `v[i]`; constant lanes are range-checked here.
+                const EmpExpr *ie = e->as.index.index;
+                if (ie && ie->kind == EMP_EXPR_INT) {
+                    const char *txt = slice_to_cstr(arena, ie->as.lit);
+                    long long lane = txt ? strtoll(txt, NULL, 0) : -1;
+                    if (lane < 0 || lane >= (long long)simd_lanes(bt.ty)) {
+                        diagf(arena, diags, ie->span, "type: ", "vector lane out of range");
+                        return (TcType){0};
+                    }
+                }
+                return (TcType){ .ty = simd_elem_type(arena, bt.ty, e->span), .lit = TC_LIT_NONE };
+            }
+
             if (type_is_string(bt.ty)) {
                 // Indexing into an owned string yields a `char`.
                 return (TcType){ .ty = make_named(arena, e->span, "char"), .lit = TC_LIT_NONE };
@@ -2233,7 +3523,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                 return (TcType){ .ty = f->ty, .lit = TC_LIT_NONE };
             }
 
-            diagf(arena, diags, e->span, "type: ", "indexing is only supported on arrays, lists, tuples, and strings for now");
+            diagf(arena, diags, e->span, "type: ", "indexing is only supported on arrays, lists, tuples, strings, and vectors for now");
             return (TcType){0};
         }
 
@@ -2259,7 +3549,12 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
 
             TcType bt = tc_expr(arena, diags, fns, env, e->as.member.base, lenient, io_changed);
             if (!bt.ty) return (TcType){0};
+            if (type_is_soa_list(bt.ty) && slice_is(e->as.member.member, "ptr")) {
+                diagf(arena, diags, e->span, "type: ", "a @soa list keeps one array per field and has no single data pointer");
+                return (TcType){0};
+            }
             const EmpType *ft = lookup_field_type(g_tc_program, bt.ty, e->as.member.member, e->span, arena, diags);
+            g_tc_packed_member = ft && field_of_packed_needs_align(g_tc_program, bt.ty, ft);
             return ft ? (TcType){ .ty = ft, .lit = TC_LIT_NONE } : (TcType){0};
         }
 
@@ -2472,6 +3767,38 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
 
             // Free-function calls: `foo(...)`
             if (e->as.call.callee->kind == EMP_EXPR_IDENT) {
+                TcType simd_ty;
+                if (tc_simd_builtin(arena, diags, fns, env, e, expected, lenient, io_changed, &simd_ty)) return simd_ty;
+                TcType atomic_ty;
+                if (tc_atomic_builtin(arena, diags, fns, env, e, lenient, io_changed, &atomic_ty)) return atomic_ty;
+
+                // `thread_count()`: online CPUs (runtime @emp.thread.count); wrapped by std.thread.
+                if (slice_is(e->as.call.callee->as.lit, "thread_count")) {
+                    if (e->as.call.args.len != 0) {
+                        diagf(arena, diags, e->span, "type: ", "wrong number of arguments");
+                        return (TcType){0};
+                    }
+                    return (TcType){ .ty = make_named(arena, e->span, "i32"), .lit = TC_LIT_NONE };
+                }
+
+                // `block_on(t)`: drives task t to completion on the calling thread; its value.
+                if (slice_is(e->as.call.callee->as.lit, "block_on")) {
+                    if (e->as.call.args.len != 1) {
+                        diagf(arena, diags, e->span, "type: ", "wrong number of arguments");
+                        return (TcType){0};
+                    }
+                    TcType t0 = tc_expr(arena, diags, fns, env, (EmpExpr *)e->as.call.args.items[0], lenient, io_changed);
+                    if (!t0.ty || (lenient && type_is_auto(t0.ty))) return (TcType){0};
+                    if (!type_is_coro(t0.ty, "Task")) {
+                        diagf(arena, diags, e->span, "type: ", "block_on expects a Task[T] (the result of calling an async fn)");
+                        return (TcType){0};
+                    }
+                    if (g_tc_coro == EMP_CORO_TASK) {
+                        diagf(arena, diags, e->span, "type: ", "block_on inside an async fn would block the task driving it; use await");
+                    }
+                    return (TcType){ .ty = coro_value_type(t0.ty), .lit = TC_LIT_NONE };
+                }
+
                 // Compiler builtins for built-in list type `T[]`.
                 bool is_reserve = slice_is(e->as.call.callee->as.lit, "list_reserve");
                 bool is_push = slice_is(e->as.call.callee->as.lit, "list_push");
@@ -2517,7 +3844,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                     const EmpType *list_ty = t0.ty->as.ptr.pointee;
 
                     if (is_len || is_cap) {
-                        return (TcType){ .ty = make_named(arena, e->span, "i32"), .lit = TC_LIT_NONE };
+                        return (TcType){ .ty = make_len_type(arena, e->span), .lit = TC_LIT_NONE };
                     }
 
                     if (is_reserve) {
@@ -2683,7 +4010,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                         return (TcType){ .ty = make_named(arena, e->span, "string"), .lit = TC_LIT_NONE };
                     }
                     if (is_s_len) {
-                        return (TcType){ .ty = make_named(arena, e->span, "i32"), .lit = TC_LIT_NONE };
+                        return (TcType){ .ty = make_len_type(arena, e->span), .lit = TC_LIT_NONE };
                     }
                     if (is_s_cstr) {
                         return (TcType){ .ty = make_ptr(arena, e->span, make_named(arena, e->span, "u8")), .lit = TC_LIT_NONE };
@@ -2716,6 +4043,12 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                     }
                 }
 
+                if (!tc_instantiate_generic_call(arena, diags, fns, e, arg_types, argc, lenient)) {
+                    free(arg_types);
+                    free(arg_exprs);
+                    return (TcType){0};
+                }
+
                 TcFnSig *sig = tc_resolve_free_overload(arena, diags, fns, env, e, e->as.call.callee->as.lit, arg_types, arg_exprs, argc, lenient, io_changed);
                 if (!sig) {
                     free(arg_types);
@@ -2811,6 +4144,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                     if (!tc_arg_compatible(arena, diags, fns, env, arg_types[i], arg_exprs ? arg_exprs[i] : NULL, pt, lenient, io_changed)) {
                         diagf(arena, diags, arg_exprs[i] ? arg_exprs[i]->span : e->span, "type: ", "argument type mismatch");
                     }
+                    if (arg_exprs) tc_note_arg_passing(arg_exprs[i], pt);
                 }
 
                 // Record resolved callee symbol name for codegen when overloaded.
@@ -3121,6 +4455,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                         if (!tc_arg_compatible(arena, diags, fns, env, arg_types[i], arg_exprs ? arg_exprs[i] : NULL, p->ty, lenient, io_changed)) {
                             diagf(arena, diags, arg_exprs[i] ? arg_exprs[i]->span : e->span, "type: ", "argument type mismatch");
                         }
+                        if (arg_exprs) tc_note_arg_passing(arg_exprs[i], p->ty);
                     }
 
                     e->as.call.resolved_name = (EmpSlice){0};
@@ -3267,6 +4602,7 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
                     if (!tc_arg_compatible(arena, diags, fns, env, arg_types[i], arg_exprs ? arg_exprs[i] : NULL, p->ty, lenient, io_changed)) {
                         diagf(arena, diags, arg_exprs[i] ? arg_exprs[i]->span : e->span, "type: ", "argument type mismatch");
                     }
+                    if (arg_exprs) tc_note_arg_passing(arg_exprs[i], p->ty);
                 }
 
                 // If this receiver has multiple overloads for this name, record a signature-mangled symbol.
@@ -3307,6 +4643,48 @@ static TcType tc_expr_expected(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcE
     }
 }
 
+// First statement in a `parallel for` body that would leave the loop as a whole: `return`, or
+// `break` not inside a nested loop. Iterations run on several threads, so neither has a meaning;
+// `continue` (skip this iteration) is fine.
+static const EmpStmt *tc_parallel_escape(const EmpStmt *s, int nested_loops) {
+    if (!s) return NULL;
+    switch (s->kind) {
+        case EMP_STMT_RETURN:
+            return s;
+        case EMP_STMT_BREAK:
+            return nested_loops ? NULL : s;
+        case EMP_STMT_BLOCK:
+            for (size_t i = 0; i < s->as.block.stmts.len; i++) {
+                const EmpStmt *hit = tc_parallel_escape((const EmpStmt *)s->as.block.stmts.items[i], nested_loops);
+                if (hit) return hit;
+            }
+            return NULL;
+        case EMP_STMT_IF: {
+            const EmpStmt *hit = tc_parallel_escape(s->as.if_stmt.then_branch, nested_loops);
+            return hit ? hit : tc_parallel_escape(s->as.if_stmt.else_branch, nested_loops);
+        }
+        case EMP_STMT_WHILE:
+            return tc_parallel_escape(s->as.while_stmt.body, nested_loops + 1);
+        case EMP_STMT_FOR:
+            return tc_parallel_escape(s->as.for_stmt.body, nested_loops + 1);
+        case EMP_STMT_MATCH:
+            for (size_t i = 0; i < s->as.match_stmt.arms.len; i++) {
+                const EmpMatchArm *a = (const EmpMatchArm *)s->as.match_stmt.arms.items[i];
+                const EmpStmt *hit = a ? tc_parallel_escape(a->body, nested_loops) : NULL;
+                if (hit) return hit;
+            }
+            return NULL;
+        case EMP_STMT_DEFER:
+            return tc_parallel_escape(s->as.defer_stmt.body, nested_loops);
+        case EMP_STMT_EMP_OFF:
+            return tc_parallel_escape(s->as.emp_off.body, nested_loops);
+        case EMP_STMT_EMP_MM_OFF:
+            return tc_parallel_escape(s->as.emp_mm_off.body, nested_loops);
+        default:
+            return NULL;
+    }
+}
+
 static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, TcFnSig *current_fn_sig, EmpType **fn_ret_slot, EmpStmt *s, int loop_depth, bool *out_terminated, bool lenient, bool *io_changed) {
     if (out_terminated) *out_terminated = false;
     if (!s) return;
@@ -3399,6 +4777,8 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
 
             if (decl && s->as.let_stmt.init && init.ty) {
                 bool ok = can_coerce(init, decl);
+                // A new atomic is not shared yet, so it starts from a plain value.
+                if (!ok && type_is_atomic(decl)) ok = can_coerce(init, atomic_value_type(arena, decl, s->span));
                 if (!ok && decl->kind == EMP_TYPE_TUPLE && s->as.let_stmt.init && s->as.let_stmt.init->kind == EMP_EXPR_TUPLE) {
                     ok = tc_check_tuple_literal_against_type(arena, diags, fns, env, s->as.let_stmt.init, decl, lenient, io_changed);
                 }
@@ -3418,6 +4798,12 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
         case EMP_STMT_RETURN: {
             const EmpType *fn_ret = fn_ret_slot ? *fn_ret_slot : NULL;
 
+            if (g_tc_coro == EMP_CORO_GEN && s->as.ret.value) {
+                diagf(arena, diags, s->span, "type: ", "a generator cannot return a value (yield it, then `return;`)");
+                if (out_terminated) *out_terminated = true;
+                return;
+            }
+
             if (fn_ret && type_is_auto(fn_ret)) {
                 if (!s->as.ret.value) {
                     diagf(arena, diags, s->span, "type: ", "cannot infer auto return type without a return value");
@@ -3481,6 +4867,29 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
             return;
         }
 
+        case EMP_STMT_YIELD: {
+            if (g_tc_coro != EMP_CORO_GEN) {
+                diagf(arena, diags, s->span, "type: ", "'yield' outside a generator (a fn returning Gen[T])");
+                return;
+            }
+            if (g_tc_par_depth) {
+                diagf(arena, diags, s->span, "type: ", "'yield' inside a parallel for body");
+                return;
+            }
+            if (!s->as.yield_stmt.value) {
+                diagf(arena, diags, s->span, "type: ", "'yield' needs a value");
+                return;
+            }
+            TcType v = tc_expr_expected(arena, diags, fns, env, s->as.yield_stmt.value, g_tc_yield_ty, lenient, io_changed);
+            if (!v.ty && v.lit == TC_LIT_NONE) return;
+            bool ok = can_coerce(v, g_tc_yield_ty);
+            if (!ok && g_tc_yield_ty && g_tc_yield_ty->kind == EMP_TYPE_TUPLE && s->as.yield_stmt.value->kind == EMP_EXPR_TUPLE) {
+                ok = tc_check_tuple_literal_against_type(arena, diags, fns, env, s->as.yield_stmt.value, g_tc_yield_ty, lenient, io_changed);
+            }
+            if (!ok) diagf(arena, diags, s->span, "type: ", "yield type mismatch");
+            return;
+        }
+
         case EMP_STMT_IF: {
             TcType cnd = tc_expr(arena, diags, fns, env, s->as.if_stmt.cond, lenient, io_changed);
             if (cnd.ty && !type_is_bool(cnd.ty) && !type_is_int(cnd.ty) && cnd.lit != TC_LIT_BOOL && cnd.lit != TC_LIT_INT && cnd.lit != TC_LIT_INT_ZERO) {
@@ -3521,6 +4930,17 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
             // Minimal support:
             // - `for i in a...b { ... }`
             // - `for i, v in arr { ... }` where `arr` is `T[N]` or `T[]`.
+            // - `parallel for i in a..b { ... }` (ranges only; races are emp_borrow's business).
+            if (s->as.for_stmt.is_parallel) {
+                if (!s->as.for_stmt.iterable || s->as.for_stmt.iterable->kind != EMP_EXPR_RANGE) {
+                    diagf(arena, diags, s->span, "type: ", "parallel for only supports ranges (parallel for i in a..b)");
+                    return;
+                }
+                const EmpStmt *esc = tc_parallel_escape(s->as.for_stmt.body, 0);
+                if (esc) {
+                    diagf(arena, diags, esc->span, "type: ", esc->kind == EMP_STMT_RETURN ? "'return' inside a parallel for body" : "'break' inside a parallel for body (use continue to skip an iteration)");
+                }
+            }
 
             if (s->as.for_stmt.iterable && s->as.for_stmt.iterable->kind == EMP_EXPR_RANGE) {
                 const EmpExpr *re = s->as.for_stmt.iterable;
@@ -3540,26 +4960,58 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
                     diagf(arena, diags, s->span, "type: ", "range for-loops only support a single index binding for now");
                 }
 
+                // The induction variable takes the type of the typed bound (the wider one if both are
+                // typed, the end on ties), so `for i in 0..n` with `n: u64` counts in u64. Literal-only
+                // ranges use i32. This changed the type of `i` in existing programs, which always got
+                // i32 (and truncated wider bounds); docs/08_control_flow.md says so.
                 EmpType *idx_ty = make_named(arena, s->span, "i32");
+                int st_bits = st_int ? int_type_bits(st.ty) : 0;
+                int en_bits = en_int ? int_type_bits(en.ty) : 0;
+                if (en_bits && en_bits >= st_bits) idx_ty->as.name = en.ty->as.name;
+                else if (st_bits) idx_ty->as.name = st.ty->as.name;
+                s->as.for_stmt.lowering = EMP_FOR_COUNTED;
+                s->as.for_stmt.idx_ty = idx_ty;
 
                 size_t mark = env->len;
                 if (s->as.for_stmt.idx_name.len && !(s->as.for_stmt.idx_name.len == 1 && s->as.for_stmt.idx_name.ptr[0] == '_')) {
                     (void)env_push(env, s->as.for_stmt.idx_name, idx_ty);
                 }
+                if (s->as.for_stmt.is_parallel) g_tc_par_depth++;
                 (void)tc_stmt(arena, diags, fns, env, current_fn_sig, fn_ret_slot, s->as.for_stmt.body, loop_depth + 1, NULL, lenient, io_changed);
+                if (s->as.for_stmt.is_parallel) g_tc_par_depth--;
                 env->len = mark;
                 return;
             }
 
             TcType it = tc_expr(arena, diags, fns, env, s->as.for_stmt.iterable, lenient, io_changed);
             if (!it.ty) return;
+            if (type_is_coro(it.ty, "Gen")) {
+                // One name binds the value; with two, the first counts iterations.
+                bool counted = s->as.for_stmt.val_name.len != 0;
+                EmpType *val_ty = coro_value_type(it.ty);
+                s->as.for_stmt.lowering = EMP_FOR_GEN;
+                s->as.for_stmt.idx_ty = counted ? make_named(arena, s->span, "u64") : val_ty;
+
+                size_t mark = env->len;
+                if (s->as.for_stmt.idx_name.len && !(s->as.for_stmt.idx_name.len == 1 && s->as.for_stmt.idx_name.ptr[0] == '_')) {
+                    (void)env_push(env, s->as.for_stmt.idx_name, s->as.for_stmt.idx_ty);
+                }
+                if (counted && !(s->as.for_stmt.val_name.len == 1 && s->as.for_stmt.val_name.ptr[0] == '_')) {
+                    (void)env_push(env, s->as.for_stmt.val_name, val_ty);
+                }
+                (void)tc_stmt(arena, diags, fns, env, current_fn_sig, fn_ret_slot, s->as.for_stmt.body, loop_depth + 1, NULL, lenient, io_changed);
+                env->len = mark;
+                return;
+            }
             if (it.ty->kind != EMP_TYPE_ARRAY && it.ty->kind != EMP_TYPE_LIST) {
-                diagf(arena, diags, s->span, "type: ", "for/in only supported for arrays and lists for now");
+                diagf(arena, diags, s->span, "type: ", "for/in only supported for ranges, arrays, lists and generators for now");
                 return;
             }
 
-            EmpType *idx_ty = make_named(arena, s->span, "i32");
+            EmpType *idx_ty = it.ty->kind == EMP_TYPE_LIST ? make_len_type(arena, s->span) : make_named(arena, s->span, "i32");
             EmpType *val_ty = it.ty->as.array.elem;
+            s->as.for_stmt.lowering = it.ty->kind == EMP_TYPE_ARRAY ? EMP_FOR_ARRAY : type_is_soa_list(it.ty) ? EMP_FOR_SOA : EMP_FOR_LIST;
+            s->as.for_stmt.idx_ty = idx_ty;
 
             // Body in its own scope with idx/val bindings.
             size_t mark = env->len;
@@ -3586,6 +5038,7 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
         case EMP_STMT_MATCH: {
             TcType scr = tc_expr(arena, diags, fns, env, s->as.match_stmt.scrutinee, lenient, io_changed);
             if (!scr.ty) return;
+            s->as.match_stmt.scrutinee_ty = (EmpType *)scr.ty;
 
             // Enum-aware match: patterns are `Enum::Variant` or `Enum::Variant(x, y, ...)`.
             const EmpItem *en = NULL;
@@ -3646,6 +5099,7 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
                                     diagf(arena, diags, a->pat ? a->pat->span : a->span, "type: ", "enum match pattern arity mismatch");
                                 }
 
+                                ((EmpMatchArm *)a)->variant = (uint32_t)vidx;
                                 if (covered && vidx < en->as.enum_decl.variants.len) {
                                     if (covered[vidx]) {
                                         diagf(arena, diags, a->pat ? a->pat->span : a->span, "type: ", "duplicate enum variant in match arms");
@@ -3710,7 +5164,9 @@ static void tc_stmt(EmpArena *arena, EmpDiags *diags, TcFns *fns, TcEnv *env, Tc
 
         case EMP_STMT_EMP_OFF:
             // Typechecking still applies inside; @emp off affects ownership/borrow rules.
+            g_tc_off_depth++;
             tc_stmt(arena, diags, fns, env, current_fn_sig, fn_ret_slot, s->as.emp_off.body, loop_depth, NULL, lenient, io_changed);
+            g_tc_off_depth--;
             return;
 
         case EMP_STMT_EMP_MM_OFF:
@@ -3734,12 +5190,25 @@ void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
     g_tc_program = program;
     const bool file_mm_off = program_has_emp_mm_off(program);
 
+    // 0) Generics: set templates aside and instantiate every `S[A, ...]` type in use. Generic fns
+    // are instantiated at their call sites below.
+    tc_split_generics(arena, diags, program);
+    for (size_t i = 0; i < program->items.len; i++) {
+        tc_mono_item(arena, diags, program, (EmpItem *)program->items.items[i]);
+    }
+
     // 1) Validate type names (builtins + declared user types).
     validate_type_names_in_program(arena, diags, program);
 
     // 1b) Validate trait impls (signatures + required methods).
     validate_trait_impls(arena, program, diags);
 
+    // 1c) Coroutines: generators (`-> Gen[T]`) and `async fn`s.
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (it && it->kind == EMP_ITEM_FN) tc_classify_coro(arena, diags, &it->as.fn);
+    }
+
     // 2) Collect function signatures.
     TcFns fns;
     memset(&fns, 0, sizeof(fns));
@@ -3752,7 +5221,7 @@ void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
         memset(&sig, 0, sizeof(sig));
         sig.name = it->as.fn.name;
         sig.span = it->as.fn.span;
-        sig.ret = it->as.fn.ret_ty; // NULL means void
+        tc_set_call_ret(arena, &sig, &it->as.fn); // NULL means void
         sig.decl = it;
 
         sig.params_len = it->as.fn.params.len;
@@ -3778,6 +5247,16 @@ void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
         (void)fns_push(&fns, sig);
     }
 
+    // Instantiating a generic fn registers its signature while other signatures are in use:
+    // reserve room up front so those pointers stay valid.
+    if (fns.len + TC_MAX_INSTANCES > fns.cap) {
+        TcFnSig *grown = (TcFnSig *)realloc(fns.items, (fns.len + TC_MAX_INSTANCES) * sizeof(TcFnSig));
+        if (grown) {
+            fns.items = grown;
+            fns.cap = fns.len + TC_MAX_INSTANCES;
+        }
+    }
+
     // 3) Typecheck function bodies.
     // 3a) Auto inference pass (no diagnostics): infer monomorphic `auto` params from call sites.
     // Iterate to a fixed point because inference can unlock more inference.
@@ -3801,10 +5280,16 @@ void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
             }
 
             bool term = false;
+            EmpType *no_ret = NULL;
+            bool is_gen = it->as.fn.coro == EMP_CORO_GEN;
             g_tc_mm_depth = (file_mm_off ? 1 : 0) + (it->as.fn.is_mm_only ? 1 : 0);
-            tc_stmt(arena, /*diags*/ NULL, &fns, &env, self_sig, &it->as.fn.ret_ty, it->as.fn.body, 0, &term, /*lenient*/ true, &changed);
+            g_tc_coro = it->as.fn.coro;
+            g_tc_yield_ty = is_gen ? coro_value_type(it->as.fn.ret_ty) : NULL;
+            tc_stmt(arena, /*diags*/ NULL, &fns, &env, it->as.fn.coro ? NULL : self_sig, is_gen ? &no_ret : &it->as.fn.ret_ty, it->as.fn.body, 0, &term, /*lenient*/ true, &changed);
             g_tc_mm_depth = 0;
-            if (self_sig) self_sig->ret = it->as.fn.ret_ty;
+            g_tc_coro = EMP_CORO_NONE;
+            g_tc_yield_ty = NULL;
+            if (self_sig) tc_set_call_ret(arena, self_sig, &it->as.fn);
 
             env_free(&env);
         }
@@ -3876,6 +5361,58 @@ void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
         if (!changed) break;
     }
 
+    // 3a') Const initializers, checked with no locals in scope. An untyped const takes the type
+    // of its initializer; a few lenient rounds first let consts name consts declared later.
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_CONST || !it->as.const_decl.init) continue;
+        if (it->as.const_decl.is_exported && !const_item_type(&it->as.const_decl)) {
+            diagf(arena, diags, it->as.const_decl.span, "type: ", "an exported const needs an explicit type");
+        }
+    }
+    for (int iter = 0; iter < 8; iter++) {
+        bool changed = false;
+        for (size_t i = 0; i < program->items.len; i++) {
+            EmpItem *it = (EmpItem *)program->items.items[i];
+            if (!it || it->kind != EMP_ITEM_CONST || !it->as.const_decl.init || const_item_type(&it->as.const_decl)) continue;
+            TcEnv env;
+            memset(&env, 0, sizeof(env));
+            TcType t = tc_expr(arena, /*diags*/ NULL, &fns, &env, it->as.const_decl.init, /*lenient*/ true, NULL);
+            if (t.ty && !type_is_auto(t.ty)) {
+                it->as.const_decl.ty = (EmpType *)t.ty;
+                changed = true;
+            }
+            env_free(&env);
+        }
+        if (!changed) break;
+    }
+    for (size_t i = 0; i < program->items.len; i++) {
+        EmpItem *it = (EmpItem *)program->items.items[i];
+        if (!it || it->kind != EMP_ITEM_CONST || !it->as.const_decl.init) continue;
+        EmpItemConst *k = &it->as.const_decl;
+        EmpType *decl = const_item_type(k);
+
+        TcEnv env;
+        memset(&env, 0, sizeof(env));
+        g_tc_mm_depth = file_mm_off ? 1 : 0;
+        if (tc_check_array_literal(arena, diags, &fns, &env, k->init, decl)) {
+            g_tc_mm_depth = 0;
+            env_free(&env);
+            continue;
+        }
+        TcType t = decl ? tc_expr_expected(arena, diags, &fns, &env, k->init, decl, /*lenient*/ false, NULL)
+                        : tc_expr(arena, diags, &fns, &env, k->init, /*lenient*/ false, NULL);
+        g_tc_mm_depth = 0;
+        if (!decl) {
+            if (t.ty) diagf(arena, diags, k->span, "type: ", "cannot infer const type (add a type annotation)");
+        } else if (t.ty && !can_coerce(t, decl)) {
+            bool ok = decl->kind == EMP_TYPE_TUPLE && k->init->kind == EMP_EXPR_TUPLE &&
+                      tc_check_tuple_literal_against_type(arena, diags, &fns, &env, k->init, decl, /*lenient*/ false, NULL);
+            if (!ok) diagf(arena, diags, k->span, "type: ", "const initializer type mismatch");
+        }
+        env_free(&env);
+    }
+
     // 3b) Strict typecheck pass (emits diagnostics).
     for (size_t i = 0; i < program->items.len; i++) {
         EmpItem *it = (EmpItem *)program->items.items[i];
@@ -3894,17 +5431,24 @@ void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
         }
 
         bool term = false;
+        EmpType *no_ret = NULL;
+        bool is_gen = it->as.fn.coro == EMP_CORO_GEN;
         g_tc_mm_depth = (file_mm_off ? 1 : 0) + (it->as.fn.is_mm_only ? 1 : 0);
-        tc_stmt(arena, diags, &fns, &env, self_sig, &it->as.fn.ret_ty, it->as.fn.body, 0, &term, /*lenient*/ false, /*io_changed*/ NULL);
+        g_tc_coro = it->as.fn.coro;
+        g_tc_yield_ty = is_gen ? coro_value_type(it->as.fn.ret_ty) : NULL;
+        // A generator's body ends with `return;`; an async fn's returns its task's value.
+        tc_stmt(arena, diags, &fns, &env, it->as.fn.coro ? NULL : self_sig, is_gen ? &no_ret : &it->as.fn.ret_ty, it->as.fn.body, 0, &term, /*lenient*/ false, /*io_changed*/ NULL);
         g_tc_mm_depth = 0;
-        if (self_sig) self_sig->ret = it->as.fn.ret_ty;
+        g_tc_coro = EMP_CORO_NONE;
+        g_tc_yield_ty = NULL;
+        if (self_sig) tc_set_call_ret(arena, self_sig, &it->as.fn);
 
         if (it->as.fn.ret_ty && type_is_auto(it->as.fn.ret_ty)) {
             diagf(arena, diags, it->as.fn.span, "type: ", "cannot infer auto return type (add an explicit return type)");
         }
 
         // If function has a non-void return, require a terminating return on all paths (very conservative for now).
-        if (!type_is_void(it->as.fn.ret_ty) && !term) {
+        if (!is_gen && !type_is_void(it->as.fn.ret_ty) && !term) {
             diagf(arena, diags, it->as.fn.span, "type: ", "missing return (not all paths return yet)");
         }
 
@@ -3998,6 +5542,11 @@ void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags) {
     }
 
     fns_free(&fns);
+    insts_free();
 
     g_tc_program = NULL;
 }
+
+bool emp_sem_has_exact_override(EmpProgram *program, EmpSlice class_name, const EmpClassMethod *base_method) {
+    return find_class_method_exact(program, class_name, base_method) || find_impl_method_exact(program, class_name, base_method);
+}
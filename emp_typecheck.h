@@ -13,6 +13,17 @@ extern "C" {
 // - May rewrite some `auto` types into concrete types (e.g., local vars with initializers).
 void emp_sem_typecheck(EmpArena *arena, EmpProgram *program, EmpDiags *diags);
 
+// True when class `class_name` has a method with exactly the signature of virtual method
+// `base_method` (in its class body or an inherent impl): the override a `dyn` call on a
+// `class_name` object dispatches to, as required by `*Concrete as dyn Base` casts.
+bool emp_sem_has_exact_override(EmpProgram *program, EmpSlice class_name, const EmpClassMethod *base_method);
+
+// True when `fn` is checked as a generic over its plain `auto` parameters: one specialized
+// instance per distinct argument type tuple instead of a single inferred type. Applies to
+// non-extern fns that are not overloaded in `program` (may be NULL) and whose parameters use
+// `auto` only at the top level. Import decls of such fns must keep the body.
+bool emp_sem_fn_is_auto_generic(const EmpProgram *program, const EmpItemFn *fn);
+
 #ifdef __cplusplus
 }
 #endif
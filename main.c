@@ -1,25 +1,53 @@
+// glibc only declares `struct ucred` (SO_PEERCRED) for GNU sources.
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "emp_lexer.h"
 #include "emp_parser.h"
 #include "emp_json.h"
 #include "emp_defer.h"
 #include "emp_semantic.h"
 #include "emp_typecheck.h"
+#include "emp_consteval.h"
 #include "emp_borrow.h"
 #include "emp_drop.h"
+#include "emp_reach.h"
+#include "emp_bounds.h"
+#include "emp_fstring.h"
+#include "emp_string.h"
+#include "emp_escape.h"
+#include "emp_layout.h"
+#include "emp_soa.h"
+#include "emp_match.h"
+#include "emp_coro.h"
+#include "emp_devirt.h"
+#include "emp_cache.h"
+#include "emp_runtime.h"
 #include "emp_codegen_llvm.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
+#include <time.h>
 
 #ifndef _WIN32
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <poll.h>
+#include <signal.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
+
+extern char **environ;
 #endif
 
 #ifdef _WIN32
@@ -31,6 +59,8 @@
 #ifdef _WIN32
 #include <io.h>
 #include <process.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <windows.h>
 #endif
 
@@ -40,6 +70,8 @@ static char *path_join2(const char *a, const char *b);
 static char *abs_path_dup(const char *path);
 static char *path_dirname_dup(const char *path);
 static bool ensure_dir(const char *path);
+static char *serve_cache_key(const char *path);
+static bool file_stamp(const char *path, long long *out_mtime, long long *out_size);
 
 static bool slice_eq(EmpSlice a, EmpSlice b) {
     if (a.len != b.len) return false;
@@ -465,8 +497,20 @@ static void cmd_append(char *dst, size_t dst_cap, const char *s) {
     memcpy(dst + cur, s, n + 1);
 }
 
-static intptr_t spawn_wait(const char *exe, const char *const *args) {
-    if (!exe || !args) return -1;
+// A child process started by `spawn_start`. Must be finished with `spawn_join`.
+typedef struct EmpProc {
+#ifdef _WIN32
+    HANDLE process;
+#else
+    pid_t pid;
+#endif
+    bool started;
+} EmpProc;
+
+static bool spawn_start(const char *exe, const char *const *args, EmpProc *out) {
+    if (!out) return false;
+    memset(out, 0, sizeof(*out));
+    if (!exe || !args) return false;
 
 #ifdef _WIN32
 
@@ -508,31 +552,116 @@ static intptr_t spawn_wait(const char *exe, const char *const *args) {
         &si,
         &pi);
 
-    if (!ok) {
-        return (intptr_t)(-2);
-    }
+    if (!ok) return false;
 
-    WaitForSingleObject(pi.hProcess, INFINITE);
-    DWORD code = 0;
-    GetExitCodeProcess(pi.hProcess, &code);
     CloseHandle(pi.hThread);
-    CloseHandle(pi.hProcess);
-    return (intptr_t)code;
+    out->process = pi.hProcess;
+    out->started = true;
+    return true;
 #else
-    pid_t pid = fork();
-    if (pid < 0) return (intptr_t)(-2);
-    if (pid == 0) {
-        execvp(exe, (char *const *)args);
-        _exit(127);
-    }
+    // posix_spawn avoids duplicating the compiler's (potentially large) address space;
+    // glibc implements it with CLONE_VM|CLONE_VFORK.
+    pid_t pid = 0;
+    if (posix_spawnp(&pid, exe, NULL, NULL, (char *const *)args, environ) != 0) return false;
+    out->pid = pid;
+    out->started = true;
+    return true;
+#endif
+}
+
+static intptr_t spawn_join(EmpProc *p) {
+    if (!p || !p->started) return (intptr_t)(-2);
+    p->started = false;
 
+#ifdef _WIN32
+    WaitForSingleObject(p->process, INFINITE);
+    DWORD code = 0;
+    GetExitCodeProcess(p->process, &code);
+    CloseHandle(p->process);
+    return (intptr_t)code;
+#else
     int status = 0;
-    if (waitpid(pid, &status, 0) < 0) return (intptr_t)(-3);
+    if (waitpid(p->pid, &status, 0) < 0) return (intptr_t)(-3);
     if (WIFEXITED(status)) return (intptr_t)WEXITSTATUS(status);
     if (WIFSIGNALED(status)) return (intptr_t)(128 + WTERMSIG(status));
     return (intptr_t)(-4);
 #endif
 }
+
+static intptr_t spawn_wait(const char *exe, const char *const *args) {
+    if (!exe || !args) return -1;
+    EmpProc p;
+    if (!spawn_start(exe, args, &p)) return (intptr_t)(-2);
+    return spawn_join(&p);
+}
+
+#ifdef _WIN32
+#ifndef EMP_LLVM_ROOT
+#define EMP_LLVM_ROOT "llvm-21.1.8-windows-amd64-msvc17-msvcrt"
+#endif
+#define EMP_TOOL_PATH_MAX MAX_PATH
+#else
+#define EMP_TOOL_PATH_MAX PATH_MAX
+#endif
+
+// Native toolchain, resolved once per process (and kept across requests in long-lived modes).
+// Tools (llc + linker) are looked up eagerly; link inputs (SDK libs / crt objects) are resolved
+// separately so that work can overlap with a running `llc`.
+typedef struct EmpToolchain {
+    bool tools_resolved;
+    bool tools_ok;
+    char llc[EMP_TOOL_PATH_MAX];
+    char lld[EMP_TOOL_PATH_MAX];
+
+    bool link_resolved;
+    bool link_ok;
+#ifdef _WIN32
+    char *um_x64; // Windows SDK import lib dir (kernel32.lib)
+#endif
+} EmpToolchain;
+
+static EmpToolchain g_toolchain;
+
+static const EmpToolchain *toolchain_tools(void) {
+    EmpToolchain *tc = &g_toolchain;
+    if (tc->tools_resolved) return tc;
+    tc->tools_resolved = true;
+#ifdef _WIN32
+    snprintf(tc->llc, sizeof(tc->llc), "%s\\bin\\llc.exe", EMP_LLVM_ROOT);
+    snprintf(tc->lld, sizeof(tc->lld), "%s\\bin\\lld-link.exe", EMP_LLVM_ROOT);
+    tc->tools_ok = file_exists(tc->llc) && file_exists(tc->lld);
+#else
+    bool have_llc = find_in_path("llc", tc->llc, sizeof(tc->llc));
+    bool have_lld = find_in_path("ld.lld", tc->lld, sizeof(tc->lld)) || find_in_path("lld", tc->lld, sizeof(tc->lld));
+    tc->tools_ok = have_llc && have_lld;
+#endif
+    return tc;
+}
+
+#ifndef _WIN32
+static const char *const k_linux_crt_objs[] = {
+    "/usr/lib/x86_64-linux-gnu/Scrt1.o",
+    "/usr/lib/x86_64-linux-gnu/crti.o",
+    "/usr/lib/x86_64-linux-gnu/crtn.o",
+};
+#endif
+
+static const EmpToolchain *toolchain_link_inputs(void) {
+    EmpToolchain *tc = &g_toolchain;
+    if (tc->link_resolved) return tc;
+    tc->link_resolved = true;
+#ifdef _WIN32
+    tc->um_x64 = find_windows_kits_um_x64();
+    tc->link_ok = tc->um_x64 != NULL;
+#else
+    tc->link_ok = true;
+    for (size_t i = 0; i < sizeof(k_linux_crt_objs) / sizeof(k_linux_crt_objs[0]); i++) {
+        if (!file_exists(k_linux_crt_objs[i])) tc->link_ok = false;
+    }
+#endif
+    return tc;
+}
+
 typedef struct StrVec {
     char **items;
     size_t len;
@@ -575,36 +704,232 @@ static bool strvec_push(StrVec *v, char *s) {
     return true;
 }
 
-static StrVec list_em_files_in_dir(const char *dir_abs) {
-    StrVec out;
-    memset(&out, 0, sizeof(out));
+// Directory listings backing module resolution. Each `use` probes candidate paths under up to
+// five bases, in the dependency loop and again per module view; answering those probes from one
+// listing per directory replaces a stat/open per candidate with a lookup.
+//
+// Listings are keyed by absolute path. Under `emp serve` they live in the server: request
+// children inherit them and revalidate each directory against its mtime once per request.
+typedef struct EmpDirEntry {
+    char *name;
+    bool is_dir;
+} EmpDirEntry;
+
+typedef struct EmpDirListing {
+    char *dir;
+    bool exists;
+    bool fresh;          // validated by this process (or request)
+    bool scanned;        // (re)scanned by this process; reported back to the server
+    long long mtime;     // directory mtime at scan; -1 when missing
+    long long scanned_at;
+    EmpDirEntry *entries; // sorted by name
+    size_t len;
+    size_t cap;
+} EmpDirListing;
 
-#ifdef _WIN32
-    char *pattern = path_join2(dir_abs, "*.em");
-    if (!pattern) return out;
+typedef struct EmpDirCache {
+    EmpDirListing *items;
+    size_t len;
+    size_t cap;
+} EmpDirCache;
+
+static EmpDirCache g_dir_cache;
+
+typedef enum EmpFsKind {
+    EMP_FS_NONE = 0,
+    EMP_FS_FILE,
+    EMP_FS_DIR,
+} EmpFsKind;
+
+static int dir_entry_cmp(const void *pa, const void *pb) {
+    const EmpDirEntry *a = (const EmpDirEntry *)pa;
+    const EmpDirEntry *b = (const EmpDirEntry *)pb;
+    return str_cmpi(a->name, b->name);
+}
 
+static void dir_listing_clear(EmpDirListing *l) {
+    for (size_t i = 0; i < l->len; i++) free(l->entries[i].name);
+    free(l->entries);
+    l->entries = NULL;
+    l->len = 0;
+    l->cap = 0;
+}
+
+static void dir_listing_add(EmpDirListing *l, const char *name, bool is_dir) {
+    if (l->len + 1 > l->cap) {
+        size_t nc = l->cap ? l->cap * 2 : 16;
+        EmpDirEntry *p = (EmpDirEntry *)realloc(l->entries, nc * sizeof(EmpDirEntry));
+        if (!p) return;
+        l->entries = p;
+        l->cap = nc;
+    }
+    char *dup = xstrdup(name);
+    if (!dup) return;
+    l->entries[l->len].name = dup;
+    l->entries[l->len].is_dir = is_dir;
+    l->len++;
+}
+
+static void dir_listing_scan(EmpDirListing *l) {
+    dir_listing_clear(l);
+    l->exists = false;
+    l->mtime = -1;
+    l->scanned_at = (long long)time(NULL) * 1000000000LL; // same unit as file_stamp
+    l->fresh = true;
+    l->scanned = true;
+
+#ifdef _WIN32
+    char *pattern = path_join2(l->dir, "*");
+    if (!pattern) return;
     WIN32_FIND_DATAA ffd;
     HANDLE h = FindFirstFileA(pattern, &ffd);
     free(pattern);
-    if (h == INVALID_HANDLE_VALUE) return out;
-
+    if (h == INVALID_HANDLE_VALUE) return;
+    l->exists = true;
+    (void)file_stamp(l->dir, &l->mtime, NULL);
     do {
-        if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
-        char *full = path_join2(dir_abs, ffd.cFileName);
+        dir_listing_add(l, ffd.cFileName, (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0);
+    } while (FindNextFileA(h, &ffd));
+    FindClose(h);
+#else
+    struct stat st;
+    if (stat(l->dir, &st) != 0 || !S_ISDIR(st.st_mode)) return;
+    DIR *d = opendir(l->dir);
+    if (!d) return;
+    l->exists = true;
+    (void)file_stamp(l->dir, &l->mtime, NULL);
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        bool is_dir = false;
+        bool known = false;
+#ifdef DT_DIR
+        if (de->d_type == DT_DIR || de->d_type == DT_REG) {
+            is_dir = de->d_type == DT_DIR;
+            known = true;
+        }
+#endif
+        if (!known) {
+            // Symlinks and filesystems without d_type.
+            char *full = path_join2(l->dir, de->d_name);
+            struct stat est;
+            is_dir = full && stat(full, &est) == 0 && S_ISDIR(est.st_mode);
+            free(full);
+        }
+        dir_listing_add(l, de->d_name, is_dir);
+    }
+    closedir(d);
+#endif
+
+    if (l->len > 1) qsort(l->entries, l->len, sizeof(EmpDirEntry), dir_entry_cmp);
+}
+
+// A listing inherited from the server is reused when the directory's mtime is unchanged and the
+// scan happened strictly after that mtime (an edit within the same second could be missed).
+static bool dir_listing_still_valid(const EmpDirListing *l) {
+    long long mtime = -1;
+    bool have = file_stamp(l->dir, &mtime, NULL);
+    if (!have) return !l->exists;
+    return l->exists && mtime == l->mtime && l->scanned_at > mtime;
+}
+
+static EmpDirListing *dircache_get(const char *dir) {
+    char *key = serve_cache_key(dir);
+    if (!key) return NULL;
+    for (size_t i = 0; i < g_dir_cache.len; i++) {
+        EmpDirListing *l = &g_dir_cache.items[i];
+        if (str_cmpi(l->dir, key) != 0) continue;
+        free(key);
+        if (!l->fresh) {
+            if (dir_listing_still_valid(l)) l->fresh = true;
+            else dir_listing_scan(l);
+        }
+        return l;
+    }
+
+    if (g_dir_cache.len + 1 > g_dir_cache.cap) {
+        size_t nc = g_dir_cache.cap ? g_dir_cache.cap * 2 : 32;
+        EmpDirListing *p = (EmpDirListing *)realloc(g_dir_cache.items, nc * sizeof(EmpDirListing));
+        if (!p) {
+            free(key);
+            return NULL;
+        }
+        g_dir_cache.items = p;
+        g_dir_cache.cap = nc;
+    }
+    EmpDirListing *l = &g_dir_cache.items[g_dir_cache.len++];
+    memset(l, 0, sizeof(*l));
+    l->dir = key;
+    dir_listing_scan(l);
+    return l;
+}
+
+// What is at `path`, answered from the listing of its parent directory.
+static EmpFsKind fs_probe(const char *path) {
+    if (!path || !path[0]) return EMP_FS_NONE;
+    char *p = xstrdup(path);
+    if (!p) return EMP_FS_NONE;
+    size_t n = strlen(p);
+    while (n > 1 && (p[n - 1] == '/' || p[n - 1] == '\\')) p[--n] = '\0';
+
+    char *slash = NULL;
+    for (char *c = p; *c; c++) {
+        if (*c == '/' || *c == '\\') slash = c;
+    }
+    const char *name = slash ? slash + 1 : p;
+    if (!name[0] || strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+        // Roots and dot components have no useful parent listing.
+        bool is_dir = dir_exists(path);
+        free(p);
+        return is_dir ? EMP_FS_DIR : EMP_FS_NONE;
+    }
+
+    char *parent = NULL;
+    if (!slash) {
+        parent = xstrdup(".");
+    } else {
+        size_t pn = (size_t)(slash - p);
+        // Keep the separator for "/x" and "C:\\x".
+        if (pn == 0 || (pn == 2 && p[1] == ':')) pn++;
+        parent = (char *)malloc(pn + 1);
+        if (parent) {
+            memcpy(parent, p, pn);
+            parent[pn] = '\0';
+        }
+    }
+
+    EmpFsKind kind = EMP_FS_NONE;
+    EmpDirListing *l = parent ? dircache_get(parent) : NULL;
+    if (l && l->len > 0) {
+        EmpDirEntry probe;
+        probe.name = (char *)name;
+        probe.is_dir = false;
+        const EmpDirEntry *hit = (const EmpDirEntry *)bsearch(&probe, l->entries, l->len, sizeof(EmpDirEntry), dir_entry_cmp);
+        if (hit) kind = hit->is_dir ? EMP_FS_DIR : EMP_FS_FILE;
+    }
+    free(parent);
+    free(p);
+    return kind;
+}
+
+static StrVec list_em_files_in_dir(const char *dir_abs) {
+    StrVec out;
+    memset(&out, 0, sizeof(out));
+
+    const EmpDirListing *l = dir_abs ? dircache_get(dir_abs) : NULL;
+    if (!l) return out;
+
+    // Listings are sorted, so wildcard package imports iterate in a deterministic order.
+    for (size_t i = 0; i < l->len; i++) {
+        const EmpDirEntry *e = &l->entries[i];
+        size_t n = strlen(e->name);
+        if (e->is_dir || n <= 3 || str_cmpi(e->name + n - 3, ".em") != 0) continue;
+        char *full = path_join2(dir_abs, e->name);
         if (!full) continue;
         char *abs = abs_path_dup(full);
         free(full);
         if (!abs) continue;
         (void)strvec_push(&out, abs);
-    } while (FindNextFileA(h, &ffd));
-
-    FindClose(h);
-
-    // Ensure deterministic iteration order for wildcard package imports.
-    if (out.len > 1) {
-        qsort(out.items, out.len, sizeof(char *), qsort_cstr_cmpi);
     }
-#endif
 
     return out;
 }
@@ -755,7 +1080,12 @@ typedef struct EmpModule {
     char *dir_abs;
     char *src_owned;
     size_t src_len;
+    long long stamp_mtime; // file mtime (ns)/size/content hash at load; used by `emp serve` to detect edits
+    long long stamp_size;
+    uint64_t stamp_hash;
     EmpParseResult pr;
+    EmpVec scope;     // import decls (module arena), see build_module_scope
+    EmpVec tmpl_srcs; // EmpModule* whose generic templates this module imports
 } EmpModule;
 
 typedef struct EmpModules {
@@ -771,6 +1101,8 @@ static void modules_free(EmpModules *m) {
     for (size_t i = 0; i < m->len; i++) {
         EmpModule *mm = &m->items[i];
         emp_parse_result_free(&mm->pr);
+        emp_vec_free(&mm->scope);
+        emp_vec_free(&mm->tmpl_srcs);
         free(mm->src_owned);
         free(mm->path_abs);
         free(mm->dir_abs);
@@ -803,13 +1135,119 @@ static EmpModule *modules_push(EmpModules *m, EmpModule mod) {
     return &m->items[m->len++];
 }
 
+// `out_mtime` is in nanoseconds (whole seconds on Windows).
+static bool file_stamp(const char *path, long long *out_mtime, long long *out_size) {
+    if (!path) return false;
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(path, &st) != 0) return false;
+    if (out_mtime) *out_mtime = (long long)st.st_mtime * 1000000000LL;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+#if defined(__APPLE__)
+    if (out_mtime) *out_mtime = (long long)st.st_mtimespec.tv_sec * 1000000000LL + (long long)st.st_mtimespec.tv_nsec;
+#else
+    if (out_mtime) *out_mtime = (long long)st.st_mtim.tv_sec * 1000000000LL + (long long)st.st_mtim.tv_nsec;
+#endif
+#endif
+    if (out_size) *out_size = (long long)st.st_size;
+    return true;
+}
+
+// FNV-1a over a module's source. Timestamps alone miss same-size edits on filesystems with
+// coarse mtimes (or within one tick), so the server cache also compares contents.
+static uint64_t content_hash(const char *p, size_t n) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static bool file_content_hash(const char *path, uint64_t *out) {
+    size_t len = 0;
+    char *src = read_entire_file(path, &len);
+    if (!src) return false;
+    *out = content_hash(src, len);
+    free(src);
+    return true;
+}
+
+// Identifies the compiler in incremental-cache keys. Bump it whenever codegen output changes
+// for the same input; it is only relied on when the compiler executable cannot be read.
+#define EMP_CODEGEN_VERSION 1
+
+// "<hash of the compiler executable>", so any rebuilt compiler invalidates cached objects, or
+// "v<EMP_CODEGEN_VERSION>" when the executable cannot be read. Computed once per process.
+static const char *compiler_build_id(void) {
+    static char id[32];
+    if (id[0]) return id;
+    uint64_t hash = 0;
+    bool have = false;
+#ifdef _WIN32
+    char exe[MAX_PATH];
+    DWORD n = GetModuleFileNameA(NULL, exe, (DWORD)sizeof(exe));
+    have = n > 0 && n < sizeof(exe) && file_content_hash(exe, &hash);
+#else
+    have = file_content_hash("/proc/self/exe", &hash);
+#endif
+    if (have) snprintf(id, sizeof(id), "%016llx", (unsigned long long)hash);
+    else snprintf(id, sizeof(id), "v%d", EMP_CODEGEN_VERSION);
+    return id;
+}
+
+// Parsed (not yet checked) modules kept hot by `emp serve`. Request handlers run in a forked
+// child, so they can take these by value and run the semantic passes on their private copy.
+static EmpModules *g_serve_cache = NULL;
+// Write end of a pipe back to the server; the request reports every module path it loaded so
+// the server can parse them ahead of the next request, and the program `emp run` built, which the
+// client starts itself. -1 outside `emp serve`.
+static int g_serve_report_fd = -1;
+
+// `abs_path_dup` is a no-op off Windows, so module paths may be cwd-relative. The server cache
+// is shared by requests from different directories and needs a stable key.
+static char *serve_cache_key(const char *path) {
+    if (!path) return NULL;
+#ifdef _WIN32
+    return abs_path_dup(path);
+#else
+    if (path[0] == '/') return xstrdup(path);
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) return NULL;
+    return path_join2(cwd, path);
+#endif
+}
+
 static EmpModule *load_module(EmpModules *mods, const char *path_abs) {
     EmpModule *existing = modules_find(mods, path_abs);
     if (existing) return existing;
 
+    long long mtime = 0;
+    long long fsize = 0;
+    bool have_stamp = file_stamp(path_abs, &mtime, &fsize);
+
+    EmpModule *cached = NULL;
+    if (g_serve_cache && have_stamp) {
+        // The server keys its cache by cwd-independent paths; keep this request's spelling.
+        char *key = serve_cache_key(path_abs);
+        cached = key ? modules_find(g_serve_cache, key) : NULL;
+        free(key);
+        if (cached && (cached->stamp_mtime != mtime || cached->stamp_size != fsize)) cached = NULL;
+    }
+
     size_t len = 0;
     char *src = read_entire_file(path_abs, &len);
     if (!src) return NULL;
+    uint64_t hash = content_hash(src, len);
+    if (cached && cached->stamp_hash == hash) {
+        free(src);
+        EmpModule mod = *cached;
+        mod.path_abs = xstrdup(path_abs);
+        mod.dir_abs = path_dirname_dup(path_abs);
+        return modules_push(mods, mod);
+    }
     strip_markdown_fence_in_place(src, &len);
 
     EmpParseResult pr = emp_parse(src, len);
@@ -820,6 +1258,9 @@ static EmpModule *load_module(EmpModules *mods, const char *path_abs) {
     mod.dir_abs = path_dirname_dup(path_abs);
     mod.src_owned = src;
     mod.src_len = len;
+    mod.stamp_mtime = have_stamp ? mtime : -1;
+    mod.stamp_size = have_stamp ? fsize : -1;
+    mod.stamp_hash = hash;
     mod.pr = pr;
 
     return modules_push(mods, mod);
@@ -880,7 +1321,7 @@ static void resolve_add_file_candidates(StrVec *abs_out, StrVec *desc_out, const
         snprintf(rel_em, strlen(rel) + 4, "%s.em", rel);
         char *cand1 = path_join2(base->dir_abs, rel_em);
         free(rel_em);
-        if (cand1 && file_exists(cand1)) {
+        if (cand1 && fs_probe(cand1) == EMP_FS_FILE) {
             char *abs = abs_path_dup(cand1);
             if (abs && !strvec_contains(abs_out, abs)) {
                 char tmp[1024];
@@ -898,7 +1339,7 @@ static void resolve_add_file_candidates(StrVec *abs_out, StrVec *desc_out, const
     char *cand2_dir = path_join2(base->dir_abs, rel);
     char *cand2 = cand2_dir ? path_join2(cand2_dir, "mod.em") : NULL;
     free(cand2_dir);
-    if (cand2 && file_exists(cand2)) {
+    if (cand2 && fs_probe(cand2) == EMP_FS_FILE) {
         char *abs = abs_path_dup(cand2);
         if (abs && !strvec_contains(abs_out, abs)) {
             char tmp[1024];
@@ -915,7 +1356,7 @@ static void resolve_add_file_candidates(StrVec *abs_out, StrVec *desc_out, const
 static void resolve_add_dir_candidates(StrVec *abs_out, StrVec *desc_out, const EmpResolveBase *base, const char *rel) {
     if (!abs_out || !desc_out || !base || !base->dir_abs || !rel) return;
     char *cand = path_join2(base->dir_abs, rel);
-    if (cand && dir_exists(cand)) {
+    if (cand && fs_probe(cand) == EMP_FS_DIR) {
         char *abs = abs_path_dup(cand);
         if (abs && !strvec_contains(abs_out, abs)) {
             char tmp[1024];
@@ -929,6 +1370,67 @@ static void resolve_add_dir_candidates(StrVec *abs_out, StrVec *desc_out, const
     free(cand);
 }
 
+// Candidates for a `use` path across a set of bases, memoized per invocation. The dependency
+// loop and every module view resolve the same paths against the same bases; only the cheap
+// precedence/ambiguity/vendoring decisions are repeated. Request children of `emp serve` start
+// with an empty memo, so it never outlives the directory listings it was built from.
+typedef struct EmpResolveMemo {
+    char *key;
+    StrVec abs;
+    StrVec desc;
+} EmpResolveMemo;
+
+typedef struct EmpResolveMemos {
+    EmpResolveMemo *items;
+    size_t len;
+    size_t cap;
+} EmpResolveMemos;
+
+static EmpResolveMemos g_resolve_memo;
+
+static const EmpResolveMemo *resolve_candidates(const EmpResolveBase *bases, size_t bases_len, const char *rel, bool want_dir) {
+    static const EmpResolveMemo empty;
+
+    size_t key_cap = strlen(rel) + 3;
+    for (size_t i = 0; i < bases_len; i++) {
+        key_cap += (bases[i].label ? strlen(bases[i].label) : 0) + (bases[i].dir_abs ? strlen(bases[i].dir_abs) : 0) + 2;
+    }
+    char *key = (char *)malloc(key_cap + 1);
+    if (!key) return &empty;
+    size_t pos = (size_t)snprintf(key, key_cap + 1, "%c|%s", want_dir ? 'd' : 'f', rel);
+    for (size_t i = 0; i < bases_len && pos < key_cap; i++) {
+        pos += (size_t)snprintf(key + pos, key_cap + 1 - pos, "|%s=%s",
+                                bases[i].label ? bases[i].label : "",
+                                bases[i].dir_abs ? bases[i].dir_abs : "");
+    }
+
+    for (size_t i = 0; i < g_resolve_memo.len; i++) {
+        if (strcmp(g_resolve_memo.items[i].key, key) == 0) {
+            free(key);
+            return &g_resolve_memo.items[i];
+        }
+    }
+
+    if (g_resolve_memo.len + 1 > g_resolve_memo.cap) {
+        size_t nc = g_resolve_memo.cap ? g_resolve_memo.cap * 2 : 32;
+        EmpResolveMemo *p = (EmpResolveMemo *)realloc(g_resolve_memo.items, nc * sizeof(EmpResolveMemo));
+        if (!p) {
+            free(key);
+            return &empty;
+        }
+        g_resolve_memo.items = p;
+        g_resolve_memo.cap = nc;
+    }
+    EmpResolveMemo *m = &g_resolve_memo.items[g_resolve_memo.len++];
+    memset(m, 0, sizeof(*m));
+    m->key = key;
+    for (size_t i = 0; i < bases_len; i++) {
+        if (want_dir) resolve_add_dir_candidates(&m->abs, &m->desc, &bases[i], rel);
+        else resolve_add_file_candidates(&m->abs, &m->desc, &bases[i], rel);
+    }
+    return m;
+}
+
 static char *resolve_use_module_file(
     EmpArena *arena,
     EmpDiags *diags,
@@ -951,23 +1453,17 @@ static char *resolve_use_module_file(
         return NULL;
     }
 
-    StrVec cands_abs;
-    StrVec cands_desc;
-    memset(&cands_abs, 0, sizeof(cands_abs));
-    memset(&cands_desc, 0, sizeof(cands_desc));
-
-    for (size_t i = 0; i < bases_len; i++) {
-        resolve_add_file_candidates(&cands_abs, &cands_desc, &bases[i], rel);
-    }
-
+    const EmpResolveMemo *memo = resolve_candidates(bases, bases_len, rel, false);
     free(rel);
+    const StrVec *cands_abs = &memo->abs;
+    const StrVec *cands_desc = &memo->desc;
 
     // Bundled stdlib is a lowest-precedence fallback: if we found any non-bundled
     // candidates, ignore bundled ones.
     size_t nonbundled_count = 0;
     size_t nonbundled_idx = 0;
-    for (size_t i = 0; i < cands_abs.len; i++) {
-        const char *p = cands_abs.items[i];
+    for (size_t i = 0; i < cands_abs->len; i++) {
+        const char *p = cands_abs->items[i];
         if (!p) continue;
         bool is_bundled = bundled_emp_mods_abs && path_starts_with_ci_sep(p, bundled_emp_mods_abs);
         if (!is_bundled) {
@@ -977,14 +1473,11 @@ static char *resolve_use_module_file(
     }
 
     if (nonbundled_count == 1) {
-        char *out = xstrdup(cands_abs.items[nonbundled_idx]);
-        strvec_free(&cands_abs);
-        strvec_free(&cands_desc);
-        return out;
+        return xstrdup(cands_abs->items[nonbundled_idx]);
     }
 
-    if (nonbundled_count == 0 && cands_abs.len == 1) {
-        char *out = xstrdup(cands_abs.items[0]);
+    if (nonbundled_count == 0 && cands_abs->len == 1) {
+        char *out = xstrdup(cands_abs->items[0]);
         if (out && bundled_emp_mods_abs && project_emp_mods_abs && path_starts_with_ci_sep(out, bundled_emp_mods_abs)) {
             char *vend = vendor_bundled_module_to_project(out, bundled_emp_mods_abs, project_emp_mods_abs);
             if (vend) {
@@ -992,15 +1485,13 @@ static char *resolve_use_module_file(
                 out = vend;
             }
         }
-        strvec_free(&cands_abs);
-        strvec_free(&cands_desc);
         return out;
     }
 
     if (out_had_diag) *out_had_diag = true;
 
     if (emit_diags) {
-        if (cands_abs.len == 0) {
+        if (cands_abs->len == 0) {
             diagf_tmp(arena, diags, span, "module: ",
                       "failed to resolve module '%.*s' (searched: module_dir, entry_dir, emp_mods, entry_root, bundled)",
                       (int)module_path.len,
@@ -1013,16 +1504,16 @@ static char *resolve_use_module_file(
                                     "ambiguous module '%.*s' (candidates: ",
                                     (int)module_path.len,
                                     module_path.ptr ? module_path.ptr : "");
-            for (size_t i = 0; i < cands_desc.len; i++) {
-                if (!cands_desc.items[i]) continue;
+            for (size_t i = 0; i < cands_desc->len; i++) {
+                if (!cands_desc->items[i]) continue;
                 if (nonbundled_count > 0) {
-                    const char *p = cands_abs.items[i];
+                    const char *p = cands_abs->items[i];
                     bool is_bundled = bundled_emp_mods_abs && p && path_starts_with_ci_sep(p, bundled_emp_mods_abs);
                     if (is_bundled) continue;
                 }
                 if (pos + 4 >= sizeof(buf)) break;
                 if (printed) pos += (size_t)snprintf(buf + pos, sizeof(buf) - pos, "; ");
-                pos += (size_t)snprintf(buf + pos, sizeof(buf) - pos, "%s", cands_desc.items[i]);
+                pos += (size_t)snprintf(buf + pos, sizeof(buf) - pos, "%s", cands_desc->items[i]);
                 printed++;
             }
             (void)snprintf(buf + pos, sizeof(buf) - pos, ")");
@@ -1030,8 +1521,6 @@ static char *resolve_use_module_file(
         }
     }
 
-    strvec_free(&cands_abs);
-    strvec_free(&cands_desc);
     return NULL;
 }
 
@@ -1051,21 +1540,15 @@ static char *resolve_use_package_dir(
     char *rel = module_slice_to_rel_path(module_path);
     if (!rel) return NULL;
 
-    StrVec cands_abs;
-    StrVec cands_desc;
-    memset(&cands_abs, 0, sizeof(cands_abs));
-    memset(&cands_desc, 0, sizeof(cands_desc));
-
-    for (size_t i = 0; i < bases_len; i++) {
-        resolve_add_dir_candidates(&cands_abs, &cands_desc, &bases[i], rel);
-    }
-
+    const EmpResolveMemo *memo = resolve_candidates(bases, bases_len, rel, true);
     free(rel);
+    const StrVec *cands_abs = &memo->abs;
+    const StrVec *cands_desc = &memo->desc;
 
     size_t nonbundled_count = 0;
     size_t nonbundled_idx = 0;
-    for (size_t i = 0; i < cands_abs.len; i++) {
-        const char *p = cands_abs.items[i];
+    for (size_t i = 0; i < cands_abs->len; i++) {
+        const char *p = cands_abs->items[i];
         if (!p) continue;
         bool is_bundled = bundled_emp_mods_abs && path_starts_with_ci_sep(p, bundled_emp_mods_abs);
         if (!is_bundled) {
@@ -1075,14 +1558,11 @@ static char *resolve_use_package_dir(
     }
 
     if (nonbundled_count == 1) {
-        char *out = xstrdup(cands_abs.items[nonbundled_idx]);
-        strvec_free(&cands_abs);
-        strvec_free(&cands_desc);
-        return out;
+        return xstrdup(cands_abs->items[nonbundled_idx]);
     }
 
-    if (nonbundled_count == 0 && cands_abs.len == 1) {
-        char *out = xstrdup(cands_abs.items[0]);
+    if (nonbundled_count == 0 && cands_abs->len == 1) {
+        char *out = xstrdup(cands_abs->items[0]);
         if (out && bundled_emp_mods_abs && project_emp_mods_abs && path_starts_with_ci_sep(out, bundled_emp_mods_abs)) {
             char *vend = vendor_bundled_package_dir_to_project(out, bundled_emp_mods_abs, project_emp_mods_abs);
             if (vend) {
@@ -1090,14 +1570,12 @@ static char *resolve_use_package_dir(
                 out = vend;
             }
         }
-        strvec_free(&cands_abs);
-        strvec_free(&cands_desc);
         return out;
     }
 
-    if (cands_abs.len > 1 && out_had_diag) *out_had_diag = true;
+    if (cands_abs->len > 1 && out_had_diag) *out_had_diag = true;
 
-    if (emit_diags && cands_abs.len > 1) {
+    if (emit_diags && cands_abs->len > 1) {
         char buf[4096];
         size_t pos = 0;
         size_t printed = 0;
@@ -1105,24 +1583,22 @@ static char *resolve_use_package_dir(
                                 "ambiguous package '%.*s' (directories: ",
                                 (int)module_path.len,
                                 module_path.ptr ? module_path.ptr : "");
-        for (size_t i = 0; i < cands_desc.len; i++) {
-            if (!cands_desc.items[i]) continue;
+        for (size_t i = 0; i < cands_desc->len; i++) {
+            if (!cands_desc->items[i]) continue;
             if (nonbundled_count > 0) {
-                const char *p = cands_abs.items[i];
+                const char *p = cands_abs->items[i];
                 bool is_bundled = bundled_emp_mods_abs && p && path_starts_with_ci_sep(p, bundled_emp_mods_abs);
                 if (is_bundled) continue;
             }
             if (pos + 4 >= sizeof(buf)) break;
             if (printed) pos += (size_t)snprintf(buf + pos, sizeof(buf) - pos, "; ");
-            pos += (size_t)snprintf(buf + pos, sizeof(buf) - pos, "%s", cands_desc.items[i]);
+            pos += (size_t)snprintf(buf + pos, sizeof(buf) - pos, "%s", cands_desc->items[i]);
             printed++;
         }
         (void)snprintf(buf + pos, sizeof(buf) - pos, ")");
         diagf_owned(arena, diags, span, "module: ", buf);
     }
 
-    strvec_free(&cands_abs);
-    strvec_free(&cands_desc);
     return NULL;
 }
 
@@ -1133,7 +1609,7 @@ static bool name_in_list(EmpSlice name, const EmpSlice *names, size_t names_len)
     return false;
 }
 
-static EmpItem *arena_make_fn_decl(EmpArena *a, const EmpItemFn *src_fn) {
+static EmpItem *arena_make_fn_decl(EmpArena *a, const EmpItemFn *src_fn, const EmpProgram *src_program, bool auto_generic) {
     EmpItem *it = (EmpItem *)emp_arena_alloc(a, sizeof(EmpItem), sizeof(void *));
     if (!it) return NULL;
     memset(it, 0, sizeof(*it));
@@ -1145,11 +1621,23 @@ static EmpItem *arena_make_fn_decl(EmpArena *a, const EmpItemFn *src_fn) {
     it->as.fn.is_extern = src_fn->is_extern;
     it->as.fn.is_unsafe = src_fn->is_unsafe;
     it->as.fn.is_mm_only = src_fn->is_mm_only;
+    it->as.fn.is_const = src_fn->is_const;
+    // A `const fn` may run in the importer at compile time, in the scope of its own module.
+    if (src_fn->is_const) {
+        it->as.fn.const_origin = src_fn->const_origin ? src_fn->const_origin : src_fn;
+        it->as.fn.const_origin_program = src_fn->const_origin ? src_fn->const_origin_program : src_program;
+    }
     // Preserve the signature for decls (used by typechecking and tooling).
     it->as.fn.ret_ty = src_fn->ret_ty;
     it->as.fn.body = NULL;
     emp_vec_init(&it->as.fn.params);
 
+    // Generic templates (including fns generic over `auto` parameters) are instantiated by the
+    // importer, so they keep their body (shared, never modified: instantiation clones it).
+    emp_vec_init(&it->as.fn.type_params);
+    for (size_t i = 0; i < src_fn->type_params.len; i++) (void)emp_vec_push(&it->as.fn.type_params, src_fn->type_params.items[i]);
+    if (src_fn->type_params.len || auto_generic) it->as.fn.body = src_fn->body;
+
     for (size_t i = 0; i < src_fn->params.len; i++) {
         void *p = src_fn->params.items[i];
         if (!p) continue;
@@ -1234,7 +1722,7 @@ static EmpItem *arena_make_trait_decl(EmpArena *a, const EmpItemTrait *src_tr) {
     return it;
 }
 
-static EmpItem *arena_make_const_decl(EmpArena *a, const EmpItemConst *src_c) {
+static EmpItem *arena_make_const_decl(EmpArena *a, const EmpItemConst *src_c, const EmpProgram *src_program) {
     EmpItem *it = (EmpItem *)emp_arena_alloc(a, sizeof(EmpItem), sizeof(void *));
     if (!it) return NULL;
     memset(it, 0, sizeof(*it));
@@ -1244,8 +1732,11 @@ static EmpItem *arena_make_const_decl(EmpArena *a, const EmpItemConst *src_c) {
     it->as.const_decl.span = src_c->span;
     it->as.const_decl.is_exported = false;
     it->as.const_decl.ty = src_c->ty;
-    // Leave initializer empty for decl.
+    // Leave initializer empty for decl; the importer evaluates the definition when it needs the
+    // value (array sizes, const initializers).
     it->as.const_decl.init = NULL;
+    it->as.const_decl.origin = src_c->origin ? src_c->origin : src_c;
+    it->as.const_decl.origin_program = src_c->origin ? src_c->origin_program : src_program;
     return it;
 }
 
@@ -1274,6 +1765,36 @@ static bool item_is_exported(const EmpItem *it) {
     return false;
 }
 
+static bool item_is_generic_template(const EmpItem *it) {
+    if (!it) return false;
+    if (it->kind == EMP_ITEM_FN) return it->as.fn.type_params.len != 0;
+    if (it->kind == EMP_ITEM_STRUCT) return it->as.struct_decl.type_params.len != 0;
+    if (it->kind == EMP_ITEM_IMPL) return it->as.impl_decl.type_params.len != 0;
+    return false;
+}
+
+static bool item_is_generic_instance(const EmpItem *it) {
+    if (!it) return false;
+    if (it->kind == EMP_ITEM_FN) return it->as.fn.is_instance;
+    if (it->kind == EMP_ITEM_STRUCT) return it->as.struct_decl.is_instance;
+    if (it->kind == EMP_ITEM_IMPL) return it->as.impl_decl.is_instance;
+    return false;
+}
+
+// Fn/struct instances are named after their template and type arguments, so equal names mean
+// equal code. Impl instances share their struct's name and only match themselves.
+static bool program_has_instance(const EmpProgram *p, const EmpItem *inst) {
+    EmpSlice name = item_decl_name(inst);
+    for (size_t i = 0; i < p->items.len; i++) {
+        const EmpItem *it = (const EmpItem *)p->items.items[i];
+        if (it == inst) return true;
+        if (!it || inst->kind == EMP_ITEM_IMPL || it->kind != inst->kind || !item_is_generic_instance(it)) continue;
+        EmpSlice other = item_decl_name(it);
+        if (other.len == name.len && memcmp(other.ptr, name.ptr, name.len) == 0) return true;
+    }
+    return false;
+}
+
 static EmpItem *arena_make_struct_decl(EmpArena *a, const EmpItemStruct *src_st) {
     EmpItem *it = (EmpItem *)emp_arena_alloc(a, sizeof(EmpItem), sizeof(void *));
     if (!it) return NULL;
@@ -1283,6 +1804,12 @@ static EmpItem *arena_make_struct_decl(EmpArena *a, const EmpItemStruct *src_st)
     it->as.struct_decl.name = src_st->name;
     it->as.struct_decl.span = src_st->span;
     it->as.struct_decl.is_exported = false;
+    it->as.struct_decl.attr_align = src_st->attr_align;
+    it->as.struct_decl.is_packed = src_st->is_packed;
+    it->as.struct_decl.is_cacheline = src_st->is_cacheline;
+    it->as.struct_decl.is_soa = src_st->is_soa;
+    emp_vec_init(&it->as.struct_decl.type_params);
+    for (size_t i = 0; i < src_st->type_params.len; i++) (void)emp_vec_push(&it->as.struct_decl.type_params, src_st->type_params.items[i]);
     emp_vec_init(&it->as.struct_decl.fields);
     for (size_t i = 0; i < src_st->fields.len; i++) {
         void *f = src_st->fields.items[i];
@@ -1310,17 +1837,33 @@ static EmpItem *arena_make_enum_decl(EmpArena *a, const EmpItemEnum *src_en) {
     return it;
 }
 
-static EmpItem *arena_make_import_decl(EmpArena *a, const EmpItem *src_item) {
+static EmpItem *arena_make_import_decl(EmpArena *a, const EmpItem *src_item, const EmpProgram *src_program) {
     if (!src_item) return NULL;
-    if (src_item->kind == EMP_ITEM_FN) return arena_make_fn_decl(a, &src_item->as.fn);
+    if (src_item->kind == EMP_ITEM_FN && src_item->as.fn.is_instance) return NULL;
+    if (src_item->kind == EMP_ITEM_STRUCT && src_item->as.struct_decl.is_instance) return NULL;
+    if (src_item->kind == EMP_ITEM_FN) return arena_make_fn_decl(a, &src_item->as.fn, src_program, emp_sem_fn_is_auto_generic(src_program, &src_item->as.fn));
     if (src_item->kind == EMP_ITEM_CLASS) return arena_make_class_decl(a, &src_item->as.class_decl);
     if (src_item->kind == EMP_ITEM_TRAIT) return arena_make_trait_decl(a, &src_item->as.trait_decl);
-    if (src_item->kind == EMP_ITEM_CONST) return arena_make_const_decl(a, &src_item->as.const_decl);
+    if (src_item->kind == EMP_ITEM_CONST) return arena_make_const_decl(a, &src_item->as.const_decl, src_program);
     if (src_item->kind == EMP_ITEM_STRUCT) return arena_make_struct_decl(a, &src_item->as.struct_decl);
     if (src_item->kind == EMP_ITEM_ENUM) return arena_make_enum_decl(a, &src_item->as.enum_decl);
     return NULL;
 }
 
+// Importing a generic struct also brings the generic impls of its module, so the importer can
+// instantiate its methods.
+static void view_add_generic_impls(EmpVec *out, const EmpProgram *src, const EmpItem *sym) {
+    if (!sym || sym->kind != EMP_ITEM_STRUCT || !sym->as.struct_decl.type_params.len) return;
+    for (size_t i = 0; i < src->items.len; i++) {
+        EmpItem *it = (EmpItem *)src->items.items[i];
+        if (!it || it->kind != EMP_ITEM_IMPL || !it->as.impl_decl.type_params.len) continue;
+        EmpSlice t = it->as.impl_decl.target_name;
+        if (t.len == sym->as.struct_decl.name.len && memcmp(t.ptr, sym->as.struct_decl.name.ptr, t.len) == 0) {
+            (void)emp_vec_push(out, it);
+        }
+    }
+}
+
 static EmpSlice slice_from_cstr_in_arena(EmpArena *a, const char *s) {
     EmpSlice out;
     out.ptr = NULL;
@@ -1335,7 +1878,61 @@ static EmpSlice slice_from_cstr_in_arena(EmpArena *a, const char *s) {
     return out;
 }
 
-static void build_module_view_and_run(
+// Records that `m` imports generic template `sym` from `target`: checking its instances in `m`
+// needs the names visible in `target`.
+static void module_note_template_src(EmpModule *m, EmpModule *target, const EmpItem *sym) {
+    bool tmpl = item_is_generic_template(sym) || (sym->kind == EMP_ITEM_FN && emp_sem_fn_is_auto_generic(target->pr.program, &sym->as.fn));
+    if (!tmpl || target == m) return;
+    for (size_t i = 0; i < m->tmpl_srcs.len; i++) {
+        if (m->tmpl_srcs.items[i] == target) return;
+    }
+    (void)emp_vec_push(&m->tmpl_srcs, target);
+}
+
+static bool view_declares(const EmpProgram *view, size_t upto, EmpSlice name) {
+    for (size_t i = 0; i < upto; i++) {
+        const EmpItem *it = (const EmpItem *)view->items.items[i];
+        if (!it || it->kind == EMP_ITEM_IMPL || it->kind == EMP_ITEM_USE) continue;
+        EmpSlice nm = item_decl_name(it);
+        if (nm.len == name.len && nm.len && memcmp(nm.ptr, name.ptr, nm.len) == 0) return true;
+    }
+    return false;
+}
+
+// Adds what the bodies of imported templates can see in their own module (its items and its
+// imports, transitively through the templates it imports) without shadowing anything `view`
+// already declares.
+static void view_add_template_scope(EmpProgram *view, EmpArena *a, const EmpModule *m, EmpVec *visited) {
+    for (size_t si = 0; si < m->tmpl_srcs.len; si++) {
+        EmpModule *t = (EmpModule *)m->tmpl_srcs.items[si];
+        bool seen_before = false;
+        for (size_t vi = 0; vi < visited->len; vi++) seen_before = seen_before || visited->items[vi] == t;
+        if (seen_before || !t->pr.program) continue;
+        (void)emp_vec_push(visited, t);
+
+        // Overloads from `t` all come in; only names declared before it are kept as they are.
+        size_t upto = view->items.len;
+        for (size_t i = 0; i < t->pr.program->items.len; i++) {
+            EmpItem *it = (EmpItem *)t->pr.program->items.items[i];
+            if (!it || it->kind == EMP_ITEM_IMPL || it->kind == EMP_ITEM_USE || view_declares(view, upto, item_decl_name(it))) continue;
+            EmpItem *decl = arena_make_import_decl(a, it, t->pr.program);
+            if (!decl) continue;
+            (void)emp_vec_push(&view->items, decl);
+            view_add_generic_impls(&view->items, t->pr.program, it);
+        }
+        for (size_t i = 0; i < t->scope.len; i++) {
+            EmpItem *it = (EmpItem *)t->scope.items[i];
+            if (!it) continue;
+            if (it->kind != EMP_ITEM_IMPL && view_declares(view, upto, item_decl_name(it))) continue;
+            (void)emp_vec_push(&view->items, it);
+        }
+        view_add_template_scope(view, a, t, visited);
+    }
+}
+
+// Resolves the `use` items of `m` into import decls (`m->scope`). Runs for every module before
+// any module is checked, so imported templates can be given their module's scope.
+static void build_module_scope(
     EmpModules *mods,
     EmpModule *m,
     const char *entry_dir_abs,
@@ -1351,9 +1948,6 @@ static void build_module_view_and_run(
         fflush(stderr);
     }
 
-    EmpProgram view;
-    emp_vec_init(&view.items);
-
     const char *entry_emp_mods_abs = project_emp_mods_abs;
 
     // Deterministic module resolution bases.
@@ -1370,7 +1964,7 @@ static void build_module_view_and_run(
     memset(bases2, 0, sizeof(bases2));
     memcpy(bases2, bases, bases_len * sizeof(EmpResolveBase));
     size_t bases2_len = bases_len;
-    if (bundled_emp_mods_abs && dir_exists(bundled_emp_mods_abs) && !bases_contains(bases2, bases2_len, bundled_emp_mods_abs)) {
+    if (bundled_emp_mods_abs && fs_probe(bundled_emp_mods_abs) == EMP_FS_DIR && !bases_contains(bases2, bases2_len, bundled_emp_mods_abs)) {
         bases2[bases2_len++] = (EmpResolveBase){"bundled", bundled_emp_mods_abs};
     }
 
@@ -1379,14 +1973,11 @@ static void build_module_view_and_run(
     size_t seen_len = 0;
     size_t seen_cap = 0;
 
-    // Add local items first.
-    //
-    // The semantic pipeline (typecheck/ownership/borrows/drops/codegen) needs to see local `impl` blocks.
-    // Only top-level declarations participate in the name-conflict tracking for imports.
+    // Local items first: only top-level declarations participate in the name-conflict
+    // tracking for imports.
     for (size_t i = 0; i < m->pr.program->items.len; i++) {
         EmpItem *it = (EmpItem *)m->pr.program->items.items[i];
         if (!it) continue;
-        (void)emp_vec_push(&view.items, it);
 
         if (it->kind != EMP_ITEM_FN && it->kind != EMP_ITEM_CLASS && it->kind != EMP_ITEM_TRAIT && it->kind != EMP_ITEM_CONST && it->kind != EMP_ITEM_STRUCT && it->kind != EMP_ITEM_ENUM) continue;
 
@@ -1454,9 +2045,11 @@ static void build_module_view_and_run(
                         diagf_owned(&m->pr.arena, &m->pr.diags, it->span, "import: ", "name conflict for package wildcard import");
                         continue;
                     }
-                    EmpItem *decl = arena_make_import_decl(&m->pr.arena, sym);
+                    EmpItem *decl = arena_make_import_decl(&m->pr.arena, sym, target->pr.program);
                     if (!decl) continue;
-                    (void)emp_vec_push(&view.items, decl);
+                    (void)emp_vec_push(&m->scope, decl);
+                    view_add_generic_impls(&m->scope, target->pr.program, sym);
+                    module_note_template_src(m, target, sym);
                     if (seen_len + 1 > seen_cap) {
                         size_t nc = seen_cap ? seen_cap * 2 : 32;
                         EmpSlice *p = (EmpSlice *)realloc(seen, nc * sizeof(EmpSlice));
@@ -1500,9 +2093,11 @@ static void build_module_view_and_run(
                         continue;
                     }
 
-                    EmpItem *decl = arena_make_import_decl(&m->pr.arena, sym);
+                    EmpItem *decl = arena_make_import_decl(&m->pr.arena, sym, target->pr.program);
                     if (!decl) continue;
-                    (void)emp_vec_push(&view.items, decl);
+                    (void)emp_vec_push(&m->scope, decl);
+                    view_add_generic_impls(&m->scope, target->pr.program, sym);
+                    module_note_template_src(m, target, sym);
 
                     if (seen_len + 1 > seen_cap) {
                         size_t nc = seen_cap ? seen_cap * 2 : 32;
@@ -1535,7 +2130,7 @@ static void build_module_view_and_run(
                         diagf_owned(&m->pr.arena, &m->pr.diags, it->span, "import: ", "name conflict for imported symbol");
                         break;
                     }
-                    EmpItem *decl = arena_make_import_decl(&m->pr.arena, sym);
+                    EmpItem *decl = arena_make_import_decl(&m->pr.arena, sym, target->pr.program);
                     if (!decl) break;
                     if (want->alias.len) {
                         // Create a stable copy of the alias name in the module arena.
@@ -1553,7 +2148,9 @@ static void build_module_view_and_run(
                             free(tmp);
                         }
                     }
-                    (void)emp_vec_push(&view.items, decl);
+                    (void)emp_vec_push(&m->scope, decl);
+                    view_add_generic_impls(&m->scope, target->pr.program, sym);
+                    module_note_template_src(m, target, sym);
                     if (seen_len + 1 > seen_cap) {
                         size_t nc = seen_cap ? seen_cap * 2 : 32;
                         EmpSlice *p = (EmpSlice *)realloc(seen, nc * sizeof(EmpSlice));
@@ -1577,6 +2174,26 @@ static void build_module_view_and_run(
 
     free(seen);
     (void)entry_emp_mods_abs;
+}
+
+static void run_module_sems(EmpModule *m) {
+    if (!m || !m->pr.program) return;
+
+    const char *trace = getenv("EMP_TRACE");
+
+    // The semantic pipeline (typecheck/ownership/borrows/drops/codegen) needs to see local `impl` blocks.
+    EmpProgram view;
+    memset(&view, 0, sizeof(view));
+    emp_vec_init(&view.items);
+    for (size_t i = 0; i < m->pr.program->items.len; i++) {
+        EmpItem *it = (EmpItem *)m->pr.program->items.items[i];
+        if (it) (void)emp_vec_push(&view.items, it);
+    }
+    for (size_t i = 0; i < m->scope.len; i++) (void)emp_vec_push(&view.items, m->scope.items[i]);
+    EmpVec visited;
+    emp_vec_init(&visited);
+    view_add_template_scope(&view, &m->pr.arena, m, &visited);
+    emp_vec_free(&visited);
 
     // Run existing semantic pipeline in module context.
     if (trace && trace[0]) {
@@ -1586,6 +2203,11 @@ static void build_module_view_and_run(
 
     emp_sem_lower_defer(&m->pr.arena, &view, &m->pr.diags);
     emp_sem_typecheck(&m->pr.arena, &view, &m->pr.diags);
+    if (trace && trace[0]) {
+        fprintf(stderr, "[trace]  sem: consteval\n");
+        fflush(stderr);
+    }
+    emp_sem_eval_consts(&m->pr.arena, &view, &m->pr.diags);
     if (trace && trace[0]) {
         fprintf(stderr, "[trace]  sem: ownership\n");
         fflush(stderr);
@@ -1606,7 +2228,14 @@ static void build_module_view_and_run(
         fflush(stderr);
     }
 
+    // Generic instances were created in the view; keep them with the module for codegen.
+    for (size_t i = 0; i < view.items.len; i++) {
+        EmpItem *it = (EmpItem *)view.items.items[i];
+        if (item_is_generic_instance(it) && !program_has_instance(m->pr.program, it)) (void)emp_vec_push(&m->pr.program->items, it);
+    }
+
     emp_vec_free(&view.items);
+    emp_vec_free(&view.generics);
 }
 
 static int ends_with(const char *s, const char *suffix) {
@@ -1779,11 +2408,43 @@ typedef enum EmpMode {
     EMP_MODE_JSON,
     EMP_MODE_LEX,
     EMP_MODE_LL,
+    EMP_MODE_CHECK, // semantics only; print diagnostics
 } EmpMode;
 
+// What a native build (EMP_MODE_LL without --nobin) stops at.
+typedef enum EmpEmit {
+    EMP_EMIT_EXE,
+    EMP_EMIT_OBJ,
+    EMP_EMIT_ASM,
+} EmpEmit;
+
+// `--print-layouts` without a build: plan every module's structs together (field types may come
+// from other modules), keeping one copy of each generic instance.
+static void print_module_layouts(EmpModules *mods, bool reorder) {
+    EmpProgram all;
+    memset(&all, 0, sizeof(all));
+    emp_vec_init(&all.items);
+    for (size_t mi = 0; mi < mods->len; mi++) {
+        const EmpProgram *p = mods->items[mi].pr.program;
+        for (size_t i = 0; p && i < p->items.len; i++) {
+            EmpItem *it = (EmpItem *)p->items.items[i];
+            if (!it || item_is_generic_template(it)) continue;
+            if (item_is_generic_instance(it) && program_has_instance(&all, it)) continue;
+            (void)emp_vec_push(&all.items, it);
+        }
+    }
+    emp_sem_plan_layouts(&all, reorder, NULL);
+    emp_layout_print(stderr, &all);
+    emp_vec_free(&all.items);
+}
+
 static void print_usage(const char *exe) {
     fprintf(stderr,
-            "Usage: %s [--ast|--json|--lex|--ll] [--out file] [--nobin] [file.em]\n"
+            "Usage: %s [--ast|--json|--lex|--ll] [--emit=exe|obj|asm] [--out file] [--nobin] [--stats] [--len64] [--drop-flags] [--print-layouts] [--reorder-fields] [file.em]\n"
+            "       %s check file.em        Type/ownership/borrow check only; print diagnostics\n"
+            "       %s run file.em [args]   Build and run the program\n"
+            "       %s serve [--socket path] [--stop]  Start/stop a compile server (POSIX)\n"
+            "       %s new <project-name>\n"
             "\n"
             "  (default) With a file input, EMP builds a .exe via LLVM\n"
             "\n"
@@ -1792,12 +2453,19 @@ static void print_usage(const char *exe) {
             "  --lex   Only run the lexer token dump\n"
             "  --ll    Emit LLVM IR (requires LLVM build; implies --nobin unless you set --out to .ll)\n"
             "  --nobin Do not produce a .exe; emit LLVM IR instead\n"
+            "  --emit=obj|asm  Stop after llc: write an object file (link it with out/emp_rt.o) / assembly instead of linking\n"
             "  --out   Output path: .exe by default; .ll when using --nobin\n"
+            "  --stats Print optimization statistics (e.g. eliminated items) to stderr\n"
+            "  --len64 64-bit list/string lengths (ABI v2): len()/cap() return usize\n"
+            "  --drop-flags Accept values moved on only some paths; they are dropped through a drop flag\n"
+            "  --print-layouts  Print size, alignment, field offsets and holes of every struct, and enum tags, to stderr\n"
+            "  --reorder-fields Reorder fields of structs C cannot see to minimize padding\n"
             "\n"
             "Notes:\n"
             "  - EMP source files use the .em extension\n"
-            "  - If you pass a path with no extension, .em is appended\n",
-            exe);
+            "  - If you pass a path with no extension, .em is appended\n"
+            "  - When a compile server is running, commands are forwarded to it (set EMP_NO_DAEMON=1 to opt out)\n",
+            exe, exe, exe, exe, exe);
 }
 
 static void print_diags(const EmpDiags *d) {
@@ -1813,7 +2481,7 @@ static void print_diags(const EmpDiags *d) {
     }
 }
 
-int main(int argc, char **argv) {
+static int emp_driver_main(int argc, char **argv) {
     const char *dump_args = getenv("EMP_DUMP_ARGS");
     if (dump_args && dump_args[0]) {
         fprintf(stderr, "[args] argc=%d\n", argc);
@@ -1838,9 +2506,32 @@ int main(int argc, char **argv) {
     EmpMode mode = EMP_MODE_AST;
     bool mode_explicit = false;
     bool nobin = false;
-
-    for (int i = 1; i < argc; i++) {
+    bool stats = false;
+    bool print_layouts = false;
+    bool reorder_fields = false;
+    EmpEmit emit = EMP_EMIT_EXE;
+    bool run_exe = false;
+    int run_argc = 0;
+    char **run_argv = NULL;
+
+    int first_arg = 1;
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        mode = EMP_MODE_CHECK;
+        mode_explicit = true;
+        first_arg = 2;
+    } else if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        run_exe = true;
+        first_arg = 2;
+    }
+
+    for (int i = first_arg; i < argc; i++) {
         const char *a = argv[i];
+        if (run_exe && path) {
+            // `emp run file.em a b c`: everything after the source file goes to the program.
+            run_argc = argc - i;
+            run_argv = &argv[i];
+            break;
+        }
         if (strcmp(a, "--ast") == 0) {
             mode = EMP_MODE_AST;
             mode_explicit = true;
@@ -1856,6 +2547,27 @@ int main(int argc, char **argv) {
             nobin = true;
         } else if (strcmp(a, "--nobin") == 0) {
             nobin = true;
+        } else if (strcmp(a, "--stats") == 0) {
+            stats = true;
+        } else if (strcmp(a, "--len64") == 0) {
+            emp_set_len_abi(EMP_LEN_ABI_64);
+        } else if (strcmp(a, "--drop-flags") == 0) {
+            emp_set_drop_flags(true);
+        } else if (strcmp(a, "--print-layouts") == 0) {
+            print_layouts = true;
+        } else if (strcmp(a, "--reorder-fields") == 0) {
+            reorder_fields = true;
+        } else if (strncmp(a, "--emit=", 7) == 0) {
+            const char *v = a + 7;
+            if (strcmp(v, "exe") == 0) emit = EMP_EMIT_EXE;
+            else if (strcmp(v, "obj") == 0) emit = EMP_EMIT_OBJ;
+            else if (strcmp(v, "asm") == 0) emit = EMP_EMIT_ASM;
+            else if (strcmp(v, "ll") == 0) nobin = true;
+            else {
+                fprintf(stderr, "Unknown --emit kind: %s (expected exe, obj, asm or ll)\n", v);
+                print_usage(argv[0]);
+                return 2;
+            }
         } else if (strcmp(a, "--out") == 0 || strcmp(a, "-o") == 0) {
             if (i + 1 >= argc) {
                 fprintf(stderr, "Missing value for --out\n");
@@ -1875,6 +2587,17 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (run_exe) {
+        if (!path) {
+            fprintf(stderr, "Usage: %s run file.em [args...]\n", argv[0]);
+            return 2;
+        }
+        mode = EMP_MODE_LL;
+        mode_explicit = true;
+        nobin = false;
+        emit = EMP_EMIT_EXE;
+    }
+
     // Default behavior: if the user passed a file and didn't explicitly choose a mode,
     // compile to a native executable via LLVM.
     if (path && !mode_explicit) {
@@ -1954,8 +2677,10 @@ int main(int argc, char **argv) {
         // Semantics (phase -1): lower `defer { ... }` to explicit scope-exit statements.
         emp_sem_lower_defer(&r.arena, r.program, &r.diags);
 
-        // Semantics (phase 0): type checking / minimal inference.
+        // Semantics (phase 0): type checking / minimal inference, then compile-time evaluation.
+        emp_sem_resolve_const_sizes(&r.arena, r.program, NULL, &r.diags);
         emp_sem_typecheck(&r.arena, r.program, &r.diags);
+        emp_sem_eval_consts(&r.arena, r.program, &r.diags);
 
         // Semantics (phase 1): ownership-only checking (no borrow checking yet).
         emp_sem_check_ownership(&r.arena, r.program, &r.diags);
@@ -1966,6 +2691,21 @@ int main(int argc, char **argv) {
         // Semantics (phase 3): drop insertion (explicit drops at scope ends / returns).
         emp_sem_insert_drops(&r.arena, r.program, &r.diags);
 
+        // Aliasing facts for codegen; only valid for programs that passed the checks above.
+        if (r.diags.len == 0) {
+            emp_sem_infer_alias_facts(r.program, NULL);
+            emp_sem_devirtualize(r.program, NULL);
+            emp_sem_eliminate_bounds_checks(r.program, NULL);
+            emp_sem_plan_fstrings(r.program, NULL);
+            emp_sem_plan_strings(r.program, NULL);
+            emp_sem_promote_new_to_stack(r.program, NULL);
+            emp_sem_plan_layouts(r.program, reorder_fields, NULL);
+            emp_sem_plan_matches(r.program, NULL);
+            emp_sem_plan_coroutines(r.program, NULL);
+            emp_sem_plan_soa(r.program, NULL);
+            if (print_layouts) emp_layout_print(stderr, r.program);
+        }
+
         if (mode == EMP_MODE_LL) {
     #ifdef EMP_HAVE_LLVM
             bool ok = emp_codegen_emit_llvm_ir(&r.arena, r.program, &r.diags, "emp", out);
@@ -1979,6 +2719,8 @@ int main(int argc, char **argv) {
             // The JSON writer does many small writes; avoid CRT buffering issues by disabling buffering.
             setvbuf(out, NULL, _IONBF, 0);
             emp_program_to_json(out, r.program, &r.diags);
+        } else if (mode == EMP_MODE_CHECK) {
+            print_diags(&r.diags);
         } else {
             if (r.diags.len) {
                 fputs("Diagnostics:\n", stderr);
@@ -2011,7 +2753,7 @@ int main(int argc, char **argv) {
         // stdlib at ./stdlib/emp_mods over the copied snapshot next to emp.exe.
         // This keeps edits to stdlib modules immediately visible to the compiler.
         char *cwd_emp_mods = abs_path_dup("stdlib/emp_mods");
-        if (cwd_emp_mods && dir_exists(cwd_emp_mods)) {
+        if (cwd_emp_mods && fs_probe(cwd_emp_mods) == EMP_FS_DIR) {
             free(bundled_emp_mods);
             bundled_emp_mods = cwd_emp_mods;
         } else {
@@ -2060,7 +2802,7 @@ int main(int argc, char **argv) {
                     if (entry_dir && !bases_contains(bases, bases_len, entry_dir)) bases[bases_len++] = (EmpResolveBase){"entry_dir", entry_dir};
                     if (entry_emp_mods && !bases_contains(bases, bases_len, entry_emp_mods)) bases[bases_len++] = (EmpResolveBase){"emp_mods", entry_emp_mods};
                     if (entry_root && !bases_contains(bases, bases_len, entry_root)) bases[bases_len++] = (EmpResolveBase){"entry_root", entry_root};
-                    if (bundled_emp_mods && dir_exists(bundled_emp_mods) && !bases_contains(bases, bases_len, bundled_emp_mods)) bases[bases_len++] = (EmpResolveBase){"bundled", bundled_emp_mods};
+                    if (bundled_emp_mods && fs_probe(bundled_emp_mods) == EMP_FS_DIR && !bases_contains(bases, bases_len, bundled_emp_mods)) bases[bases_len++] = (EmpResolveBase){"bundled", bundled_emp_mods};
 
                     bool ambiguous_pkg = false;
                     char *pkg_dir_abs = resolve_use_package_dir(&m->pr.arena, &m->pr.diags, it->span, bases, bases_len, u->from_path, bundled_emp_mods, entry_emp_mods, false, &ambiguous_pkg);
@@ -2100,7 +2842,7 @@ int main(int argc, char **argv) {
                 if (entry_dir && !bases_contains(bases, bases_len, entry_dir)) bases[bases_len++] = (EmpResolveBase){"entry_dir", entry_dir};
                 if (entry_emp_mods && !bases_contains(bases, bases_len, entry_emp_mods)) bases[bases_len++] = (EmpResolveBase){"emp_mods", entry_emp_mods};
                 if (entry_root && !bases_contains(bases, bases_len, entry_root)) bases[bases_len++] = (EmpResolveBase){"entry_root", entry_root};
-                if (bundled_emp_mods && dir_exists(bundled_emp_mods) && !bases_contains(bases, bases_len, bundled_emp_mods)) bases[bases_len++] = (EmpResolveBase){"bundled", bundled_emp_mods};
+                if (bundled_emp_mods && fs_probe(bundled_emp_mods) == EMP_FS_DIR && !bases_contains(bases, bases_len, bundled_emp_mods)) bases[bases_len++] = (EmpResolveBase){"bundled", bundled_emp_mods};
 
                 char *target_abs = resolve_use_module_file(&m->pr.arena, &m->pr.diags, it->span, bases, bases_len, u->from_path, bundled_emp_mods, entry_emp_mods, false, NULL);
                 if (!target_abs) continue;
@@ -2133,9 +2875,38 @@ int main(int argc, char **argv) {
             return 1;
         }
 
+#ifndef _WIN32
+        if (g_serve_report_fd >= 0) {
+            // `m <module>` and `d <directory listed by this request>` lines for the server.
+            for (size_t mi = 0; mi < mods.len; mi++) {
+                char *mp = serve_cache_key(mods.items[mi].path_abs);
+                if (!mp) continue;
+                (void)!write(g_serve_report_fd, "m ", 2);
+                (void)!write(g_serve_report_fd, mp, strlen(mp));
+                (void)!write(g_serve_report_fd, "\n", 1);
+                free(mp);
+            }
+            for (size_t di = 0; di < g_dir_cache.len; di++) {
+                const EmpDirListing *l = &g_dir_cache.items[di];
+                if (!l->scanned) continue;
+                (void)!write(g_serve_report_fd, "d ", 2);
+                (void)!write(g_serve_report_fd, l->dir, strlen(l->dir));
+                (void)!write(g_serve_report_fd, "\n", 1);
+            }
+        }
+#endif
+
         // Run semantics in each module with imports in scope.
         for (size_t mi = 0; mi < mods.len; mi++) {
-            build_module_view_and_run(&mods, &mods.items[mi], entry_dir, entry_root, bundled_emp_mods, entry_emp_mods);
+            build_module_scope(&mods, &mods.items[mi], entry_dir, entry_root, bundled_emp_mods, entry_emp_mods);
+        }
+        // Array sizes naming a const first: import decls share their types with the definition.
+        for (size_t mi = 0; mi < mods.len; mi++) {
+            EmpModule *m = &mods.items[mi];
+            if (m->pr.program) emp_sem_resolve_const_sizes(&m->pr.arena, m->pr.program, &m->scope, &m->pr.diags);
+        }
+        for (size_t mi = 0; mi < mods.len; mi++) {
+            run_module_sems(&mods.items[mi]);
         }
 
         free(bundled_emp_mods);
@@ -2167,6 +2938,8 @@ int main(int argc, char **argv) {
             }
         }
 
+        if (print_layouts && mode != EMP_MODE_LL && merged.len == 0) print_module_layouts(&mods, reorder_fields);
+
         if (mode == EMP_MODE_LL) {
             if (merged.len) {
                 fputs("Diagnostics:\n", stderr);
@@ -2181,11 +2954,132 @@ int main(int argc, char **argv) {
                 for (size_t mi = 0; mi < mods.len; mi++) {
                     EmpModule *m = &mods.items[mi];
                     if (!m->pr.program) continue;
+                    // Modules instantiate generics independently; keep one copy of each instance.
+                    // A struct instance comes before its impls, so a duplicate struct drops them too.
+                    EmpVec dup_structs; // EmpItem*
+                    emp_vec_init(&dup_structs);
                     for (size_t ii = 0; ii < m->pr.program->items.len; ii++) {
-                        void *it = m->pr.program->items.items[ii];
-                        if (!it) continue;
+                        EmpItem *it = (EmpItem *)m->pr.program->items.items[ii];
+                        if (!it || item_is_generic_template(it)) continue;
+                        if (item_is_generic_instance(it)) {
+                            if (it->kind == EMP_ITEM_IMPL) {
+                                bool dup = false;
+                                for (size_t di = 0; di < dup_structs.len && !dup; di++) {
+                                    const EmpItem *st = (const EmpItem *)dup_structs.items[di];
+                                    EmpSlice a = st->as.struct_decl.name, b = it->as.impl_decl.target_name;
+                                    dup = a.len == b.len && memcmp(a.ptr, b.ptr, a.len) == 0;
+                                }
+                                if (dup) continue;
+                            } else if (program_has_instance(&merged_program, it)) {
+                                if (it->kind == EMP_ITEM_STRUCT) (void)emp_vec_push(&dup_structs, it);
+                                continue;
+                            }
+                        }
                         (void)emp_vec_push(&merged_program.items, it);
                     }
+                    emp_vec_free(&dup_structs);
+                }
+
+                // Drop items unreachable from `main` / exports / extern definitions and give the
+                // remaining non-exported functions internal linkage.
+                size_t dead_items = emp_sem_eliminate_dead_items(&merged_program, entry->pr.program);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] reach: eliminated %zu unreachable item(s), %zu kept\n", dead_items, merged_program.items.len);
+                }
+
+                // Parameter/call aliasing facts for codegen (noalias/readonly/nocapture).
+                EmpAliasStats alias_stats;
+                emp_sem_infer_alias_facts(&merged_program, &alias_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] alias: %zu noalias, %zu readonly, %zu nocapture param(s); %zu call(s) with disjoint args\n",
+                            alias_stats.noalias, alias_stats.readonly, alias_stats.nocapture, alias_stats.disjoint_calls);
+                }
+
+                // Direct (or guarded speculative) targets for `dyn Base` calls.
+                EmpDevirtStats devirt_stats;
+                emp_sem_devirtualize(&merged_program, &devirt_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] devirt: %zu of %zu dyn call(s) direct, %zu guarded\n",
+                            devirt_stats.direct, devirt_stats.dyn_calls, devirt_stats.guarded);
+                }
+
+                // Index checks proven redundant (or hoistable to a loop preheader).
+                EmpBoundsStats bounds_stats;
+                emp_sem_eliminate_bounds_checks(&merged_program, &bounds_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] bounds: %zu of %zu index check(s) removed, %zu hoisted to loop preheaders\n",
+                            bounds_stats.removed, bounds_stats.checks, bounds_stats.hoisted);
+                }
+
+                // f-string buffer sizes and the shared constant-piece pool.
+                EmpFStringStats fstr_stats;
+                emp_sem_plan_fstrings(&merged_program, &fstr_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] fstrings: %zu f-string(s), %zu formatted on the stack; %zu constant piece(s) in %zu global(s)\n",
+                            fstr_stats.fstrings, fstr_stats.on_stack, fstr_stats.pieces, fstr_stats.unique);
+                }
+
+                // Drops of strings known to be inline (small-string representation).
+                EmpStringStats str_stats;
+                emp_sem_plan_strings(&merged_program, &str_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] strings: %zu of %zu string drop(s) elided as inline\n",
+                            str_stats.elided, str_stats.drops);
+                }
+
+                // Class instances that never escape their function live on the stack.
+                EmpEscapeStats esc_stats;
+                emp_sem_promote_new_to_stack(&merged_program, &esc_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] escape: %zu of %zu new object(s) on the stack; %zu method(s) with nocapture self\n",
+                            esc_stats.on_stack, esc_stats.news, esc_stats.self_nocapture);
+                }
+
+                // Struct sizes/offsets for codegen; optionally reorder fields to shrink padding.
+                EmpLayoutStats layout_stats;
+                emp_sem_plan_layouts(&merged_program, reorder_fields, &layout_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] layout: %zu struct(s), %zu padding byte(s); %zu reordered, saving %zu byte(s)\n",
+                            layout_stats.structs, layout_stats.padding, layout_stats.reordered, layout_stats.bytes_saved);
+                    fprintf(stderr, "[stats] layout: %zu enum(s), %zu with a niche tag; %zu byte(s) smaller than u32 tags\n",
+                            layout_stats.enums, layout_stats.enums_niche, layout_stats.enum_bytes_saved);
+                }
+                if (print_layouts) emp_layout_print(stderr, &merged_program);
+
+                // `match` as `switch`/jump tables on values and enum tags.
+                EmpMatchStats match_stats;
+                emp_sem_plan_matches(&merged_program, &match_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] match: %zu jump table(s), %zu switch(es), %zu compare chain(s); %zu unreachable default(s), %zu dead arm(s)\n",
+                            match_stats.tables, match_stats.switches, match_stats.chains, match_stats.unreachable, match_stats.dead_arms);
+                }
+
+                // Generators and async fns as LLVM coroutines; frames that can live on the stack.
+                EmpCoroStats coro_stats;
+                emp_sem_plan_coroutines(&merged_program, &coro_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] coro: %zu generator(s), %zu async fn(s), %zu suspend point(s); %zu of %zu call(s) with an elided frame\n",
+                            coro_stats.generators, coro_stats.tasks, coro_stats.suspends, coro_stats.elided, coro_stats.calls);
+                }
+
+                // Column accesses for lists of @soa structs.
+                EmpSoaStats soa_stats;
+                emp_sem_plan_soa(&merged_program, &soa_stats);
+                if (stats || (trace && trace[0])) {
+                    fprintf(stderr, "[stats] soa: %zu column access(es), %zu element gather(s); %zu of %zu loop(s) assemble their value\n",
+                            soa_stats.columns, soa_stats.gathers, soa_stats.gathered, soa_stats.loops);
+                }
+                if (stats || (trace && trace[0])) {
+                    EmpConstStats const_stats;
+                    emp_sem_const_stats(&merged_program, &const_stats);
+                    fprintf(stderr, "[stats] consteval: %zu const(s), %zu byte(s) of constant data; %zu const fn call(s) folded\n",
+                            const_stats.consts, const_stats.bytes, const_stats.folded);
+                }
+                if (stats || (trace && trace[0])) {
+                    EmpDropStats drop_stats;
+                    emp_sem_drop_stats(&merged_program, &drop_stats);
+                    fprintf(stderr, "[stats] drops: %zu drop(s), %zu behind %zu drop flag(s); %zu exit(s) share %zu cleanup sequence(s)\n",
+                            drop_stats.drops, drop_stats.conditional, drop_stats.flags, drop_stats.exits, drop_stats.cleanups);
                 }
 
                 if (nobin) {
@@ -2207,43 +3101,76 @@ int main(int argc, char **argv) {
                     char *obj_path = NULL;
                     char *exe_path = NULL;
 
+                    char *asm_path = NULL;
+                    char *rt_ll_path = NULL;
+                    char *rt_obj_path = NULL;
 #ifdef _WIN32
-                    if (out_path) exe_path = xstrdup(out_path);
-                    else {
-                        char tmp[MAX_PATH];
-                        snprintf(tmp, sizeof(tmp), "out\\bin\\%s.exe", base ? base : "emp");
-                        exe_path = xstrdup(tmp);
-                    }
-                    {
-                        char tmp[MAX_PATH];
-                        snprintf(tmp, sizeof(tmp), "out\\%s.ll", base ? base : "emp");
-                        ll_path = xstrdup(tmp);
-                        snprintf(tmp, sizeof(tmp), "out\\%s.obj", base ? base : "emp");
-                        obj_path = xstrdup(tmp);
-                    }
+                    const char *sep = "\\";
+                    const char *exe_ext = ".exe";
+                    const char *obj_ext = ".obj";
 #else
-                    if (out_path) exe_path = xstrdup(out_path);
-                    else {
-                        char tmp[PATH_MAX];
-                        snprintf(tmp, sizeof(tmp), "out/bin/%s", base ? base : "emp");
-                        exe_path = xstrdup(tmp);
-                    }
+                    const char *sep = "/";
+                    const char *exe_ext = "";
+                    const char *obj_ext = ".o";
+#endif
                     {
-                        char tmp[PATH_MAX];
-                        snprintf(tmp, sizeof(tmp), "out/%s.ll", base ? base : "emp");
+                        const char *b = base ? base : "emp";
+                        char tmp[EMP_TOOL_PATH_MAX];
+                        snprintf(tmp, sizeof(tmp), "out%sbin%s%s%s", sep, sep, b, exe_ext);
+                        exe_path = xstrdup(emit == EMP_EMIT_EXE && out_path ? out_path : tmp);
+                        snprintf(tmp, sizeof(tmp), "out%s%s.ll", sep, b);
                         ll_path = xstrdup(tmp);
-                        snprintf(tmp, sizeof(tmp), "out/%s.o", base ? base : "emp");
-                        obj_path = xstrdup(tmp);
+                        snprintf(tmp, sizeof(tmp), "out%s%s%s", sep, b, obj_ext);
+                        obj_path = xstrdup(emit == EMP_EMIT_OBJ && out_path ? out_path : tmp);
+                        snprintf(tmp, sizeof(tmp), "out%s%s.s", sep, b);
+                        asm_path = xstrdup(emit == EMP_EMIT_ASM && out_path ? out_path : tmp);
+                        snprintf(tmp, sizeof(tmp), "out%semp_rt.ll", sep);
+                        rt_ll_path = xstrdup(tmp);
+                        snprintf(tmp, sizeof(tmp), "out%semp_rt%s", sep, obj_ext);
+                        rt_obj_path = xstrdup(tmp);
+                    }
+
+                    // Incremental cache: fingerprint every function/type of the merged program and
+                    // compare against the manifest written next to the previous object file. When
+                    // nothing changed, the object is reused and only the link step runs.
+                    char *fp_path = NULL;
+                    if (obj_path) {
+                        size_t n = strlen(obj_path) + 4;
+                        fp_path = (char *)malloc(n);
+                        if (fp_path) snprintf(fp_path, n, "%s.fp", obj_path);
                     }
+                    EmpFingerprints fp_prev;
+                    EmpFingerprints fp_cur;
+                    emp_fingerprints_init(&fp_prev);
+                    emp_fingerprints_init(&fp_cur);
+#ifdef _WIN32
+                    const char *target_base = "x86_64-pc-windows-msvc;llc-default;emp ";
+#else
+                    const char *target_base = "x86_64-pc-linux-gnu;pic;llc-default;emp ";
 #endif
+                    char target_key[160];
+                    snprintf(target_key, sizeof(target_key), "%s%s;%s", target_base, compiler_build_id(), emp_len_abi() == EMP_LEN_ABI_64 ? "len64" : "len32");
+                    bool have_fp = fp_path && emp_fingerprint_program(&merged_program, target_key, &fp_cur);
+                    bool have_prev = have_fp && emp_fingerprints_load(fp_path, &fp_prev);
+                    size_t fp_changed = emp_fingerprints_diff(have_prev ? &fp_prev : NULL, &fp_cur);
+                    bool reuse_obj = emit != EMP_EMIT_ASM && have_prev && fp_changed == 0 && file_exists(obj_path);
+                    if (stats || (trace && trace[0])) {
+                        fprintf(stderr, "[stats] cache: %zu of %zu symbol(s) changed%s\n", fp_changed, fp_cur.len, reuse_obj ? ", reusing object" : "");
+                    }
+                    // The manifest only describes a fully written object; drop it until llc succeeds.
+                    if (!reuse_obj && emit != EMP_EMIT_ASM && fp_path) (void)remove(fp_path);
 
                     FILE *irf = NULL;
+                    if (!reuse_obj) {
 #ifdef _WIN32
-                    if (ll_path) fopen_s(&irf, ll_path, "wb");
+                        if (ll_path) fopen_s(&irf, ll_path, "wb");
 #else
-                    if (ll_path) irf = fopen(ll_path, "wb");
+                        if (ll_path) irf = fopen(ll_path, "wb");
 #endif
-                    if (!irf) {
+                    }
+                    if (reuse_obj) {
+                        // Object is up to date.
+                    } else if (!irf) {
                         fprintf(stderr, "Failed to open IR temp file: %s\n", ll_path ? ll_path : "<null>");
                         exit_code = 1;
                     } else {
@@ -2259,84 +3186,158 @@ int main(int argc, char **argv) {
                     }
 
                     if (exit_code == 0) {
+                        const EmpToolchain *tc = toolchain_tools();
+                        if (!tc->tools_ok) {
 #ifdef _WIN32
-#ifndef EMP_LLVM_ROOT
-#define EMP_LLVM_ROOT "llvm-21.1.8-windows-amd64-msvc17-msvcrt"
+                            fprintf(stderr, "LLVM tools missing (llc.exe/lld-link.exe). Check EMP_LLVM_ROOT.\n");
+#else
+                            fprintf(stderr, "LLVM tools missing (llc and ld.lld/lld). Install llvm/lld on Ubuntu.\n");
 #endif
-                        char llc_exe[MAX_PATH];
-                        char lld_exe[MAX_PATH];
-                        snprintf(llc_exe, sizeof(llc_exe), "%s\\bin\\llc.exe", EMP_LLVM_ROOT);
-                        snprintf(lld_exe, sizeof(lld_exe), "%s\\bin\\lld-link.exe", EMP_LLVM_ROOT);
+                            exit_code = 1;
+                        }
+                    }
 
-                        if (!file_exists(llc_exe) || !file_exists(lld_exe)) {
-                            fprintf(stderr, "LLVM tools missing (llc.exe/lld-link.exe). Check EMP_LLVM_ROOT.\n");
+                    if (exit_code == 0) {
+                        const EmpToolchain *tc = toolchain_tools();
+                        const char *filetype = emit == EMP_EMIT_ASM ? "-filetype=asm" : "-filetype=obj";
+                        const char *llc_out = emit == EMP_EMIT_ASM ? asm_path : obj_path;
+#ifdef _WIN32
+                        const char *llc_args[] = {tc->llc, filetype, "-o", llc_out, ll_path, NULL};
+#else
+                        const char *llc_args[] = {tc->llc, filetype, "-relocation-model=pic", "-o", llc_out, ll_path, NULL};
+#endif
+                        // The runtime module (out-of-line list growth) is only rebuilt when its
+                        // IR text changes, i.e. after a compiler update. Objects reference it too,
+                        // so `--emit=obj` builds it for whoever links them.
+                        bool rt_stale = false;
+                        if (emit != EMP_EMIT_ASM) {
+                            const char *rt_ir = emp_runtime_ir(emp_len_abi());
+                            size_t have_len = 0;
+                            char *have = read_entire_file(rt_ll_path, &have_len);
+                            bool same = have && have_len == strlen(rt_ir) && memcmp(have, rt_ir, have_len) == 0;
+                            free(have);
+                            if (!same) (void)write_text_file(rt_ll_path, rt_ir);
+                            rt_stale = !same || !file_exists(rt_obj_path);
+                            if (rt_stale) (void)remove(rt_obj_path);
+                        }
+#ifdef _WIN32
+                        const char *rt_args[] = {tc->llc, "-filetype=obj", "-o", rt_obj_path, rt_ll_path, NULL};
+#else
+                        const char *rt_args[] = {tc->llc, "-filetype=obj", "-relocation-model=pic", "-o", rt_obj_path, rt_ll_path, NULL};
+#endif
+
+                        // Start llc and prepare the link (SDK/crt discovery) while it runs.
+                        EmpProc llc_proc;
+                        EmpProc rt_proc;
+                        memset(&llc_proc, 0, sizeof(llc_proc));
+                        memset(&rt_proc, 0, sizeof(rt_proc));
+                        bool llc_started = reuse_obj || spawn_start(tc->llc, llc_args, &llc_proc);
+                        bool rt_started = !rt_stale || spawn_start(tc->llc, rt_args, &rt_proc);
+                        if (emit == EMP_EMIT_EXE) (void)toolchain_link_inputs();
+                        intptr_t rc1 = !llc_started ? (intptr_t)(-2) : reuse_obj ? 0 : spawn_join(&llc_proc);
+                        intptr_t rc_rt = !rt_started ? (intptr_t)(-2) : rt_stale ? spawn_join(&rt_proc) : 0;
+                        if (rc1 != 0) {
+                            fprintf(stderr, "llc failed with code %lld\n", (long long)rc1);
                             exit_code = 1;
-                        } else {
-                            const char *llc_args[] = {llc_exe, "-filetype=obj", "-o", obj_path, ll_path, NULL};
-                            intptr_t rc1 = spawn_wait(llc_exe, llc_args);
-                            if (rc1 != 0) {
-                                fprintf(stderr, "llc failed with code %lld\n", (long long)rc1);
+                        } else if (!reuse_obj && emit != EMP_EMIT_ASM && have_fp) {
+                            (void)emp_fingerprints_save(fp_path, &fp_cur);
+                        }
+                        if (rc_rt != 0) {
+                            fprintf(stderr, "llc failed on the runtime module (%s) with code %lld\n", rt_ll_path, (long long)rc_rt);
+                            (void)remove(rt_obj_path);
+                            exit_code = 1;
+                        }
+                        if (exit_code == 0 && emit == EMP_EMIT_OBJ) {
+                            fprintf(stderr, "emp: link %s together with the runtime object %s\n", obj_path, rt_obj_path);
+                        }
+
+                        if (exit_code == 0 && emit == EMP_EMIT_EXE) {
+                            tc = toolchain_link_inputs();
+#ifdef _WIN32
+                            if (!tc->link_ok) {
+                                fprintf(stderr, "Failed to locate Windows SDK libs (kernel32.lib). Install Windows 10 SDK via VS Installer.\n");
                                 exit_code = 1;
                             } else {
-                                char *um_x64 = find_windows_kits_um_x64();
-                                if (!um_x64) {
-                                    fprintf(stderr, "Failed to locate Windows SDK libs (kernel32.lib). Install Windows 10 SDK via VS Installer.\n");
+                                char outarg[MAX_PATH * 2];
+                                char libpatharg[MAX_PATH * 2];
+                                char entryarg[128];
+                                snprintf(outarg, sizeof(outarg), "/OUT:%s", exe_path);
+                                snprintf(libpatharg, sizeof(libpatharg), "/LIBPATH:%s", tc->um_x64);
+                                snprintf(entryarg, sizeof(entryarg), "/ENTRY:mainCRTStartup");
+                                const char *link_args[] = {tc->lld, "/NOLOGO", "/SUBSYSTEM:CONSOLE", entryarg, outarg, libpatharg, obj_path, rt_obj_path, "kernel32.lib", NULL};
+                                intptr_t rc2 = spawn_wait(tc->lld, link_args);
+                                if (rc2 != 0) {
+                                    fprintf(stderr, "lld-link failed with code %lld\n", (long long)rc2);
                                     exit_code = 1;
-                                } else {
-                                    char outarg[MAX_PATH * 2];
-                                    char libpatharg[MAX_PATH * 2];
-                                    char entryarg[128];
-                                    snprintf(outarg, sizeof(outarg), "/OUT:%s", exe_path);
-                                    snprintf(libpatharg, sizeof(libpatharg), "/LIBPATH:%s", um_x64);
-                                    snprintf(entryarg, sizeof(entryarg), "/ENTRY:mainCRTStartup");
-                                    const char *link_args[] = {lld_exe, "/NOLOGO", "/SUBSYSTEM:CONSOLE", entryarg, outarg, libpatharg, obj_path, "kernel32.lib", NULL};
-                                    intptr_t rc2 = spawn_wait(lld_exe, link_args);
-                                    if (rc2 != 0) {
-                                        fprintf(stderr, "lld-link failed with code %lld\n", (long long)rc2);
-                                        exit_code = 1;
-                                    }
-                                    free(um_x64);
                                 }
                             }
-                        }
 #else
-                        char llc[PATH_MAX];
-                        char lld[PATH_MAX];
-                        const char *llc_exe = NULL;
-                        const char *lld_exe = NULL;
-                        if (find_in_path("llc", llc, sizeof(llc))) llc_exe = llc;
-                        if (find_in_path("ld.lld", lld, sizeof(lld))) lld_exe = lld;
-                        else if (find_in_path("lld", lld, sizeof(lld))) lld_exe = lld;
-
-                        if (!llc_exe || !lld_exe) {
-                            fprintf(stderr, "LLVM tools missing (llc and ld.lld/lld). Install llvm/lld on Ubuntu.\n");
-                            exit_code = 1;
-                        } else {
-                            const char *llc_args[] = {llc_exe, "-filetype=obj", "-relocation-model=pic", "-o", obj_path, ll_path, NULL};
-                            intptr_t rc1 = spawn_wait(llc_exe, llc_args);
-                            if (rc1 != 0) {
-                                fprintf(stderr, "llc failed with code %lld\n", (long long)rc1);
+                            if (!tc->link_ok) {
+                                fprintf(stderr, "C runtime startup objects missing (%s). Install libc6-dev.\n", k_linux_crt_objs[0]);
                                 exit_code = 1;
                             } else {
-                                const char *link_args[] = {lld_exe, "-pie", "-dynamic-linker", "/lib64/ld-linux-x86-64.so.2", "/usr/lib/x86_64-linux-gnu/Scrt1.o", "/usr/lib/x86_64-linux-gnu/crti.o", obj_path, "-lc", "/usr/lib/x86_64-linux-gnu/crtn.o", "-o", exe_path, NULL};
-                                intptr_t rc2 = spawn_wait(lld_exe, link_args);
+                                const char *link_args[] = {tc->lld, "-pie", "-dynamic-linker", "/lib64/ld-linux-x86-64.so.2", k_linux_crt_objs[0], k_linux_crt_objs[1], obj_path, rt_obj_path, "-lc", k_linux_crt_objs[2], "-o", exe_path, NULL};
+                                intptr_t rc2 = spawn_wait(tc->lld, link_args);
                                 if (rc2 != 0) {
                                     fprintf(stderr, "lld failed with code %lld\n", (long long)rc2);
                                     exit_code = 1;
                                 }
                             }
+#endif
                         }
+                    }
+
+#ifndef _WIN32
+                    if (exit_code == 0 && run_exe && g_serve_report_fd >= 0) {
+                        // `r <argv index of the first program argument> <exe>`: the client runs
+                        // the program in its own process, with its own environment and signals.
+                        char line[32];
+                        snprintf(line, sizeof(line), "r %d ", run_argv ? (int)(run_argv - argv) : argc);
+                        (void)!write(g_serve_report_fd, line, strlen(line));
+                        (void)!write(g_serve_report_fd, exe_path, strlen(exe_path));
+                        (void)!write(g_serve_report_fd, "\n", 1);
+                        run_exe = false;
+                    }
 #endif
+                    if (exit_code == 0 && run_exe) {
+                        const char **prog_args = (const char **)calloc((size_t)run_argc + 2, sizeof(char *));
+                        if (!prog_args) {
+                            exit_code = 1;
+                        } else {
+                            prog_args[0] = exe_path;
+                            for (int ai = 0; ai < run_argc; ai++) prog_args[ai + 1] = run_argv[ai];
+                            fflush(stdout);
+                            fflush(stderr);
+                            intptr_t rc = spawn_wait(exe_path, prog_args);
+                            if (rc < 0) {
+                                fprintf(stderr, "Failed to run %s\n", exe_path ? exe_path : "<null>");
+                                exit_code = 1;
+                            } else {
+                                exit_code = (int)rc;
+                            }
+                            free(prog_args);
+                        }
                     }
 
+                    emp_fingerprints_free(&fp_prev);
+                    emp_fingerprints_free(&fp_cur);
+                    free(fp_path);
                     free(base);
                     free(ll_path);
                     free(obj_path);
+                    free(asm_path);
+                    free(rt_ll_path);
+                    free(rt_obj_path);
                     free(exe_path);
                 }
 
                 emp_vec_free(&merged_program.items);
+                emp_vec_free(&merged_program.fmt_consts);
 #else
+                (void)stats;
+                (void)emit;
+                (void)run_argc;
+                (void)run_argv;
                 fprintf(stderr, "LLVM backend not enabled in this build. Reconfigure/build with the x64 preset and LLVM available.\n");
                 exit_code = 1;
 #endif
@@ -2344,6 +3345,8 @@ int main(int argc, char **argv) {
         } else if (mode == EMP_MODE_JSON) {
             setvbuf(out, NULL, _IONBF, 0);
             emp_program_to_json(out, entry->pr.program, &merged);
+        } else if (mode == EMP_MODE_CHECK) {
+            print_diags(&merged);
         } else {
             // Like JSON, keep debug output unbuffered to avoid losing output on crashes.
             setvbuf(out, NULL, _IONBF, 0);
@@ -2371,3 +3374,642 @@ int main(int argc, char **argv) {
     if (out && out != stdout) fclose(out);
     return exit_code;
 }
+
+#ifndef _WIN32
+// ===== Compile server (`emp serve`) =====
+//
+// The server parses modules once and keeps them (plus the resolved toolchain) in memory.
+// Each request is handled in a forked child that inherits those caches copy-on-write, runs the
+// normal driver with the client's cwd, environment (EMP_* vars) and stdio (passed over the
+// socket with SCM_RIGHTS), and exits. Requests run concurrently: the parent keeps accepting
+// while children build, and reaps each one when its report pipe closes. It then refreshes its
+// module cache from the paths the child reported, re-parsing only files whose mtime, size or
+// contents changed.
+//
+// `emp run` only builds on the server. The program itself is started by the client, so it gets
+// the client's full environment, terminal and signals, and never occupies the server.
+//
+// Wire format (client -> server): u32 payload length (host order) + 3 fds, then the payload:
+//   cwd '\0' env_count '\0' env_0 '\0' ... argv_0 '\0' argv_1 '\0' ...
+// Reply: i32 exit code; after a successful `emp run` build, followed by
+//   argv index of the first program argument '\0' exe path '\0'
+//
+// The request hands over the client's stdio, so both ends only talk to their own user: the
+// default socket lives in a directory only that user can enter, and each side checks the uid
+// of its peer (SO_PEERCRED / getpeereid). The client compiles locally on any mismatch.
+
+#define EMP_SERVE_STOP_ARG "--serve-stop"
+
+// True when `dir` exists as a directory that only this user can reach. Only the server creates
+// it; clients just look.
+static bool serve_private_dir(const char *dir, bool create) {
+    if (create && mkdir(dir, 0700) != 0 && errno != EEXIST) return false;
+    struct stat st;
+    if (lstat(dir, &st) != 0) return false;
+    return S_ISDIR(st.st_mode) && st.st_uid == getuid() && (st.st_mode & 077) == 0;
+}
+
+// NULL when the default socket directory is missing, shared with other users, or the path does
+// not fit in `buf`.
+static const char *serve_socket_path(char *buf, size_t cap, bool create) {
+    const char *env = getenv("EMP_SERVE_SOCKET");
+    int n;
+    if (env && env[0]) {
+        n = snprintf(buf, cap, "%s", env);
+        return n < 0 || (size_t)n >= cap ? NULL : buf;
+    }
+    char dir[PATH_MAX];
+    const char *rt = getenv("XDG_RUNTIME_DIR");
+    if (rt && rt[0]) n = snprintf(dir, sizeof(dir), "%s/emp", rt);
+    else n = snprintf(dir, sizeof(dir), "/tmp/emp-%u", (unsigned)getuid());
+    if (n < 0 || (size_t)n >= sizeof(dir)) return NULL;
+    if (!serve_private_dir(dir, create)) return NULL;
+    n = snprintf(buf, cap, "%s/serve.sock", dir);
+    return n < 0 || (size_t)n >= cap ? NULL : buf;
+}
+
+// Is the process at the other end of `fd` running as this user?
+static bool serve_peer_is_self(int fd) {
+#if defined(SO_PEERCRED)
+    struct ucred cred;
+    socklen_t n = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &n) != 0 || n != sizeof(cred)) return false;
+    return cred.uid == getuid();
+#else
+    uid_t uid = 0;
+    gid_t gid = 0;
+    if (getpeereid(fd, &uid, &gid) != 0) return false;
+    return uid == getuid();
+#endif
+}
+
+static bool serve_fill_addr(struct sockaddr_un *addr, const char *sock_path) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(sock_path) >= sizeof(addr->sun_path)) return false;
+    memcpy(addr->sun_path, sock_path, strlen(sock_path) + 1);
+    return true;
+}
+
+static int serve_connect(const char *sock_path) {
+    struct sockaddr_un addr;
+    if (!serve_fill_addr(&addr, sock_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (!serve_peer_is_self(fd)) {
+        fprintf(stderr, "emp: %s is served by another user; ignoring it\n", sock_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool write_all(int fd, const void *data, size_t n) {
+    const char *p = (const char *)data;
+    while (n) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *data, size_t n) {
+    char *p = (char *)data;
+    while (n) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+static bool buf_append(char **buf, size_t *len, size_t *cap, const char *s) {
+    size_t n = strlen(s) + 1;
+    if (*len + n > *cap) {
+        size_t new_cap = *cap ? *cap * 2 : 1024;
+        while (new_cap < *len + n) new_cap *= 2;
+        char *p = (char *)realloc(*buf, new_cap);
+        if (!p) return false;
+        *buf = p;
+        *cap = new_cap;
+    }
+    memcpy(*buf + *len, s, n);
+    *len += n;
+    return true;
+}
+
+// Sends the request; returns the connected fd or -1.
+static int serve_send_request(const char *sock_path, int argc, char **argv) {
+    int fd = serve_connect(sock_path);
+    if (fd < 0) return -1;
+
+    char *payload = NULL;
+    size_t len = 0;
+    size_t cap = 0;
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) cwd[0] = '\0';
+    bool ok = buf_append(&payload, &len, &cap, cwd);
+
+    size_t env_count = 0;
+    for (char **e = environ; e && *e; e++) {
+        if (strncmp(*e, "EMP_", 4) == 0) env_count++;
+    }
+    char num[32];
+    snprintf(num, sizeof(num), "%zu", env_count);
+    ok = ok && buf_append(&payload, &len, &cap, num);
+    for (char **e = environ; ok && e && *e; e++) {
+        if (strncmp(*e, "EMP_", 4) == 0) ok = buf_append(&payload, &len, &cap, *e);
+    }
+    for (int i = 0; ok && i < argc; i++) ok = buf_append(&payload, &len, &cap, argv[i] ? argv[i] : "");
+
+    if (ok) {
+        uint32_t n32 = (uint32_t)len;
+        struct iovec iov;
+        iov.iov_base = &n32;
+        iov.iov_len = sizeof(n32);
+
+        int fds[3] = {0, 1, 2};
+        char ctrl[CMSG_SPACE(sizeof(fds))];
+        memset(ctrl, 0, sizeof(ctrl));
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl;
+        msg.msg_controllen = sizeof(ctrl);
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+
+        ok = sendmsg(fd, &msg, 0) == (ssize_t)sizeof(n32) && write_all(fd, payload, len);
+    }
+    free(payload);
+    if (!ok) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Returns the exit code from the server, or -1 when no server handled the request.
+static int serve_try_forward(int argc, char **argv) {
+    const char *opt_out = getenv("EMP_NO_DAEMON");
+    if (opt_out && opt_out[0] && strcmp(opt_out, "0") != 0) return -1;
+    if (argc < 2) return -1;
+    if (strcmp(argv[1], "new") == 0 || strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0) return -1;
+
+    char sock_buf[PATH_MAX];
+    const char *sock_path = serve_socket_path(sock_buf, sizeof(sock_buf), false);
+    if (!sock_path) return -1;
+    int fd = serve_send_request(sock_path, argc, argv);
+    if (fd < 0) return -1;
+
+    int32_t code = 0;
+    bool ok = read_all(fd, &code, sizeof(code));
+    // The rest of the reply, if any, names the program `emp run` built.
+    char run[PATH_MAX + 32];
+    size_t run_len = 0;
+    while (ok && run_len < sizeof(run) - 1) {
+        ssize_t r = read(fd, run + run_len, sizeof(run) - 1 - run_len);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        run_len += (size_t)r;
+    }
+    run[run_len] = '\0';
+    close(fd);
+    if (!ok) {
+        fprintf(stderr, "emp: compile server dropped the request; compiling locally\n");
+        return -1;
+    }
+    if (code != 0 || run_len == 0) return (int)code;
+
+    int first = atoi(run);
+    const char *exe = run + strlen(run) + 1;
+    if (first < 1 || first > argc || exe >= run + run_len || !exe[0]) {
+        fprintf(stderr, "emp: malformed reply from the compile server\n");
+        return 1;
+    }
+    char **prog_args = (char **)calloc((size_t)(argc - first) + 2, sizeof(char *));
+    if (!prog_args) return 1;
+    prog_args[0] = (char *)exe;
+    for (int i = first; i < argc; i++) prog_args[i - first + 1] = argv[i];
+    fflush(NULL);
+    execv(exe, prog_args);
+    fprintf(stderr, "Failed to run %s\n", exe);
+    free(prog_args);
+    return 1;
+}
+
+static void modules_remove_at(EmpModules *m, size_t idx) {
+    if (idx >= m->len) return;
+    EmpModule *mm = &m->items[idx];
+    emp_parse_result_free(&mm->pr);
+    free(mm->src_owned);
+    free(mm->path_abs);
+    free(mm->dir_abs);
+    memmove(&m->items[idx], &m->items[idx + 1], (m->len - idx - 1) * sizeof(EmpModule));
+    m->len--;
+}
+
+// Re-parse (or add) a module in the server cache when its file changed since it was parsed.
+static void serve_refresh_module(EmpModules *cache, const char *path_abs) {
+    long long mtime = 0;
+    long long fsize = 0;
+    bool have_stamp = file_stamp(path_abs, &mtime, &fsize);
+    EmpModule *cached = modules_find(cache, path_abs);
+    if (cached) {
+        uint64_t hash = 0;
+        if (have_stamp && cached->stamp_mtime == mtime && cached->stamp_size == fsize && file_content_hash(path_abs, &hash) && hash == cached->stamp_hash) return;
+        modules_remove_at(cache, (size_t)(cached - cache->items));
+    }
+    if (have_stamp) (void)load_module(cache, path_abs);
+}
+
+// Re-list a directory the request had to scan so the next request can reuse it. Listings held by
+// the server are never `fresh`: each request revalidates them once.
+static void serve_refresh_dir(const char *dir_abs) {
+    EmpDirListing *l = dircache_get(dir_abs);
+    if (!l) return;
+    l->fresh = false;
+    l->scanned = false;
+}
+
+static bool serve_recv_request(int conn, int fds_out[3], char **payload_out, size_t *len_out) {
+    uint32_t n32 = 0;
+    struct iovec iov;
+    iov.iov_base = &n32;
+    iov.iov_len = sizeof(n32);
+    char ctrl[CMSG_SPACE(sizeof(int) * 3)];
+    memset(ctrl, 0, sizeof(ctrl));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+
+    if (recvmsg(conn, &msg, 0) != (ssize_t)sizeof(n32)) return false;
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    if (!cm || cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS || cm->cmsg_len != CMSG_LEN(sizeof(int) * 3)) return false;
+    memcpy(fds_out, CMSG_DATA(cm), sizeof(int) * 3);
+
+    if (n32 == 0 || n32 > (64u << 20)) return false;
+    char *payload = (char *)malloc(n32);
+    if (!payload || !read_all(conn, payload, n32) || payload[n32 - 1] != '\0') {
+        free(payload);
+        return false;
+    }
+    *payload_out = payload;
+    *len_out = n32;
+    return true;
+}
+
+// A request being built by a forked child. `report` is the read end of the child's report pipe;
+// it reaches EOF when the child exits.
+typedef struct {
+    pid_t pid;
+    int conn;
+    int report;
+    char *acc;
+    size_t acc_len;
+} EmpServeJob;
+
+typedef struct {
+    EmpServeJob *items;
+    size_t len;
+    size_t cap;
+} EmpServeJobs;
+
+// Reads a request from `conn` and forks a child to run it. Returns true when the connection now
+// belongs to a job in `jobs`; otherwise the caller closes it (after any reply was written).
+static bool serve_start(int listen_fd, int conn, EmpModules *cache, EmpServeJobs *jobs, bool *out_stop) {
+    int fds[3] = {-1, -1, -1};
+    char *payload = NULL;
+    size_t len = 0;
+    if (!serve_recv_request(conn, fds, &payload, &len)) {
+        for (int i = 0; i < 3; i++) if (fds[i] >= 0) close(fds[i]);
+        return false;
+    }
+
+    // Split the payload into cwd / env / argv.
+    StrVec parts;
+    memset(&parts, 0, sizeof(parts));
+    for (size_t at = 0; at < len;) {
+        (void)strvec_push(&parts, payload + at);
+        at += strlen(payload + at) + 1;
+    }
+    size_t env_count = parts.len >= 2 ? (size_t)strtoul(parts.items[1], NULL, 10) : 0;
+    size_t argv_at = 2 + env_count;
+    int32_t code = 2;
+    bool started = false;
+    bool reply = true;
+
+    if (parts.len > argv_at && parts.len - argv_at >= 2 && strcmp(parts.items[argv_at + 1], EMP_SERVE_STOP_ARG) == 0) {
+        *out_stop = true;
+        code = 0;
+    } else if (parts.len > argv_at) {
+        int report[2] = {-1, -1};
+        bool have_slot = jobs->len < jobs->cap;
+        if (!have_slot) {
+            size_t new_cap = jobs->cap ? jobs->cap * 2 : 8;
+            EmpServeJob *p = (EmpServeJob *)realloc(jobs->items, new_cap * sizeof(EmpServeJob));
+            if (p) {
+                jobs->items = p;
+                jobs->cap = new_cap;
+                have_slot = true;
+            }
+        }
+        fflush(NULL);
+        pid_t pid = have_slot && pipe(report) == 0 ? fork() : -1;
+        if (pid == 0) {
+            close(listen_fd);
+            close(conn);
+            for (size_t i = 0; i < jobs->len; i++) {
+                close(jobs->items[i].conn);
+                close(jobs->items[i].report);
+            }
+            close(report[0]);
+            (void)signal(SIGPIPE, SIG_DFL);
+            // Compiler tools must not hold the pipe open past this process.
+            (void)fcntl(report[1], F_SETFD, FD_CLOEXEC);
+            dup2(fds[0], 0);
+            dup2(fds[1], 1);
+            dup2(fds[2], 2);
+            for (int i = 0; i < 3; i++) if (fds[i] > 2) close(fds[i]);
+
+            // Replace the server's EMP_* environment with the client's.
+            for (;;) {
+                char **e = environ;
+                while (e && *e && strncmp(*e, "EMP_", 4) != 0) e++;
+                if (!e || !*e) break;
+                char name[256];
+                const char *eq = strchr(*e, '=');
+                size_t n = eq ? (size_t)(eq - *e) : strlen(*e);
+                if (n >= sizeof(name)) n = sizeof(name) - 1;
+                memcpy(name, *e, n);
+                name[n] = '\0';
+                if (unsetenv(name) != 0) break;
+            }
+            for (size_t i = 0; i < env_count && 2 + i < parts.len; i++) {
+                char *kv = parts.items[2 + i];
+                char *eq = strchr(kv, '=');
+                if (!eq) continue;
+                *eq = '\0';
+                (void)setenv(kv, eq + 1, 1);
+            }
+
+            if (parts.items[0][0] && chdir(parts.items[0]) != 0) {
+                fprintf(stderr, "emp serve: cannot enter %s\n", parts.items[0]);
+                _exit(1);
+            }
+            g_serve_cache = cache;
+            g_serve_report_fd = report[1];
+            int rc = emp_driver_main((int)(parts.len - argv_at), &parts.items[argv_at]);
+            fflush(NULL);
+            _exit(rc & 0xff);
+        }
+        if (report[1] >= 0) close(report[1]);
+        if (pid > 0) {
+            EmpServeJob *job = &jobs->items[jobs->len++];
+            memset(job, 0, sizeof(*job));
+            job->pid = pid;
+            job->conn = conn;
+            job->report = report[0];
+            started = true;
+        } else {
+            // Without a child nothing was built: drop the connection so the client compiles locally.
+            if (report[0] >= 0) close(report[0]);
+            fprintf(stderr, "emp serve: cannot start a request: %s\n", strerror(errno));
+            reply = false;
+        }
+    }
+
+    for (int i = 0; i < 3; i++) if (fds[i] >= 0) close(fds[i]);
+    if (!started && reply) (void)write_all(conn, &code, sizeof(code));
+    free(parts.items);
+    free(payload);
+    return started;
+}
+
+// Called once the job's report pipe reached EOF: reaps the child, replies to the client and
+// refreshes the caches from the paths the child reported.
+static void serve_finish(EmpServeJob *job, EmpModules *cache) {
+    close(job->report);
+    int status = 0;
+    while (waitpid(job->pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    int32_t code = 1;
+    if (WIFEXITED(status)) code = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status)) code = 128 + WTERMSIG(status);
+
+    StrVec loaded;
+    StrVec listed;
+    memset(&loaded, 0, sizeof(loaded));
+    memset(&listed, 0, sizeof(listed));
+    const char *run = NULL;
+    if (job->acc) {
+        job->acc[job->acc_len] = '\0';
+        for (char *line = strtok(job->acc, "\n"); line; line = strtok(NULL, "\n")) {
+            if (line[0] == '\0' || line[1] != ' ') continue;
+            if (line[0] == 'r') run = line + 2;
+            StrVec *dst = line[0] == 'm' ? &loaded : line[0] == 'd' ? &listed : NULL;
+            if (dst && !strvec_contains(dst, line + 2)) (void)strvec_push(dst, xstrdup(line + 2));
+        }
+    }
+
+    bool ok = write_all(job->conn, &code, sizeof(code));
+    if (ok && code == 0 && run) {
+        // "<index> <exe>" -> "<index>\0<exe>\0"
+        char *sp = strchr(run, ' ');
+        if (sp) {
+            *sp = '\0';
+            ok = write_all(job->conn, run, strlen(run) + 1) && write_all(job->conn, sp + 1, strlen(sp + 1) + 1);
+        }
+    }
+    close(job->conn);
+
+    for (size_t i = 0; i < loaded.len; i++) serve_refresh_module(cache, loaded.items[i]);
+    for (size_t i = 0; i < listed.len; i++) serve_refresh_dir(listed.items[i]);
+    strvec_free(&loaded);
+    strvec_free(&listed);
+    free(job->acc);
+}
+
+static int cmd_serve(int argc, char **argv) {
+    const char *sock_opt = NULL;
+    bool stop = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            sock_opt = argv[++i];
+        } else if (strcmp(argv[i], "--stop") == 0) {
+            stop = true;
+        } else {
+            fprintf(stderr, "Usage: %s serve [--socket path] [--stop]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    char sock_buf[PATH_MAX];
+    const char *sock_path = sock_opt ? sock_opt : serve_socket_path(sock_buf, sizeof(sock_buf), !stop);
+    if (!sock_path) {
+        fprintf(stderr, "emp serve: %s must be a directory private to this user\n", getenv("XDG_RUNTIME_DIR") ? "$XDG_RUNTIME_DIR/emp" : "/tmp/emp-<uid>");
+        return 1;
+    }
+
+    if (stop) {
+        char *stop_argv[] = {argv[0], (char *)EMP_SERVE_STOP_ARG};
+        int fd = serve_send_request(sock_path, 2, stop_argv);
+        if (fd < 0) {
+            fprintf(stderr, "emp serve: no server on %s\n", sock_path);
+            return 1;
+        }
+        int32_t code = 0;
+        (void)read_all(fd, &code, sizeof(code));
+        close(fd);
+        return 0;
+    }
+
+    int probe = serve_connect(sock_path);
+    if (probe >= 0) {
+        close(probe);
+        fprintf(stderr, "emp serve: already running on %s\n", sock_path);
+        return 1;
+    }
+    (void)unlink(sock_path);
+
+    struct sockaddr_un addr;
+    if (!serve_fill_addr(&addr, sock_path)) {
+        fprintf(stderr, "emp serve: socket path too long: %s\n", sock_path);
+        return 1;
+    }
+    // Created 0600 rather than chmod-ed after bind, so nobody can connect in between.
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t old_mask = umask(0177);
+    bool bound = lfd >= 0 && bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    (void)umask(old_mask);
+    if (!bound || listen(lfd, 16) != 0) {
+        fprintf(stderr, "emp serve: cannot listen on %s: %s\n", sock_path, strerror(errno));
+        if (lfd >= 0) close(lfd);
+        return 1;
+    }
+
+    // Warm per-process caches once; request children inherit them.
+    (void)compiler_build_id();
+    (void)toolchain_tools();
+    (void)toolchain_link_inputs();
+
+    EmpModules cache;
+    modules_init(&cache);
+
+    // A client that goes away before its reply must not take the server down.
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    EmpServeJobs jobs;
+    memset(&jobs, 0, sizeof(jobs));
+    struct pollfd *pfds = NULL;
+
+    fprintf(stderr, "emp serve: listening on %s\n", sock_path);
+    bool should_stop = false;
+    bool accepting = true;
+    // After a stop request, requests already running are still finished and answered.
+    while (accepting || jobs.len) {
+        struct pollfd *p = (struct pollfd *)realloc(pfds, (jobs.len + 1) * sizeof(struct pollfd));
+        if (!p) break;
+        pfds = p;
+        for (size_t i = 0; i < jobs.len; i++) {
+            pfds[i].fd = jobs.items[i].report;
+            pfds[i].events = POLLIN;
+            pfds[i].revents = 0;
+        }
+        pfds[jobs.len].fd = accepting ? lfd : -1;
+        pfds[jobs.len].events = POLLIN;
+        pfds[jobs.len].revents = 0;
+        size_t n_jobs = jobs.len;
+        if (poll(pfds, (nfds_t)(n_jobs + 1), -1) < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "emp serve: poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        // Drain reports; finish (and drop) the jobs whose child is done.
+        for (size_t i = n_jobs; i-- > 0;) {
+            if (!pfds[i].revents) continue;
+            EmpServeJob *job = &jobs.items[i];
+            char chunk[4096];
+            ssize_t r = read(job->report, chunk, sizeof(chunk));
+            if (r < 0 && errno == EINTR) continue;
+            if (r > 0) {
+                char *grown = (char *)realloc(job->acc, job->acc_len + (size_t)r + 1);
+                if (grown) {
+                    job->acc = grown;
+                    memcpy(job->acc + job->acc_len, chunk, (size_t)r);
+                    job->acc_len += (size_t)r;
+                }
+                continue;
+            }
+            serve_finish(job, &cache);
+            jobs.items[i] = jobs.items[--jobs.len];
+        }
+
+        if (accepting && pfds[n_jobs].revents) {
+            int conn = accept(lfd, NULL, NULL);
+            if (conn < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                fprintf(stderr, "emp serve: accept failed: %s\n", strerror(errno));
+                accepting = false;
+                continue;
+            }
+            if (!serve_peer_is_self(conn)) {
+                close(conn);
+                continue;
+            }
+            if (!serve_start(lfd, conn, &cache, &jobs, &should_stop)) close(conn);
+            if (should_stop) {
+                // Nobody new can reach a server that is shutting down.
+                accepting = false;
+                close(lfd);
+                lfd = -1;
+                (void)unlink(sock_path);
+            }
+        }
+    }
+
+    if (lfd >= 0) {
+        close(lfd);
+        (void)unlink(sock_path);
+    }
+    free(pfds);
+    free(jobs.items);
+    modules_free(&cache);
+    return 0;
+}
+#endif
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+#ifdef _WIN32
+        fprintf(stderr, "emp serve is not supported on Windows yet\n");
+        return 2;
+#else
+        return cmd_serve(argc, argv);
+#endif
+    }
+
+#ifndef _WIN32
+    int forwarded = serve_try_forward(argc, argv);
+    if (forwarded >= 0) return forwarded;
+#endif
+
+    return emp_driver_main(argc, argv);
+}